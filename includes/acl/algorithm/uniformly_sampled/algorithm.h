@@ -41,9 +41,9 @@ namespace acl
 			m_compression_settings.range_reduction = range_reduction;
 		}
 
-		virtual CompressedClip* compress_clip(Allocator& allocator, const AnimationClip& clip, const RigidSkeleton& skeleton) override
+		virtual CompressedClip* compress_clip(Allocator& allocator, const AnimationClip& clip, const RigidSkeleton& skeleton, CompressionStats* out_stats = nullptr) override
 		{
-			return uniformly_sampled::compress_clip(allocator, clip, skeleton, m_compression_settings);
+			return uniformly_sampled::compress_clip(allocator, clip, skeleton, m_compression_settings, nullptr, out_stats);
 		}
 
 		virtual void decompress_pose(const CompressedClip& clip, float sample_time, Transform_32* out_transforms, uint16_t num_transforms) override
@@ -53,6 +53,23 @@ namespace acl
 			uniformly_sampled::decompress_pose(settings, clip, sample_time, writer);
 		}
 
+		virtual void decompress_poses(Allocator& allocator, const CompressedClip& clip, const float* sample_times, uint32_t num_poses, Transform_32* const* out_poses, uint16_t num_transforms) override
+		{
+			if (num_poses == 0)
+				return;
+
+			uniformly_sampled::DecompressionSettings settings;
+
+			// One writer per pose, the batch entry point is writer generic
+			AlgorithmOutputWriterImpl* writers = reinterpret_cast<AlgorithmOutputWriterImpl*>(allocator.allocate(sizeof(AlgorithmOutputWriterImpl) * num_poses, alignof(AlgorithmOutputWriterImpl)));
+			for (uint32_t pose_index = 0; pose_index < num_poses; ++pose_index)
+				new(&writers[pose_index]) AlgorithmOutputWriterImpl(out_poses[pose_index], num_transforms);
+
+			uniformly_sampled::decompress_poses(allocator, settings, clip, sample_times, num_poses, writers);
+
+			deallocate_type_array(allocator, writers, num_poses);
+		}
+
 		virtual void decompress_bone(const CompressedClip& clip, float sample_time, uint16_t sample_bone_index, Quat_32* out_rotation, Vector4_32* out_translation) override
 		{
 			uniformly_sampled::DecompressionSettings settings;
@@ -64,6 +81,10 @@ namespace acl
 			uniformly_sampled::print_stats(clip, file);
 		}
 
+		// The settings the constructor arguments mapped to, the compressed output
+		// is a pure function of these, the clip, and the skeleton
+		const uniformly_sampled::CompressionSettings& get_compression_settings() const { return m_compression_settings; }
+
 	private:
 		uniformly_sampled::CompressionSettings m_compression_settings;
 	};
@@ -38,6 +38,10 @@ namespace acl
 			struct FullPrecisionConstants
 			{
 				static constexpr uint32_t NUM_TRACKS_PER_BONE = 2;
+
+				// Clips compressed with scale tracks carry a third track per bone
+				// in the bitsets, see FullPrecisionHeader::has_scale
+				static constexpr uint32_t NUM_TRACKS_PER_SCALED_BONE = 3;
 			};
 
 			struct FullPrecisionHeader
@@ -46,13 +50,28 @@ namespace acl
 				RotationFormat8			rotation_format;
 				VectorFormat8			translation_format;
 				RangeReductionFlags8	range_reduction;
+				AnimationDataLayout8	data_layout;
+				bool					are_key_frames_paired;						// Key frame pairs are interleaved per track, see CompressionSettings
+				bool					is_animated_data_external;					// The animated track data lives in a separate payload buffer, see compress_clip_split
+				bool					is_constant_data_external;					// The constant track data lives in a shared database pool, see compress_clip_database
+				bool					is_delta_encoded;							// Animated samples store 32 bit deltas from the previous sample, see CompressionSettings::enable_delta_encoding
+				bool					is_additive;								// Tracks store deltas from a reference pose and decompress as deltas, see CompressionSettings::additive_base_pose
+				bool					has_scale;									// The clip has scale tracks, three tracks per bone in the bitsets; scale samples always store full precision
 				uint32_t				num_samples;
 				uint32_t				sample_rate;								// TODO: Store duration as float instead
 				uint32_t				num_animated_rotation_tracks;				// TODO: Calculate from bitsets?
 				uint32_t				num_animated_translation_tracks;			// TODO: Calculate from bitsets?
+				uint32_t				num_animated_scale_tracks;					// 0 when the clip has no scale tracks
+				uint32_t				num_samples_per_segment;					// 0 when the clip is not segmented
+				uint32_t				num_segments;
+				uint32_t				animated_data_size;							// Size in bytes of the animated track data, resident or external
+				uint16_t				num_lod_levels;								// 0 when the clip has no LOD data
 
 				PtrOffset16<uint32_t>	default_tracks_bitset_offset;
 				PtrOffset16<uint32_t>	constant_tracks_bitset_offset;
+				PtrOffset16<uint8_t>	format_per_track_data_offset;				// Invalid when every track uses the clip wide formats
+				PtrOffset16<uint32_t>	segment_headers_offset;						// Invalid when the clip is not segmented
+				PtrOffset16<uint16_t>	lod_data_offset;							// Invalid when the clip has no LOD data
 				PtrOffset16<uint8_t>	constant_track_data_offset;
 				PtrOffset16<uint8_t>	clip_range_data_offset;
 				PtrOffset16<uint8_t>	track_data_offset;
@@ -65,12 +84,36 @@ namespace acl
 				uint32_t*		get_constant_tracks_bitset()		{ return constant_tracks_bitset_offset.add_to(this); }
 				const uint32_t*	get_constant_tracks_bitset() const	{ return constant_tracks_bitset_offset.add_to(this); }
 
+				// When variable quantization is used, two bytes per bone: the RotationFormat8
+				// followed by the VectorFormat8 chosen for that bone. Null otherwise.
+				uint8_t*		get_format_per_track_data()			{ return format_per_track_data_offset.safe_add_to(this); }
+				const uint8_t*	get_format_per_track_data() const	{ return format_per_track_data_offset.safe_add_to(this); }
+
+				// When the clip is segmented, two uint32 per segment: the segment's animated
+				// data offset relative to the track data and its range data offset relative
+				// to the clip range data. Null otherwise.
+				uint32_t*		get_segment_headers()				{ return segment_headers_offset.safe_add_to(this); }
+				const uint32_t*	get_segment_headers() const			{ return segment_headers_offset.safe_add_to(this); }
+
+				// When the clip has LOD data, num_lod_levels uint16 bone counts followed
+				// by num_bones uint16 entries mapping compressed track order to skeleton
+				// bone indices. Every per bone section is sorted so the bones animated
+				// at LOD level L are the first bone count[L] entries. Null otherwise.
+				uint16_t*		get_lod_data()						{ return lod_data_offset.safe_add_to(this); }
+				const uint16_t*	get_lod_data() const				{ return lod_data_offset.safe_add_to(this); }
+
+				// Null when the constant track data is external: it lives in the
+				// deduplicated pool of the database holding this clip and must be
+				// bound at decompression time, see compress_clip_database
 				uint8_t*		get_constant_track_data()			{ return constant_track_data_offset.safe_add_to(this); }
 				const uint8_t*	get_constant_track_data() const		{ return constant_track_data_offset.safe_add_to(this); }
 
 				uint8_t*		get_clip_range_data()				{ return clip_range_data_offset.safe_add_to(this); }
 				const uint8_t*	get_clip_range_data() const			{ return clip_range_data_offset.safe_add_to(this); }
 
+				// Null when the animated track data is external: the install
+				// section ends with the range data and the payload written by
+				// compress_clip_split must be bound at decompression time
 				uint8_t*		get_track_data()					{ return track_data_offset.safe_add_to(this); }
 				const uint8_t*	get_track_data() const				{ return track_data_offset.safe_add_to(this); }
 			};
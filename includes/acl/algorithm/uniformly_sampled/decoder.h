@@ -24,7 +24,11 @@
 // SOFTWARE.
 ////////////////////////////////////////////////////////////////////////////////
 
+#include "acl/core/compiler.h"
 #include "acl/core/compressed_clip.h"
+#include "acl/core/compressed_clip_database.h"
+#include "acl/core/memory.h"
+#include "acl/core/bitset.h"
 #include "acl/core/utils.h"
 #include "acl/math/quat_32.h"
 #include "acl/math/vector4_32.h"
@@ -33,6 +37,7 @@
 #include "acl/decompression/output_writer.h"
 
 #include <stdint.h>
+#include <algorithm>
 
 //////////////////////////////////////////////////////////////////////////
 // See encoder for details
@@ -63,31 +68,100 @@ namespace acl
 		{
 			struct DecompressionContext
 			{
-				// Read-only data
+				// Read-only data, initialized once per clip
 				const uint32_t* default_tracks_bitset;
 				const uint32_t* constant_tracks_bitset;
-				const uint8_t* constant_track_data;
+				const uint8_t* format_per_track_data;		// Null when every track uses the clip wide formats
+				const uint8_t* clip_constant_track_data;
 
-				const uint8_t* range_data;
+				const uint8_t* clip_range_data;
 
-				const uint8_t* key_frame_data0;
-				const uint8_t* key_frame_data1;
+				const uint8_t* animated_track_data;
+
+				const uint32_t* segment_headers;			// Null when the clip is not segmented
+				uint32_t num_samples_per_segment;
+				uint32_t num_segments;
+
+				// LOD data, the compressed tracks are sorted most persistent first so
+				// a coarse LOD decode stops after a prefix of the stream. The bone
+				// order maps compressed track order back to skeleton bone indices.
+				const uint16_t* lod_bone_order;		// Null when the clip has no LOD data
+				uint32_t num_decode_bones;
 
 				uint32_t bitset_size;
+
+				// 3 when the clip has scale tracks, 2 otherwise. Clips without scale
+				// carry no scale bits in the bitsets and no scale code runs for them
+				uint32_t num_tracks_per_bone;
+				bool has_scale;
+
 				uint32_t rotation_size;
 				uint32_t translation_size;
+
+				// Constant rotation tracks always use the clip's rotation format; this
+				// differs from rotation_size for delta encoded clips where every
+				// animated sample occupies 32 bits
+				uint32_t constant_rotation_size;
 				uint32_t range_rotation_size;
 				uint32_t range_translation_size;
+				uint32_t animated_rotation_size;	// Bytes of rotation data in one animated pose
+				uint32_t animated_pose_size;
+
+				// Size of the 48 bits per track refresh pose of a delta encoded
+				// clip, 0 otherwise, see write_delta_track_data
+				uint32_t delta_refresh_pose_size;
+
+				// 2 when key frame pairs are interleaved per track, 1 otherwise.
+				// Every key frame cursor then advances by two samples per track since
+				// consecutive samples of a track are adjacent in the pair block.
+				uint32_t num_interleaved_samples;
+
+				AnimationDataLayout8 data_layout;
+
+				float clip_duration;
+
+				// Seek specific data, updated every time we seek.
+				// The translation cursors are only used by the grouped layout where the
+				// translations of a key frame follow all of its rotations.
+				const uint8_t* key_frame_data0;
+				const uint8_t* key_frame_data1;
+				const uint8_t* key_frame_translation_data0;
+				const uint8_t* key_frame_translation_data1;
+
+				// Range data of the segment the seek landed in, equals clip_range_data
+				// when the clip is not segmented
+				const uint8_t* segment_range_data;
+
+				// Animated data of the segment the seek landed in, the delta decode
+				// path accumulates from the refresh pose it starts with
+				const uint8_t* segment_animated_data;
 
 				float interpolation_alpha;
 
-				// Read-write data
+				// interpolation_alpha in 16.16 fixed point for the fixed point decode path
+				uint32_t interpolation_alpha_fixed;
+
+				// Key frame indices relative to the segment holding them, the delta
+				// decode path accumulates from the segment's refresh frame
+				uint32_t delta_key_frame0;
+				uint32_t delta_key_frame1;
+
+				// Read-write data, the decoding functions advance these as tracks are consumed
+				const uint8_t* constant_track_data;
+				const uint8_t* range_data;
+
 				uint32_t default_track_offset;
 				uint32_t constant_track_offset;
+
+				// Cursors into the track bitsets at the current track offsets, they
+				// advance in lockstep with the offsets above and avoid a divide on
+				// every bitset test in the per bone decode loops
+				BitSetCursor default_track_cursor;
+				BitSetCursor constant_track_cursor;
 			};
 
 			template<class SettingsType>
-			inline void initialize_context(const SettingsType& settings, const FullPrecisionHeader& header, float sample_time, DecompressionContext& context)
+			inline void initialize_context(const SettingsType& settings, const FullPrecisionHeader& header, DecompressionContext& context)
 			{
 				const RotationFormat8 rotation_format = settings.get_rotation_format(header.rotation_format);
 				const VectorFormat8 translation_format = settings.get_translation_format(header.translation_format);
@@ -99,74 +173,242 @@ namespace acl
 				ACL_ENSURE(settings.is_translation_format_supported(translation_format), "Translation format (%s) isn't statically supported!", get_vector_format_name(translation_format));
 				ACL_ENSURE(range_reduction == header.range_reduction, "Statically compiled range reduction settings (%u) differ from the compressed settings (%u)!", range_reduction, header.range_reduction);
 				ACL_ENSURE(settings.are_range_reduction_flags_supported(range_reduction), "Range reduction settings (%u) aren't statically supported!", range_reduction);
+				ACL_ENSURE(settings.is_scale_supported() || !header.has_scale, "The clip has scale tracks but scale support is statically stripped!");
 
-				const uint32_t rotation_size = get_packed_rotation_size(rotation_format);
-				const uint32_t translation_size = get_packed_vector_size(translation_format);
+				// Delta encoded clips store every animated sample in 32 bits regardless
+				// of the clip formats, only the constant tracks keep the format sizes
+				const uint32_t rotation_size = header.is_delta_encoded ? sizeof(uint32_t) : get_packed_rotation_size(rotation_format);
+				const uint32_t translation_size = header.is_delta_encoded ? sizeof(uint32_t) : get_packed_vector_size(translation_format);
 				const uint32_t range_rotation_size = get_range_reduction_rotation_size(rotation_format);
 				const uint32_t range_translation_size = get_range_reduction_vector_size(translation_format);
-				const bool has_clip_range_reduction = is_enum_flag_set(range_reduction, RangeReductionFlags8::PerClip);
+				const bool has_range_reduction = has_per_block_range_reduction(range_reduction);
 
-				float clip_duration = float(header.num_samples - 1) / float(header.sample_rate);
+				context.default_tracks_bitset = header.get_default_tracks_bitset();
 
-				uint32_t key_frame0;
-				uint32_t key_frame1;
-				float interpolation_alpha;
-				calculate_interpolation_keys(header.num_samples, clip_duration, sample_time, key_frame0, key_frame1, interpolation_alpha);
+				context.constant_tracks_bitset = header.get_constant_tracks_bitset();
+				context.format_per_track_data = header.get_format_per_track_data();
+				context.clip_constant_track_data = header.get_constant_track_data();
 
-				// TODO: No need to store this, unpack from bitset in context and simplify branching logic below?
-				uint32_t animated_pose_size = (rotation_size * header.num_animated_rotation_tracks) + (translation_size * header.num_animated_translation_tracks);
+				context.clip_range_data = header.get_clip_range_data();
 
-				context.default_tracks_bitset = header.get_default_tracks_bitset();
+				context.animated_track_data = header.get_track_data();
 
-				context.constant_tracks_bitset = header.get_constant_tracks_bitset();
-				context.constant_track_data = header.get_constant_track_data();
+				context.segment_headers = header.get_segment_headers();
+				context.num_samples_per_segment = header.num_samples_per_segment;
+				context.num_segments = header.num_segments;
 
-				context.range_data = header.get_clip_range_data();
+				const uint16_t* lod_data = header.get_lod_data();
+				if (lod_data != nullptr)
+				{
+					const uint32_t lod_level = std::min(uint32_t(settings.get_level_of_detail()), uint32_t(header.num_lod_levels) - 1);
+					context.lod_bone_order = lod_data + header.num_lod_levels;
+					context.num_decode_bones = lod_data[lod_level];
+				}
+				else
+				{
+					context.lod_bone_order = nullptr;
+					context.num_decode_bones = header.num_bones;
+				}
 
-				const uint8_t* animated_track_data = header.get_track_data();
-				context.key_frame_data0 = animated_track_data + (key_frame0 * animated_pose_size);
-				context.key_frame_data1 = animated_track_data + (key_frame1 * animated_pose_size);
+				context.num_tracks_per_bone = header.has_scale ? FullPrecisionConstants::NUM_TRACKS_PER_SCALED_BONE : FullPrecisionConstants::NUM_TRACKS_PER_BONE;
+				context.has_scale = header.has_scale;
 
-				context.bitset_size = get_bitset_size(header.num_bones * FullPrecisionConstants::NUM_TRACKS_PER_BONE);
+				context.bitset_size = get_bitset_size(header.num_bones * context.num_tracks_per_bone);
 				context.rotation_size = rotation_size;
 				context.translation_size = translation_size;
-				context.range_rotation_size = has_clip_range_reduction && is_enum_flag_set(range_reduction, RangeReductionFlags8::Rotations) ? range_rotation_size : 0;
-				context.range_translation_size = has_clip_range_reduction && is_enum_flag_set(range_reduction, RangeReductionFlags8::Translations) ? range_translation_size : 0;
+				context.constant_rotation_size = get_packed_rotation_size(rotation_format);
+				context.range_rotation_size = has_range_reduction && is_enum_flag_set(range_reduction, RangeReductionFlags8::Rotations) ? range_rotation_size : 0;
+				context.range_translation_size = has_range_reduction && is_enum_flag_set(range_reduction, RangeReductionFlags8::Translations) ? range_translation_size : 0;
 
-				context.interpolation_alpha = interpolation_alpha;
+				context.data_layout = header.data_layout;
+				context.num_interleaved_samples = header.are_key_frames_paired ? 2 : 1;
+
+				ACL_ENSURE(!header.are_key_frames_paired || context.format_per_track_data == nullptr, "Key frame pairing requires uniform track sizes!");
+				ACL_ENSURE(!header.is_delta_encoded || (context.format_per_track_data == nullptr && !header.are_key_frames_paired), "Delta encoded clips use uniform 32 bit samples!");
+				ACL_ENSURE(!header.has_scale || (context.format_per_track_data == nullptr && !header.are_key_frames_paired && !header.is_delta_encoded && header.data_layout == AnimationDataLayout8::Interleaved), "Scale tracks require the uniform interleaved layout!");
+
+				if (context.format_per_track_data != nullptr)
+				{
+					// Variable quantization, the formats vary per track. The header formats are the
+					// most precise used by the clip, validate every table entry and sum the animated
+					// track sizes to get the pose size
+					uint32_t animated_rotation_size = 0;
+					uint32_t animated_translation_size = 0;
+					for (uint32_t track_index = 0; track_index < uint32_t(header.num_bones) * FullPrecisionConstants::NUM_TRACKS_PER_BONE; track_index += FullPrecisionConstants::NUM_TRACKS_PER_BONE)
+					{
+						const RotationFormat8 track_rotation_format = RotationFormat8(context.format_per_track_data[track_index + 0]);
+						const VectorFormat8 track_translation_format = VectorFormat8(context.format_per_track_data[track_index + 1]);
+						ACL_ENSURE(settings.is_rotation_format_supported(track_rotation_format), "Rotation format (%s) isn't statically supported!", get_rotation_format_name(track_rotation_format));
+						ACL_ENSURE(settings.is_translation_format_supported(track_translation_format), "Translation format (%s) isn't statically supported!", get_vector_format_name(track_translation_format));
+
+						bool is_rotation_animated = !bitset_test(context.default_tracks_bitset, context.bitset_size, track_index + 0) && !bitset_test(context.constant_tracks_bitset, context.bitset_size, track_index + 0);
+						if (is_rotation_animated)
+							animated_rotation_size += get_packed_rotation_size(track_rotation_format);
+
+						bool is_translation_animated = !bitset_test(context.default_tracks_bitset, context.bitset_size, track_index + 1) && !bitset_test(context.constant_tracks_bitset, context.bitset_size, track_index + 1);
+						if (is_translation_animated)
+							animated_translation_size += get_packed_vector_size(track_translation_format);
+					}
+
+					context.animated_rotation_size = animated_rotation_size;
+					context.animated_pose_size = animated_rotation_size + animated_translation_size;
+				}
+				else
+				{
+					// TODO: No need to store this, unpack from bitset in context and simplify branching logic below?
+					// Scale tracks always store full precision samples
+					context.animated_rotation_size = rotation_size * header.num_animated_rotation_tracks;
+					context.animated_pose_size = context.animated_rotation_size + (translation_size * header.num_animated_translation_tracks)
+						+ (get_packed_vector_size(VectorFormat8::Vector3_96) * header.num_animated_scale_tracks);
+				}
 
+				// The refresh pose of a delta encoded clip stores 48 bits per track
+				// instead of 32, see write_delta_track_data
+				context.delta_refresh_pose_size = header.is_delta_encoded ? (context.animated_pose_size / uint32_t(sizeof(uint32_t))) * get_packed_vector_size(VectorFormat8::Vector3_48) : 0;
+
+				context.clip_duration = float(header.num_samples - 1) / float(header.sample_rate);
+
+				context.key_frame_data0 = nullptr;
+				context.key_frame_data1 = nullptr;
+				context.key_frame_translation_data0 = nullptr;
+				context.key_frame_translation_data1 = nullptr;
+				context.segment_animated_data = nullptr;
+				context.segment_range_data = context.clip_range_data;
+				context.interpolation_alpha = 0.0f;
+				context.interpolation_alpha_fixed = 0;
+				context.delta_key_frame0 = 0;
+				context.delta_key_frame1 = 0;
+
+				context.constant_track_data = context.clip_constant_track_data;
+				context.range_data = context.clip_range_data;
 				context.constant_track_offset = 0;
 				context.default_track_offset = 0;
+				context.default_track_cursor = bitset_make_cursor(context.default_tracks_bitset, context.bitset_size, 0);
+				context.constant_track_cursor = bitset_make_cursor(context.constant_tracks_bitset, context.bitset_size, 0);
+			}
+
+			// Binds the external animated data payload written by compress_clip_split.
+			// The clip buffer only holds the install section then, the payload must
+			// be resident before any animated track is sampled.
+			inline void bind_animated_data(const FullPrecisionHeader& header, DecompressionContext& context, const uint8_t* animated_data)
+			{
+				ACL_ENSURE(header.is_animated_data_external, "The clip was not compressed with compress_clip_split, its animated data is already resident!");
+				ACL_ENSURE(animated_data != nullptr || header.animated_data_size == 0, "Clip has animated data but no payload was provided!");
+
+				context.animated_track_data = animated_data;
+			}
+
+			// Binds the clip's constant track data section from the deduplicated pool
+			// of the database holding it, see compress_clip_database. Null when the
+			// clip has no constant track data.
+			inline void bind_constant_data(const FullPrecisionHeader& header, DecompressionContext& context, const uint8_t* constant_data)
+			{
+				ACL_ENSURE(header.is_constant_data_external, "The clip was not compressed into a database, its constant data is already resident!");
+
+				context.clip_constant_track_data = constant_data;
+				context.constant_track_data = constant_data;
+			}
+
+			inline void seek_context(const FullPrecisionHeader& header, float sample_time, DecompressionContext& context)
+			{
+				uint32_t key_frame0;
+				uint32_t key_frame1;
+				float interpolation_alpha;
+				calculate_interpolation_keys(header.num_samples, context.clip_duration, sample_time, key_frame0, key_frame1, interpolation_alpha);
+
+				ACL_ENSURE(context.animated_track_data != nullptr || header.animated_data_size == 0, "The animated data payload is external and was not bound, see compress_clip_split!");
+
+				const uint8_t* animated_data;
+				if (context.segment_headers != nullptr)
+				{
+					// Consecutive segments overlap by one sample which guarantees that both
+					// key frames live in the segment that holds key_frame0. The last clip
+					// sample is the end of the last segment, clamp to handle it.
+					const uint32_t segment_index = std::min(key_frame0 / context.num_samples_per_segment, context.num_segments - 1);
+					const uint32_t* segment_header = context.segment_headers + (segment_index * 2);
+					animated_data = context.animated_track_data + segment_header[0];
+					context.segment_range_data = context.clip_range_data + segment_header[1];
+
+					key_frame0 -= segment_index * context.num_samples_per_segment;
+					key_frame1 -= segment_index * context.num_samples_per_segment;
+				}
+				else
+					animated_data = context.animated_track_data;
+
+				context.segment_animated_data = animated_data;
+
+				if (context.num_interleaved_samples == 2)
+				{
+					// Pair blocks are two poses wide; within a block consecutive samples
+					// of a track are adjacent so the slot offset is a single track value
+					const uint32_t pair_block_size = context.animated_pose_size * 2;
+					context.key_frame_data0 = animated_data + ((key_frame0 / 2) * pair_block_size) + ((key_frame0 % 2) * context.rotation_size);
+					context.key_frame_data1 = animated_data + ((key_frame1 / 2) * pair_block_size) + ((key_frame1 % 2) * context.rotation_size);
+
+					if (context.data_layout == AnimationDataLayout8::GroupedPerTrackType)
+					{
+						const uint32_t translation_group_offset = context.animated_rotation_size * 2;
+						context.key_frame_translation_data0 = animated_data + ((key_frame0 / 2) * pair_block_size) + translation_group_offset + ((key_frame0 % 2) * context.translation_size);
+						context.key_frame_translation_data1 = animated_data + ((key_frame1 / 2) * pair_block_size) + translation_group_offset + ((key_frame1 % 2) * context.translation_size);
+					}
+				}
+				else
+				{
+					context.key_frame_data0 = animated_data + (key_frame0 * context.animated_pose_size);
+					context.key_frame_data1 = animated_data + (key_frame1 * context.animated_pose_size);
+
+					if (context.data_layout == AnimationDataLayout8::GroupedPerTrackType)
+					{
+						context.key_frame_translation_data0 = context.key_frame_data0 + context.animated_rotation_size;
+						context.key_frame_translation_data1 = context.key_frame_data1 + context.animated_rotation_size;
+					}
+				}
+
+				context.range_data = context.segment_range_data;
+
+				context.interpolation_alpha = interpolation_alpha;
+				context.interpolation_alpha_fixed = pack_fixed_point_alpha(interpolation_alpha);
+
+				// Segment relative at this point, the delta decode path accumulates
+				// from the segment's refresh frame
+				context.delta_key_frame0 = key_frame0;
+				context.delta_key_frame1 = key_frame1;
 			}
 
-			inline void skip_rotation(DecompressionContext& context)
+			ACL_FORCE_INLINE void skip_rotation(DecompressionContext& context)
 			{
-				bool is_rotation_default = bitset_test(context.default_tracks_bitset, context.bitset_size, context.default_track_offset);
+				bool is_rotation_default = bitset_test(context.default_track_cursor);
 				if (!is_rotation_default)
 				{
-					bool is_rotation_constant = bitset_test(context.constant_tracks_bitset, context.bitset_size, context.constant_track_offset);
+					bool is_rotation_constant = bitset_test(context.constant_track_cursor);
 					if (is_rotation_constant)
 					{
-						context.constant_track_data += context.rotation_size;
+						// Constant rotation tracks are packed with the track's rotation format.
+						// Rotation tracks are at even track offsets which matches the table layout
+						uint32_t rotation_size = context.format_per_track_data != nullptr ? get_packed_rotation_size(RotationFormat8(context.format_per_track_data[context.default_track_offset])) : context.constant_rotation_size;
+						context.constant_track_data += rotation_size;
 					}
 					else
 					{
-						context.key_frame_data0 += context.rotation_size;
-						context.key_frame_data1 += context.rotation_size;
+						uint32_t rotation_size = context.format_per_track_data != nullptr ? get_packed_rotation_size(RotationFormat8(context.format_per_track_data[context.default_track_offset])) : context.rotation_size;
+						context.key_frame_data0 += rotation_size * context.num_interleaved_samples;
+						context.key_frame_data1 += rotation_size * context.num_interleaved_samples;
 						context.range_data += context.range_rotation_size;
 					}
 				}
 
 				context.default_track_offset++;
 				context.constant_track_offset++;
+				bitset_advance(context.default_track_cursor);
+				bitset_advance(context.constant_track_cursor);
 			}
 
-			inline void skip_translation(DecompressionContext& context)
+			ACL_FORCE_INLINE void skip_translation(DecompressionContext& context)
 			{
-				bool is_translation_default = bitset_test(context.default_tracks_bitset, context.bitset_size, context.default_track_offset);
+				bool is_translation_default = bitset_test(context.default_track_cursor);
 				if (!is_translation_default)
 				{
-					bool is_translation_constant = bitset_test(context.constant_tracks_bitset, context.bitset_size, context.constant_track_offset);
+					bool is_translation_constant = bitset_test(context.constant_track_cursor);
 					if (is_translation_constant)
 					{
 						// Constant translation tracks store the remaining sample with full precision
@@ -174,31 +416,75 @@ namespace acl
 					}
 					else
 					{
-						context.key_frame_data0 += context.translation_size;
-						context.key_frame_data1 += context.translation_size;
+						uint32_t translation_size = context.format_per_track_data != nullptr ? get_packed_vector_size(VectorFormat8(context.format_per_track_data[context.default_track_offset])) : context.translation_size;
+
+						if (context.data_layout == AnimationDataLayout8::GroupedPerTrackType)
+						{
+							context.key_frame_translation_data0 += translation_size * context.num_interleaved_samples;
+							context.key_frame_translation_data1 += translation_size * context.num_interleaved_samples;
+						}
+						else
+						{
+							context.key_frame_data0 += translation_size * context.num_interleaved_samples;
+							context.key_frame_data1 += translation_size * context.num_interleaved_samples;
+						}
 						context.range_data += context.range_translation_size;
 					}
 				}
 
 				context.default_track_offset++;
 				context.constant_track_offset++;
+				bitset_advance(context.default_track_cursor);
+				bitset_advance(context.constant_track_cursor);
+			}
+
+			// Reconstructs both key frame values of a delta encoded track by
+			// accumulating the stored deltas from the refresh frame, see
+			// CompressionSettings::enable_delta_encoding. key_frame_data0 points at
+			// the track's slot within key frame 0 as if every pose were delta sized;
+			// the refresh pose is wider, 48 bits per track, so the slot index maps
+			// the delta pose offset to the refresh pose offset. The accumulation
+			// matches the encoder's running reconstruction float op for float op.
+			ACL_FORCE_INLINE void reconstruct_delta_track(const DecompressionContext& context, const uint8_t* key_frame_data0, Vector4_32& out_value0, Vector4_32& out_value1)
+			{
+				const uint32_t key_frame0 = context.delta_key_frame0;
+				const uint32_t track_offset = uint32_t(key_frame_data0 - context.segment_animated_data) - (key_frame0 * context.animated_pose_size);
+
+				// The refresh frame is absolute
+				Vector4_32 value = unpack_vector3_48(context.segment_animated_data + ((track_offset / sizeof(uint32_t)) * get_packed_vector_size(VectorFormat8::Vector3_48)));
+
+				const uint8_t* sample_data = context.segment_animated_data + context.delta_refresh_pose_size + track_offset;
+				for (uint32_t sample_index = 1; sample_index <= key_frame0; ++sample_index)
+				{
+					value = vector_add(value, unpack_delta_vector3_32(sample_data));
+					sample_data += context.animated_pose_size;
+				}
+
+				out_value0 = value;
+
+				if (context.delta_key_frame1 != key_frame0)
+					value = vector_add(value, unpack_delta_vector3_32(sample_data));
+
+				out_value1 = value;
 			}
 
 			template<class SettingsType>
-			inline Quat_32 decompress_rotation(const SettingsType& settings, const FullPrecisionHeader& header, DecompressionContext& context)
+			ACL_FORCE_INLINE Quat_32 decompress_rotation(const SettingsType& settings, const FullPrecisionHeader& header, DecompressionContext& context)
 			{
 				Quat_32 rotation;
 
-				bool is_rotation_default = bitset_test(context.default_tracks_bitset, context.bitset_size, context.default_track_offset);
+				bool is_rotation_default = bitset_test(context.default_track_cursor);
 				if (is_rotation_default)
 				{
 					rotation = quat_identity_32();
 				}
 				else
 				{
-					const RotationFormat8 rotation_format = settings.get_rotation_format(header.rotation_format);
+					// Rotation tracks are at even track offsets which matches the table layout
+					const RotationFormat8 rotation_format = context.format_per_track_data != nullptr ? RotationFormat8(context.format_per_track_data[context.default_track_offset]) : settings.get_rotation_format(header.rotation_format);
+					const uint32_t rotation_size = context.format_per_track_data != nullptr ? get_packed_rotation_size(rotation_format) : context.rotation_size;
 
-					bool is_rotation_constant = bitset_test(context.constant_tracks_bitset, context.bitset_size, context.constant_track_offset);
+					bool is_rotation_constant = bitset_test(context.constant_track_cursor);
 					if (is_rotation_constant)
 					{
 						if (rotation_format == RotationFormat8::Quat_128 && settings.is_rotation_format_supported(RotationFormat8::Quat_128))
@@ -213,120 +499,167 @@ namespace acl
 						ACL_ENSURE(quat_is_valid(rotation), "Rotation is not valid!");
 						ACL_ENSURE(quat_is_normalized(rotation), "Rotation is not normalized!");
 
-						context.constant_track_data += context.rotation_size;
+						// Constant rotation tracks are packed with the track's rotation format
+						context.constant_track_data += context.format_per_track_data != nullptr ? rotation_size : context.constant_rotation_size;
 					}
 					else
 					{
 						const RangeReductionFlags8 range_reduction = settings.get_range_reduction(header.range_reduction);
+						const bool are_rotations_range_reduced = is_enum_flag_set(range_reduction, RangeReductionFlags8::Rotations) && has_per_block_range_reduction(range_reduction);
 
-						Quat_32 rotation0;
-						Quat_32 rotation1;
-
-						if (rotation_format == RotationFormat8::Quat_128 && settings.is_rotation_format_supported(RotationFormat8::Quat_128))
+						if (header.is_delta_encoded)
 						{
-							Vector4_32 rotation0_xyzw = unpack_vector4_128(context.key_frame_data0);
-							Vector4_32 rotation1_xyzw = unpack_vector4_128(context.key_frame_data1);
+							// Delta encoded clips are always range reduced
+							Vector4_32 rotation0_xyz;
+							Vector4_32 rotation1_xyz;
+							reconstruct_delta_track(context, context.key_frame_data0, rotation0_xyz, rotation1_xyz);
 
-							if (are_enum_flags_set(range_reduction, RangeReductionFlags8::PerClip | RangeReductionFlags8::Rotations))
+							Vector4_32 clip_range_min = vector_unaligned_load(context.range_data);
+							Vector4_32 clip_range_extent = vector_unaligned_load(context.range_data + (context.range_rotation_size / 2));
+
+							rotation0_xyz = vector_mul_add(rotation0_xyz, clip_range_extent, clip_range_min);
+							rotation1_xyz = vector_mul_add(rotation1_xyz, clip_range_extent, clip_range_min);
+
+							rotation = quat_lerp_from_positive_w(rotation0_xyz, rotation1_xyz, context.interpolation_alpha);
+						}
+						else if (rotation_format == RotationFormat8::Quat_128 && settings.is_rotation_format_supported(RotationFormat8::Quat_128))
+						{
+							if (are_rotations_range_reduced)
 							{
+								Vector4_32 rotation0_xyzw = unpack_vector4_128(context.key_frame_data0);
+								Vector4_32 rotation1_xyzw = unpack_vector4_128(context.key_frame_data1);
+
 								Vector4_32 clip_range_min = vector_unaligned_load(context.range_data);
 								Vector4_32 clip_range_extent = vector_unaligned_load(context.range_data + (context.range_rotation_size / 2));
 
 								rotation0_xyzw = vector_mul_add(rotation0_xyzw, clip_range_extent, clip_range_min);
 								rotation1_xyzw = vector_mul_add(rotation1_xyzw, clip_range_extent, clip_range_min);
 
-								context.range_data += context.range_rotation_size;
+								rotation = quat_lerp(vector_to_quat(rotation0_xyzw), vector_to_quat(rotation1_xyzw), context.interpolation_alpha);
 							}
-
-							rotation0 = vector_to_quat(rotation0_xyzw);
-							rotation1 = vector_to_quat(rotation1_xyzw);
+							else
+								rotation = unpack2_lerp_quat_128(context.key_frame_data0, context.key_frame_data1, context.interpolation_alpha);
 						}
 						else if (rotation_format == RotationFormat8::Quat_96 && settings.is_rotation_format_supported(RotationFormat8::Quat_96))
 						{
-							Vector4_32 rotation0_xyz = unpack_vector3_96(context.key_frame_data0);
-							Vector4_32 rotation1_xyz = unpack_vector3_96(context.key_frame_data1);
-
-							if (are_enum_flags_set(range_reduction, RangeReductionFlags8::PerClip | RangeReductionFlags8::Rotations))
+							if (are_rotations_range_reduced)
 							{
+								Vector4_32 rotation0_xyz = unpack_vector3_96(context.key_frame_data0);
+								Vector4_32 rotation1_xyz = unpack_vector3_96(context.key_frame_data1);
+
 								Vector4_32 clip_range_min = vector_unaligned_load(context.range_data);
 								Vector4_32 clip_range_extent = vector_unaligned_load(context.range_data + (context.range_rotation_size / 2));
 
 								rotation0_xyz = vector_mul_add(rotation0_xyz, clip_range_extent, clip_range_min);
 								rotation1_xyz = vector_mul_add(rotation1_xyz, clip_range_extent, clip_range_min);
 
-								context.range_data += context.range_rotation_size;
+								rotation = quat_lerp_from_positive_w(rotation0_xyz, rotation1_xyz, context.interpolation_alpha);
 							}
-
-							rotation0 = quat_from_positive_w(rotation0_xyz);
-							rotation1 = quat_from_positive_w(rotation1_xyz);
+							else
+								rotation = unpack2_lerp_quat_96(context.key_frame_data0, context.key_frame_data1, context.interpolation_alpha);
 						}
 						else if (rotation_format == RotationFormat8::Quat_48 && settings.is_rotation_format_supported(RotationFormat8::Quat_48))
 						{
-							Vector4_32 rotation0_xyz = unpack_vector3_48(context.key_frame_data0);
-							Vector4_32 rotation1_xyz = unpack_vector3_48(context.key_frame_data1);
+							if (settings.is_fixed_point_interpolation_enabled())
+							{
+								if (are_rotations_range_reduced)
+								{
+									Vector4_32 rotation_xyz = unpack2_lerp_vector3_48_fixed(context.key_frame_data0, context.key_frame_data1, context.interpolation_alpha_fixed);
+
+									Vector4_32 clip_range_min = vector_unaligned_load(context.range_data);
+									Vector4_32 clip_range_extent = vector_unaligned_load(context.range_data + (context.range_rotation_size / 2));
 
-							if (are_enum_flags_set(range_reduction, RangeReductionFlags8::PerClip | RangeReductionFlags8::Rotations))
+									// The remap is affine and commutes with the lerp, remapping
+									// the interpolated value once matches the float path
+									rotation_xyz = vector_mul_add(rotation_xyz, clip_range_extent, clip_range_min);
+
+									rotation = quat_from_positive_w(rotation_xyz);
+								}
+								else
+									rotation = unpack2_lerp_quat_48_fixed(context.key_frame_data0, context.key_frame_data1, context.interpolation_alpha_fixed);
+							}
+							else if (are_rotations_range_reduced)
 							{
+								Vector4_32 rotation0_xyz = unpack_vector3_48(context.key_frame_data0);
+								Vector4_32 rotation1_xyz = unpack_vector3_48(context.key_frame_data1);
+
 								Vector4_32 clip_range_min = vector_unaligned_load(context.range_data);
 								Vector4_32 clip_range_extent = vector_unaligned_load(context.range_data + (context.range_rotation_size / 2));
 
 								rotation0_xyz = vector_mul_add(rotation0_xyz, clip_range_extent, clip_range_min);
 								rotation1_xyz = vector_mul_add(rotation1_xyz, clip_range_extent, clip_range_min);
 
-								context.range_data += context.range_rotation_size;
+								rotation = quat_lerp_from_positive_w(rotation0_xyz, rotation1_xyz, context.interpolation_alpha);
 							}
-
-							rotation0 = quat_from_positive_w(rotation0_xyz);
-							rotation1 = quat_from_positive_w(rotation1_xyz);
+							else
+								rotation = unpack2_lerp_quat_48(context.key_frame_data0, context.key_frame_data1, context.interpolation_alpha);
 						}
 						else if (rotation_format == RotationFormat8::Quat_32 && settings.is_rotation_format_supported(RotationFormat8::Quat_32))
 						{
-							Vector4_32 rotation0_xyz = unpack_vector3_32<11, 11, 10>(context.key_frame_data0);
-							Vector4_32 rotation1_xyz = unpack_vector3_32<11, 11, 10>(context.key_frame_data1);
+							if (settings.is_fixed_point_interpolation_enabled())
+							{
+								if (are_rotations_range_reduced)
+								{
+									Vector4_32 rotation_xyz = unpack2_lerp_vector3_32_fixed<11, 11, 10>(context.key_frame_data0, context.key_frame_data1, context.interpolation_alpha_fixed);
+
+									Vector4_32 clip_range_min = vector_unaligned_load(context.range_data);
+									Vector4_32 clip_range_extent = vector_unaligned_load(context.range_data + (context.range_rotation_size / 2));
 
-							if (are_enum_flags_set(range_reduction, RangeReductionFlags8::PerClip | RangeReductionFlags8::Rotations))
+									rotation_xyz = vector_mul_add(rotation_xyz, clip_range_extent, clip_range_min);
+
+									rotation = quat_from_positive_w(rotation_xyz);
+								}
+								else
+									rotation = unpack2_lerp_quat_32_fixed(context.key_frame_data0, context.key_frame_data1, context.interpolation_alpha_fixed);
+							}
+							else if (are_rotations_range_reduced)
 							{
+								Vector4_32 rotation0_xyz = unpack_vector3_32<11, 11, 10>(context.key_frame_data0);
+								Vector4_32 rotation1_xyz = unpack_vector3_32<11, 11, 10>(context.key_frame_data1);
+
 								Vector4_32 clip_range_min = vector_unaligned_load(context.range_data);
 								Vector4_32 clip_range_extent = vector_unaligned_load(context.range_data + (context.range_rotation_size / 2));
 
 								rotation0_xyz = vector_mul_add(rotation0_xyz, clip_range_extent, clip_range_min);
 								rotation1_xyz = vector_mul_add(rotation1_xyz, clip_range_extent, clip_range_min);
 
-								context.range_data += context.range_rotation_size;
+								rotation = quat_lerp_from_positive_w(rotation0_xyz, rotation1_xyz, context.interpolation_alpha);
 							}
-
-							rotation0 = quat_from_positive_w(rotation0_xyz);
-							rotation1 = quat_from_positive_w(rotation1_xyz);
+							else
+								rotation = unpack2_lerp_quat_32(context.key_frame_data0, context.key_frame_data1, context.interpolation_alpha);
 						}
 
-						rotation = quat_lerp(rotation0, rotation1, context.interpolation_alpha);
+						if (are_rotations_range_reduced)
+							context.range_data += context.range_rotation_size;
 
 						ACL_ENSURE(quat_is_valid(rotation), "Rotation is not valid!");
 						ACL_ENSURE(quat_is_normalized(rotation), "Rotation is not normalized!");
 
-						context.key_frame_data0 += context.rotation_size;
-						context.key_frame_data1 += context.rotation_size;
+						context.key_frame_data0 += rotation_size * context.num_interleaved_samples;
+						context.key_frame_data1 += rotation_size * context.num_interleaved_samples;
 					}
 				}
 
 				context.default_track_offset++;
 				context.constant_track_offset++;
+				bitset_advance(context.default_track_cursor);
+				bitset_advance(context.constant_track_cursor);
 				return rotation;
 			}
 
 			template<class SettingsType>
-			inline Vector4_32 decompress_translation(const SettingsType& settings, const FullPrecisionHeader& header, DecompressionContext& context)
+			ACL_FORCE_INLINE Vector4_32 decompress_translation(const SettingsType& settings, const FullPrecisionHeader& header, DecompressionContext& context)
 			{
 				Vector4_32 translation;
 
-				bool is_translation_default = bitset_test(context.default_tracks_bitset, context.bitset_size, context.default_track_offset);
+				bool is_translation_default = bitset_test(context.default_track_cursor);
 				if (is_translation_default)
 				{
 					translation = vector_zero_32();
 				}
 				else
 				{
-					bool is_translation_constant = bitset_test(context.constant_tracks_bitset, context.bitset_size, context.constant_track_offset);
+					bool is_translation_constant = bitset_test(context.constant_track_cursor);
 					if (is_translation_constant)
 					{
 						// Constant translation tracks store the remaining sample with full precision
@@ -338,30 +671,23 @@ namespace acl
 					}
 					else
 					{
-						const VectorFormat8 translation_format = settings.get_translation_format(header.translation_format);
+						// Translation tracks are at odd track offsets which matches the table layout
+						const VectorFormat8 translation_format = context.format_per_track_data != nullptr ? VectorFormat8(context.format_per_track_data[context.default_track_offset]) : settings.get_translation_format(header.translation_format);
+						const uint32_t translation_size = context.format_per_track_data != nullptr ? get_packed_vector_size(translation_format) : context.translation_size;
 						const RangeReductionFlags8 range_reduction = settings.get_range_reduction(header.range_reduction);
 
-						Vector4_32 translation0;
-						Vector4_32 translation1;
+						// With the grouped layout the translations live in their own stream after the rotations
+						const bool is_grouped_layout = context.data_layout == AnimationDataLayout8::GroupedPerTrackType;
+						const uint8_t* translation_key_frame_data0 = is_grouped_layout ? context.key_frame_translation_data0 : context.key_frame_data0;
+						const uint8_t* translation_key_frame_data1 = is_grouped_layout ? context.key_frame_translation_data1 : context.key_frame_data1;
 
-						if (translation_format == VectorFormat8::Vector3_96 && settings.is_translation_format_supported(VectorFormat8::Vector3_96))
-						{
-							translation0 = unpack_vector3_96(context.key_frame_data0);
-							translation1 = unpack_vector3_96(context.key_frame_data1);
-						}
-						else if (translation_format == VectorFormat8::Vector3_48 && settings.is_translation_format_supported(VectorFormat8::Vector3_48))
+						if (header.is_delta_encoded)
 						{
-							translation0 = unpack_vector3_48(context.key_frame_data0);
-							translation1 = unpack_vector3_48(context.key_frame_data1);
-						}
-						else if (translation_format == VectorFormat8::Vector3_32 && settings.is_translation_format_supported(VectorFormat8::Vector3_32))
-						{
-							translation0 = unpack_vector3_32<11, 11, 10>(context.key_frame_data0);
-							translation1 = unpack_vector3_32<11, 11, 10>(context.key_frame_data1);
-						}
+							// Delta encoded clips are always range reduced
+							Vector4_32 translation0;
+							Vector4_32 translation1;
+							reconstruct_delta_track(context, translation_key_frame_data0, translation0, translation1);
 
-						if (are_enum_flags_set(range_reduction, RangeReductionFlags8::PerClip | RangeReductionFlags8::Translations))
-						{
 							Vector4_32 clip_range_min = vector_unaligned_load(context.range_data);
 							Vector4_32 clip_range_extent = vector_unaligned_load(context.range_data + (context.range_translation_size / 2));
 
@@ -369,103 +695,1230 @@ namespace acl
 							translation1 = vector_mul_add(translation1, clip_range_extent, clip_range_min);
 
 							context.range_data += context.range_translation_size;
+
+							translation = vector_lerp(translation0, translation1, context.interpolation_alpha);
+						}
+						else if (settings.is_fixed_point_interpolation_enabled() && translation_format != VectorFormat8::Vector3_96)
+						{
+							if (translation_format == VectorFormat8::Vector3_48 && settings.is_translation_format_supported(VectorFormat8::Vector3_48))
+								translation = unpack2_lerp_vector3_48_fixed(translation_key_frame_data0, translation_key_frame_data1, context.interpolation_alpha_fixed);
+							else if (translation_format == VectorFormat8::Vector3_32 && settings.is_translation_format_supported(VectorFormat8::Vector3_32))
+								translation = unpack2_lerp_vector3_32_fixed<11, 11, 10>(translation_key_frame_data0, translation_key_frame_data1, context.interpolation_alpha_fixed);
+
+							if (is_enum_flag_set(range_reduction, RangeReductionFlags8::Translations) && has_per_block_range_reduction(range_reduction))
+							{
+								Vector4_32 clip_range_min = vector_unaligned_load(context.range_data);
+								Vector4_32 clip_range_extent = vector_unaligned_load(context.range_data + (context.range_translation_size / 2));
+
+								// The remap is affine and commutes with the lerp, remapping
+								// the interpolated value once matches the float path
+								translation = vector_mul_add(translation, clip_range_extent, clip_range_min);
+
+								context.range_data += context.range_translation_size;
+							}
 						}
+						else
+						{
+							Vector4_32 translation0;
+							Vector4_32 translation1;
+
+							if (translation_format == VectorFormat8::Vector3_96 && settings.is_translation_format_supported(VectorFormat8::Vector3_96))
+							{
+								translation0 = unpack_vector3_96(translation_key_frame_data0);
+								translation1 = unpack_vector3_96(translation_key_frame_data1);
+							}
+							else if (translation_format == VectorFormat8::Vector3_48 && settings.is_translation_format_supported(VectorFormat8::Vector3_48))
+							{
+								translation0 = unpack_vector3_48(translation_key_frame_data0);
+								translation1 = unpack_vector3_48(translation_key_frame_data1);
+							}
+							else if (translation_format == VectorFormat8::Vector3_32 && settings.is_translation_format_supported(VectorFormat8::Vector3_32))
+							{
+								translation0 = unpack_vector3_32<11, 11, 10>(translation_key_frame_data0);
+								translation1 = unpack_vector3_32<11, 11, 10>(translation_key_frame_data1);
+							}
+
+							if (is_enum_flag_set(range_reduction, RangeReductionFlags8::Translations) && has_per_block_range_reduction(range_reduction))
+							{
+								Vector4_32 clip_range_min = vector_unaligned_load(context.range_data);
+								Vector4_32 clip_range_extent = vector_unaligned_load(context.range_data + (context.range_translation_size / 2));
 
-						translation = vector_lerp(translation0, translation1, context.interpolation_alpha);
+								translation0 = vector_mul_add(translation0, clip_range_extent, clip_range_min);
+								translation1 = vector_mul_add(translation1, clip_range_extent, clip_range_min);
+
+								context.range_data += context.range_translation_size;
+							}
+
+							translation = vector_lerp(translation0, translation1, context.interpolation_alpha);
+						}
 
 						ACL_ENSURE(vector_is_valid3(translation), "Translation is not valid!");
 
-						context.key_frame_data0 += context.translation_size;
-						context.key_frame_data1 += context.translation_size;
+						if (is_grouped_layout)
+						{
+							context.key_frame_translation_data0 += translation_size * context.num_interleaved_samples;
+							context.key_frame_translation_data1 += translation_size * context.num_interleaved_samples;
+						}
+						else
+						{
+							context.key_frame_data0 += translation_size * context.num_interleaved_samples;
+							context.key_frame_data1 += translation_size * context.num_interleaved_samples;
+						}
 					}
 				}
 
 				context.default_track_offset++;
 				context.constant_track_offset++;
+				bitset_advance(context.default_track_cursor);
+				bitset_advance(context.constant_track_cursor);
 				return translation;
 			}
-		}
 
-		//////////////////////////////////////////////////////////////////////////
-		// Deriving from this struct and overriding these constexpr functions
-		// allow you to control which code is stripped for maximum performance.
-		// With these, you can:
-		//    - Support only a subset of the formats and statically strip the rest
-		//    - Force a single format and statically strip the rest
-		//    - Decide all of this at runtime by not making the overrides constexpr
-		//
-		// By default, all formats are supported.
-		//////////////////////////////////////////////////////////////////////////
-		struct DecompressionSettings
-		{
-			constexpr bool is_rotation_format_supported(RotationFormat8 format) const { return true; }
-			constexpr bool is_translation_format_supported(VectorFormat8 format) const { return true; }
-			constexpr RotationFormat8 get_rotation_format(RotationFormat8 format) const { return format; }
-			constexpr VectorFormat8 get_translation_format(VectorFormat8 format) const { return format; }
+			ACL_FORCE_INLINE void skip_scale(DecompressionContext& context)
+			{
+				bool is_scale_default = bitset_test(context.default_track_cursor);
+				if (!is_scale_default)
+				{
+					// Scale tracks always store full precision samples and are never range reduced
+					bool is_scale_constant = bitset_test(context.constant_track_cursor);
+					if (is_scale_constant)
+					{
+						context.constant_track_data += get_packed_vector_size(VectorFormat8::Vector3_96);
+					}
+					else
+					{
+						context.key_frame_data0 += get_packed_vector_size(VectorFormat8::Vector3_96) * context.num_interleaved_samples;
+						context.key_frame_data1 += get_packed_vector_size(VectorFormat8::Vector3_96) * context.num_interleaved_samples;
+					}
+				}
 
-			constexpr bool are_range_reduction_flags_supported(RangeReductionFlags8 flags) const { return true; }
-			constexpr RangeReductionFlags8 get_range_reduction(RangeReductionFlags8 flags) const { return flags; }
-		};
+				context.default_track_offset++;
+				context.constant_track_offset++;
+				bitset_advance(context.default_track_cursor);
+				bitset_advance(context.constant_track_cursor);
+			}
 
-		template<class SettingsType, class OutputWriterType>
-		inline void decompress_pose(const SettingsType& settings, const CompressedClip& clip, float sample_time, OutputWriterType& writer)
-		{
-			static_assert(std::is_base_of<DecompressionSettings, SettingsType>::value, "SettingsType must derive from DecompressionSettings!");
-			static_assert(std::is_base_of<OutputWriter, OutputWriterType>::value, "OutputWriterType must derive from OutputWriter!");
+			template<class SettingsType>
+			ACL_FORCE_INLINE Vector4_32 decompress_scale(const SettingsType& settings, const FullPrecisionHeader& header, DecompressionContext& context)
+			{
+				Vector4_32 scale;
+
+				bool is_scale_default = bitset_test(context.default_track_cursor);
+				if (is_scale_default)
+				{
+					scale = vector_set(1.0f);
+				}
+				else
+				{
+					bool is_scale_constant = bitset_test(context.constant_track_cursor);
+					if (is_scale_constant)
+					{
+						// Scale tracks always store full precision samples
+						scale = unpack_vector3_96(context.constant_track_data);
 
-			using namespace impl;
+						ACL_ENSURE(vector_is_valid3(scale), "Scale is not valid!");
 
-			ACL_ENSURE(clip.get_algorithm_type() == AlgorithmType8::UniformlySampled, "Invalid algorithm type [%s], expected [%s]", get_algorithm_name(clip.get_algorithm_type()), get_algorithm_name(AlgorithmType8::UniformlySampled));
-			ACL_ENSURE(clip.is_valid(false), "Clip is invalid");
+						context.constant_track_data += get_packed_vector_size(VectorFormat8::Vector3_96);
+					}
+					else
+					{
+						Vector4_32 scale0 = unpack_vector3_96(context.key_frame_data0);
+						Vector4_32 scale1 = unpack_vector3_96(context.key_frame_data1);
+
+						scale = vector_lerp(scale0, scale1, context.interpolation_alpha);
 
-			const FullPrecisionHeader& header = get_full_precision_header(clip);
+						ACL_ENSURE(vector_is_valid3(scale), "Scale is not valid!");
 
-			DecompressionContext context;
-			initialize_context(settings, header, sample_time, context);
+						context.key_frame_data0 += get_packed_vector_size(VectorFormat8::Vector3_96) * context.num_interleaved_samples;
+						context.key_frame_data1 += get_packed_vector_size(VectorFormat8::Vector3_96) * context.num_interleaved_samples;
+					}
+				}
+
+				context.default_track_offset++;
+				context.constant_track_offset++;
+				bitset_advance(context.default_track_cursor);
+				bitset_advance(context.constant_track_cursor);
+				return scale;
+			}
 
-			for (uint32_t bone_index = 0; bone_index < header.num_bones; ++bone_index)
+			// Counts the constant and animated rotation/translation tracks among the
+			// first num_tracks tracks in one pass over the bitset words
+			inline void count_leading_track_bits(const DecompressionContext& context, uint32_t num_tracks,
+				uint32_t& out_num_constant_rotations, uint32_t& out_num_constant_translations,
+				uint32_t& out_num_animated_rotations, uint32_t& out_num_animated_translations)
 			{
-				Quat_32 rotation = decompress_rotation(settings, header, context);
-				writer.write_bone_rotation(bone_index, rotation);
+				// Rotation tracks are at even track offsets, translations at odd ones.
+				// Track offsets map to word bits from the most significant bit down which
+				// puts every rotation track at an odd word bit.
+				constexpr uint32_t ROTATION_TRACK_BITS = 0xAAAAAAAA;
+				constexpr uint32_t TRANSLATION_TRACK_BITS = 0x55555555;
+
+				uint32_t num_constant_rotations = 0;
+				uint32_t num_constant_translations = 0;
+				uint32_t num_animated_rotations = 0;
+				uint32_t num_animated_translations = 0;
+
+				uint32_t num_words = (num_tracks + 31) / 32;
+				for (uint32_t offset = 0; offset < num_words; ++offset)
+				{
+					uint32_t remainder = num_tracks - (offset * 32);
+					uint32_t valid_mask = remainder >= 32 ? 0xFFFFFFFF : ~(0xFFFFFFFF >> remainder);
+
+					uint32_t default_bits = context.default_tracks_bitset[offset];
+					uint32_t constant_bits = context.constant_tracks_bitset[offset] & ~default_bits & valid_mask;
+					uint32_t animated_bits = ~context.constant_tracks_bitset[offset] & ~default_bits & valid_mask;
 
-				Vector4_32 translation = decompress_translation(settings, header, context);
-				writer.write_bone_translation(bone_index, translation);
+					num_constant_rotations += count_set_bits(constant_bits & ROTATION_TRACK_BITS);
+					num_constant_translations += count_set_bits(constant_bits & TRANSLATION_TRACK_BITS);
+					num_animated_rotations += count_set_bits(animated_bits & ROTATION_TRACK_BITS);
+					num_animated_translations += count_set_bits(animated_bits & TRANSLATION_TRACK_BITS);
+				}
+
+				out_num_constant_rotations = num_constant_rotations;
+				out_num_constant_translations = num_constant_translations;
+				out_num_animated_rotations = num_animated_rotations;
+				out_num_animated_translations = num_animated_translations;
 			}
-		}
 
-		template<class SettingsType>
-		inline void decompress_bone(const SettingsType& settings, const CompressedClip& clip, float sample_time, uint16_t sample_bone_index, Quat_32* out_rotation, Vector4_32* out_translation)
-		{
-			static_assert(std::is_base_of<DecompressionSettings, SettingsType>::value, "SettingsType must derive from DecompressionSettings!");
+			// Advances every cursor to the first track of the given bone. With uniform
+			// formats the cursor offsets are computed arithmetically from pop-counts of
+			// the track bitsets, the per track branches only remain when the track sizes
+			// vary and must be read from the format table.
+			inline void skip_to_bone(DecompressionContext& context, uint16_t sample_bone_index)
+			{
+				// The pop-count masks assume two tracks per bone, scaled clips take
+				// the per track loop below
+				if (context.format_per_track_data == nullptr && !context.has_scale)
+				{
+					uint32_t num_constant_rotations;
+					uint32_t num_constant_translations;
+					uint32_t num_animated_rotations;
+					uint32_t num_animated_translations;
+					count_leading_track_bits(context, uint32_t(sample_bone_index) * FullPrecisionConstants::NUM_TRACKS_PER_BONE,
+						num_constant_rotations, num_constant_translations, num_animated_rotations, num_animated_translations);
+
+					// Constant translation tracks store the remaining sample with full precision
+					context.constant_track_data += (num_constant_rotations * context.constant_rotation_size) + (num_constant_translations * get_packed_vector_size(VectorFormat8::Vector3_96));
+					context.range_data += (num_animated_rotations * context.range_rotation_size) + (num_animated_translations * context.range_translation_size);
+
+					if (context.data_layout == AnimationDataLayout8::GroupedPerTrackType)
+					{
+						uint32_t animated_rotation_offset = num_animated_rotations * context.rotation_size * context.num_interleaved_samples;
+						uint32_t animated_translation_offset = num_animated_translations * context.translation_size * context.num_interleaved_samples;
+						context.key_frame_data0 += animated_rotation_offset;
+						context.key_frame_data1 += animated_rotation_offset;
+						context.key_frame_translation_data0 += animated_translation_offset;
+						context.key_frame_translation_data1 += animated_translation_offset;
+					}
+					else
+					{
+						uint32_t animated_data_offset = ((num_animated_rotations * context.rotation_size) + (num_animated_translations * context.translation_size)) * context.num_interleaved_samples;
+						context.key_frame_data0 += animated_data_offset;
+						context.key_frame_data1 += animated_data_offset;
+					}
+
+					context.default_track_offset = uint32_t(sample_bone_index) * FullPrecisionConstants::NUM_TRACKS_PER_BONE;
+					context.constant_track_offset = uint32_t(sample_bone_index) * FullPrecisionConstants::NUM_TRACKS_PER_BONE;
+					context.default_track_cursor = bitset_make_cursor(context.default_tracks_bitset, context.bitset_size, context.default_track_offset);
+					context.constant_track_cursor = bitset_make_cursor(context.constant_tracks_bitset, context.bitset_size, context.constant_track_offset);
+				}
+				else
+				{
+					for (uint32_t bone_index = 0; bone_index < sample_bone_index; ++bone_index)
+					{
+						skip_rotation(context);
+						skip_translation(context);
+						if (context.has_scale)
+							skip_scale(context);
+					}
+				}
+			}
 
-			using namespace impl;
+			// Maps a skeleton bone index to its position in the compressed track order.
+			// Identity when the clip has no LOD data; otherwise a linear scan of the
+			// bone order table. Single bone sampling always succeeds, the LOD level
+			// only prunes whole pose decoding.
+			inline uint16_t find_bone_track_entry(const DecompressionContext& context, uint16_t num_bones, uint16_t bone_index)
+			{
+				if (context.lod_bone_order == nullptr)
+					return bone_index;
 
-			ACL_ENSURE(clip.get_algorithm_type() == AlgorithmType8::UniformlySampled, "Invalid algorithm type [%s], expected [%s]", get_algorithm_name(clip.get_algorithm_type()), get_algorithm_name(AlgorithmType8::UniformlySampled));
-			ACL_ENSURE(clip.is_valid(false), "Clip is invalid");
+				for (uint16_t entry_index = 0; entry_index < num_bones; ++entry_index)
+				{
+					if (context.lod_bone_order[entry_index] == bone_index)
+						return entry_index;
+				}
 
-			const FullPrecisionHeader& header = get_full_precision_header(clip);
+				ACL_ENSURE(false, "Bone %u is missing from the LOD bone order!", bone_index);
+				return bone_index;
+			}
 
-			DecompressionContext context;
-			initialize_context(settings, header, sample_time, context);
+			// Per bone cursor offsets used for O(1) single bone sampling.
+			// Offsets are relative to the start of their respective sections which
+			// keeps them independent of the current seek position.
+			struct BoneTrackOffsets
+			{
+				uint32_t constant_data_offset;
+				uint32_t animated_data_offset;
+				uint32_t animated_translation_data_offset;	// Only used by the grouped layout
+				uint32_t range_data_offset;
+			};
 
-			// TODO: Optimize this by counting the number of bits set, we can use the pop-count instruction on
-			// architectures that support it (e.g. xb1/ps4). This would entirely avoid looping here.
-			for (uint32_t bone_index = 0; bone_index < header.num_bones; ++bone_index)
+			inline void build_bone_track_offsets(const FullPrecisionHeader& header, const DecompressionContext& context, BoneTrackOffsets* out_bone_offsets)
 			{
-				if (bone_index == sample_bone_index)
-					break;
+				// Walk every track once with the skip functions and record where each bone's
+				// cursors land, a prefix sum of the track sizes
+				DecompressionContext cursor_context = context;
+				cursor_context.constant_track_data = context.clip_constant_track_data;
+				cursor_context.range_data = context.clip_range_data;
+				cursor_context.key_frame_data0 = context.animated_track_data;
+				cursor_context.key_frame_data1 = context.animated_track_data;
+				cursor_context.key_frame_translation_data0 = context.animated_track_data + (context.animated_rotation_size * context.num_interleaved_samples);
+				cursor_context.key_frame_translation_data1 = context.animated_track_data + (context.animated_rotation_size * context.num_interleaved_samples);
+				cursor_context.default_track_offset = 0;
+				cursor_context.constant_track_offset = 0;
+				cursor_context.default_track_cursor = bitset_make_cursor(context.default_tracks_bitset, context.bitset_size, 0);
+				cursor_context.constant_track_cursor = bitset_make_cursor(context.constant_tracks_bitset, context.bitset_size, 0);
+
+				for (uint32_t bone_index = 0; bone_index < header.num_bones; ++bone_index)
+				{
+					out_bone_offsets[bone_index].constant_data_offset = safe_static_cast<uint32_t>(cursor_context.constant_track_data - context.clip_constant_track_data);
+					out_bone_offsets[bone_index].animated_data_offset = safe_static_cast<uint32_t>(cursor_context.key_frame_data0 - context.animated_track_data);
+					out_bone_offsets[bone_index].animated_translation_data_offset = safe_static_cast<uint32_t>(cursor_context.key_frame_translation_data0 - (context.animated_track_data + (context.animated_rotation_size * context.num_interleaved_samples)));
+					out_bone_offsets[bone_index].range_data_offset = safe_static_cast<uint32_t>(cursor_context.range_data - context.clip_range_data);
+
+					skip_rotation(cursor_context);
+					skip_translation(cursor_context);
+					if (context.has_scale)
+						skip_scale(cursor_context);
+				}
+			}
 
-				skip_rotation(context);
-				skip_translation(context);
+			inline void seek_context_to_bone(const BoneTrackOffsets& bone_offsets, uint16_t bone_index, DecompressionContext& context)
+			{
+				context.constant_track_data = context.clip_constant_track_data + bone_offsets.constant_data_offset;
+				context.range_data = context.segment_range_data + bone_offsets.range_data_offset;
+				context.key_frame_data0 += bone_offsets.animated_data_offset;
+				context.key_frame_data1 += bone_offsets.animated_data_offset;
+				if (context.data_layout == AnimationDataLayout8::GroupedPerTrackType)
+				{
+					context.key_frame_translation_data0 += bone_offsets.animated_translation_data_offset;
+					context.key_frame_translation_data1 += bone_offsets.animated_translation_data_offset;
+				}
+				context.default_track_offset = bone_index * context.num_tracks_per_bone;
+				context.constant_track_offset = bone_index * context.num_tracks_per_bone;
+				context.default_track_cursor = bitset_make_cursor(context.default_tracks_bitset, context.bitset_size, context.default_track_offset);
+				context.constant_track_cursor = bitset_make_cursor(context.constant_tracks_bitset, context.bitset_size, context.constant_track_offset);
 			}
 
-			Quat_32 rotation = decompress_rotation(settings, header, context);
-			if (out_rotation != nullptr)
-				*out_rotation = rotation;
+				constexpr uint32_t NUM_SOA_DECODE_LANES = 4;
 
-			Vector4_32 translation = decompress_translation(settings, header, context);
-			if (out_translation != nullptr)
-				*out_translation = translation;
+			inline bool are_soa_bones_animated(const DecompressionContext& context)
+			{
+				// Four bones can be decoded together when all their rotation and translation
+				// tracks are animated, each bone contributing two consecutive bits
+				BitSetCursor default_track_cursor = context.default_track_cursor;
+				BitSetCursor constant_track_cursor = context.constant_track_cursor;
+				for (uint32_t track_index = 0; track_index < NUM_SOA_DECODE_LANES * FullPrecisionConstants::NUM_TRACKS_PER_BONE; ++track_index)
+				{
+					if (bitset_test(default_track_cursor))
+						return false;
+					if (bitset_test(constant_track_cursor))
+						return false;
+
+					bitset_advance(default_track_cursor);
+					bitset_advance(constant_track_cursor);
+				}
+
+				return true;
+			}
+
+			// Decodes and interpolates four fully animated bones per iteration.
+			// The animated pose data interleaves 12 byte Quat_96 rotations and Vector3_96
+			// translations for consecutive bones. We gather both key frames, transpose the
+			// rotations into SoA form [xxxx, yyyy, zzzz], reconstruct and interpolate every
+			// component across the four bones at once, and transpose back before writing.
+			template<class OutputWriterType>
+			inline void decompress_soa_bones_96(DecompressionContext& context, uint32_t first_bone_index, OutputWriterType& writer)
+			{
+				const uint32_t bone_stride = (context.rotation_size + context.translation_size) * context.num_interleaved_samples;
+				const uint32_t range_stride = context.range_rotation_size + context.range_translation_size;
+
+				// The cursors advance by fixed strides below, masked out channels skip
+				// their unpack, range expansion, and interpolation entirely
+				if (writer.are_rotations_wanted())
+				{
+					Vector4_32 rotations0[NUM_SOA_DECODE_LANES];
+					Vector4_32 rotations1[NUM_SOA_DECODE_LANES];
+
+					for (uint32_t lane_index = 0; lane_index < NUM_SOA_DECODE_LANES; ++lane_index)
+					{
+						const uint8_t* bone_key_frame_data0 = context.key_frame_data0 + (lane_index * bone_stride);
+						const uint8_t* bone_key_frame_data1 = context.key_frame_data1 + (lane_index * bone_stride);
+						const uint8_t* bone_range_data = context.range_data + (lane_index * range_stride);
+
+						Vector4_32 rotation0_xyz = unpack_vector3_96(bone_key_frame_data0);
+						Vector4_32 rotation1_xyz = unpack_vector3_96(bone_key_frame_data1);
+
+						if (context.range_rotation_size != 0)
+						{
+							Vector4_32 clip_range_min = vector_unaligned_load(bone_range_data);
+							Vector4_32 clip_range_extent = vector_unaligned_load(bone_range_data + (context.range_rotation_size / 2));
+
+							rotation0_xyz = vector_mul_add(rotation0_xyz, clip_range_extent, clip_range_min);
+							rotation1_xyz = vector_mul_add(rotation1_xyz, clip_range_extent, clip_range_min);
+						}
+
+						rotations0[lane_index] = rotation0_xyz;
+						rotations1[lane_index] = rotation1_xyz;
+					}
+
+					vector_transpose4(rotations0[0], rotations0[1], rotations0[2], rotations0[3]);
+					vector_transpose4(rotations1[0], rotations1[1], rotations1[2], rotations1[3]);
+
+					const Vector4_32 one = vector_set(1.0f);
+					const Vector4_32 zero = vector_zero_32();
+
+					// quat_from_positive_w for the four bones of both key frames at once
+					Vector4_32 w0_squared = vector_sub(one, vector_add(vector_add(vector_mul(rotations0[0], rotations0[0]), vector_mul(rotations0[1], rotations0[1])), vector_mul(rotations0[2], rotations0[2])));
+					Vector4_32 w1_squared = vector_sub(one, vector_add(vector_add(vector_mul(rotations1[0], rotations1[0]), vector_mul(rotations1[1], rotations1[1])), vector_mul(rotations1[2], rotations1[2])));
+					rotations0[3] = vector_sqrt(vector_max(w0_squared, zero));
+					rotations1[3] = vector_sqrt(vector_max(w1_squared, zero));
+
+					// quat_lerp for the four bones at once, one component per iteration
+					Vector4_32 interpolation_alpha = vector_set(context.interpolation_alpha);
+					Vector4_32 rotations[NUM_SOA_DECODE_LANES];
+					for (uint32_t component_index = 0; component_index < 4; ++component_index)
+						rotations[component_index] = vector_mul_add(vector_sub(rotations1[component_index], rotations0[component_index]), interpolation_alpha, rotations0[component_index]);
+
+					Vector4_32 length_squared = vector_add(vector_add(vector_mul(rotations[0], rotations[0]), vector_mul(rotations[1], rotations[1])), vector_add(vector_mul(rotations[2], rotations[2]), vector_mul(rotations[3], rotations[3])));
+					Vector4_32 length_reciprocal = vector_div(one, vector_sqrt(length_squared));
+					for (uint32_t component_index = 0; component_index < 4; ++component_index)
+						rotations[component_index] = vector_mul(rotations[component_index], length_reciprocal);
+
+					vector_transpose4(rotations[0], rotations[1], rotations[2], rotations[3]);
+
+					for (uint32_t lane_index = 0; lane_index < NUM_SOA_DECODE_LANES; ++lane_index)
+					{
+						Quat_32 rotation = vector_to_quat(rotations[lane_index]);
+
+						ACL_ENSURE(quat_is_valid(rotation), "Rotation is not valid!");
+						ACL_ENSURE(quat_is_normalized(rotation), "Rotation is not normalized!");
+
+						const uint32_t output_bone_index = context.lod_bone_order != nullptr ? context.lod_bone_order[first_bone_index + lane_index] : first_bone_index + lane_index;
+						writer.write_bone_rotation(output_bone_index, rotation);
+					}
+				}
+
+				if (writer.are_translations_wanted())
+				{
+					for (uint32_t lane_index = 0; lane_index < NUM_SOA_DECODE_LANES; ++lane_index)
+					{
+						const uint8_t* bone_key_frame_data0 = context.key_frame_data0 + (lane_index * bone_stride);
+						const uint8_t* bone_key_frame_data1 = context.key_frame_data1 + (lane_index * bone_stride);
+						const uint8_t* bone_range_data = context.range_data + (lane_index * range_stride);
+
+						Vector4_32 translation0 = unpack_vector3_96(bone_key_frame_data0 + (context.rotation_size * context.num_interleaved_samples));
+						Vector4_32 translation1 = unpack_vector3_96(bone_key_frame_data1 + (context.rotation_size * context.num_interleaved_samples));
+
+						if (context.range_translation_size != 0)
+						{
+							const uint8_t* translation_range_data = bone_range_data + context.range_rotation_size;
+							Vector4_32 clip_range_min = vector_unaligned_load(translation_range_data);
+							Vector4_32 clip_range_extent = vector_unaligned_load(translation_range_data + (context.range_translation_size / 2));
+
+							translation0 = vector_mul_add(translation0, clip_range_extent, clip_range_min);
+							translation1 = vector_mul_add(translation1, clip_range_extent, clip_range_min);
+						}
+
+						// Translation interpolation is component-wise, no transposition needed
+						Vector4_32 translation = vector_lerp(translation0, translation1, context.interpolation_alpha);
+
+						ACL_ENSURE(vector_is_valid3(translation), "Translation is not valid!");
+
+						const uint32_t output_bone_index = context.lod_bone_order != nullptr ? context.lod_bone_order[first_bone_index + lane_index] : first_bone_index + lane_index;
+						writer.write_bone_translation(output_bone_index, translation);
+					}
+				}
+
+				context.key_frame_data0 += NUM_SOA_DECODE_LANES * bone_stride;
+				context.key_frame_data1 += NUM_SOA_DECODE_LANES * bone_stride;
+				context.range_data += NUM_SOA_DECODE_LANES * range_stride;
+				context.default_track_offset += NUM_SOA_DECODE_LANES * FullPrecisionConstants::NUM_TRACKS_PER_BONE;
+				context.constant_track_offset += NUM_SOA_DECODE_LANES * FullPrecisionConstants::NUM_TRACKS_PER_BONE;
+				context.default_track_cursor = bitset_make_cursor(context.default_tracks_bitset, context.bitset_size, context.default_track_offset);
+				context.constant_track_cursor = bitset_make_cursor(context.constant_tracks_bitset, context.bitset_size, context.constant_track_offset);
+			}
+
+			template<class SettingsType, class OutputWriterType>
+			inline void decompress_pose_tracks(const SettingsType& settings, const FullPrecisionHeader& header, DecompressionContext& context, OutputWriterType& writer)
+			{
+				if (settings.is_forward_playback_assumed())
+				{
+					// Forward playback samples the pose right after the current key
+					// frames next, warm its key frame region while this pose decodes.
+					// The prefetches overlap with the whole per bone loop below and
+					// reaching a little past the end of the clip data is harmless,
+					// prefetches never fault.
+					const uint32_t pose_stride = context.animated_pose_size * context.num_interleaved_samples;
+					memory_prefetch_range(context.key_frame_data1 + pose_stride, context.animated_pose_size);
+
+					// The constant tracks are read interleaved with the animated ones,
+					// pull the head of their stream in ahead of the loop
+					if (context.constant_track_data != nullptr)
+						memory_prefetch_range(context.constant_track_data, 256);
+				}
+
+				const RotationFormat8 rotation_format = settings.get_rotation_format(header.rotation_format);
+				const VectorFormat8 translation_format = settings.get_translation_format(header.translation_format);
+				const bool is_soa_decode_supported = rotation_format == RotationFormat8::Quat_96 && settings.is_rotation_format_supported(RotationFormat8::Quat_96)
+					&& translation_format == VectorFormat8::Vector3_96 && settings.is_translation_format_supported(VectorFormat8::Vector3_96)
+					&& context.format_per_track_data == nullptr		// Variable quantization, the formats vary per track
+					&& context.data_layout == AnimationDataLayout8::Interleaved	// The SoA kernel expects interleaved bone data
+					&& !context.has_scale;							// The SoA kernel assumes two tracks per bone
+
+				// Tracks are sorted by LOD tier, a coarser LOD only decodes the leading
+				// bones of the stream and never touches the data past the tier boundary
+				const uint32_t num_decode_bones = context.num_decode_bones;
+
+				uint32_t bone_index = 0;
+				while (bone_index < num_decode_bones)
+				{
+					if (is_soa_decode_supported && bone_index + NUM_SOA_DECODE_LANES <= num_decode_bones && are_soa_bones_animated(context))
+					{
+						decompress_soa_bones_96(context, bone_index, writer);
+						bone_index += NUM_SOA_DECODE_LANES;
+						continue;
+					}
+
+					const uint32_t output_bone_index = context.lod_bone_order != nullptr ? context.lod_bone_order[bone_index] : bone_index;
+
+					if (writer.are_rotations_wanted())
+					{
+						Quat_32 rotation = decompress_rotation(settings, header, context);
+						writer.write_bone_rotation(output_bone_index, rotation);
+					}
+					else
+						skip_rotation(context);
+
+					if (writer.are_translations_wanted())
+					{
+						Vector4_32 translation = decompress_translation(settings, header, context);
+						writer.write_bone_translation(output_bone_index, translation);
+					}
+					else
+						skip_translation(context);
+
+					// Clips without scale never reach the scale code, stripping
+					// it statically only benefits decoders for clips that have it
+					if (settings.is_scale_supported() && header.has_scale)
+					{
+						if (writer.are_scales_wanted())
+						{
+							Vector4_32 scale = decompress_scale(settings, header, context);
+							writer.write_bone_scale(output_bone_index, scale);
+						}
+						else
+							skip_scale(context);
+					}
+
+					bone_index++;
+				}
+			}
+
+			// Whether two clips decode their tracks in the same bone order, a
+			// requirement for walking their streams in lockstep. Clips without LOD
+			// data always match, otherwise the bone order tables must be identical.
+			inline bool are_track_orders_matching(const DecompressionContext& context_a, const DecompressionContext& context_b, uint32_t num_bones)
+			{
+				if ((context_a.lod_bone_order == nullptr) != (context_b.lod_bone_order == nullptr))
+					return false;
+
+				if (context_a.lod_bone_order == nullptr)
+					return true;
+
+				for (uint32_t bone_index = 0; bone_index < num_bones; ++bone_index)
+				{
+					if (context_a.lod_bone_order[bone_index] != context_b.lod_bone_order[bone_index])
+						return false;
+				}
+
+				return true;
+			}
+
+			// Walks both compressed streams in lockstep and blends the two poses in
+			// registers: each bone is stored once, there is no intermediate pose
+			// buffer and no second pass over the skeleton. Within each clip the key
+			// frame interpolation uses the clip's own decode kernels, the cross clip
+			// blend is a lerp with a single normalize per rotation.
+			template<class SettingsTypeA, class SettingsTypeB, class OutputWriterType>
+			inline void decompress_pose_tracks_blended(const SettingsTypeA& settings_a, const FullPrecisionHeader& header_a, DecompressionContext& context_a,
+				const SettingsTypeB& settings_b, const FullPrecisionHeader& header_b, DecompressionContext& context_b,
+				float blend_weight, OutputWriterType& writer)
+			{
+				const bool clip_a_has_scale = settings_a.is_scale_supported() && header_a.has_scale;
+				const bool clip_b_has_scale = settings_b.is_scale_supported() && header_b.has_scale;
+
+				// A coarse LOD on either clip prunes the blended pose
+				const uint32_t num_decode_bones = std::min(context_a.num_decode_bones, context_b.num_decode_bones);
+
+				for (uint32_t bone_index = 0; bone_index < num_decode_bones; ++bone_index)
+				{
+					const uint32_t output_bone_index = context_a.lod_bone_order != nullptr ? context_a.lod_bone_order[bone_index] : bone_index;
+
+					if (writer.are_rotations_wanted())
+					{
+						Quat_32 rotation_a = decompress_rotation(settings_a, header_a, context_a);
+						Quat_32 rotation_b = decompress_rotation(settings_b, header_b, context_b);
+
+						// The clips were compressed independently, their quaternions can
+						// land in opposite hemispheres; flip to the shortest arc first
+						if (quat_dot(rotation_a, rotation_b) < 0.0f)
+							rotation_b = quat_neg(rotation_b);
+
+						writer.write_bone_rotation(output_bone_index, quat_lerp(rotation_a, rotation_b, blend_weight));
+					}
+					else
+					{
+						skip_rotation(context_a);
+						skip_rotation(context_b);
+					}
+
+					if (writer.are_translations_wanted())
+					{
+						Vector4_32 translation_a = decompress_translation(settings_a, header_a, context_a);
+						Vector4_32 translation_b = decompress_translation(settings_b, header_b, context_b);
+						writer.write_bone_translation(output_bone_index, vector_lerp(translation_a, translation_b, blend_weight));
+					}
+					else
+					{
+						skip_translation(context_a);
+						skip_translation(context_b);
+					}
+
+					// A clip without scale tracks contributes the default scale
+					if (clip_a_has_scale || clip_b_has_scale)
+					{
+						if (writer.are_scales_wanted())
+						{
+							Vector4_32 scale_a = clip_a_has_scale ? decompress_scale(settings_a, header_a, context_a) : vector_set(1.0f);
+							Vector4_32 scale_b = clip_b_has_scale ? decompress_scale(settings_b, header_b, context_b) : vector_set(1.0f);
+							writer.write_bone_scale(output_bone_index, vector_lerp(scale_a, scale_b, blend_weight));
+						}
+						else
+						{
+							if (clip_a_has_scale)
+								skip_scale(context_a);
+							if (clip_b_has_scale)
+								skip_scale(context_b);
+						}
+					}
+				}
+			}
+		}
+
+		//////////////////////////////////////////////////////////////////////////
+		// Deriving from this struct and overriding these constexpr functions
+		// allow you to control which code is stripped for maximum performance.
+		// With these, you can:
+		//    - Support only a subset of the formats and statically strip the rest
+		//    - Force a single format and statically strip the rest
+		//    - Decide all of this at runtime by not making the overrides constexpr
+		//
+		// By default, all formats are supported.
+		//////////////////////////////////////////////////////////////////////////
+		struct DecompressionSettings
+		{
+			constexpr bool is_rotation_format_supported(RotationFormat8 format) const { return true; }
+			constexpr bool is_translation_format_supported(VectorFormat8 format) const { return true; }
+			constexpr RotationFormat8 get_rotation_format(RotationFormat8 format) const { return format; }
+			constexpr VectorFormat8 get_translation_format(VectorFormat8 format) const { return format; }
+
+			constexpr bool are_range_reduction_flags_supported(RangeReductionFlags8 flags) const { return true; }
+			constexpr RangeReductionFlags8 get_range_reduction(RangeReductionFlags8 flags) const { return flags; }
+
+			// Whether clips compressed with scale tracks can be decompressed.
+			// Clips without scale never execute any scale code either way; override
+			// to return false when your clips never carry scale and the scale decode
+			// paths are stripped from the per bone loop entirely.
+			constexpr bool is_scale_supported() const { return true; }
+
+			// LOD level to decode whole poses at, 0 being full detail. When the clip
+			// was compressed with a per bone LOD assignment, decompress_pose only
+			// decodes the bones still animated at this level and stops at the tier
+			// boundary; the level clamps to the clip's coarsest one. Clips without
+			// LOD data always decode fully. Override with a runtime value to drive
+			// this from the character's display distance.
+			constexpr uint16_t get_level_of_detail() const { return 0; }
+
+			// When enabled, the quantized Quat_48/Quat_32 and Vector3_48/Vector3_32
+			// tracks interpolate their integer components directly with fixed point
+			// math and convert to float once at the end instead of unpacking both
+			// key frames to float first. The decode loop then stays in the integer
+			// pipe which wins on narrow mobile cores, measure before enabling
+			// elsewhere. Rotations reconstruct w from the interpolated components
+			// which stays within quantization noise of the float path. Disabled by
+			// default, the branch compiles away either way.
+			constexpr bool is_fixed_point_interpolation_enabled() const { return false; }
+
+			// When enabled, decompress_pose assumes forward sequential playback and
+			// issues software prefetches for the key frame region the next forward
+			// sample will read while the current pose decodes, along with the head
+			// of the constant track data ahead of the per bone loop. Pure hint: the
+			// decoded values are identical either way and the prefetches overlap
+			// with the decode loop, but random or backward sampling wastes cache
+			// bandwidth on lines that will not be read. Enable for contexts that
+			// advance a playback cursor, leave disabled for blend trees sampling
+			// all over the timeline.
+			constexpr bool is_forward_playback_assumed() const { return false; }
+		};
+
+		//////////////////////////////////////////////////////////////////////////
+		// Ready made fully specialized settings. Shipping titles usually cook two
+		// or three format combinations, instantiating the decompressors with these
+		// strips every other format branch at compile time and the decode loops
+		// become monomorphic. See find_specialized_decompress_pose below to select
+		// the right instantiation once per clip.
+		//////////////////////////////////////////////////////////////////////////
+		template<RotationFormat8 rotation_format, VectorFormat8 translation_format, RangeReductionFlags8 range_reduction>
+		struct FixedDecompressionSettings : public DecompressionSettings
+		{
+			constexpr bool is_rotation_format_supported(RotationFormat8 format) const { return format == rotation_format; }
+			constexpr bool is_translation_format_supported(VectorFormat8 format) const { return format == translation_format; }
+			constexpr RotationFormat8 get_rotation_format(RotationFormat8 format) const { return rotation_format; }
+			constexpr VectorFormat8 get_translation_format(VectorFormat8 format) const { return translation_format; }
+
+			constexpr bool are_range_reduction_flags_supported(RangeReductionFlags8 flags) const { return flags == range_reduction; }
+			constexpr RangeReductionFlags8 get_range_reduction(RangeReductionFlags8 flags) const { return range_reduction; }
+		};
+
+		//////////////////////////////////////////////////////////////////////////
+		// A DecompressionContext is owned by the user and re-used between calls.
+		// Initializing it reads the clip header once, caches the track bitset
+		// pointers, the format sizes, and the various data offsets. Afterwards,
+		// seeking only needs to calculate the new key frame pointers and the
+		// interpolation alpha which makes repeated sampling of the same clip
+		// as cheap as possible.
+		//////////////////////////////////////////////////////////////////////////
+		template<class SettingsType>
+		class DecompressionContext
+		{
+		public:
+			DecompressionContext(const SettingsType& settings = SettingsType())
+				: m_settings(settings)
+				, m_clip(nullptr)
+				, m_allocator(nullptr)
+				, m_bone_track_offsets(nullptr)
+				, m_num_bones(0)
+			{}
+
+			~DecompressionContext()
+			{
+				release_bone_track_offsets();
+			}
+
+			DecompressionContext(const DecompressionContext&) = delete;
+			DecompressionContext& operator=(const DecompressionContext&) = delete;
+
+			void initialize(const CompressedClip& clip)
+			{
+				ACL_ENSURE(clip.get_algorithm_type() == AlgorithmType8::UniformlySampled, "Invalid algorithm type [%s], expected [%s]", get_algorithm_name(clip.get_algorithm_type()), get_algorithm_name(AlgorithmType8::UniformlySampled));
+				ACL_ENSURE(clip.is_valid(false), "Clip is invalid");
+
+				release_bone_track_offsets();
+
+				const impl::FullPrecisionHeader& header = impl::get_full_precision_header(clip);
+				impl::initialize_context(m_settings, header, m_context);
+
+				m_clip = &clip;
+
+				// Split clips cannot seek until their payload is bound
+				if (!header.is_animated_data_external)
+					seek(0.0f);
+			}
+
+			// When an allocator is provided, a small per bone offset index is also built
+			// which makes decompress_bone O(1) instead of scanning every earlier track
+			void initialize(Allocator& allocator, const CompressedClip& clip)
+			{
+				initialize(clip);
+				build_bone_track_index(allocator);
+			}
+
+			// Binds the context to a clip stored in a shared database: the clip's
+			// constant track data lives in the database's deduplicated pool and is
+			// bound alongside the clip, see compress_clip_database
+			void initialize(const CompressedClipDatabase& database, uint32_t clip_index)
+			{
+				ACL_ENSURE(clip_index < database.get_num_clips(), "Clip index %u is out of range, the database holds %u clips", clip_index, database.get_num_clips());
+
+				const CompressedClip& clip = *database.get_clip(clip_index);
+				initialize(clip);
+
+				const impl::FullPrecisionHeader& header = impl::get_full_precision_header(clip);
+				impl::bind_constant_data(header, m_context, database.get_clip_constant_data(clip_index));
+			}
+
+			void initialize(Allocator& allocator, const CompressedClipDatabase& database, uint32_t clip_index)
+			{
+				initialize(database, clip_index);
+				build_bone_track_index(allocator);
+			}
+
+			bool is_initialized() const { return m_clip != nullptr; }
+
+			// Binds the external animated data payload written by compress_clip_split
+			// once it streamed in, must be called before seeking. The payload can be
+			// re-bound when the runtime moves it, e.g. after evicting cold segments.
+			void bind_animated_data(const uint8_t* animated_data)
+			{
+				ACL_ENSURE(is_initialized(), "Context is not initialized");
+
+				const impl::FullPrecisionHeader& header = impl::get_full_precision_header(*m_clip);
+				impl::bind_animated_data(header, m_context, animated_data);
+			}
+
+			void seek(float sample_time)
+			{
+				ACL_ENSURE(is_initialized(), "Context is not initialized");
+
+				const impl::FullPrecisionHeader& header = impl::get_full_precision_header(*m_clip);
+				impl::seek_context(header, sample_time, m_context);
+			}
+
+			const CompressedClip* get_compressed_clip() const { return m_clip; }
+			const SettingsType& get_settings() const { return m_settings; }
+
+		private:
+			void build_bone_track_index(Allocator& allocator)
+			{
+				const impl::FullPrecisionHeader& header = impl::get_full_precision_header(*m_clip);
+
+				m_allocator = &allocator;
+				m_num_bones = header.num_bones;
+				m_bone_track_offsets = allocate_type_array<impl::BoneTrackOffsets>(allocator, header.num_bones);
+				impl::build_bone_track_offsets(header, m_context, m_bone_track_offsets);
+			}
+
+			void release_bone_track_offsets()
+			{
+				if (m_bone_track_offsets != nullptr)
+				{
+					deallocate_type_array(*m_allocator, m_bone_track_offsets, m_num_bones);
+					m_allocator = nullptr;
+					m_bone_track_offsets = nullptr;
+					m_num_bones = 0;
+				}
+			}
+
+			SettingsType					m_settings;
+			const CompressedClip*			m_clip;
+			impl::DecompressionContext		m_context;
+			Allocator*						m_allocator;
+			impl::BoneTrackOffsets*			m_bone_track_offsets;
+			uint16_t						m_num_bones;
+
+			template<class ContextSettingsType, class OutputWriterType>
+			friend void decompress_pose(const DecompressionContext<ContextSettingsType>& context, OutputWriterType& writer);
+
+			template<class ContextSettingsType>
+			friend void decompress_bone(const DecompressionContext<ContextSettingsType>& context, uint16_t sample_bone_index, Quat_32* out_rotation, Vector4_32* out_translation, Vector4_32* out_scale);
+
+			template<class ContextSettingsTypeA, class ContextSettingsTypeB, class OutputWriterType>
+			friend void decompress_pose_blended(const DecompressionContext<ContextSettingsTypeA>& context_a, const DecompressionContext<ContextSettingsTypeB>& context_b, float blend_weight, OutputWriterType& writer);
+		};
+
+		template<class SettingsType, class OutputWriterType>
+		inline void decompress_pose(const DecompressionContext<SettingsType>& context, OutputWriterType& writer)
+		{
+			static_assert(std::is_base_of<DecompressionSettings, SettingsType>::value, "SettingsType must derive from DecompressionSettings!");
+			static_assert(std::is_base_of<OutputWriter, OutputWriterType>::value, "OutputWriterType must derive from OutputWriter!");
+
+			ACL_ENSURE(context.is_initialized(), "Context is not initialized");
+
+			const impl::FullPrecisionHeader& header = impl::get_full_precision_header(*context.m_clip);
+
+			// Decoding advances the track cursors, work with a local copy to keep the context re-usable
+			impl::DecompressionContext decode_context = context.m_context;
+			impl::decompress_pose_tracks(context.m_settings, header, decode_context, writer);
+		}
+
+		// Blends the poses of two persistent contexts at their current seek times,
+		// see decompress_pose_blended below for the semantics
+		template<class SettingsTypeA, class SettingsTypeB, class OutputWriterType>
+		inline void decompress_pose_blended(const DecompressionContext<SettingsTypeA>& context_a, const DecompressionContext<SettingsTypeB>& context_b, float blend_weight, OutputWriterType& writer)
+		{
+			static_assert(std::is_base_of<DecompressionSettings, SettingsTypeA>::value, "SettingsTypeA must derive from DecompressionSettings!");
+			static_assert(std::is_base_of<DecompressionSettings, SettingsTypeB>::value, "SettingsTypeB must derive from DecompressionSettings!");
+			static_assert(std::is_base_of<OutputWriter, OutputWriterType>::value, "OutputWriterType must derive from OutputWriter!");
+
+			ACL_ENSURE(context_a.is_initialized(), "Context A is not initialized");
+			ACL_ENSURE(context_b.is_initialized(), "Context B is not initialized");
+
+			const impl::FullPrecisionHeader& header_a = impl::get_full_precision_header(*context_a.m_clip);
+			const impl::FullPrecisionHeader& header_b = impl::get_full_precision_header(*context_b.m_clip);
+
+			ACL_ENSURE(header_a.num_bones == header_b.num_bones, "Blended clips must share the same skeleton: %u bones != %u bones", header_a.num_bones, header_b.num_bones);
+			ACL_ENSURE(header_a.is_additive == header_b.is_additive, "Cannot blend an additive clip with an absolute clip!");
+			ACL_ENSURE(impl::are_track_orders_matching(context_a.m_context, context_b.m_context, header_a.num_bones), "Blended clips must decode their tracks in the same bone order!");
+
+			// Decoding advances the track cursors, work with local copies to keep the contexts re-usable
+			impl::DecompressionContext decode_context_a = context_a.m_context;
+			impl::DecompressionContext decode_context_b = context_b.m_context;
+			impl::decompress_pose_tracks_blended(context_a.get_settings(), header_a, decode_context_a, context_b.get_settings(), header_b, decode_context_b, blend_weight, writer);
+		}
+
+		template<class SettingsType>
+		inline void decompress_bone(const DecompressionContext<SettingsType>& context, uint16_t sample_bone_index, Quat_32* out_rotation, Vector4_32* out_translation, Vector4_32* out_scale = nullptr)
+		{
+			static_assert(std::is_base_of<DecompressionSettings, SettingsType>::value, "SettingsType must derive from DecompressionSettings!");
+
+			ACL_ENSURE(context.is_initialized(), "Context is not initialized");
+
+			const impl::FullPrecisionHeader& header = impl::get_full_precision_header(*context.m_clip);
+
+			// Decoding advances the track cursors, work with a local copy to keep the context re-usable
+			impl::DecompressionContext decode_context = context.m_context;
+
+			// With LOD sorted tracks the bone's data lives at its track entry, not at its skeleton index
+			const uint16_t track_entry_index = impl::find_bone_track_entry(decode_context, header.num_bones, sample_bone_index);
+
+			if (context.m_bone_track_offsets != nullptr)
+			{
+				// The context was initialized with an allocator, jump straight to the bone
+				impl::seek_context_to_bone(context.m_bone_track_offsets[track_entry_index], track_entry_index, decode_context);
+			}
+			else
+				impl::skip_to_bone(decode_context, track_entry_index);
+
+			Quat_32 rotation = impl::decompress_rotation(context.m_settings, header, decode_context);
+			if (out_rotation != nullptr)
+				*out_rotation = rotation;
+
+			Vector4_32 translation = impl::decompress_translation(context.m_settings, header, decode_context);
+			if (out_translation != nullptr)
+				*out_translation = translation;
+
+			if (out_scale != nullptr)
+				*out_scale = context.m_settings.is_scale_supported() && header.has_scale ? impl::decompress_scale(context.m_settings, header, decode_context) : vector_set(1.0f);
+		}
+
+		//////////////////////////////////////////////////////////////////////////
+		// Returns whether the clip was compressed relative to a reference pose.
+		// The decompression entry points then write base relative deltas: feed
+		// them to an additive blender on top of the base pose instead of using
+		// them as absolute transforms, see CompressionSettings::additive_base_pose.
+		//////////////////////////////////////////////////////////////////////////
+		inline bool is_additive_clip(const CompressedClip& clip)
+		{
+			ACL_ENSURE(clip.get_algorithm_type() == AlgorithmType8::UniformlySampled, "Invalid algorithm type [%s], expected [%s]", get_algorithm_name(clip.get_algorithm_type()), get_algorithm_name(AlgorithmType8::UniformlySampled));
+
+			const impl::FullPrecisionHeader& header = impl::get_full_precision_header(clip);
+			return header.is_additive;
+		}
+
+		template<class SettingsType, class OutputWriterType>
+		inline void decompress_pose(const SettingsType& settings, const CompressedClip& clip, float sample_time, OutputWriterType& writer)
+		{
+			static_assert(std::is_base_of<DecompressionSettings, SettingsType>::value, "SettingsType must derive from DecompressionSettings!");
+			static_assert(std::is_base_of<OutputWriter, OutputWriterType>::value, "OutputWriterType must derive from OutputWriter!");
+
+			ACL_ENSURE(clip.get_algorithm_type() == AlgorithmType8::UniformlySampled, "Invalid algorithm type [%s], expected [%s]", get_algorithm_name(clip.get_algorithm_type()), get_algorithm_name(AlgorithmType8::UniformlySampled));
+			ACL_ENSURE(clip.is_valid(false), "Clip is invalid");
+
+			const impl::FullPrecisionHeader& header = impl::get_full_precision_header(clip);
+
+			impl::DecompressionContext context;
+			impl::initialize_context(settings, header, context);
+			impl::seek_context(header, sample_time, context);
+
+			impl::decompress_pose_tracks(settings, header, context, writer);
+		}
+
+		// Variant for clips compressed with compress_clip_split, animated_data is the
+		// streamed in payload buffer
+		template<class SettingsType, class OutputWriterType>
+		inline void decompress_pose(const SettingsType& settings, const CompressedClip& clip, const uint8_t* animated_data, float sample_time, OutputWriterType& writer)
+		{
+			static_assert(std::is_base_of<DecompressionSettings, SettingsType>::value, "SettingsType must derive from DecompressionSettings!");
+			static_assert(std::is_base_of<OutputWriter, OutputWriterType>::value, "OutputWriterType must derive from OutputWriter!");
+
+			ACL_ENSURE(clip.get_algorithm_type() == AlgorithmType8::UniformlySampled, "Invalid algorithm type [%s], expected [%s]", get_algorithm_name(clip.get_algorithm_type()), get_algorithm_name(AlgorithmType8::UniformlySampled));
+			ACL_ENSURE(clip.is_valid(false), "Clip is invalid");
+
+			const impl::FullPrecisionHeader& header = impl::get_full_precision_header(clip);
+
+			impl::DecompressionContext context;
+			impl::initialize_context(settings, header, context);
+			impl::bind_animated_data(header, context, animated_data);
+			impl::seek_context(header, sample_time, context);
+
+			impl::decompress_pose_tracks(settings, header, context, writer);
+		}
+
+		// Variant for clips stored in a shared database, the clip's constant track
+		// data comes from the database's deduplicated pool
+		template<class SettingsType, class OutputWriterType>
+		inline void decompress_pose(const SettingsType& settings, const CompressedClipDatabase& database, uint32_t clip_index, float sample_time, OutputWriterType& writer)
+		{
+			static_assert(std::is_base_of<DecompressionSettings, SettingsType>::value, "SettingsType must derive from DecompressionSettings!");
+			static_assert(std::is_base_of<OutputWriter, OutputWriterType>::value, "OutputWriterType must derive from OutputWriter!");
+
+			ACL_ENSURE(clip_index < database.get_num_clips(), "Clip index %u is out of range, the database holds %u clips", clip_index, database.get_num_clips());
+
+			const CompressedClip& clip = *database.get_clip(clip_index);
+			ACL_ENSURE(clip.get_algorithm_type() == AlgorithmType8::UniformlySampled, "Invalid algorithm type [%s], expected [%s]", get_algorithm_name(clip.get_algorithm_type()), get_algorithm_name(AlgorithmType8::UniformlySampled));
+			ACL_ENSURE(clip.is_valid(false), "Clip is invalid");
+
+			const impl::FullPrecisionHeader& header = impl::get_full_precision_header(clip);
+
+			impl::DecompressionContext context;
+			impl::initialize_context(settings, header, context);
+			impl::bind_constant_data(header, context, database.get_clip_constant_data(clip_index));
+			impl::seek_context(header, sample_time, context);
+
+			impl::decompress_pose_tracks(settings, header, context, writer);
+		}
+
+		//////////////////////////////////////////////////////////////////////////
+		// Samples two clips sharing the same skeleton and blends them into a
+		// single pose, e.g. a walk/run cycle transition. Both compressed streams
+		// are walked in lockstep and the blend happens in registers, each bone is
+		// decoded once per clip and stored once: no intermediate pose buffers, no
+		// second decode pass, no separate blend pass. A blend_weight of 0.0 gives
+		// clip A, 1.0 gives clip B. The clips can use different formats, they only
+		// need the same number of bones and the same decode order.
+		//////////////////////////////////////////////////////////////////////////
+		template<class SettingsTypeA, class SettingsTypeB, class OutputWriterType>
+		inline void decompress_pose_blended(const SettingsTypeA& settings_a, const CompressedClip& clip_a, float sample_time_a,
+			const SettingsTypeB& settings_b, const CompressedClip& clip_b, float sample_time_b,
+			float blend_weight, OutputWriterType& writer)
+		{
+			static_assert(std::is_base_of<DecompressionSettings, SettingsTypeA>::value, "SettingsTypeA must derive from DecompressionSettings!");
+			static_assert(std::is_base_of<DecompressionSettings, SettingsTypeB>::value, "SettingsTypeB must derive from DecompressionSettings!");
+			static_assert(std::is_base_of<OutputWriter, OutputWriterType>::value, "OutputWriterType must derive from OutputWriter!");
+
+			ACL_ENSURE(clip_a.get_algorithm_type() == AlgorithmType8::UniformlySampled, "Invalid algorithm type [%s], expected [%s]", get_algorithm_name(clip_a.get_algorithm_type()), get_algorithm_name(AlgorithmType8::UniformlySampled));
+			ACL_ENSURE(clip_a.is_valid(false), "Clip A is invalid");
+			ACL_ENSURE(clip_b.get_algorithm_type() == AlgorithmType8::UniformlySampled, "Invalid algorithm type [%s], expected [%s]", get_algorithm_name(clip_b.get_algorithm_type()), get_algorithm_name(AlgorithmType8::UniformlySampled));
+			ACL_ENSURE(clip_b.is_valid(false), "Clip B is invalid");
+
+			const impl::FullPrecisionHeader& header_a = impl::get_full_precision_header(clip_a);
+			const impl::FullPrecisionHeader& header_b = impl::get_full_precision_header(clip_b);
+
+			ACL_ENSURE(header_a.num_bones == header_b.num_bones, "Blended clips must share the same skeleton: %u bones != %u bones", header_a.num_bones, header_b.num_bones);
+			ACL_ENSURE(header_a.is_additive == header_b.is_additive, "Cannot blend an additive clip with an absolute clip!");
+
+			impl::DecompressionContext context_a;
+			impl::initialize_context(settings_a, header_a, context_a);
+			impl::seek_context(header_a, sample_time_a, context_a);
+
+			impl::DecompressionContext context_b;
+			impl::initialize_context(settings_b, header_b, context_b);
+			impl::seek_context(header_b, sample_time_b, context_b);
+
+			ACL_ENSURE(impl::are_track_orders_matching(context_a, context_b, header_a.num_bones), "Blended clips must decode their tracks in the same bone order!");
+
+			impl::decompress_pose_tracks_blended(settings_a, header_a, context_a, settings_b, header_b, context_b, blend_weight, writer);
+		}
+
+		//////////////////////////////////////////////////////////////////////////
+		// Samples the same clip at many different times, e.g. a crowd of agents
+		// sharing an animation. The clip header is parsed once and the poses are
+		// decompressed in increasing sample time order so the clip's bitsets, range
+		// data, and key frames stay hot in the cache across agents instead of being
+		// re-faulted for every agent. Batches are independent of each other, large
+		// crowds can be split into several batches dispatched across worker threads.
+		//////////////////////////////////////////////////////////////////////////
+		template<class SettingsType, class OutputWriterType>
+		inline void decompress_poses(Allocator& allocator, const SettingsType& settings, const CompressedClip& clip, const float* sample_times, uint32_t num_poses, OutputWriterType* writers)
+		{
+			static_assert(std::is_base_of<DecompressionSettings, SettingsType>::value, "SettingsType must derive from DecompressionSettings!");
+			static_assert(std::is_base_of<OutputWriter, OutputWriterType>::value, "OutputWriterType must derive from OutputWriter!");
+
+			ACL_ENSURE(clip.get_algorithm_type() == AlgorithmType8::UniformlySampled, "Invalid algorithm type [%s], expected [%s]", get_algorithm_name(clip.get_algorithm_type()), get_algorithm_name(AlgorithmType8::UniformlySampled));
+			ACL_ENSURE(clip.is_valid(false), "Clip is invalid");
+
+			if (num_poses == 0)
+				return;
+
+			const impl::FullPrecisionHeader& header = impl::get_full_precision_header(clip);
+
+			impl::DecompressionContext context;
+			impl::initialize_context(settings, header, context);
+
+			uint32_t* sample_order = allocate_type_array<uint32_t>(allocator, num_poses);
+			for (uint32_t pose_index = 0; pose_index < num_poses; ++pose_index)
+				sample_order[pose_index] = pose_index;
+
+			std::sort(sample_order, sample_order + num_poses, [sample_times](uint32_t lhs_index, uint32_t rhs_index) { return sample_times[lhs_index] < sample_times[rhs_index]; });
+
+			for (uint32_t entry_index = 0; entry_index < num_poses; ++entry_index)
+			{
+				const uint32_t pose_index = sample_order[entry_index];
+				impl::seek_context(header, sample_times[pose_index], context);
+
+				// Decoding advances the track cursors, work with a local copy to keep the context re-usable
+				impl::DecompressionContext decode_context = context;
+				impl::decompress_pose_tracks(settings, header, decode_context, writers[pose_index]);
+			}
+
+			deallocate_type_array(allocator, sample_order, num_poses);
+		}
+
+		template<class SettingsType>
+		inline void decompress_bone(const SettingsType& settings, const CompressedClip& clip, float sample_time, uint16_t sample_bone_index, Quat_32* out_rotation, Vector4_32* out_translation, Vector4_32* out_scale = nullptr)
+		{
+			static_assert(std::is_base_of<DecompressionSettings, SettingsType>::value, "SettingsType must derive from DecompressionSettings!");
+
+			ACL_ENSURE(clip.get_algorithm_type() == AlgorithmType8::UniformlySampled, "Invalid algorithm type [%s], expected [%s]", get_algorithm_name(clip.get_algorithm_type()), get_algorithm_name(AlgorithmType8::UniformlySampled));
+			ACL_ENSURE(clip.is_valid(false), "Clip is invalid");
+
+			const impl::FullPrecisionHeader& header = impl::get_full_precision_header(clip);
+
+			impl::DecompressionContext context;
+			impl::initialize_context(settings, header, context);
+			impl::seek_context(header, sample_time, context);
+
+			// With LOD sorted tracks the bone's data lives at its track entry, not at its skeleton index
+			impl::skip_to_bone(context, impl::find_bone_track_entry(context, header.num_bones, sample_bone_index));
+
+			Quat_32 rotation = impl::decompress_rotation(settings, header, context);
+			if (out_rotation != nullptr)
+				*out_rotation = rotation;
+
+			Vector4_32 translation = impl::decompress_translation(settings, header, context);
+			if (out_translation != nullptr)
+				*out_translation = translation;
+
+			if (out_scale != nullptr)
+				*out_scale = settings.is_scale_supported() && header.has_scale ? impl::decompress_scale(settings, header, context) : vector_set(1.0f);
+		}
+
+		// Variant for clips compressed with compress_clip_split, animated_data is the
+		// streamed in payload buffer
+		template<class SettingsType>
+		inline void decompress_bone(const SettingsType& settings, const CompressedClip& clip, const uint8_t* animated_data, float sample_time, uint16_t sample_bone_index, Quat_32* out_rotation, Vector4_32* out_translation, Vector4_32* out_scale = nullptr)
+		{
+			static_assert(std::is_base_of<DecompressionSettings, SettingsType>::value, "SettingsType must derive from DecompressionSettings!");
+
+			ACL_ENSURE(clip.get_algorithm_type() == AlgorithmType8::UniformlySampled, "Invalid algorithm type [%s], expected [%s]", get_algorithm_name(clip.get_algorithm_type()), get_algorithm_name(AlgorithmType8::UniformlySampled));
+			ACL_ENSURE(clip.is_valid(false), "Clip is invalid");
+
+			const impl::FullPrecisionHeader& header = impl::get_full_precision_header(clip);
+
+			impl::DecompressionContext context;
+			impl::initialize_context(settings, header, context);
+			impl::bind_animated_data(header, context, animated_data);
+			impl::seek_context(header, sample_time, context);
+
+			// With LOD sorted tracks the bone's data lives at its track entry, not at its skeleton index
+			impl::skip_to_bone(context, impl::find_bone_track_entry(context, header.num_bones, sample_bone_index));
+
+			Quat_32 rotation = impl::decompress_rotation(settings, header, context);
+			if (out_rotation != nullptr)
+				*out_rotation = rotation;
+
+			Vector4_32 translation = impl::decompress_translation(settings, header, context);
+			if (out_translation != nullptr)
+				*out_translation = translation;
+
+			if (out_scale != nullptr)
+				*out_scale = settings.is_scale_supported() && header.has_scale ? impl::decompress_scale(settings, header, context) : vector_set(1.0f);
+		}
+
+		// Variant for clips stored in a shared database, the clip's constant track
+		// data comes from the database's deduplicated pool
+		template<class SettingsType>
+		inline void decompress_bone(const SettingsType& settings, const CompressedClipDatabase& database, uint32_t clip_index, float sample_time, uint16_t sample_bone_index, Quat_32* out_rotation, Vector4_32* out_translation, Vector4_32* out_scale = nullptr)
+		{
+			static_assert(std::is_base_of<DecompressionSettings, SettingsType>::value, "SettingsType must derive from DecompressionSettings!");
+
+			ACL_ENSURE(clip_index < database.get_num_clips(), "Clip index %u is out of range, the database holds %u clips", clip_index, database.get_num_clips());
+
+			const CompressedClip& clip = *database.get_clip(clip_index);
+			ACL_ENSURE(clip.get_algorithm_type() == AlgorithmType8::UniformlySampled, "Invalid algorithm type [%s], expected [%s]", get_algorithm_name(clip.get_algorithm_type()), get_algorithm_name(AlgorithmType8::UniformlySampled));
+			ACL_ENSURE(clip.is_valid(false), "Clip is invalid");
+
+			const impl::FullPrecisionHeader& header = impl::get_full_precision_header(clip);
+
+			impl::DecompressionContext context;
+			impl::initialize_context(settings, header, context);
+			impl::bind_constant_data(header, context, database.get_clip_constant_data(clip_index));
+			impl::seek_context(header, sample_time, context);
+
+			// With LOD sorted tracks the bone's data lives at its track entry, not at its skeleton index
+			impl::skip_to_bone(context, impl::find_bone_track_entry(context, header.num_bones, sample_bone_index));
+
+			Quat_32 rotation = impl::decompress_rotation(settings, header, context);
+			if (out_rotation != nullptr)
+				*out_rotation = rotation;
+
+			Vector4_32 translation = impl::decompress_translation(settings, header, context);
+			if (out_translation != nullptr)
+				*out_translation = translation;
+
+			if (out_scale != nullptr)
+				*out_scale = settings.is_scale_supported() && header.has_scale ? impl::decompress_scale(settings, header, context) : vector_set(1.0f);
+		}
+
+		template<class OutputWriterType>
+		using DecompressPoseFunction = void(*)(const CompressedClip& clip, float sample_time, OutputWriterType& writer);
+
+		namespace impl
+		{
+			template<class SettingsType, class OutputWriterType>
+			void decompress_pose_with(const CompressedClip& clip, float sample_time, OutputWriterType& writer)
+			{
+				SettingsType settings;
+				decompress_pose(settings, clip, sample_time, writer);
+			}
+
+			template<class SettingsType>
+			inline bool are_settings_matching_header(const FullPrecisionHeader& header)
+			{
+				SettingsType settings;
+				return settings.get_rotation_format(header.rotation_format) == header.rotation_format
+					&& settings.is_rotation_format_supported(header.rotation_format)
+					&& settings.get_translation_format(header.translation_format) == header.translation_format
+					&& settings.is_translation_format_supported(header.translation_format)
+					&& settings.get_range_reduction(header.range_reduction) == header.range_reduction
+					&& settings.are_range_reduction_flags_supported(header.range_reduction)
+					&& (settings.is_scale_supported() || !header.has_scale);
+			}
+
+			template<class OutputWriterType>
+			inline DecompressPoseFunction<OutputWriterType> find_specialized_decompress_pose_impl(const FullPrecisionHeader& header)
+			{
+				return nullptr;
+			}
+
+			template<class OutputWriterType, class SettingsType, class... RemainingSettingsTypes>
+			inline DecompressPoseFunction<OutputWriterType> find_specialized_decompress_pose_impl(const FullPrecisionHeader& header)
+			{
+				if (are_settings_matching_header<SettingsType>(header))
+					return &decompress_pose_with<SettingsType, OutputWriterType>;
+
+				return find_specialized_decompress_pose_impl<OutputWriterType, RemainingSettingsTypes...>(header);
+			}
+		}
+
+		//////////////////////////////////////////////////////////////////////////
+		// Returns a decode entry point instantiated with the first settings type
+		// that matches the clip's compressed formats, null when none match. Call
+		// this once per clip and cache the returned function: with a list of
+		// FixedDecompressionSettings for the format combinations a title ships,
+		// every format and range reduction branch is resolved here instead of per
+		// bone inside the decode loop.
+		//////////////////////////////////////////////////////////////////////////
+		template<class OutputWriterType, class... SettingsTypes>
+		inline DecompressPoseFunction<OutputWriterType> find_specialized_decompress_pose(const CompressedClip& clip)
+		{
+			ACL_ENSURE(clip.get_algorithm_type() == AlgorithmType8::UniformlySampled, "Invalid algorithm type [%s], expected [%s]", get_algorithm_name(clip.get_algorithm_type()), get_algorithm_name(AlgorithmType8::UniformlySampled));
+			ACL_ENSURE(clip.is_valid(false), "Clip is invalid");
+
+			const impl::FullPrecisionHeader& header = impl::get_full_precision_header(clip);
+			return impl::find_specialized_decompress_pose_impl<OutputWriterType, SettingsTypes...>(header);
 		}
 	}
 }
@@ -25,27 +25,39 @@
 ////////////////////////////////////////////////////////////////////////////////
 
 #include "acl/core/memory.h"
+#include "acl/core/arena_allocator.h"
+#include "acl/core/counting_allocator.h"
 #include "acl/core/error.h"
+#include "acl/core/task_scheduler.h"
 #include "acl/core/bitset.h"
 #include "acl/core/enum_utils.h"
 #include "acl/core/algorithm_types.h"
 #include "acl/algorithm/uniformly_sampled/common.h"
 #include "acl/compression/compressed_clip_impl.h"
+#include "acl/compression/compression_stats.h"
+#include "acl/compression/clip_telemetry.h"
 #include "acl/compression/skeleton.h"
 #include "acl/compression/animation_clip.h"
+#include "acl/compression/downsample_clip.h"
 #include "acl/compression/stream/track_stream.h"
+#include "acl/compression/stream/track_stream_cache.h"
 #include "acl/compression/stream/convert_clip_to_streams.h"
+#include "acl/compression/stream/convert_streams_to_relative.h"
 #include "acl/compression/stream/convert_rotation_streams.h"
 #include "acl/compression/stream/compact_constant_streams.h"
+#include "acl/compression/stream/segment_streams.h"
 #include "acl/compression/stream/normalize_streams.h"
 #include "acl/compression/stream/quantize_streams.h"
+#include "acl/compression/stream/select_track_formats.h"
 #include "acl/compression/stream/get_num_animated_streams.h"
 #include "acl/compression/stream/write_stream_bitsets.h"
 #include "acl/compression/stream/write_stream_data.h"
 #include "acl/compression/stream/write_range_data.h"
 
+#include <algorithm>
 #include <stdint.h>
 #include <cstdio>
+#include <cstring>
 
 //////////////////////////////////////////////////////////////////////////
 // Full Precision Encoder
@@ -72,18 +84,162 @@ namespace acl
 
 			RangeReductionFlags8 range_reduction;
 
+			// Optional scheduler used to parallelize the per-track passes.
+			// When null, everything runs on the calling thread.
+			// The caller owns the scheduler and can share it between clips
+			// compressed concurrently as long as the allocator is thread safe.
+			ITaskScheduler* task_scheduler;
+
+			// When enabled, constant track detection also collapses tracks whose
+			// motion stays invisible in object space as judged by the skeleton
+			// error metric, instead of only bitwise constant tracks. Near constant
+			// bones then take the constant track fast path in the decoder.
+			// Ignored when a track cache is used since the metric needs the whole
+			// skeleton.
+			bool enable_error_driven_constant_tracks;
+
+			// When enabled, the encoder searches per bone for the cheapest formats
+			// that keep the skeleton error under the clip error threshold and the
+			// chosen formats are written in the compressed stream for the decoder.
+			// The candidate formats come from the range reduction flags and the
+			// rotation_format/translation_format fields above are ignored.
+			bool enable_variable_quantization;
+
+			// Layout of the animated pose data. The grouped layout keeps every
+			// rotation of a key frame contiguous followed by every translation,
+			// giving the decode loop linear streams the hardware prefetcher likes
+			// instead of one interleaved stream.
+			AnimationDataLayout8 data_layout;
+
+			// When enabled, key frame pairs are interleaved per track: the values of
+			// samples 2k and 2k+1 are adjacent for every track instead of sitting a
+			// whole pose apart. Interpolating between two consecutive key frames then
+			// reads one contiguous region, both interpolation sources share cache
+			// lines and the decode bandwidth of forward playback is halved.
+			// Odd sample counts duplicate the last sample to complete the final pair.
+			// Not supported with variable quantization; with the interleaved layout
+			// the packed rotation and translation sizes must also match (e.g.
+			// Quat_96/Vector3_96 or Quat_48/Vector3_48) for the track cursors to
+			// advance uniformly, the grouped layout has no such restriction.
+			bool interleave_key_frame_pairs;
+
+			// When enabled, every animated sample is stored in 32 bits: the first
+			// sample of the clip is an absolute refresh frame while the following
+			// samples store the delta from the previous sample in the normalized
+			// domain, clamped to a small window and accumulated back at decompression
+			// time. Temporally coherent tracks keep an effective precision close to
+			// the 48 bit formats at two thirds of the size; a seek costs one
+			// accumulation walk from the refresh frame so long clips pay more per
+			// random seek. Requires the Quat_48/Vector3_48 formats and per clip
+			// range reduction on rotations and translations; segmented clips are
+			// not supported since segments normalize per segment and the delta
+			// window is sized for the clip wide normalized domain; not supported
+			// with variable quantization or key frame pairing.
+			bool enable_delta_encoding;
+
+			// When enabled and stats are gathered, compress_clip builds a compact
+			// binary telemetry blob recording the achieved error (max and RMS, object
+			// space), chosen formats, value ranges and constant/default classification
+			// of every track, see ClipTelemetryHeader. The tools persist it next to
+			// the compressed clip so precision complaints can be investigated from a
+			// file read instead of a recompression. The error is measured by
+			// simulating the quantized reconstruction of every sample which costs
+			// about one error metric evaluation per pose; delta encoded clips report
+			// the error of the underlying clip formats, not the delta reconstruction.
+			// Ignored when no stats are passed to compress_clip.
+			bool generate_telemetry;
+
+			// Optional per bone LOD assignment, one entry per skeleton bone.
+			// bone_lod_levels[bone] is the most distant LOD level that still animates
+			// the bone, LOD level 0 being full detail; a root bone animated in every
+			// LOD holds num_lod_levels - 1 while a fingertip only animated up close
+			// holds 0. The compressed tracks are sorted most persistent first which
+			// lets the decoder read a prefix of the stream when a coarser LOD level
+			// is selected instead of skipping through every track.
+			// When null, tracks keep the skeleton bone order and clips decode fully.
+			const uint8_t* bone_lod_levels;
+			uint16_t num_lod_levels;
+
+			// When non zero, the clip is split into segments of that many key frames
+			// and a seek only touches one segment's pages instead of striding across
+			// the whole clip. Combine with RangeReductionFlags8::PerSegment to give
+			// every segment its own range data which also tightens quantization.
+			// Segments overlap by one sample so interpolation never crosses one.
+			uint32_t num_samples_per_segment;
+
+			// When non zero, the clip is re-sampled to this rate before any stream
+			// is built. The rate must evenly divide the clip sample rate and every
+			// retained sample must land on an authored sample point so the duration
+			// stays exact, see downsample_clip. The effective rate and sample count
+			// are recorded in the compressed header like any other clip.
+			// Cannot be combined with enable_error_driven_downsampling.
+			uint32_t target_sample_rate;
+
+			// When enabled, the encoder searches for the lowest sample rate that
+			// keeps the skeleton error under the clip error threshold, validated
+			// at every original sample point, and compresses at that rate.
+			// Idle and facial clips authored at 60 Hz commonly hold at a quarter
+			// of their rate for a matching size and decode bandwidth win.
+			bool enable_error_driven_downsampling;
+
+			// When not None, every track is encoded as its delta from a reference
+			// pose: the skeleton bind pose or the additive_base_transforms array
+			// below, see convert_streams_to_relative. The decoder then emits the
+			// deltas directly for an additive blender, nothing reconstructs the
+			// absolutes. Additive clips (recoils, breathing) barely deviate from
+			// their base so most tracks collapse to default tracks outright and
+			// the survivors normalize over near zero ranges, keeping even the
+			// smallest packed formats under the error threshold.
+			// The error driven features measure against the absolute clip and are
+			// not supported, except variable quantization which measures the
+			// deltas against their full precision selves instead.
+			AdditiveBasePose8 additive_base_pose;
+
+			// One transform per skeleton bone, only used with
+			// AdditiveBasePose8::Custom. The caller owns the array.
+			const Transform_64* additive_base_transforms;
+
 			CompressionSettings()
 				: rotation_format(RotationFormat8::Quat_128)
 				, translation_format(VectorFormat8::Vector3_96)
 				, range_reduction(RangeReductionFlags8::None)
+				, task_scheduler(nullptr)
+				, enable_error_driven_constant_tracks(false)
+				, enable_variable_quantization(false)
+				, data_layout(AnimationDataLayout8::Interleaved)
+				, interleave_key_frame_pairs(false)
+				, enable_delta_encoding(false)
+				, generate_telemetry(false)
+				, bone_lod_levels(nullptr)
+				, num_lod_levels(0)
+				, num_samples_per_segment(0)
+				, target_sample_rate(0)
+				, enable_error_driven_downsampling(false)
+				, additive_base_pose(AdditiveBasePose8::None)
+				, additive_base_transforms(nullptr)
 			{}
 		};
 
-		// Encoder entry point
-		inline CompressedClip* compress_clip(Allocator& allocator, const AnimationClip& clip, const RigidSkeleton& skeleton, const CompressionSettings& settings)
+		// Shared implementation behind the compression entry points below.
+		// The pipeline always runs in full since the compressed size depends on it.
+		// When measure_only is set, nothing is written and out_compressed_size is
+		// the only output. When out_buffer is non null the clip is written into it
+		// in place, otherwise the final buffer comes from the allocator.
+		// When out_stats is non null, per pass wall times and transient memory
+		// figures are gathered into it along the way.
+		// When out_animated_data is non null, the animated track data is split
+		// out of the clip buffer into its own payload allocation, see
+		// compress_clip_split.
+		// When out_constant_data is non null, the constant track data is split
+		// out of the clip buffer into its own allocation for pooling in a clip
+		// database, see compress_clip_database.
+		inline CompressedClip* compress_clip_impl(Allocator& allocator, const AnimationClip& clip, const RigidSkeleton& skeleton, const CompressionSettings& settings, TrackStreamCache* track_cache, void* out_buffer, size_t out_buffer_size, bool measure_only, uint32_t& out_compressed_size, CompressionStats* out_stats, uint8_t** out_animated_data, uint32_t* out_animated_data_size, uint8_t** out_constant_data, uint32_t* out_constant_data_size)
 		{
 			using namespace impl;
 
+			const bool gather_stats = out_stats != nullptr;
+			const double compression_start_time = gather_stats ? get_current_time_seconds() : 0.0;
+
 			uint16_t num_bones = clip.get_num_bones();
 			uint32_t num_samples = clip.get_num_samples();
 
@@ -94,24 +250,364 @@ namespace acl
 
 			if (settings.translation_format != VectorFormat8::Vector3_96)
 			{
-				if (ACL_TRY_ASSERT(are_enum_flags_set(settings.range_reduction, RangeReductionFlags8::PerClip | RangeReductionFlags8::Translations), "Translation quantization requires range reduction to be enabled!"))
+				if (ACL_TRY_ASSERT(is_enum_flag_set(settings.range_reduction, RangeReductionFlags8::Translations) && has_per_block_range_reduction(settings.range_reduction), "Translation quantization requires range reduction to be enabled!"))
+					return nullptr;
+			}
+
+			if (is_enum_flag_set(settings.range_reduction, RangeReductionFlags8::PerSegment))
+			{
+				if (ACL_TRY_ASSERT(settings.num_samples_per_segment != 0, "Per segment range reduction requires a segmented clip!"))
+					return nullptr;
+			}
+
+			if (settings.num_samples_per_segment != 0)
+			{
+				if (ACL_TRY_ASSERT(!is_enum_flag_set(settings.range_reduction, RangeReductionFlags8::PerClip), "Segmented clips use per segment range reduction, not per clip!"))
+					return nullptr;
+				if (ACL_TRY_ASSERT(!settings.enable_variable_quantization, "Variable quantization is not supported with segmented clips!"))
+					return nullptr;
+			}
+
+			if (settings.interleave_key_frame_pairs)
+			{
+				if (ACL_TRY_ASSERT(!settings.enable_variable_quantization, "Key frame pairing requires uniform track sizes, variable quantization is not supported!"))
+					return nullptr;
+				if (settings.data_layout == AnimationDataLayout8::Interleaved)
+				{
+					if (ACL_TRY_ASSERT(get_packed_rotation_size(settings.rotation_format) == get_packed_vector_size(settings.translation_format), "Key frame pairing with the interleaved layout requires matching rotation and translation sizes!"))
+						return nullptr;
+				}
+			}
+
+			if (settings.enable_delta_encoding)
+			{
+				if (ACL_TRY_ASSERT(settings.rotation_format == RotationFormat8::Quat_48 && settings.translation_format == VectorFormat8::Vector3_48, "Delta encoding requires the Quat_48 and Vector3_48 formats!"))
+					return nullptr;
+				if (ACL_TRY_ASSERT(is_enum_flag_set(settings.range_reduction, RangeReductionFlags8::Rotations) && is_enum_flag_set(settings.range_reduction, RangeReductionFlags8::Translations) && is_enum_flag_set(settings.range_reduction, RangeReductionFlags8::PerClip), "Delta encoding works in the normalized domain and requires per clip range reduction on rotations and translations!"))
+					return nullptr;
+				if (ACL_TRY_ASSERT(settings.num_samples_per_segment == 0, "Segments normalize per segment which shrinks the extent under the per step deltas and saturates the delta window, segmented clips are not supported!"))
+					return nullptr;
+				if (ACL_TRY_ASSERT(!settings.enable_variable_quantization, "Delta encoding requires uniform track sizes, variable quantization is not supported!"))
+					return nullptr;
+				if (ACL_TRY_ASSERT(!settings.interleave_key_frame_pairs, "Delta encoding accumulates samples in order, key frame pairing is not supported!"))
+					return nullptr;
+			}
+
+			// Scale tracks ride the interleaved per bone layout, one full precision
+			// sample after the bone's translation. The specialized layouts would each
+			// need their own scale handling and none of our scaled clips use them.
+			const bool has_scale = clip.has_scale_tracks();
+			if (has_scale)
+			{
+				if (ACL_TRY_ASSERT(settings.data_layout == AnimationDataLayout8::Interleaved, "Scale tracks are only supported with the interleaved layout!"))
+					return nullptr;
+				if (ACL_TRY_ASSERT(!settings.interleave_key_frame_pairs, "Scale tracks are not supported with key frame pairing!"))
+					return nullptr;
+				if (ACL_TRY_ASSERT(!settings.enable_delta_encoding, "Scale tracks are not supported with delta encoding!"))
+					return nullptr;
+				if (ACL_TRY_ASSERT(!settings.enable_variable_quantization, "Scale tracks are not supported with variable quantization!"))
+					return nullptr;
+				if (ACL_TRY_ASSERT(settings.num_samples_per_segment == 0, "Scale tracks are not supported with segmented clips!"))
 					return nullptr;
 			}
 
-			BoneStreams* bone_streams = convert_clip_to_streams(allocator, clip);
-			convert_rotation_streams(allocator, bone_streams, num_bones, settings.rotation_format);
-			compact_constant_streams(allocator, bone_streams, num_bones, 0.00001);
+			if (settings.additive_base_pose != AdditiveBasePose8::None)
+			{
+				if (ACL_TRY_ASSERT(settings.additive_base_pose != AdditiveBasePose8::Custom || settings.additive_base_transforms != nullptr, "A custom additive base pose requires base transforms!"))
+					return nullptr;
+				if (ACL_TRY_ASSERT(!settings.enable_error_driven_constant_tracks, "Error driven constant tracks measure against the absolute clip, not supported with additive encoding!"))
+					return nullptr;
+				if (ACL_TRY_ASSERT(!settings.enable_error_driven_downsampling, "Error driven down-sampling measures against the absolute clip, not supported with additive encoding!"))
+					return nullptr;
+				if (ACL_TRY_ASSERT(!settings.generate_telemetry, "Telemetry measures against the absolute clip, not supported with additive encoding!"))
+					return nullptr;
+				if (ACL_TRY_ASSERT(!has_scale, "Scale tracks are not supported with additive encoding, the bind pose has no scale!"))
+					return nullptr;
+			}
+
+			if (settings.bone_lod_levels != nullptr)
+			{
+				if (ACL_TRY_ASSERT(settings.num_lod_levels > 0, "A per bone LOD assignment requires at least one LOD level!"))
+					return nullptr;
+
+				for (uint16_t bone_index = 0; bone_index < num_bones; ++bone_index)
+				{
+					if (ACL_TRY_ASSERT(settings.bone_lod_levels[bone_index] < settings.num_lod_levels, "Bone %u has LOD level %u but the clip only has %u levels!", bone_index, settings.bone_lod_levels[bone_index], settings.num_lod_levels))
+						return nullptr;
+				}
+			}
+
+			// Down-sampling pre-pass: the clip is re-sampled to a lower rate before
+			// any stream is built and the rest of the pipeline runs on the smaller
+			// clip unchanged, recording the effective rate in the header. Only rates
+			// that keep every retained sample on an authored sample point are
+			// allowed so the decoder's uniform interpolation lands correctly,
+			// see downsample_clip.
+			if (settings.target_sample_rate != 0 || settings.enable_error_driven_downsampling)
+			{
+				const uint32_t sample_rate = clip.get_sample_rate();
+				uint32_t target_sample_rate = settings.target_sample_rate;
+
+				if (target_sample_rate != 0)
+				{
+					if (ACL_TRY_ASSERT(!settings.enable_error_driven_downsampling, "Specify a target sample rate or error driven down-sampling, not both!"))
+						return nullptr;
+					if (ACL_TRY_ASSERT(target_sample_rate <= sample_rate && (sample_rate % target_sample_rate) == 0, "The target sample rate must evenly divide the clip sample rate! %u does not divide %u", target_sample_rate, sample_rate))
+						return nullptr;
+					if (target_sample_rate != sample_rate)
+					{
+						if (ACL_TRY_ASSERT(can_downsample_clip(clip, sample_rate / target_sample_rate), "The clip cannot be re-sampled to %u, every retained sample must land on an authored sample!", target_sample_rate))
+							return nullptr;
+					}
+				}
+				else
+					target_sample_rate = find_downsampled_sample_rate(allocator, clip, skeleton);
+
+				if (target_sample_rate != sample_rate)
+				{
+					AnimationClip* downsampled_clip = downsample_clip(allocator, clip, skeleton, sample_rate / target_sample_rate);
+
+					CompressionSettings downsampled_settings = settings;
+					downsampled_settings.target_sample_rate = 0;
+					downsampled_settings.enable_error_driven_downsampling = false;
+
+					CompressedClip* compressed_clip = compress_clip_impl(allocator, *downsampled_clip, skeleton, downsampled_settings, track_cache, out_buffer, out_buffer_size, measure_only, out_compressed_size, out_stats, out_animated_data, out_animated_data_size, out_constant_data, out_constant_data_size);
+					deallocate_type(allocator, downsampled_clip);
+					return compressed_clip;
+				}
+			}
+
+			// Every stream we build below is transient, grab it all from an arena
+			// and release it in a single shot once the compressed clip is written.
+			// When stats are gathered, a counting wrapper between the arena and
+			// the backing allocator measures the transient memory footprint.
+			CountingAllocator counting_allocator(allocator);
+			ArenaAllocator arena_allocator(gather_stats ? static_cast<Allocator&>(counting_allocator) : static_cast<Allocator&>(allocator));
+
+			// Charges the wall time since the previous checkpoint to the given pass
+			double pass_start_time = compression_start_time;
+			auto record_pass_time = [out_stats, &pass_start_time](double CompressionStats::* pass_time)
+			{
+				if (out_stats == nullptr)
+					return;
+
+				const double end_time = get_current_time_seconds();
+				out_stats->*pass_time += end_time - pass_start_time;
+				pass_start_time = end_time;
+			};
+
+			// With variable quantization any rotation track can end up in a drop W format,
+			// so every track goes through the positive W conversion. Quat_96 stands in for
+			// the clip wide format everywhere a single rotation format is expected since
+			// Quat_128 is excluded from the candidates when range reduction is enabled.
+			RotationFormat8 clip_rotation_format = settings.enable_variable_quantization ? RotationFormat8::Quat_96 : settings.rotation_format;
+
+			const bool is_segmented = settings.num_samples_per_segment != 0;
+			const uint32_t num_segments = is_segmented ? calculate_num_segments(num_samples, settings.num_samples_per_segment) : 1;
+
+			// The bone order sorts the compressed tracks by decreasing LOD persistence:
+			// bones still animated at the most distant LOD level come first so a coarse
+			// LOD decode only reads a prefix of every per bone section. The sort is
+			// stable which preserves the skeleton bone order within a tier.
+			const bool has_lod_data = settings.bone_lod_levels != nullptr && settings.num_lod_levels > 1;
+			uint16_t* bone_order = nullptr;
+			if (has_lod_data)
+			{
+				bone_order = allocate_type_array<uint16_t>(arena_allocator, num_bones);
+				for (uint16_t bone_index = 0; bone_index < num_bones; ++bone_index)
+					bone_order[bone_index] = bone_index;
+
+				const uint8_t* bone_lod_levels = settings.bone_lod_levels;
+				std::stable_sort(bone_order, bone_order + num_bones, [bone_lod_levels](uint16_t lhs_bone_index, uint16_t rhs_bone_index) { return bone_lod_levels[lhs_bone_index] > bone_lod_levels[rhs_bone_index]; });
+			}
+
+			// Variable quantization picks its formats from the whole skeleton error
+			// and segmenting slices every stream, neither can reuse a track in
+			// isolation so the cache is ignored for those
+			// Delta encoding packs at write time from the normalized streams, the
+			// cache only holds fully quantized streams
+			// Telemetry measures the error from the full precision streams which the
+			// cache path quantizes bone by bone
+			// The cache only tracks rotation and translation hashes, scaled clips
+			// always run the full pipeline
+			// The cache key ignores the additive base pose, additive clips always
+			// run the full pipeline
+			const bool use_track_cache = track_cache != nullptr && !is_segmented && !settings.enable_variable_quantization && !settings.enable_delta_encoding && !(gather_stats && settings.generate_telemetry) && !has_scale && settings.additive_base_pose == AdditiveBasePose8::None;
+
+			uint32_t* track_hashes = nullptr;
+			bool* is_bone_dirty = nullptr;
+			if (use_track_cache)
+			{
+				const AnimatedBone* bones = clip.get_bones();
+				const bool is_cache_compatible = track_cache->is_compatible(settings.rotation_format, settings.translation_format, settings.range_reduction, num_bones, num_samples);
+
+				track_hashes = allocate_type_array<uint32_t>(arena_allocator, size_t(num_bones) * 2);
+				is_bone_dirty = allocate_type_array<bool>(arena_allocator, num_bones);
+				for (uint16_t bone_index = 0; bone_index < num_bones; ++bone_index)
+				{
+					track_hashes[(bone_index * 2) + 0] = bones[bone_index].rotation_track.get_hash();
+					track_hashes[(bone_index * 2) + 1] = bones[bone_index].translation_track.get_hash();
+					is_bone_dirty[bone_index] = !is_cache_compatible || !track_cache->is_bone_unchanged(bone_index, track_hashes[(bone_index * 2) + 0], track_hashes[(bone_index * 2) + 1]);
+				}
+			}
 
 			uint32_t clip_range_data_size = 0;
-			if (is_enum_flag_set(settings.range_reduction, RangeReductionFlags8::PerClip))
+			uint32_t segment_range_data_size = 0;
+			ClipSegment* segments = nullptr;
+			BoneTrackFormats* bone_formats = nullptr;
+
+			// Builds the optional telemetry sidecar, must run right before the streams
+			// are quantized while they still hold their full precision samples. The
+			// blob outlives the arena, it comes from the caller allocator.
+			auto generate_telemetry = [&](const BoneStreams* telemetry_streams, const ClipSegment* telemetry_segments, uint32_t num_telemetry_segments, const BoneTrackFormats* telemetry_formats)
 			{
-				normalize_rotation_streams(bone_streams, num_bones, settings.range_reduction, settings.rotation_format);
-				normalize_translation_streams(bone_streams, num_bones, settings.range_reduction);
-				clip_range_data_size = get_stream_range_data_size(bone_streams, num_bones, settings.range_reduction, settings.rotation_format, settings.translation_format);
+				if (!gather_stats || !settings.generate_telemetry)
+					return;
+
+				out_stats->set_telemetry(allocator, generate_clip_telemetry(allocator, clip, skeleton, telemetry_streams, telemetry_segments, num_telemetry_segments, telemetry_formats, settings.rotation_format, settings.translation_format));
+				record_pass_time(&CompressionStats::telemetry_time);
+			};
+
+			BoneStreams* bone_streams;
+			if (use_track_cache)
+			{
+				bone_streams = allocate_type_array<BoneStreams>(arena_allocator, num_bones);
+
+				const AnimatedBone* bones = clip.get_bones();
+				for (uint16_t bone_index = 0; bone_index < num_bones; ++bone_index)
+				{
+					if (!is_bone_dirty[bone_index])
+					{
+						// Cached streams already went through the whole pipeline
+						duplicate_bone_streams(arena_allocator, track_cache->get_bone_streams(bone_index), bone_streams[bone_index]);
+						continue;
+					}
+
+					convert_bone_to_streams(arena_allocator, bones[bone_index], num_samples, bone_streams[bone_index]);
+					record_pass_time(&CompressionStats::convert_clip_time);
+					convert_rotation_streams(arena_allocator, &bone_streams[bone_index], 1, clip_rotation_format);
+					record_pass_time(&CompressionStats::convert_rotations_time);
+					compact_constant_streams(arena_allocator, &bone_streams[bone_index], 1, 0.00001);
+					record_pass_time(&CompressionStats::compact_constants_time);
+
+					if (is_enum_flag_set(settings.range_reduction, RangeReductionFlags8::PerClip))
+					{
+						normalize_rotation_streams(&bone_streams[bone_index], 1, settings.range_reduction, clip_rotation_format, nullptr);
+						normalize_translation_streams(&bone_streams[bone_index], 1, settings.range_reduction, nullptr);
+						record_pass_time(&CompressionStats::normalize_time);
+					}
+
+					quantize_rotation_stream(arena_allocator, bone_streams[bone_index], settings.rotation_format);
+					quantize_translation_stream(arena_allocator, bone_streams[bone_index], settings.translation_format);
+					record_pass_time(&CompressionStats::quantize_time);
+				}
+
+				if (is_enum_flag_set(settings.range_reduction, RangeReductionFlags8::PerClip))
+					clip_range_data_size = get_stream_range_data_size(bone_streams, num_bones, settings.range_reduction, clip_rotation_format, settings.translation_format);
+
+				track_cache->update(bone_streams, track_hashes, num_bones, num_samples, settings.rotation_format, settings.translation_format, settings.range_reduction);
+			}
+			else
+			{
+				bone_streams = convert_clip_to_streams(arena_allocator, clip);
+				if (settings.additive_base_pose != AdditiveBasePose8::None)
+					convert_streams_to_relative(bone_streams, num_bones, skeleton, settings.additive_base_pose, settings.additive_base_transforms);
+				record_pass_time(&CompressionStats::convert_clip_time);
+				convert_rotation_streams(arena_allocator, bone_streams, num_bones, clip_rotation_format);
+				record_pass_time(&CompressionStats::convert_rotations_time);
+
+				if (settings.enable_error_driven_constant_tracks)
+					compact_constant_streams(arena_allocator, bone_streams, num_bones, 0.00001, clip, skeleton);
+				else
+					compact_constant_streams(arena_allocator, bone_streams, num_bones, 0.00001);
+				record_pass_time(&CompressionStats::compact_constants_time);
+
+				if (is_segmented)
+				{
+					segments = segment_streams(arena_allocator, bone_streams, num_bones, num_samples, settings.num_samples_per_segment, num_segments);
+					record_pass_time(&CompressionStats::segment_time);
+
+					if (is_enum_flag_set(settings.range_reduction, RangeReductionFlags8::PerSegment))
+					{
+						for (uint32_t segment_index = 0; segment_index < num_segments; ++segment_index)
+						{
+							normalize_rotation_streams(segments[segment_index].bone_streams, num_bones, settings.range_reduction, clip_rotation_format, settings.task_scheduler);
+							normalize_translation_streams(segments[segment_index].bone_streams, num_bones, settings.range_reduction, settings.task_scheduler);
+						}
+
+						// Every segment stores the same set of ranges, only their values differ
+						segment_range_data_size = get_stream_range_data_size(segments[0].bone_streams, num_bones, settings.range_reduction, clip_rotation_format, settings.translation_format);
+						clip_range_data_size = segment_range_data_size * num_segments;
+						record_pass_time(&CompressionStats::normalize_time);
+					}
+
+					generate_telemetry(bone_streams, segments, num_segments, nullptr);
+
+					for (uint32_t segment_index = 0; segment_index < num_segments; ++segment_index)
+					{
+						quantize_rotation_streams(arena_allocator, segments[segment_index].bone_streams, num_bones, settings.rotation_format, settings.task_scheduler);
+						quantize_translation_streams(arena_allocator, segments[segment_index].bone_streams, num_bones, settings.translation_format, settings.task_scheduler);
+					}
+					record_pass_time(&CompressionStats::quantize_time);
+				}
+				else
+				{
+					if (is_enum_flag_set(settings.range_reduction, RangeReductionFlags8::PerClip))
+					{
+						normalize_rotation_streams(bone_streams, num_bones, settings.range_reduction, clip_rotation_format, settings.task_scheduler);
+						normalize_translation_streams(bone_streams, num_bones, settings.range_reduction, settings.task_scheduler);
+						clip_range_data_size = get_stream_range_data_size(bone_streams, num_bones, settings.range_reduction, clip_rotation_format, settings.translation_format);
+						record_pass_time(&CompressionStats::normalize_time);
+					}
+
+					if (settings.enable_variable_quantization)
+					{
+						bone_formats = allocate_type_array<BoneTrackFormats>(arena_allocator, num_bones);
+						select_variable_track_formats(arena_allocator, bone_streams, num_bones, clip, skeleton, settings.range_reduction, settings.additive_base_pose != AdditiveBasePose8::None, bone_formats);
+						record_pass_time(&CompressionStats::select_formats_time);
+
+						if (gather_stats)
+						{
+							// The stats outlive the arena, copy the decisions with the caller allocator
+							BoneTrackFormats* track_formats = allocate_type_array<BoneTrackFormats>(allocator, num_bones);
+							for (uint16_t bone_index = 0; bone_index < num_bones; ++bone_index)
+								track_formats[bone_index] = bone_formats[bone_index];
+							out_stats->set_track_formats(allocator, track_formats, num_bones);
+						}
+
+						generate_telemetry(bone_streams, nullptr, 0, bone_formats);
+
+						parallel_tasks(settings.task_scheduler, num_bones, [&arena_allocator, bone_streams, bone_formats](uint32_t bone_index)
+						{
+							quantize_rotation_stream(arena_allocator, bone_streams[bone_index], bone_formats[bone_index].rotation_format);
+							quantize_translation_stream(arena_allocator, bone_streams[bone_index], bone_formats[bone_index].translation_format);
+						});
+						record_pass_time(&CompressionStats::quantize_time);
+					}
+					else if (settings.enable_delta_encoding)
+					{
+						generate_telemetry(bone_streams, nullptr, 0, nullptr);
+
+						// The animated samples are delta packed at write time, straight from the normalized streams
+						quantize_constant_streams(arena_allocator, bone_streams, num_bones, settings.rotation_format, settings.translation_format, settings.task_scheduler);
+						record_pass_time(&CompressionStats::quantize_time);
+					}
+					else
+					{
+						generate_telemetry(bone_streams, nullptr, 0, nullptr);
+
+						quantize_rotation_streams(arena_allocator, bone_streams, num_bones, settings.rotation_format, settings.task_scheduler);
+						quantize_translation_streams(arena_allocator, bone_streams, num_bones, settings.translation_format, settings.task_scheduler);
+						if (has_scale)
+							quantize_scale_streams(arena_allocator, bone_streams, num_bones, settings.task_scheduler);
+						record_pass_time(&CompressionStats::quantize_time);
+					}
+				}
 			}
 
-			quantize_rotation_streams(allocator, bone_streams, num_bones, settings.rotation_format);
-			quantize_translation_streams(allocator, bone_streams, num_bones, settings.translation_format);
+			// Segments hold the quantized samples when segmenting is enabled, the clip
+			// wide streams only retain the track flags and the constant samples
+			const BoneStreams* output_bone_streams = is_segmented ? segments[0].bone_streams : bone_streams;
 
 			uint32_t num_constant_rotation_tracks;
 			uint32_t num_constant_translation_tracks;
@@ -119,80 +615,552 @@ namespace acl
 			uint32_t num_animated_translation_tracks;
 			get_num_animated_streams(bone_streams, num_bones, num_constant_rotation_tracks, num_constant_translation_tracks, num_animated_rotation_tracks, num_animated_translation_tracks);
 
-			uint32_t rotation_size = get_packed_rotation_size(settings.rotation_format);
-			uint32_t translation_size = get_packed_vector_size(settings.translation_format);
+			uint32_t num_constant_scale_tracks;
+			uint32_t num_animated_scale_tracks;
+			get_num_animated_scale_streams(bone_streams, num_bones, num_constant_scale_tracks, num_animated_scale_tracks);
+
+			uint32_t constant_data_size = 0;
+			uint32_t animated_data_size = 0;
+			RotationFormat8 header_rotation_format = settings.rotation_format;
+			VectorFormat8 header_translation_format = settings.translation_format;
+			if (settings.enable_variable_quantization)
+			{
+				// Formats vary per bone, sum the quantized stream sample sizes and
+				// record the most precise chosen formats in the header
+				header_rotation_format = bone_formats[0].rotation_format;
+				header_translation_format = bone_formats[0].translation_format;
+				for (uint16_t bone_index = 0; bone_index < num_bones; ++bone_index)
+				{
+					const BoneStreams& bone_stream = bone_streams[bone_index];
+
+					if (bone_stream.is_rotation_animated())
+						animated_data_size += bone_stream.rotations.get_sample_size();
+					else if (!bone_stream.is_rotation_default)
+						constant_data_size += bone_stream.rotations.get_sample_size();
+
+					if (bone_stream.is_translation_animated())
+						animated_data_size += bone_stream.translations.get_sample_size();
+					else if (!bone_stream.is_translation_default)
+						constant_data_size += bone_stream.translations.get_sample_size();
 
-			// Constant translation tracks store the remaining sample with full precision
-			const uint32_t constant_translation_size = get_packed_vector_size(VectorFormat8::Vector3_96);
-			uint32_t constant_data_size = (rotation_size * num_constant_rotation_tracks) + (constant_translation_size * num_constant_translation_tracks);
-			uint32_t animated_data_size = (rotation_size * num_animated_rotation_tracks) + (translation_size * num_animated_translation_tracks);
+					// Lower enum values are more precise
+					if (bone_formats[bone_index].rotation_format < header_rotation_format)
+						header_rotation_format = bone_formats[bone_index].rotation_format;
+					if (bone_formats[bone_index].translation_format < header_translation_format)
+						header_translation_format = bone_formats[bone_index].translation_format;
+				}
+			}
+			else
+			{
+				uint32_t rotation_size = get_packed_rotation_size(settings.rotation_format);
+				uint32_t translation_size = get_packed_vector_size(settings.translation_format);
 
-			animated_data_size *= num_samples;
+				// Delta encoded clips store every animated sample in 32 bits, the
+				// constant tracks keep the clip formats
+				const uint32_t animated_rotation_size = settings.enable_delta_encoding ? sizeof(uint32_t) : rotation_size;
+				const uint32_t animated_translation_size = settings.enable_delta_encoding ? sizeof(uint32_t) : translation_size;
 
-			uint32_t bitset_size = get_bitset_size(num_bones * FullPrecisionConstants::NUM_TRACKS_PER_BONE);
+				// Constant translation tracks store the remaining sample with full precision
+				const uint32_t constant_translation_size = get_packed_vector_size(VectorFormat8::Vector3_96);
+				constant_data_size = (rotation_size * num_constant_rotation_tracks) + (constant_translation_size * num_constant_translation_tracks);
+				animated_data_size = (animated_rotation_size * num_animated_rotation_tracks) + (animated_translation_size * num_animated_translation_tracks);
+
+				// Scale tracks always store full precision samples
+				const uint32_t scale_size = get_packed_vector_size(VectorFormat8::Vector3_96);
+				constant_data_size += scale_size * num_constant_scale_tracks;
+				animated_data_size += scale_size * num_animated_scale_tracks;
+			}
+
+			// Consecutive segments overlap by one sample, the shared samples are stored twice.
+			// Key frame pairing pads every segment to an even sample count, the
+			// duplicated last sample completes the final pair.
+			const uint32_t animated_pose_size = animated_data_size;
+			uint32_t total_stored_samples;
+			if (settings.interleave_key_frame_pairs)
+			{
+				if (is_segmented)
+				{
+					total_stored_samples = 0;
+					for (uint32_t segment_index = 0; segment_index < num_segments; ++segment_index)
+						total_stored_samples += align_to(segments[segment_index].num_samples, 2);
+				}
+				else
+					total_stored_samples = align_to(num_samples, 2);
+			}
+			else
+				total_stored_samples = num_samples + (num_segments - 1);
+			animated_data_size *= total_stored_samples;
+
+			// The refresh frame of a delta encoded clip stores 48 bits per track
+			// instead of 32, see write_delta_track_data
+			if (settings.enable_delta_encoding)
+				animated_data_size += (animated_pose_size / sizeof(uint32_t)) * (get_packed_vector_size(VectorFormat8::Vector3_48) - sizeof(uint32_t));
+
+			const uint32_t num_tracks_per_bone = has_scale ? FullPrecisionConstants::NUM_TRACKS_PER_SCALED_BONE : FullPrecisionConstants::NUM_TRACKS_PER_BONE;
+			uint32_t bitset_size = get_bitset_size(num_bones * num_tracks_per_bone);
+			uint32_t format_per_track_data_size = settings.enable_variable_quantization ? uint32_t(num_bones) * FullPrecisionConstants::NUM_TRACKS_PER_BONE : 0;
+			uint32_t segment_headers_size = is_segmented ? num_segments * 2 * sizeof(uint32_t) : 0;
+			uint32_t lod_data_size = has_lod_data ? (uint32_t(settings.num_lod_levels) + num_bones) * sizeof(uint16_t) : 0;
+
+			// When the animated data is split out, the clip buffer only holds the
+			// install section and the payload gets its own allocation
+			const bool is_animated_data_external = out_animated_data != nullptr;
+
+			// When the constant data is split out for pooling in a database, the
+			// clip buffer excludes it entirely
+			const bool is_constant_data_external = out_constant_data != nullptr;
+			const uint32_t resident_constant_data_size = is_constant_data_external ? 0 : constant_data_size;
 
 			uint32_t buffer_size = 0;
 			buffer_size += sizeof(CompressedClip);
 			buffer_size += sizeof(FullPrecisionHeader);
 			buffer_size += sizeof(uint32_t) * bitset_size;		// Default tracks bitset
 			buffer_size += sizeof(uint32_t) * bitset_size;		// Constant tracks bitset
-			buffer_size += constant_data_size;					// Constant track data
+			buffer_size += format_per_track_data_size;			// Per track format table
+			buffer_size += segment_headers_size;				// Segment header table
+			buffer_size += lod_data_size;						// LOD bone counts and bone order table
+			buffer_size += resident_constant_data_size;			// Constant track data
 			buffer_size = align_to(buffer_size, 4);				// Align range data
 			buffer_size += clip_range_data_size;						// Range data
-			buffer_size = align_to(buffer_size, 4);				// Align animated data
-			buffer_size += animated_data_size;					// Animated track data
+			if (!is_animated_data_external)
+			{
+				buffer_size = align_to(buffer_size, 4);			// Align animated data
+				buffer_size += animated_data_size;				// Animated track data
+			}
+			buffer_size += PACKED_DATA_TAIL_PADDING;			// The unpack kernels read whole vectors
 
-			uint8_t* buffer = allocate_type_array<uint8_t>(allocator, buffer_size, 16);
+			out_compressed_size = buffer_size;
+
+			auto deallocate_streams = [&]()
+			{
+				if (is_segmented)
+				{
+					for (uint32_t segment_index = 0; segment_index < num_segments; ++segment_index)
+						deallocate_type_array(arena_allocator, segments[segment_index].bone_streams, num_bones);
+					deallocate_type_array(arena_allocator, segments, num_segments);
+				}
+				if (bone_order != nullptr)
+					deallocate_type_array(arena_allocator, bone_order, num_bones);
+				deallocate_type_array(arena_allocator, bone_streams, num_bones);
+			};
+
+			// The arena only returns its blocks when it is destroyed so the
+			// counters already hold their final values here
+			auto record_final_stats = [&]()
+			{
+				if (!gather_stats)
+					return;
+
+				out_stats->transient_peak_allocated_size = counting_allocator.get_peak_allocated_size();
+				out_stats->transient_total_allocated_size = counting_allocator.get_total_allocated_size();
+				out_stats->transient_num_allocations = counting_allocator.get_num_allocations();
+				out_stats->total_time = get_current_time_seconds() - compression_start_time;
+			};
+
+			if (measure_only)
+			{
+				deallocate_streams();
+				record_final_stats();
+				return nullptr;
+			}
+
+			uint8_t* buffer;
+			if (out_buffer != nullptr)
+			{
+				if (ACL_TRY_ASSERT(out_buffer_size >= buffer_size, "Output buffer is too small: %u < %u", uint32_t(out_buffer_size), buffer_size))
+				{
+					deallocate_streams();
+					return nullptr;
+				}
+				if (ACL_TRY_ASSERT(is_aligned_to(out_buffer, alignof(CompressedClip)), "Output buffer must be aligned to %u bytes", uint32_t(alignof(CompressedClip))))
+				{
+					deallocate_streams();
+					return nullptr;
+				}
+
+				buffer = reinterpret_cast<uint8_t*>(out_buffer);
+			}
+			else
+				buffer = allocate_type_array<uint8_t>(allocator, buffer_size, 16);
+
+			// The padding bytes are part of the clip and thus of its hash, keep them deterministic
+			std::memset(buffer + (buffer_size - PACKED_DATA_TAIL_PADDING), 0, PACKED_DATA_TAIL_PADDING);
 
 			CompressedClip* compressed_clip = make_compressed_clip(buffer, buffer_size, AlgorithmType8::UniformlySampled);
 
 			FullPrecisionHeader& header = get_full_precision_header(*compressed_clip);
 			header.num_bones = num_bones;
-			header.rotation_format = settings.rotation_format;
-			header.translation_format = settings.translation_format;
+			header.rotation_format = header_rotation_format;
+			header.translation_format = header_translation_format;
 			header.range_reduction = settings.range_reduction;
+			header.data_layout = settings.data_layout;
+			header.are_key_frames_paired = settings.interleave_key_frame_pairs;
+			header.is_animated_data_external = is_animated_data_external;
+			header.is_constant_data_external = is_constant_data_external;
+			header.is_delta_encoded = settings.enable_delta_encoding;
+			header.is_additive = settings.additive_base_pose != AdditiveBasePose8::None;
+			header.has_scale = has_scale;
 			header.num_samples = num_samples;
 			header.sample_rate = clip.get_sample_rate();
 			header.num_animated_rotation_tracks = num_animated_rotation_tracks;
 			header.num_animated_translation_tracks = num_animated_translation_tracks;
+			header.num_animated_scale_tracks = num_animated_scale_tracks;
+			header.num_samples_per_segment = is_segmented ? settings.num_samples_per_segment : 0;
+			header.num_segments = num_segments;
+			header.animated_data_size = animated_data_size;
+			header.num_lod_levels = has_lod_data ? settings.num_lod_levels : 0;
 			header.default_tracks_bitset_offset = sizeof(FullPrecisionHeader);
 			header.constant_tracks_bitset_offset = header.default_tracks_bitset_offset + (sizeof(uint32_t) * bitset_size);
-			header.constant_track_data_offset = header.constant_tracks_bitset_offset + (sizeof(uint32_t) * bitset_size);	// Aligned to 4 bytes
-			header.clip_range_data_offset = align_to(header.constant_track_data_offset + constant_data_size, 4);					// Aligned to 4 bytes
-			header.track_data_offset = align_to(header.clip_range_data_offset + clip_range_data_size, 4);								// Aligned to 4 bytes
+			header.format_per_track_data_offset = header.constant_tracks_bitset_offset + (sizeof(uint32_t) * bitset_size);	// Aligned to 4 bytes
+			header.segment_headers_offset = header.format_per_track_data_offset + format_per_track_data_size;				// Aligned to 4 bytes
+			header.lod_data_offset = header.segment_headers_offset + segment_headers_size;									// Aligned to 2 bytes
+			header.constant_track_data_offset = header.lod_data_offset + lod_data_size;
+			header.clip_range_data_offset = align_to(header.constant_track_data_offset + resident_constant_data_size, 4);			// Aligned to 4 bytes
+			if (is_animated_data_external)
+				header.track_data_offset = InvalidPtrOffset();
+			else
+				header.track_data_offset = align_to(header.clip_range_data_offset + clip_range_data_size, 4);						// Aligned to 4 bytes
 
-			write_default_track_bitset(bone_streams, num_bones, header.get_default_tracks_bitset(), bitset_size);
-			write_constant_track_bitset(bone_streams, num_bones, header.get_constant_tracks_bitset(), bitset_size);
+			write_default_track_bitset(bone_streams, num_bones, header.get_default_tracks_bitset(), bitset_size, bone_order);
+			write_constant_track_bitset(bone_streams, num_bones, header.get_constant_tracks_bitset(), bitset_size, bone_order);
 
-			if (constant_data_size > 0)
-				write_constant_track_data(bone_streams, num_bones, header.get_constant_track_data(), constant_data_size);
+			if (format_per_track_data_size > 0)
+			{
+				uint8_t* format_per_track_data = header.get_format_per_track_data();
+				for (uint16_t entry_index = 0; entry_index < num_bones; ++entry_index)
+				{
+					const uint16_t bone_index = bone_order != nullptr ? bone_order[entry_index] : entry_index;
+					format_per_track_data[(entry_index * FullPrecisionConstants::NUM_TRACKS_PER_BONE) + 0] = static_cast<uint8_t>(bone_formats[bone_index].rotation_format);
+					format_per_track_data[(entry_index * FullPrecisionConstants::NUM_TRACKS_PER_BONE) + 1] = static_cast<uint8_t>(bone_formats[bone_index].translation_format);
+				}
+			}
+			else
+				header.format_per_track_data_offset = InvalidPtrOffset();
+
+			if (has_lod_data)
+			{
+				// The bone counts are cumulative: count[L] is how many leading entries
+				// of every per bone section cover the bones animated at LOD level L
+				uint16_t* lod_data = header.get_lod_data();
+				for (uint16_t lod_level = 0; lod_level < settings.num_lod_levels; ++lod_level)
+				{
+					uint16_t num_lod_bones = 0;
+					for (uint16_t bone_index = 0; bone_index < num_bones; ++bone_index)
+					{
+						if (settings.bone_lod_levels[bone_index] >= lod_level)
+							num_lod_bones++;
+					}
+
+					lod_data[lod_level] = num_lod_bones;
+				}
+
+				for (uint16_t entry_index = 0; entry_index < num_bones; ++entry_index)
+					lod_data[settings.num_lod_levels + entry_index] = bone_order[entry_index];
+			}
 			else
+				header.lod_data_offset = InvalidPtrOffset();
+
+			if (is_segmented)
+			{
+				uint32_t* segment_headers = header.get_segment_headers();
+				uint32_t segment_animated_data_offset = 0;
+				for (uint32_t segment_index = 0; segment_index < num_segments; ++segment_index)
+				{
+					segment_headers[(segment_index * 2) + 0] = segment_animated_data_offset;
+					segment_headers[(segment_index * 2) + 1] = segment_index * segment_range_data_size;
+					const uint32_t num_stored_samples = settings.interleave_key_frame_pairs ? align_to(segments[segment_index].num_samples, 2) : segments[segment_index].num_samples;
+					segment_animated_data_offset += animated_pose_size * num_stored_samples;
+				}
+			}
+			else
+				header.segment_headers_offset = InvalidPtrOffset();
+
+			// When the constant data is external, it gets its own allocation for
+			// the database pool and the clip buffer skips straight to the range data
+			uint8_t* constant_data_payload = nullptr;
+			if (is_constant_data_external && constant_data_size > 0)
+			{
+				constant_data_payload = allocate_type_array<uint8_t>(allocator, constant_data_size + PACKED_DATA_TAIL_PADDING, 4);
+				std::memset(constant_data_payload + constant_data_size, 0, PACKED_DATA_TAIL_PADDING);
+			}
+
+			if (is_constant_data_external)
 				header.constant_track_data_offset = InvalidPtrOffset();
 
+			if (constant_data_size > 0)
+			{
+				uint8_t* constant_track_data = is_constant_data_external ? constant_data_payload : header.get_constant_track_data();
+				write_constant_track_data(output_bone_streams, num_bones, constant_track_data, constant_data_size, bone_order);
+			}
+			else if (!is_constant_data_external)
+				header.constant_track_data_offset = InvalidPtrOffset();
+
+			if (is_constant_data_external)
+			{
+				*out_constant_data = constant_data_payload;
+				*out_constant_data_size = constant_data_size != 0 ? constant_data_size + PACKED_DATA_TAIL_PADDING : 0;
+			}
+
+			// When the animated data is external, the payload gets its own
+			// allocation and the clip buffer ends with the range data
+			uint8_t* animated_data_payload = nullptr;
+			if (is_animated_data_external && animated_data_size > 0)
+			{
+				animated_data_payload = allocate_type_array<uint8_t>(allocator, animated_data_size + PACKED_DATA_TAIL_PADDING, 16);
+				std::memset(animated_data_payload + animated_data_size, 0, PACKED_DATA_TAIL_PADDING);
+			}
+
 			if (animated_data_size > 0)
-				write_animated_track_data(bone_streams, num_bones, header.get_track_data(), animated_data_size);
-			else
+			{
+				uint8_t* animated_track_data = is_animated_data_external ? animated_data_payload : header.get_track_data();
+				if (is_segmented)
+				{
+					uint32_t segment_animated_data_offset = 0;
+					for (uint32_t segment_index = 0; segment_index < num_segments; ++segment_index)
+					{
+						const ClipSegment& segment = segments[segment_index];
+						const uint32_t num_stored_samples = settings.interleave_key_frame_pairs ? align_to(segment.num_samples, 2) : segment.num_samples;
+						const uint32_t segment_animated_data_size = animated_pose_size * num_stored_samples;
+						write_animated_track_data(segment.bone_streams, num_bones, settings.data_layout, settings.interleave_key_frame_pairs, animated_track_data + segment_animated_data_offset, segment_animated_data_size, bone_order);
+						segment_animated_data_offset += segment_animated_data_size;
+					}
+				}
+				else if (settings.enable_delta_encoding)
+					write_delta_animated_track_data(bone_streams, num_bones, settings.data_layout, animated_track_data, animated_data_size, bone_order);
+				else
+					write_animated_track_data(bone_streams, num_bones, settings.data_layout, settings.interleave_key_frame_pairs, animated_track_data, animated_data_size, bone_order);
+			}
+			else if (!is_animated_data_external)
 				header.track_data_offset = InvalidPtrOffset();
 
+			if (is_animated_data_external)
+			{
+				*out_animated_data = animated_data_payload;
+				*out_animated_data_size = animated_data_size != 0 ? animated_data_size + PACKED_DATA_TAIL_PADDING : 0;
+			}
+
 			if (is_enum_flag_set(settings.range_reduction, RangeReductionFlags8::PerClip))
-				write_range_track_data(bone_streams, num_bones, settings.range_reduction, settings.rotation_format, settings.translation_format, header.get_clip_range_data(), clip_range_data_size);
+				write_range_track_data(bone_streams, num_bones, settings.range_reduction, clip_rotation_format, settings.translation_format, header.get_clip_range_data(), clip_range_data_size, bone_order);
+			else if (is_enum_flag_set(settings.range_reduction, RangeReductionFlags8::PerSegment))
+			{
+				uint8_t* clip_range_data = header.get_clip_range_data();
+				for (uint32_t segment_index = 0; segment_index < num_segments; ++segment_index)
+					write_range_track_data(segments[segment_index].bone_streams, num_bones, settings.range_reduction, clip_rotation_format, settings.translation_format, clip_range_data + (segment_index * segment_range_data_size), segment_range_data_size, bone_order);
+			}
 			else
 				header.clip_range_data_offset = InvalidPtrOffset();
 
 			finalize_compressed_clip(*compressed_clip);
+			record_pass_time(&CompressionStats::write_time);
 
-			deallocate_type_array(allocator, bone_streams, num_bones);
+			deallocate_streams();
+			record_final_stats();
 
 			return compressed_clip;
 		}
 
+		// Encoder entry point
+		// The optional track cache enables incremental recompression: it persists
+		// across compressions of successive versions of the same clip and bones
+		// whose raw track samples did not change reuse their processed streams,
+		// only dirty bones go through the compression pipeline again.
+		// The optional stats gather per pass times, transient memory figures,
+		// and the variable quantization decisions for diagnostics.
+		inline CompressedClip* compress_clip(Allocator& allocator, const AnimationClip& clip, const RigidSkeleton& skeleton, const CompressionSettings& settings, TrackStreamCache* track_cache = nullptr, CompressionStats* out_stats = nullptr)
+		{
+			uint32_t compressed_size;
+			return compress_clip_impl(allocator, clip, skeleton, settings, track_cache, nullptr, 0, false, compressed_size, out_stats, nullptr, nullptr, nullptr, nullptr);
+		}
+
+		// Streaming variant of compress_clip: the returned clip only holds the
+		// install section (header, bitsets, format and segment tables, LOD data,
+		// constant and range data) — everything context initialization touches —
+		// while the bulk animated track data is written to a separate payload
+		// buffer returned through out_animated_data, allocated with the allocator
+		// and 16 byte aligned. The install section can ship with the world tile
+		// and constant tracks decode before the payload is resident; bind the
+		// payload with DecompressionContext::initialize or the decompress_pose
+		// overload taking it once it streamed in. With a segmented clip the
+		// segment header table gives the offset of every segment within the
+		// payload so segments can fault in individually and cold ones can be
+		// evicted behind the decoder's back between seeks.
+		// out_animated_data is null and its size zero when every track is
+		// constant or default.
+		inline CompressedClip* compress_clip_split(Allocator& allocator, const AnimationClip& clip, const RigidSkeleton& skeleton, const CompressionSettings& settings, uint8_t*& out_animated_data, uint32_t& out_animated_data_size, TrackStreamCache* track_cache = nullptr, CompressionStats* out_stats = nullptr)
+		{
+			out_animated_data = nullptr;
+			out_animated_data_size = 0;
+
+			uint32_t compressed_size;
+			return compress_clip_impl(allocator, clip, skeleton, settings, track_cache, nullptr, 0, false, compressed_size, out_stats, &out_animated_data, &out_animated_data_size, nullptr, nullptr);
+		}
+
+		// Compresses a batch of clips sharing a skeleton into a single database
+		// buffer, see CompressedClipDatabase for the layout. The constant track
+		// values of a character barely vary between its clips (bind pose fingers,
+		// twist bones) yet every standalone clip stores its own copy; here each
+		// clip's constant track data is split out of its buffer and identical
+		// sections are stored once in a shared pool the clips reference by offset.
+		// Sections are deduplicated whole: the decoder walks the constant data
+		// with a sequential cursor so a clip's section must stay contiguous, and
+		// on a real character the sections are identical across clips anyway.
+		// Decompress with the DecompressionContext overload or the decompress_pose
+		// overload taking a database and a clip index.
+		// Returns nullptr if any clip fails to compress.
+		inline CompressedClipDatabase* compress_clip_database(Allocator& allocator, const AnimationClip* const* clips, uint32_t num_clips, const RigidSkeleton& skeleton, const CompressionSettings& settings)
+		{
+			if (ACL_TRY_ASSERT(clips != nullptr, "No clips provided!"))
+				return nullptr;
+			if (ACL_TRY_ASSERT(num_clips > 0, "A clip database requires at least one clip!"))
+				return nullptr;
+
+			CompressedClip** compressed_clips = allocate_type_array<CompressedClip*>(allocator, num_clips);
+			uint8_t** constant_data = allocate_type_array<uint8_t*>(allocator, num_clips);
+			uint32_t* constant_data_sizes = allocate_type_array<uint32_t>(allocator, num_clips);
+
+			// Maps every clip to the pool offset of its constant data section,
+			// 0 when the clip has none
+			uint32_t* constant_data_offsets = allocate_type_array<uint32_t>(allocator, num_clips);
+			uint32_t* constant_data_hashes = allocate_type_array<uint32_t>(allocator, num_clips);
+
+			auto deallocate_temporaries = [&](uint32_t num_compressed_clips)
+			{
+				for (uint32_t clip_index = 0; clip_index < num_compressed_clips; ++clip_index)
+				{
+					if (constant_data[clip_index] != nullptr)
+						deallocate_type_array(allocator, constant_data[clip_index], constant_data_sizes[clip_index]);
+					allocator.deallocate(compressed_clips[clip_index], compressed_clips[clip_index]->get_size());
+				}
+
+				deallocate_type_array(allocator, compressed_clips, num_clips);
+				deallocate_type_array(allocator, constant_data, num_clips);
+				deallocate_type_array(allocator, constant_data_sizes, num_clips);
+				deallocate_type_array(allocator, constant_data_offsets, num_clips);
+				deallocate_type_array(allocator, constant_data_hashes, num_clips);
+			};
+
+			for (uint32_t clip_index = 0; clip_index < num_clips; ++clip_index)
+			{
+				constant_data[clip_index] = nullptr;
+				constant_data_sizes[clip_index] = 0;
+
+				uint32_t compressed_size;
+				compressed_clips[clip_index] = compress_clip_impl(allocator, *clips[clip_index], skeleton, settings, nullptr, nullptr, 0, false, compressed_size, nullptr, nullptr, nullptr, &constant_data[clip_index], &constant_data_sizes[clip_index]);
+				if (compressed_clips[clip_index] == nullptr)
+				{
+					deallocate_temporaries(clip_index);
+					return nullptr;
+				}
+			}
+
+			// Deduplicate the constant data sections: a clip reuses the pool section
+			// of the first earlier clip with bitwise identical constant data. Pool
+			// sections keep the alignment of the resident constant data.
+			const uint32_t entries_end_offset = safe_static_cast<uint32_t>(sizeof(CompressedClipDatabase) + (size_t(num_clips) * sizeof(ClipDatabaseEntry)));
+			uint32_t constant_pool_end_offset = entries_end_offset;
+			for (uint32_t clip_index = 0; clip_index < num_clips; ++clip_index)
+			{
+				if (constant_data_sizes[clip_index] == 0)
+				{
+					constant_data_offsets[clip_index] = 0;
+					continue;
+				}
+
+				constant_data_hashes[clip_index] = crc32(constant_data[clip_index], constant_data_sizes[clip_index]);
+
+				uint32_t pool_offset = 0;
+				for (uint32_t pooled_clip_index = 0; pooled_clip_index < clip_index; ++pooled_clip_index)
+				{
+					if (constant_data[pooled_clip_index] == nullptr || constant_data_offsets[pooled_clip_index] == 0)
+						continue;
+
+					if (constant_data_sizes[pooled_clip_index] != constant_data_sizes[clip_index] || constant_data_hashes[pooled_clip_index] != constant_data_hashes[clip_index])
+						continue;
+
+					if (std::memcmp(constant_data[pooled_clip_index], constant_data[clip_index], constant_data_sizes[clip_index]) == 0)
+					{
+						pool_offset = constant_data_offsets[pooled_clip_index];
+						break;
+					}
+				}
+
+				if (pool_offset == 0)
+				{
+					constant_pool_end_offset = align_to(constant_pool_end_offset, 4);
+					pool_offset = constant_pool_end_offset;
+					constant_pool_end_offset += constant_data_sizes[clip_index];
+				}
+
+				constant_data_offsets[clip_index] = pool_offset;
+			}
+
+			uint32_t database_size = constant_pool_end_offset;
+			for (uint32_t clip_index = 0; clip_index < num_clips; ++clip_index)
+			{
+				database_size = align_to(database_size, alignof(CompressedClip));
+				database_size += compressed_clips[clip_index]->get_size();
+			}
+
+			uint8_t* database_buffer = allocate_type_array<uint8_t>(allocator, database_size, 16);
+
+			// Zero the buffer so the alignment padding between sections hashes deterministically
+			std::memset(database_buffer, 0, database_size);
+
+			CompressedClipDatabase* database = make_compressed_clip_database(database_buffer, database_size, num_clips);
+
+			ClipDatabaseEntry* entries = database->get_clip_entries();
+			uint32_t clip_offset = constant_pool_end_offset;
+			for (uint32_t clip_index = 0; clip_index < num_clips; ++clip_index)
+			{
+				clip_offset = align_to(clip_offset, alignof(CompressedClip));
+				entries[clip_index].clip_offset = clip_offset;
+				entries[clip_index].constant_data_offset = constant_data_offsets[clip_index];
+
+				std::memcpy(database_buffer + clip_offset, compressed_clips[clip_index], compressed_clips[clip_index]->get_size());
+				clip_offset += compressed_clips[clip_index]->get_size();
+
+				// The first owner of a pool section writes it
+				if (constant_data_offsets[clip_index] != 0)
+					std::memcpy(database_buffer + constant_data_offsets[clip_index], constant_data[clip_index], constant_data_sizes[clip_index]);
+			}
+
+			finalize_compressed_clip_database(*database);
+
+			deallocate_temporaries(num_clips);
+			return database;
+		}
+
+		// Returns the exact size in bytes compress_clip_into requires for the
+		// given clip and settings. The whole compression pipeline runs to measure
+		// it, only the output write is skipped; the allocator serves the same
+		// transient buffers compress_clip would use.
+		inline uint32_t calculate_compressed_clip_size(Allocator& allocator, const AnimationClip& clip, const RigidSkeleton& skeleton, const CompressionSettings& settings, TrackStreamCache* track_cache = nullptr)
+		{
+			uint32_t compressed_size = 0;
+			compress_clip_impl(allocator, clip, skeleton, settings, track_cache, nullptr, 0, true, compressed_size, nullptr, nullptr, nullptr, nullptr, nullptr);
+			return compressed_size;
+		}
+
+		// Writes the compressed clip directly into the caller provided buffer,
+		// e.g. a write combined file mapping, with no intermediate allocation for
+		// the output; headers, bitsets, range data, and track data land in place
+		// and the hash is finalized in the buffer. The buffer must be aligned like
+		// CompressedClip and at least calculate_compressed_clip_size(..) bytes;
+		// the written size is returned through out_compressed_size.
+		// Returns nullptr if the buffer is unsuitable or the inputs are invalid.
+		inline CompressedClip* compress_clip_into(void* buffer, size_t buffer_size, Allocator& allocator, const AnimationClip& clip, const RigidSkeleton& skeleton, const CompressionSettings& settings, uint32_t& out_compressed_size, TrackStreamCache* track_cache = nullptr)
+		{
+			out_compressed_size = 0;
+			return compress_clip_impl(allocator, clip, skeleton, settings, track_cache, buffer, buffer_size, false, out_compressed_size, nullptr, nullptr, nullptr, nullptr, nullptr);
+		}
+
 		inline void print_stats(const CompressedClip& clip, std::FILE* file)
 		{
 			using namespace impl;
 
 			const FullPrecisionHeader& header = get_full_precision_header(clip);
 
-			uint32_t num_animated_tracks = header.num_animated_rotation_tracks + header.num_animated_translation_tracks;
+			uint32_t num_animated_tracks = header.num_animated_rotation_tracks + header.num_animated_translation_tracks + header.num_animated_scale_tracks;
 
 			fprintf(file, "Clip rotation format: %s\n", get_rotation_format_name(header.rotation_format));
 			fprintf(file, "Clip translation format: %s\n", get_vector_format_name(header.translation_format));
@@ -27,6 +27,8 @@
 #include "acl/compression/animation_track.h"
 #include "acl/compression/skeleton.h"
 #include "acl/core/string.h"
+#include "acl/math/quat_32.h"
+#include "acl/math/vector4_32.h"
 
 #include <stdint.h>
 
@@ -36,18 +38,34 @@ namespace acl
 	{
 		AnimationRotationTrack		rotation_track;
 		AnimationTranslationTrack	translation_track;
+
+		// Only initialized when the clip carries scale tracks, most clips do not
+		AnimationScaleTrack			scale_track;
 	};
 
+	// Describes the external sample buffers of one bone, see AnimationClip::bind
+	struct AnimatedBoneBinding
+	{
+		double*		rotation_samples;		// num_samples xyzw double quadruplets
+		double*		translation_samples;	// num_samples xyz double triplets
+		double*		scale_samples;			// num_samples xyz double triplets, null when the clip has no scale tracks
+	};
+
+	class AnimationClipSamplingContext;
+
 	class AnimationClip
 	{
 	public:
-		AnimationClip(Allocator& allocator, const RigidSkeleton& skeleton, uint32_t num_samples, uint32_t sample_rate, const String &name, double error_threshold)
+		// Most clips carry no scale, their bones skip the scale track allocation
+		// entirely and compress exactly as before
+		AnimationClip(Allocator& allocator, const RigidSkeleton& skeleton, uint32_t num_samples, uint32_t sample_rate, const String &name, double error_threshold, bool has_scale = false)
 			: m_allocator(allocator)
 			, m_bones()
 			, m_error_threshold(error_threshold)
 			, m_num_samples(num_samples)
 			, m_sample_rate(sample_rate)
 			, m_num_bones(skeleton.get_num_bones())
+			, m_has_scale(has_scale)
 			, m_name(allocator, name)
 		{
 			m_bones = allocate_type_array<AnimatedBone>(allocator, m_num_bones);
@@ -56,9 +74,62 @@ namespace acl
 			{
 				m_bones[bone_index].rotation_track = AnimationRotationTrack(allocator, num_samples, sample_rate);
 				m_bones[bone_index].translation_track = AnimationTranslationTrack(allocator, num_samples, sample_rate);
+				if (has_scale)
+					m_bones[bone_index].scale_track = AnimationScaleTrack(allocator, num_samples, sample_rate);
+			}
+		}
+
+		// Binding constructor, see AnimationClip::bind for validation and rationale
+		AnimationClip(Allocator& allocator, const RigidSkeleton& skeleton, const AnimatedBoneBinding* bindings, uint32_t num_samples, uint32_t sample_rate, const String& name, double error_threshold, bool has_scale)
+			: m_allocator(allocator)
+			, m_bones()
+			, m_error_threshold(error_threshold)
+			, m_num_samples(num_samples)
+			, m_sample_rate(sample_rate)
+			, m_num_bones(skeleton.get_num_bones())
+			, m_has_scale(has_scale)
+			, m_name(allocator, name)
+		{
+			m_bones = allocate_type_array<AnimatedBone>(allocator, m_num_bones);
+
+			for (uint16_t bone_index = 0; bone_index < m_num_bones; ++bone_index)
+			{
+				const AnimatedBoneBinding& binding = bindings[bone_index];
+				m_bones[bone_index].rotation_track = AnimationRotationTrack(binding.rotation_samples, num_samples, sample_rate);
+				m_bones[bone_index].translation_track = AnimationTranslationTrack(binding.translation_samples, num_samples, sample_rate);
+				if (has_scale)
+					m_bones[bone_index].scale_track = AnimationScaleTrack(binding.scale_samples, num_samples, sample_rate);
 			}
 		}
 
+		// Non owning construction path for importers that already hold their sample
+		// data in flat arrays: each bone binds its tracks directly over the caller's
+		// buffers, laid out exactly as set_sample writes them. Ingestion is pointer
+		// wiring, nothing per track is allocated or copied and the caller keeps
+		// every buffer alive for the clip's lifetime. All bones must agree on
+		// whether they carry scale. Free the returned clip with deallocate_type.
+		static AnimationClip* bind(Allocator& allocator, const RigidSkeleton& skeleton, const AnimatedBoneBinding* bindings, uint32_t num_samples, uint32_t sample_rate, const String& name, double error_threshold)
+		{
+			if (ACL_TRY_ASSERT(bindings != nullptr, "Bindings cannot be null"))
+				return nullptr;
+
+			uint16_t num_bones = skeleton.get_num_bones();
+			bool has_scale = num_bones != 0 && bindings[0].scale_samples != nullptr;
+
+			for (uint16_t bone_index = 0; bone_index < num_bones; ++bone_index)
+			{
+				const AnimatedBoneBinding& binding = bindings[bone_index];
+				if (ACL_TRY_ASSERT(binding.rotation_samples != nullptr, "Rotation samples cannot be null for bone %u", bone_index))
+					return nullptr;
+				if (ACL_TRY_ASSERT(binding.translation_samples != nullptr, "Translation samples cannot be null for bone %u", bone_index))
+					return nullptr;
+				if (ACL_TRY_ASSERT((binding.scale_samples != nullptr) == has_scale, "Every bone must agree on whether the clip carries scale, bone %u does not", bone_index))
+					return nullptr;
+			}
+
+			return allocate_type<AnimationClip>(allocator, allocator, skeleton, bindings, num_samples, sample_rate, name, error_threshold, has_scale);
+		}
+
 		~AnimationClip()
 		{
 			deallocate_type_array(m_allocator, m_bones, m_num_bones);
@@ -86,52 +157,146 @@ namespace acl
 		}
 		const String& get_name() const { return m_name; }
 		double get_error_threshold() const { return m_error_threshold; }
+		bool has_scale_tracks() const { return m_has_scale; }
 
+		// One off sampling entry point. Loops that sample many times per clip
+		// should create an AnimationClipSamplingContext instead and re-use it
 		template<class OutputWriterType>
-		void sample_pose(double sample_time, OutputWriterType& writer) const
+		void sample_pose(double sample_time, OutputWriterType& writer) const;
+
+		uint32_t get_total_size() const
 		{
-			uint16_t num_bones = get_num_bones();
-			ACL_ENSURE(num_bones > 0, "Invalid number of bones: %u", num_bones);
+			uint32_t bone_sample_size = (sizeof(float) * 4) + (sizeof(float) * 3);
+			if (m_has_scale)
+				bone_sample_size += sizeof(float) * 3;
+			return m_num_bones * bone_sample_size * m_num_samples;
+		}
 
-			double clip_duration = get_duration();
+	private:
+		Allocator&				m_allocator;
 
-			uint32_t sample_frame0;
-			uint32_t sample_frame1;
-			double interpolation_alpha;
-			calculate_interpolation_keys(m_num_samples, clip_duration, sample_time, sample_frame0, sample_frame1, interpolation_alpha);
+		AnimatedBone*			m_bones;
 
-			for (uint16_t bone_index = 0; bone_index < num_bones; ++bone_index)
+		double					m_error_threshold;
+		uint32_t				m_num_samples;
+		uint32_t				m_sample_rate;
+		uint16_t				m_num_bones;
+		bool					m_has_scale;
+
+		String					m_name;
+	};
+
+	//////////////////////////////////////////////////////////////////////////
+	// Precomputes everything sample_pose otherwise derives on every call: the
+	// duration reciprocal and the key frame pair and interpolation alpha of the
+	// current time. seek() does that work once per sample time, the sampling
+	// entry points then run tight loops over the raw double arrays of every
+	// track. Error measurement loops sample thousands of poses per clip, create
+	// one context and re-use it, nothing is allocated.
+	//////////////////////////////////////////////////////////////////////////
+	class AnimationClipSamplingContext
+	{
+	public:
+		AnimationClipSamplingContext(const AnimationClip& clip)
+			: m_bones(clip.get_bones())
+			, m_clip_duration(clip.get_duration())
+			, m_inv_clip_duration(clip.get_duration() != 0.0 ? 1.0 / clip.get_duration() : 0.0)
+			, m_interpolation_alpha(0.0)
+			, m_num_samples(clip.get_num_samples())
+			, m_sample_frame0(0)
+			, m_sample_frame1(0)
+			, m_num_bones(clip.get_num_bones())
+		{
+			ACL_ENSURE(m_num_bones > 0, "Invalid number of bones: %u", m_num_bones);
+		}
+
+		// Computes the key frame pair and interpolation alpha for the given time,
+		// multiplying with the precomputed duration reciprocal instead of dividing
+		void seek(double sample_time)
+		{
+			ACL_ENSURE(sample_time >= 0.0 && sample_time <= m_clip_duration, "Invalid sample time. 0.0 <= %f <= %f", sample_time, m_clip_duration);
+
+			double sample_key = (sample_time * m_inv_clip_duration) * double(m_num_samples - 1);
+			uint32_t sample_frame0 = uint32_t(floor(sample_key));
+
+			m_sample_frame0 = sample_frame0;
+			m_sample_frame1 = std::min(sample_frame0 + 1, m_num_samples - 1);
+			m_interpolation_alpha = sample_key - double(sample_frame0);
+
+			ACL_ENSURE(m_interpolation_alpha >= 0.0 && m_interpolation_alpha <= 1.0, "Invalid interpolation alpha: 0.0 <= %f <= 1.0", m_interpolation_alpha);
+		}
+
+		// Samples every track at the current time
+		template<class OutputWriterType>
+		void sample_pose(OutputWriterType& writer) const
+		{
+			size_t rotation_offset0 = size_t(m_sample_frame0) * 4;
+			size_t rotation_offset1 = size_t(m_sample_frame1) * 4;
+			size_t translation_offset0 = size_t(m_sample_frame0) * 3;
+			size_t translation_offset1 = size_t(m_sample_frame1) * 3;
+			double interpolation_alpha = m_interpolation_alpha;
+
+			for (uint16_t bone_index = 0; bone_index < m_num_bones; ++bone_index)
 			{
 				const AnimatedBone& bone = m_bones[bone_index];
 
-				Quat_64 rotation0 = bone.rotation_track.get_sample(sample_frame0);
-				Quat_64 rotation1 = bone.rotation_track.get_sample(sample_frame1);
-				Quat_64 rotation = quat_lerp(rotation0, rotation1, interpolation_alpha);
-				writer.write_bone_rotation(bone_index, rotation);
+				const double* rotation_samples = bone.rotation_track.get_sample_data();
+				Quat_64 rotation0 = quat_unaligned_load(rotation_samples + rotation_offset0);
+				Quat_64 rotation1 = quat_unaligned_load(rotation_samples + rotation_offset1);
+				writer.write_bone_rotation(bone_index, quat_lerp(rotation0, rotation1, interpolation_alpha));
 
-				Vector4_64 translation0 = bone.translation_track.get_sample(sample_frame0);
-				Vector4_64 translation1 = bone.translation_track.get_sample(sample_frame1);
-				Vector4_64 translation = vector_lerp(translation0, translation1, interpolation_alpha);
-				writer.write_bone_translation(bone_index, translation);
+				const double* translation_samples = bone.translation_track.get_sample_data();
+				Vector4_64 translation0 = vector_unaligned_load3(translation_samples + translation_offset0);
+				Vector4_64 translation1 = vector_unaligned_load3(translation_samples + translation_offset1);
+				writer.write_bone_translation(bone_index, vector_lerp(translation0, translation1, interpolation_alpha));
 			}
 		}
 
-		uint32_t get_total_size() const
+		// Float variant: the endpoints are cast once and interpolated in float,
+		// for writers that consume 32 bit rotations and translations
+		template<class OutputWriterType>
+		void sample_pose_32(OutputWriterType& writer) const
 		{
-			uint32_t bone_sample_size = (sizeof(float) * 4) + (sizeof(float) * 3);
-			return m_num_bones * bone_sample_size * m_num_samples;
+			size_t rotation_offset0 = size_t(m_sample_frame0) * 4;
+			size_t rotation_offset1 = size_t(m_sample_frame1) * 4;
+			size_t translation_offset0 = size_t(m_sample_frame0) * 3;
+			size_t translation_offset1 = size_t(m_sample_frame1) * 3;
+			float interpolation_alpha = float(m_interpolation_alpha);
+
+			for (uint16_t bone_index = 0; bone_index < m_num_bones; ++bone_index)
+			{
+				const AnimatedBone& bone = m_bones[bone_index];
+
+				const double* rotation_samples = bone.rotation_track.get_sample_data();
+				Quat_32 rotation0 = quat_cast(quat_unaligned_load(rotation_samples + rotation_offset0));
+				Quat_32 rotation1 = quat_cast(quat_unaligned_load(rotation_samples + rotation_offset1));
+				writer.write_bone_rotation(bone_index, quat_lerp(rotation0, rotation1, interpolation_alpha));
+
+				const double* translation_samples = bone.translation_track.get_sample_data();
+				Vector4_32 translation0 = vector_cast(vector_unaligned_load3(translation_samples + translation_offset0));
+				Vector4_32 translation1 = vector_cast(vector_unaligned_load3(translation_samples + translation_offset1));
+				writer.write_bone_translation(bone_index, vector_lerp(translation0, translation1, interpolation_alpha));
+			}
 		}
 
 	private:
-		Allocator&				m_allocator;
+		const AnimatedBone*		m_bones;
 
-		AnimatedBone*			m_bones;
+		double					m_clip_duration;
+		double					m_inv_clip_duration;
+		double					m_interpolation_alpha;
 
-		double					m_error_threshold;
 		uint32_t				m_num_samples;
-		uint32_t				m_sample_rate;
+		uint32_t				m_sample_frame0;
+		uint32_t				m_sample_frame1;
 		uint16_t				m_num_bones;
-
-		String					m_name;
 	};
+
+	template<class OutputWriterType>
+	inline void AnimationClip::sample_pose(double sample_time, OutputWriterType& writer) const
+	{
+		AnimationClipSamplingContext context(*this);
+		context.seek(sample_time);
+		context.sample_pose(writer);
+	}
 }
@@ -26,6 +26,7 @@
 
 #include "acl/core/memory.h"
 #include "acl/core/error.h"
+#include "acl/core/hash.h"
 #include "acl/core/utils.h"
 #include "acl/math/quat_64.h"
 #include "acl/math/vector4_64.h"
@@ -38,16 +39,31 @@ namespace acl
 	class AnimationTrack
 	{
 	public:
-		bool is_initialized() const { return m_allocator != nullptr; }
+		bool is_initialized() const { return m_sample_data != nullptr; }
+
+		// Bound tracks wrap an external sample buffer instead of owning one,
+		// see AnimationClip::bind
+		bool is_bound() const { return m_sample_data != nullptr && m_allocator == nullptr; }
 
 		uint32_t get_num_samples() const { return m_num_samples; }
 
+		// Raw sample values, get_animation_track_sample_size(..) doubles per sample.
+		// Used by the bulk sampling path in AnimationClipSamplingContext
+		const double* get_sample_data() const { return m_sample_data; }
+
+		// Hash of the raw sample data, used to detect tracks that did not change
+		// between two versions of a clip when recompressing
+		uint32_t get_hash() const
+		{
+			return crc32(m_sample_data, m_num_samples * get_animation_track_sample_size(m_type) * sizeof(double));
+		}
+
 	protected:
 		enum class AnimationTrackType8 : uint8_t
 		{
 			Rotation = 0,
 			Translation = 1,
-			// TODO: Scale
+			Scale = 2,
 		};
 
 		AnimationTrack()
@@ -74,9 +90,22 @@ namespace acl
 			, m_type(type)
 		{}
 
+		// Binds over an external sample buffer of num_samples * get_animation_track_sample_size(type)
+		// doubles laid out exactly as set_sample writes them. Nothing is copied or
+		// allocated, the caller keeps the buffer alive for the track's lifetime.
+		AnimationTrack(double* sample_data, uint32_t num_samples, uint32_t sample_rate, AnimationTrackType8 type)
+			: m_allocator(nullptr)
+			, m_sample_data(sample_data)
+			, m_num_samples(num_samples)
+			, m_sample_rate(sample_rate)
+			, m_type(type)
+		{
+			ACL_ENSURE(sample_data != nullptr, "Sample data cannot be null");
+		}
+
 		~AnimationTrack()
 		{
-			if (is_initialized())
+			if (m_allocator != nullptr)
 			{
 				deallocate_type_array(*m_allocator, m_sample_data, m_num_samples * get_animation_track_sample_size(m_type));
 			}
@@ -104,6 +133,7 @@ namespace acl
 			default:
 			case AnimationTrackType8::Rotation:		return 4;
 			case AnimationTrackType8::Translation:	return 3;
+			case AnimationTrackType8::Scale:		return 3;
 			}
 		}
 
@@ -129,6 +159,11 @@ namespace acl
 			: AnimationTrack(allocator, num_samples, sample_rate, AnimationTrackType8::Rotation)
 		{}
 
+		// Binds over num_samples xyzw double quadruplets, see AnimationClip::bind
+		AnimationRotationTrack(double* sample_data, uint32_t num_samples, uint32_t sample_rate)
+			: AnimationTrack(sample_data, num_samples, sample_rate, AnimationTrackType8::Rotation)
+		{}
+
 		AnimationRotationTrack(AnimationRotationTrack&& track)
 			: AnimationTrack(std::forward<AnimationTrack>(track))
 		{}
@@ -197,6 +232,11 @@ namespace acl
 			: AnimationTrack(allocator, num_samples, sample_rate, AnimationTrackType8::Translation)
 		{}
 
+		// Binds over num_samples xyz double triplets, see AnimationClip::bind
+		AnimationTranslationTrack(double* sample_data, uint32_t num_samples, uint32_t sample_rate)
+			: AnimationTrack(sample_data, num_samples, sample_rate, AnimationTrackType8::Translation)
+		{}
+
 		AnimationTranslationTrack(AnimationTranslationTrack&& track)
 			: AnimationTrack(std::forward<AnimationTrack>(track))
 		{}
@@ -251,4 +291,75 @@ namespace acl
 		AnimationTranslationTrack(const AnimationTranslationTrack&) = delete;
 		AnimationTranslationTrack& operator=(const AnimationTranslationTrack&) = delete;
 	};
+
+	class AnimationScaleTrack : public AnimationTrack
+	{
+	public:
+		AnimationScaleTrack()
+			: AnimationTrack()
+		{}
+
+		AnimationScaleTrack(Allocator& allocator, uint32_t num_samples, uint32_t sample_rate)
+			: AnimationTrack(allocator, num_samples, sample_rate, AnimationTrackType8::Scale)
+		{}
+
+		// Binds over num_samples xyz double triplets, see AnimationClip::bind
+		AnimationScaleTrack(double* sample_data, uint32_t num_samples, uint32_t sample_rate)
+			: AnimationTrack(sample_data, num_samples, sample_rate, AnimationTrackType8::Scale)
+		{}
+
+		AnimationScaleTrack(AnimationScaleTrack&& track)
+			: AnimationTrack(std::forward<AnimationTrack>(track))
+		{}
+
+		AnimationScaleTrack& operator=(AnimationScaleTrack&& track)
+		{
+			AnimationTrack::operator=(std::forward<AnimationTrack>(track));
+			return *this;
+		}
+
+		void set_sample(uint32_t sample_index, const Vector4_64& scale)
+		{
+			ACL_ENSURE(is_initialized(), "Track is not initialized");
+			ACL_ENSURE(sample_index < m_num_samples, "Invalid sample index. %u >= %u", sample_index, m_num_samples);
+			ACL_ENSURE(vector_is_valid3(scale), "Invalid scale: [%f, %f, %f, %f]", vector_get_x(scale), vector_get_y(scale), vector_get_z(scale));
+
+			size_t sample_size = get_animation_track_sample_size(m_type);
+			ACL_ENSURE(sample_size == 3, "Invalid sample size. %u != 3", sample_size);
+
+			double* sample = &m_sample_data[sample_index * sample_size];
+			sample[0] = vector_get_x(scale);
+			sample[1] = vector_get_y(scale);
+			sample[2] = vector_get_z(scale);
+		}
+
+		Vector4_64 get_sample(uint32_t sample_index) const
+		{
+			ACL_ENSURE(is_initialized(), "Track is not initialized");
+			ACL_ENSURE(m_type == AnimationTrackType8::Scale, "Invalid track type. %u != %u", m_type, AnimationTrackType8::Scale);
+			ACL_ENSURE(sample_index < m_num_samples, "Invalid sample index. %u >= %u", sample_index, m_num_samples);
+
+			size_t sample_size = get_animation_track_sample_size(m_type);
+
+			const double* sample = &m_sample_data[sample_index * sample_size];
+			return vector_unaligned_load3(sample);
+		}
+
+		Vector4_64 sample_track(double sample_time) const
+		{
+			double track_duration = double(m_num_samples - 1) / double(m_sample_rate);
+
+			uint32_t sample_frame0;
+			uint32_t sample_frame1;
+			double interpolation_alpha;
+			calculate_interpolation_keys(m_num_samples, track_duration, sample_time, sample_frame0, sample_frame1, interpolation_alpha);
+
+			Vector4_64 sample0 = get_sample(sample_frame0);
+			Vector4_64 sample1 = get_sample(sample_frame1);
+			return vector_lerp(sample0, sample1, interpolation_alpha);
+		}
+
+		AnimationScaleTrack(const AnimationScaleTrack&) = delete;
+		AnimationScaleTrack& operator=(const AnimationScaleTrack&) = delete;
+	};
 }
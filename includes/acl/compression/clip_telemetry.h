@@ -0,0 +1,251 @@
+#pragma once
+
+////////////////////////////////////////////////////////////////////////////////
+// The MIT License (MIT)
+//
+// Copyright (c) 2017 Nicholas Frechette & Animation Compression Library contributors
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+////////////////////////////////////////////////////////////////////////////////
+
+#include "acl/core/memory.h"
+#include "acl/core/error.h"
+#include "acl/core/enum_utils.h"
+#include "acl/core/algorithm_types.h"
+#include "acl/math/scalar_64.h"
+#include "acl/math/transform_32.h"
+#include "acl/math/transform_64.h"
+#include "acl/compression/animation_clip.h"
+#include "acl/compression/skeleton.h"
+#include "acl/compression/skeleton_error_metric.h"
+#include "acl/compression/stream/track_stream.h"
+#include "acl/compression/stream/select_track_formats.h"
+#include "acl/compression/stream/segment_streams.h"
+
+#include <stdint.h>
+
+namespace acl
+{
+	// Classification of a bone's tracks at compression time
+	enum class BoneTelemetryFlags8 : uint8_t
+	{
+		None					= 0x00,
+
+		RotationDefault			= 0x01,
+		RotationConstant		= 0x02,
+		TranslationDefault		= 0x04,
+		TranslationConstant		= 0x08,
+	};
+
+	ACL_IMPL_ENUM_FLAGS_OPERATORS(BoneTelemetryFlags8)
+
+	////////////////////////////////////////////////////////////////////////////////
+	// Per bone entry of the telemetry blob, see ClipTelemetryHeader.
+	// The errors are object space distances measured with the virtual vertex
+	// metric of calculate_skeleton_error, the ranges are the clip wide extents
+	// of the track values before range reduction.
+	////////////////////////////////////////////////////////////////////////////////
+	struct BoneTelemetry
+	{
+		float max_error;
+		float rms_error;
+
+		RotationFormat8 rotation_format;
+		VectorFormat8 translation_format;
+		BoneTelemetryFlags8 flags;
+		uint8_t padding;
+
+		float rotation_range_min[3];
+		float rotation_range_extent[3];
+		float translation_range_min[3];
+		float translation_range_extent[3];
+	};
+
+	static_assert(sizeof(BoneTelemetry) == 60, "Unexpected BoneTelemetry size");
+
+	// 'ACLT' when viewed in memory
+	constexpr uint32_t CLIP_TELEMETRY_TAG = 0x544C4341;
+	constexpr uint16_t CLIP_TELEMETRY_VERSION = 1;
+
+	////////////////////////////////////////////////////////////////////////////////
+	// Compact binary sidecar written by compress_clip when
+	// CompressionSettings::generate_telemetry is enabled. Tools persist it next
+	// to the compressed clip and load it to investigate precision complaints
+	// without recompressing. The blob is self contained and relocatable: this
+	// header followed by one BoneTelemetry entry per bone in skeleton order.
+	////////////////////////////////////////////////////////////////////////////////
+	struct ClipTelemetryHeader
+	{
+		uint32_t tag;				// CLIP_TELEMETRY_TAG
+		uint16_t version;			// CLIP_TELEMETRY_VERSION
+		uint16_t num_bones;
+		uint32_t num_samples;
+		uint32_t size;				// Total blob size in bytes
+
+		BoneTelemetry*			get_bone_telemetry()		{ return add_offset_to_ptr<BoneTelemetry>(this, sizeof(ClipTelemetryHeader)); }
+		const BoneTelemetry*	get_bone_telemetry() const	{ return add_offset_to_ptr<const BoneTelemetry>(this, sizeof(ClipTelemetryHeader)); }
+	};
+
+	constexpr uint32_t get_clip_telemetry_size(uint16_t num_bones)
+	{
+		return sizeof(ClipTelemetryHeader) + (uint32_t(num_bones) * sizeof(BoneTelemetry));
+	}
+
+	// Validates a blob loaded from disk before its entries are read
+	inline bool is_valid_clip_telemetry(const ClipTelemetryHeader& header, size_t buffer_size)
+	{
+		if (buffer_size < sizeof(ClipTelemetryHeader))
+			return false;
+		if (header.tag != CLIP_TELEMETRY_TAG)
+			return false;
+		if (header.version != CLIP_TELEMETRY_VERSION)
+			return false;
+		if (header.size != get_clip_telemetry_size(header.num_bones))
+			return false;
+		return size_t(header.size) <= buffer_size;
+	}
+
+	// Builds the telemetry blob from the bone streams right before they are
+	// quantized, they must still hold their full precision samples. The achieved
+	// error simulates the quantized reconstruction of every track with its
+	// chosen format, matching what the decoder will produce; when segments are
+	// provided the simulation reads the segment streams so per segment range
+	// reduction is accounted for. The returned blob is allocated with the given
+	// allocator and owned by the caller.
+	inline ClipTelemetryHeader* generate_clip_telemetry(Allocator& allocator, const AnimationClip& clip, const RigidSkeleton& skeleton,
+		const BoneStreams* bone_streams, const ClipSegment* segments, uint32_t num_segments,
+		const BoneTrackFormats* bone_formats, RotationFormat8 rotation_format, VectorFormat8 translation_format)
+	{
+		const uint16_t num_bones = skeleton.get_num_bones();
+		const uint32_t num_samples = clip.get_num_samples();
+
+		ACL_ENSURE(num_bones == clip.get_num_bones(), "Unexpected number of bones. %u != %u", num_bones, clip.get_num_bones());
+		ACL_ENSURE(num_samples != 0, "Invalid number of samples: %u", num_samples);
+
+		const uint32_t telemetry_size = get_clip_telemetry_size(num_bones);
+		ClipTelemetryHeader* telemetry = reinterpret_cast<ClipTelemetryHeader*>(allocator.allocate(telemetry_size, alignof(ClipTelemetryHeader)));
+		telemetry->tag = CLIP_TELEMETRY_TAG;
+		telemetry->version = CLIP_TELEMETRY_VERSION;
+		telemetry->num_bones = num_bones;
+		telemetry->num_samples = num_samples;
+		telemetry->size = telemetry_size;
+
+		BoneTelemetry* bone_telemetry = telemetry->get_bone_telemetry();
+
+		for (uint16_t bone_index = 0; bone_index < num_bones; ++bone_index)
+		{
+			const BoneStreams& bone_stream = bone_streams[bone_index];
+			BoneTelemetry& entry = bone_telemetry[bone_index];
+
+			entry.rotation_format = bone_formats != nullptr ? bone_formats[bone_index].rotation_format : rotation_format;
+			entry.translation_format = bone_formats != nullptr ? bone_formats[bone_index].translation_format : translation_format;
+
+			BoneTelemetryFlags8 flags = BoneTelemetryFlags8::None;
+			if (bone_stream.is_rotation_default)
+				flags |= BoneTelemetryFlags8::RotationDefault;
+			else if (bone_stream.is_rotation_constant)
+				flags |= BoneTelemetryFlags8::RotationConstant;
+			if (bone_stream.is_translation_default)
+				flags |= BoneTelemetryFlags8::TranslationDefault;
+			else if (bone_stream.is_translation_constant)
+				flags |= BoneTelemetryFlags8::TranslationConstant;
+			entry.flags = flags;
+			entry.padding = 0;
+
+			const Vector4_64 rotation_range_min = bone_stream.rotation_range.get_min();
+			const Vector4_64 rotation_range_extent = bone_stream.rotation_range.get_extent();
+			const Vector4_64 translation_range_min = bone_stream.translation_range.get_min();
+			const Vector4_64 translation_range_extent = bone_stream.translation_range.get_extent();
+			entry.rotation_range_min[0] = float(vector_get_x(rotation_range_min));
+			entry.rotation_range_min[1] = float(vector_get_y(rotation_range_min));
+			entry.rotation_range_min[2] = float(vector_get_z(rotation_range_min));
+			entry.rotation_range_extent[0] = float(vector_get_x(rotation_range_extent));
+			entry.rotation_range_extent[1] = float(vector_get_y(rotation_range_extent));
+			entry.rotation_range_extent[2] = float(vector_get_z(rotation_range_extent));
+			entry.translation_range_min[0] = float(vector_get_x(translation_range_min));
+			entry.translation_range_min[1] = float(vector_get_y(translation_range_min));
+			entry.translation_range_min[2] = float(vector_get_z(translation_range_min));
+			entry.translation_range_extent[0] = float(vector_get_x(translation_range_extent));
+			entry.translation_range_extent[1] = float(vector_get_y(translation_range_extent));
+			entry.translation_range_extent[2] = float(vector_get_z(translation_range_extent));
+		}
+
+		Transform_64* raw_pose = allocate_type_array<Transform_64>(allocator, num_bones);
+		Transform_32* lossy_pose = allocate_type_array<Transform_32>(allocator, num_bones);
+		double* bone_errors = allocate_type_array<double>(allocator, num_bones);
+		double* max_errors = allocate_type_array<double>(allocator, num_bones);
+		double* error_squared_sums = allocate_type_array<double>(allocator, num_bones);
+		for (uint16_t bone_index = 0; bone_index < num_bones; ++bone_index)
+		{
+			max_errors[bone_index] = 0.0;
+			error_squared_sums[bone_index] = 0.0;
+		}
+
+		SkeletonErrorMetricContext error_metric_context(allocator, skeleton);
+
+		const AnimatedBone* clip_bones = clip.get_bones();
+		uint32_t segment_index = 0;
+		for (uint32_t sample_index = 0; sample_index < num_samples; ++sample_index)
+		{
+			// Consecutive segments overlap by one sample, the overlapping sample
+			// reads from the later segment
+			if (segments != nullptr)
+			{
+				while (segment_index + 1 < num_segments && sample_index >= segments[segment_index + 1].first_sample_index)
+					segment_index++;
+			}
+
+			const BoneStreams* sample_streams = segments != nullptr ? segments[segment_index].bone_streams : bone_streams;
+			const uint32_t stream_sample_index = segments != nullptr ? sample_index - segments[segment_index].first_sample_index : sample_index;
+
+			for (uint16_t bone_index = 0; bone_index < num_bones; ++bone_index)
+			{
+				Quat_64 rotation = clip_bones[bone_index].rotation_track.get_sample(sample_index);
+				Vector4_64 translation = clip_bones[bone_index].translation_track.get_sample(sample_index);
+				raw_pose[bone_index] = transform_set(rotation, translation);
+
+				const BoneTelemetry& entry = bone_telemetry[bone_index];
+				lossy_pose[bone_index].rotation = simulate_quantized_rotation(sample_streams[bone_index], stream_sample_index, entry.rotation_format);
+				lossy_pose[bone_index].translation = simulate_quantized_translation(sample_streams[bone_index], stream_sample_index, entry.translation_format);
+			}
+
+			error_metric_context.calculate_bone_errors(raw_pose, lossy_pose, bone_errors);
+
+			for (uint16_t bone_index = 0; bone_index < num_bones; ++bone_index)
+			{
+				max_errors[bone_index] = max(max_errors[bone_index], bone_errors[bone_index]);
+				error_squared_sums[bone_index] += bone_errors[bone_index] * bone_errors[bone_index];
+			}
+		}
+
+		for (uint16_t bone_index = 0; bone_index < num_bones; ++bone_index)
+		{
+			bone_telemetry[bone_index].max_error = float(max_errors[bone_index]);
+			bone_telemetry[bone_index].rms_error = float(sqrt(error_squared_sums[bone_index] / num_samples));
+		}
+
+		deallocate_type_array(allocator, raw_pose, num_bones);
+		deallocate_type_array(allocator, lossy_pose, num_bones);
+		deallocate_type_array(allocator, bone_errors, num_bones);
+		deallocate_type_array(allocator, max_errors, num_bones);
+		deallocate_type_array(allocator, error_squared_sums, num_bones);
+
+		return telemetry;
+	}
+}
@@ -25,6 +25,7 @@
 ////////////////////////////////////////////////////////////////////////////////
 
 #include "acl/core/compressed_clip.h"
+#include "acl/core/compressed_clip_database.h"
 
 namespace acl
 {
@@ -35,8 +36,18 @@ namespace acl
 
 	inline void finalize_compressed_clip(CompressedClip& compressed_clip)
 	{
-		// For now we just run the constructor in place again, it'll update the CRC, etc.
-		// TODO: Fix this to be more efficient in make_compressed_clip above
-		new(&compressed_clip) CompressedClip(compressed_clip.get_size(), compressed_clip.get_algorithm_type());
+		// The buffer content is final, seal it with the content hash
+		compressed_clip.m_crc32 = compressed_clip.calculate_crc32();
+	}
+
+	inline CompressedClipDatabase* make_compressed_clip_database(void* buffer, uint32_t size, uint32_t num_clips)
+	{
+		return new(buffer) CompressedClipDatabase(size, num_clips);
+	}
+
+	inline void finalize_compressed_clip_database(CompressedClipDatabase& database)
+	{
+		// The buffer content is final, seal it with the content hash
+		database.m_crc32 = database.calculate_crc32();
 	}
 }
@@ -0,0 +1,217 @@
+#pragma once
+
+////////////////////////////////////////////////////////////////////////////////
+// The MIT License (MIT)
+//
+// Copyright (c) 2017 Nicholas Frechette & Animation Compression Library contributors
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+////////////////////////////////////////////////////////////////////////////////
+
+#include "acl/core/memory.h"
+#include "acl/core/algorithm_types.h"
+#include "acl/compression/clip_telemetry.h"
+#include "acl/compression/stream/select_track_formats.h"
+
+#include <stdint.h>
+#include <chrono>
+#include <cstdio>
+
+namespace acl
+{
+	// Wall clock time in seconds from a monotonic high resolution clock,
+	// only differences between two calls are meaningful
+	inline double get_current_time_seconds()
+	{
+		const auto now = std::chrono::high_resolution_clock::now();
+		return std::chrono::duration_cast<std::chrono::duration<double>>(now.time_since_epoch()).count();
+	}
+
+	//////////////////////////////////////////////////////////////////////////
+	// Diagnostic statistics gathered while a clip is compressed, meant to
+	// pinpoint which pass regressed when compression time or memory jumps.
+	// Pass it to compress_clip to populate it; gathering adds a clock query
+	// per pass and a few atomic increments per transient allocation.
+	//
+	// The pass times are wall clock seconds and accumulate over every bone
+	// and segment a pass touches. The memory figures only cover the
+	// transient compression buffers, not the compressed clip itself.
+	//////////////////////////////////////////////////////////////////////////
+	struct CompressionStats
+	{
+		// Per pass wall clock times in seconds
+		double convert_clip_time;				// Raw clip samples to track streams
+		double convert_rotations_time;			// Rotation format conversion
+		double compact_constants_time;			// Constant and default track detection
+		double segment_time;					// Splitting the streams into segments
+		double normalize_time;					// Range reduction normalization
+		double select_formats_time;				// Variable quantization format search
+		double quantize_time;					// Sample quantization
+		double telemetry_time;					// Building the optional telemetry blob
+		double write_time;						// Output layout computation and writing the compressed clip buffer
+		double total_time;						// Whole compression call, includes the above
+
+		// Transient memory allocated by the compression passes in bytes
+		size_t transient_peak_allocated_size;	// High water mark of the live allocations
+		size_t transient_total_allocated_size;	// Sum of every allocation made
+		size_t transient_num_allocations;
+
+		// Formats chosen per bone by variable quantization, one entry per bone in
+		// skeleton order. Null when variable quantization was not used since every
+		// track then uses the clip wide formats. Owned by these stats, released on
+		// destruction with the allocator that was passed to compress_clip.
+		BoneTrackFormats* track_formats;
+		uint16_t num_track_formats;
+
+		// Per track precision telemetry blob, see ClipTelemetryHeader. Null unless
+		// CompressionSettings::generate_telemetry was enabled. Owned by these stats,
+		// released on destruction with the allocator that was passed to compress_clip.
+		ClipTelemetryHeader* telemetry;
+
+		CompressionStats()
+			: convert_clip_time(0.0)
+			, convert_rotations_time(0.0)
+			, compact_constants_time(0.0)
+			, segment_time(0.0)
+			, normalize_time(0.0)
+			, select_formats_time(0.0)
+			, quantize_time(0.0)
+			, telemetry_time(0.0)
+			, write_time(0.0)
+			, total_time(0.0)
+			, transient_peak_allocated_size(0)
+			, transient_total_allocated_size(0)
+			, transient_num_allocations(0)
+			, track_formats(nullptr)
+			, num_track_formats(0)
+			, telemetry(nullptr)
+			, m_allocator(nullptr)
+			, m_telemetry_allocator(nullptr)
+		{}
+
+		~CompressionStats()
+		{
+			release_track_formats();
+			release_telemetry();
+		}
+
+		CompressionStats(const CompressionStats&) = delete;
+		CompressionStats& operator=(const CompressionStats&) = delete;
+
+		// Called by the encoder, the allocator must outlive these stats
+		void set_track_formats(Allocator& allocator, BoneTrackFormats* formats, uint16_t num_formats)
+		{
+			release_track_formats();
+
+			m_allocator = &allocator;
+			track_formats = formats;
+			num_track_formats = num_formats;
+		}
+
+		void release_track_formats()
+		{
+			if (track_formats != nullptr)
+				deallocate_type_array(*m_allocator, track_formats, num_track_formats);
+
+			m_allocator = nullptr;
+			track_formats = nullptr;
+			num_track_formats = 0;
+		}
+
+		// Called by the encoder, the allocator must outlive these stats
+		void set_telemetry(Allocator& allocator, ClipTelemetryHeader* new_telemetry)
+		{
+			release_telemetry();
+
+			m_telemetry_allocator = &allocator;
+			telemetry = new_telemetry;
+		}
+
+		void release_telemetry()
+		{
+			if (telemetry != nullptr)
+				m_telemetry_allocator->deallocate(telemetry, telemetry->size);
+
+			m_telemetry_allocator = nullptr;
+			telemetry = nullptr;
+		}
+
+	private:
+		Allocator* m_allocator;
+		Allocator* m_telemetry_allocator;
+	};
+
+	inline void print_stats(const CompressionStats& stats, std::FILE* file)
+	{
+		fprintf(file, "Clip pass convert clip time (s): %.6f\n", stats.convert_clip_time);
+		fprintf(file, "Clip pass convert rotations time (s): %.6f\n", stats.convert_rotations_time);
+		fprintf(file, "Clip pass compact constants time (s): %.6f\n", stats.compact_constants_time);
+		fprintf(file, "Clip pass segment time (s): %.6f\n", stats.segment_time);
+		fprintf(file, "Clip pass normalize time (s): %.6f\n", stats.normalize_time);
+		fprintf(file, "Clip pass select formats time (s): %.6f\n", stats.select_formats_time);
+		fprintf(file, "Clip pass quantize time (s): %.6f\n", stats.quantize_time);
+		fprintf(file, "Clip pass write time (s): %.6f\n", stats.write_time);
+		fprintf(file, "Clip transient memory peak (bytes): %zu\n", stats.transient_peak_allocated_size);
+		fprintf(file, "Clip transient memory total (bytes): %zu\n", stats.transient_total_allocated_size);
+		fprintf(file, "Clip transient num allocations: %zu\n", stats.transient_num_allocations);
+
+		if (stats.track_formats != nullptr)
+		{
+			// Summarize the variable quantization decisions, the per bone details
+			// remain available programmatically
+			uint32_t num_tracks_per_rotation_format[4] = { 0, 0, 0, 0 };
+			uint32_t num_tracks_per_translation_format[4] = { 0, 0, 0, 0 };
+			for (uint16_t bone_index = 0; bone_index < stats.num_track_formats; ++bone_index)
+			{
+				num_tracks_per_rotation_format[static_cast<uint8_t>(stats.track_formats[bone_index].rotation_format)]++;
+				num_tracks_per_translation_format[static_cast<uint8_t>(stats.track_formats[bone_index].translation_format)]++;
+			}
+
+			for (uint8_t format_index = 0; format_index < 4; ++format_index)
+			{
+				if (num_tracks_per_rotation_format[format_index] != 0)
+					fprintf(file, "Clip num tracks with rotation format %s: %u\n", get_rotation_format_name(static_cast<RotationFormat8>(format_index)), num_tracks_per_rotation_format[format_index]);
+			}
+
+			for (uint8_t format_index = 0; format_index < 4; ++format_index)
+			{
+				if (num_tracks_per_translation_format[format_index] != 0)
+					fprintf(file, "Clip num tracks with translation format %s: %u\n", get_vector_format_name(static_cast<VectorFormat8>(format_index)), num_tracks_per_translation_format[format_index]);
+			}
+		}
+
+		if (stats.telemetry != nullptr)
+		{
+			// The blob is meant to be persisted and loaded by the tools, only
+			// surface the worst offender here
+			const BoneTelemetry* bone_telemetry = stats.telemetry->get_bone_telemetry();
+			uint16_t worst_bone_index = 0;
+			for (uint16_t bone_index = 1; bone_index < stats.telemetry->num_bones; ++bone_index)
+			{
+				if (bone_telemetry[bone_index].max_error > bone_telemetry[worst_bone_index].max_error)
+					worst_bone_index = bone_index;
+			}
+
+			fprintf(file, "Clip telemetry size (bytes): %u\n", stats.telemetry->size);
+			fprintf(file, "Clip telemetry worst bone: %u\n", worst_bone_index);
+			fprintf(file, "Clip telemetry worst bone max error: %f\n", bone_telemetry[worst_bone_index].max_error);
+			fprintf(file, "Clip telemetry worst bone rms error: %f\n", bone_telemetry[worst_bone_index].rms_error);
+		}
+	}
+}
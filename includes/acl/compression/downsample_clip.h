@@ -0,0 +1,157 @@
+#pragma once
+
+////////////////////////////////////////////////////////////////////////////////
+// The MIT License (MIT)
+//
+// Copyright (c) 2017 Nicholas Frechette & Animation Compression Library contributors
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+////////////////////////////////////////////////////////////////////////////////
+
+#include "acl/core/memory.h"
+#include "acl/core/error.h"
+#include "acl/math/transform_32.h"
+#include "acl/compression/animation_clip.h"
+#include "acl/compression/skeleton.h"
+#include "acl/compression/skeleton_error_metric.h"
+
+#include <stdint.h>
+
+namespace acl
+{
+	//////////////////////////////////////////////////////////////////////////
+	// Down-sampling pre-pass. Many clips are authored at a higher rate than
+	// their content needs; re-sampling them before compression is a direct
+	// size and decode bandwidth win. Only integer factors that keep every
+	// retained sample on an authored sample point are allowed: the duration
+	// stays exact and the decoder's uniform interpolation lands on the same
+	// key frames, see calculate_interpolation_keys.
+	//////////////////////////////////////////////////////////////////////////
+
+	// Whether the clip can be re-sampled by the given factor: the factor must
+	// evenly divide both the sample rate and the key frame intervals
+	inline bool can_downsample_clip(const AnimationClip& clip, uint32_t factor)
+	{
+		uint32_t num_samples = clip.get_num_samples();
+		uint32_t sample_rate = clip.get_sample_rate();
+
+		if (factor <= 1 || num_samples <= 2)
+			return false;
+
+		return (sample_rate % factor) == 0 && ((num_samples - 1) % factor) == 0;
+	}
+
+	// Builds a copy of the clip at sample_rate / factor, keeping every factor'th
+	// sample. No interpolation happens, every retained sample is an authored one.
+	// Free the returned clip with deallocate_type.
+	inline AnimationClip* downsample_clip(Allocator& allocator, const AnimationClip& clip, const RigidSkeleton& skeleton, uint32_t factor)
+	{
+		ACL_ENSURE(can_downsample_clip(clip, factor), "Clip cannot be down-sampled by a factor of %u", factor);
+
+		uint32_t num_samples = ((clip.get_num_samples() - 1) / factor) + 1;
+		uint32_t sample_rate = clip.get_sample_rate() / factor;
+		bool has_scale = clip.has_scale_tracks();
+
+		AnimationClip* downsampled_clip = allocate_type<AnimationClip>(allocator, allocator, skeleton, num_samples, sample_rate, clip.get_name(), clip.get_error_threshold(), has_scale);
+
+		const AnimatedBone* src_bones = clip.get_bones();
+		AnimatedBone* dst_bones = downsampled_clip->get_bones();
+
+		uint16_t num_bones = clip.get_num_bones();
+		for (uint16_t bone_index = 0; bone_index < num_bones; ++bone_index)
+		{
+			const AnimatedBone& src_bone = src_bones[bone_index];
+			AnimatedBone& dst_bone = dst_bones[bone_index];
+
+			for (uint32_t sample_index = 0; sample_index < num_samples; ++sample_index)
+			{
+				uint32_t src_sample_index = sample_index * factor;
+				dst_bone.rotation_track.set_sample(sample_index, src_bone.rotation_track.get_sample(src_sample_index));
+				dst_bone.translation_track.set_sample(sample_index, src_bone.translation_track.get_sample(src_sample_index));
+				if (has_scale)
+					dst_bone.scale_track.set_sample(sample_index, src_bone.scale_track.get_sample(src_sample_index));
+			}
+		}
+
+		return downsampled_clip;
+	}
+
+	// Measures the largest skeleton error introduced by the re-sampling,
+	// validated at every original sample point: the raw pose reads the authored
+	// samples directly while the lossy pose interpolates the down-sampled clip
+	// at the same time
+	inline double calculate_downsampled_clip_error(Allocator& allocator, const AnimationClip& clip, const AnimationClip& downsampled_clip, const RigidSkeleton& skeleton)
+	{
+		uint16_t num_bones = clip.get_num_bones();
+		uint32_t num_samples = clip.get_num_samples();
+		uint32_t sample_rate = clip.get_sample_rate();
+
+		SkeletonErrorMetricContext error_metric_context(allocator, skeleton);
+		Transform_64* raw_pose = error_metric_context.get_raw_local_pose();
+		Transform_32* lossy_pose = error_metric_context.get_lossy_local_pose();
+
+		const AnimatedBone* raw_bones = clip.get_bones();
+		const AnimatedBone* lossy_bones = downsampled_clip.get_bones();
+
+		double max_error = 0.0;
+		for (uint32_t sample_index = 0; sample_index < num_samples; ++sample_index)
+		{
+			double sample_time = double(sample_index) / double(sample_rate);
+
+			for (uint16_t bone_index = 0; bone_index < num_bones; ++bone_index)
+			{
+				Quat_64 raw_rotation = raw_bones[bone_index].rotation_track.get_sample(sample_index);
+				Vector4_64 raw_translation = raw_bones[bone_index].translation_track.get_sample(sample_index);
+				raw_pose[bone_index] = transform_set(raw_rotation, raw_translation);
+
+				Quat_32 lossy_rotation = quat_cast(lossy_bones[bone_index].rotation_track.sample_track(sample_time));
+				Vector4_32 lossy_translation = vector_cast(lossy_bones[bone_index].translation_track.sample_track(sample_time));
+				lossy_pose[bone_index] = transform_set(lossy_rotation, lossy_translation);
+			}
+
+			max_error = max(max_error, error_metric_context.calculate_error(raw_pose, lossy_pose));
+		}
+
+		return max_error;
+	}
+
+	// Searches for the lowest sample rate that keeps the skeleton error of the
+	// re-sampled clip under the clip error threshold. Factors of two are tried
+	// as long as they divide the clip evenly and the error stays acceptable;
+	// returns the authored rate when no down-sampling is acceptable.
+	inline uint32_t find_downsampled_sample_rate(Allocator& allocator, const AnimationClip& clip, const RigidSkeleton& skeleton)
+	{
+		uint32_t sample_rate = clip.get_sample_rate();
+		uint32_t best_sample_rate = sample_rate;
+
+		for (uint32_t factor = 2; can_downsample_clip(clip, factor); factor *= 2)
+		{
+			AnimationClip* candidate_clip = downsample_clip(allocator, clip, skeleton, factor);
+			double error = calculate_downsampled_clip_error(allocator, clip, *candidate_clip, skeleton);
+			deallocate_type(allocator, candidate_clip);
+
+			if (error > clip.get_error_threshold())
+				break;
+
+			best_sample_rate = sample_rate / factor;
+		}
+
+		return best_sample_rate;
+	}
+}
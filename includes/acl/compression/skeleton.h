@@ -25,7 +25,8 @@
 ////////////////////////////////////////////////////////////////////////////////
 
 #include "acl/core/memory.h"
-#include "acl/core/string.h"
+#include "acl/core/string_view.h"
+#include "acl/core/string_table.h"
 #include "acl/math/quat_64.h"		// todo remove
 #include "acl/math/vector4_64.h"	// todo remove
 #include "acl/math/transform_64.h"
@@ -70,7 +71,9 @@ namespace acl
 
 		bool is_root() const { return parent_index == INVALID_BONE_INDEX; }
 
-		String		name;
+		// Non owning view, typically into a StringTable that outlives the skeleton.
+		// Names interned in the same table compare by pointer identity.
+		StringView	name;
 
 		// TODO: Introduce a type for bone indices
 		uint16_t	parent_index;
@@ -87,9 +90,14 @@ namespace acl
 	class RigidSkeleton
 	{
 	public:
-		RigidSkeleton(Allocator& allocator, RigidBone* bones, uint16_t num_bones)
+		// When an owned string table is provided, the skeleton takes ownership of
+		// the table holding its bone names and releases it on destruction. Loaders
+		// sharing one table across many skeletons pass nullptr and keep the table
+		// alive themselves.
+		RigidSkeleton(Allocator& allocator, RigidBone* bones, uint16_t num_bones, StringTable* owned_string_table = nullptr)
 			: m_allocator(allocator)
 			, m_bones(allocate_type_array<RigidBone>(allocator, num_bones))
+			, m_string_table(owned_string_table)
 			, m_num_bones(num_bones)
 		{
 			// Copy and validate the input data
@@ -117,6 +125,9 @@ namespace acl
 		~RigidSkeleton()
 		{
 			deallocate_type_array(m_allocator, m_bones, m_num_bones);
+
+			if (m_string_table != nullptr)
+				deallocate_type(m_allocator, m_string_table);
 		}
 
 		RigidSkeleton(const RigidSkeleton&) = delete;
@@ -131,10 +142,12 @@ namespace acl
 		uint16_t get_num_bones() const { return m_num_bones; }
 
 	private:
-		Allocator&	m_allocator;
-		RigidBone*	m_bones;
+		Allocator&		m_allocator;
+		RigidBone*		m_bones;
+
+		StringTable*	m_string_table;		// Optionally owned, see constructor
 
-		uint16_t	m_num_bones;
+		uint16_t		m_num_bones;
 	};
 
 	// Note: It is safe for both pose buffers to alias since the data is sorted parent first
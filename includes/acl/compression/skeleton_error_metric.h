@@ -24,6 +24,8 @@
 // SOFTWARE.
 ////////////////////////////////////////////////////////////////////////////////
 
+#include "acl/core/memory.h"
+#include "acl/core/task_scheduler.h"
 #include "acl/math/transform_64.h"
 #include "acl/math/scalar_64.h"
 #include "acl/compression/skeleton.h"
@@ -31,53 +33,347 @@
 namespace acl
 {
 	// TODO: Add separate types for local/object space poses, avoid any possible usage error
-	// TODO: Add a context object to avoid malloc/free of the buffers with every call of the function
-	//       or manage the pose buffers externally?
-	inline double calculate_skeleton_error(Allocator& allocator, const RigidSkeleton& skeleton, const Transform_64* raw_local_pose, const Transform_32* lossy_local_pose)
+
+	//////////////////////////////////////////////////////////////////////////
+	// Owns the scratch pose buffers needed to measure the error of a skeleton.
+	// Create one per skeleton and re-use it between calls, nothing is allocated
+	// while evaluating. The scratch buffers are not thread safe, use one
+	// context per thread when evaluating in parallel.
+	//////////////////////////////////////////////////////////////////////////
+	class SkeletonErrorMetricContext
 	{
-		uint16_t num_bones = skeleton.get_num_bones();
-		const RigidBone* bones = skeleton.get_bones();
-		ACL_ENSURE(num_bones != 0, "Invalid number of bones: %u", num_bones);
+	public:
+		SkeletonErrorMetricContext(Allocator& allocator, const RigidSkeleton& skeleton)
+			: m_allocator(allocator)
+			, m_skeleton(skeleton)
+			, m_cached_raw_object_poses(nullptr)
+			, m_cached_base_object_poses(nullptr)
+			, m_cached_base_bone_errors(nullptr)
+			, m_num_cached_samples(0)
+			, m_num_bones(skeleton.get_num_bones())
+		{
+			ACL_ENSURE(m_num_bones != 0, "Invalid number of bones: %u", m_num_bones);
+
+			m_raw_object_pose = allocate_type_array<Transform_64>(allocator, m_num_bones);
+			m_lossy_object_pose = allocate_type_array<Transform_64>(allocator, m_num_bones);
+			m_lossy_local_pose_64 = allocate_type_array<Transform_64>(allocator, m_num_bones);
+			m_raw_local_pose = allocate_type_array<Transform_64>(allocator, m_num_bones);
+			m_lossy_local_pose = allocate_type_array<Transform_32>(allocator, m_num_bones);
+			m_is_bone_dirty = allocate_type_array<uint8_t>(allocator, m_num_bones);
+		}
+
+		~SkeletonErrorMetricContext()
+		{
+			release_base_poses();
+
+			deallocate_type_array(m_allocator, m_raw_object_pose, m_num_bones);
+			deallocate_type_array(m_allocator, m_lossy_object_pose, m_num_bones);
+			deallocate_type_array(m_allocator, m_lossy_local_pose_64, m_num_bones);
+			deallocate_type_array(m_allocator, m_raw_local_pose, m_num_bones);
+			deallocate_type_array(m_allocator, m_lossy_local_pose, m_num_bones);
+			deallocate_type_array(m_allocator, m_is_bone_dirty, m_num_bones);
+		}
+
+		SkeletonErrorMetricContext(const SkeletonErrorMetricContext&) = delete;
+		SkeletonErrorMetricContext& operator=(const SkeletonErrorMetricContext&) = delete;
+
+		uint16_t get_num_bones() const { return m_num_bones; }
+
+		// Scratch local pose buffers for the batched entry point, filled by the caller's sample function
+		Transform_64* get_raw_local_pose() { return m_raw_local_pose; }
+		Transform_32* get_lossy_local_pose() { return m_lossy_local_pose; }
+
+		double calculate_error(const Transform_64* raw_local_pose, const Transform_32* lossy_local_pose)
+		{
+			for (uint16_t bone_index = 0; bone_index < m_num_bones; ++bone_index)
+				m_lossy_local_pose_64[bone_index] = transform_cast(lossy_local_pose[bone_index]);
+
+			local_to_object_space(m_skeleton, raw_local_pose, m_raw_object_pose);
+			local_to_object_space(m_skeleton, m_lossy_local_pose_64, m_lossy_object_pose);
+
+			double error = -1.0;
+			for (uint16_t bone_index = 0; bone_index < m_num_bones; ++bone_index)
+				error = max(error, calculate_bone_error(bone_index, m_raw_object_pose[bone_index], m_lossy_object_pose[bone_index]));
+
+			ACL_ENSURE(error >= 0.0, "Invalid error: %f", error);
+
+			return error;
+		}
+
+		// Same evaluation as calculate_error but writes the object space error of
+		// every bone instead of only returning the largest one
+		void calculate_bone_errors(const Transform_64* raw_local_pose, const Transform_32* lossy_local_pose, double* out_bone_errors)
+		{
+			for (uint16_t bone_index = 0; bone_index < m_num_bones; ++bone_index)
+				m_lossy_local_pose_64[bone_index] = transform_cast(lossy_local_pose[bone_index]);
 
-		Transform_64* raw_object_pose = allocate_type_array<Transform_64>(allocator, num_bones);
-		Transform_64* lossy_object_pose = allocate_type_array<Transform_64>(allocator, num_bones);
-		Transform_64* lossy_local_pose_64 = allocate_type_array<Transform_64>(allocator, num_bones);
+			local_to_object_space(m_skeleton, raw_local_pose, m_raw_object_pose);
+			local_to_object_space(m_skeleton, m_lossy_local_pose_64, m_lossy_object_pose);
 
-		for (uint16_t bone_index = 0; bone_index < num_bones; ++bone_index)
-			lossy_local_pose_64[bone_index] = transform_cast(lossy_local_pose[bone_index]);
+			for (uint16_t bone_index = 0; bone_index < m_num_bones; ++bone_index)
+				out_bone_errors[bone_index] = calculate_bone_error(bone_index, m_raw_object_pose[bone_index], m_lossy_object_pose[bone_index]);
+		}
+
+		//////////////////////////////////////////////////////////////////////////
+		// Base pose caching for searches that alter one track at a time
+
+		// Caches the object space transforms of the raw poses at every sample along
+		// with the object space transforms and per bone errors of a base lossy pose.
+		// calculate_error_for_subtree then evaluates candidate poses that differ from
+		// the base in a single bone by only walking the affected subtree, everything
+		// else comes straight from the cache. Both pose arrays hold one pose of
+		// num_bones transforms per sample.
+		void cache_base_poses(uint32_t num_samples, const Transform_64* raw_local_poses, const Transform_32* lossy_local_poses)
+		{
+			ACL_ENSURE(num_samples != 0, "Invalid number of samples: %u", num_samples);
+
+			release_base_poses();
+
+			m_num_cached_samples = num_samples;
+			m_cached_raw_object_poses = allocate_type_array<Transform_64>(m_allocator, size_t(num_samples) * m_num_bones);
+			m_cached_base_object_poses = allocate_type_array<Transform_64>(m_allocator, size_t(num_samples) * m_num_bones);
+			m_cached_base_bone_errors = allocate_type_array<double>(m_allocator, size_t(num_samples) * m_num_bones);
 
-		local_to_object_space(skeleton, raw_local_pose, raw_object_pose);
-		local_to_object_space(skeleton, lossy_local_pose_64, lossy_object_pose);
+			for (uint32_t sample_index = 0; sample_index < num_samples; ++sample_index)
+			{
+				size_t pose_offset = size_t(sample_index) * m_num_bones;
+				const Transform_64* raw_local_pose = raw_local_poses + pose_offset;
+				const Transform_32* lossy_local_pose = lossy_local_poses + pose_offset;
+				Transform_64* raw_object_pose = m_cached_raw_object_poses + pose_offset;
+				Transform_64* base_object_pose = m_cached_base_object_poses + pose_offset;
+				double* base_bone_errors = m_cached_base_bone_errors + pose_offset;
 
-		Vector4_64 x_axis = vector_set(1.0, 0.0, 0.0);
-		Vector4_64 y_axis = vector_set(0.0, 1.0, 0.0);
+				for (uint16_t bone_index = 0; bone_index < m_num_bones; ++bone_index)
+					m_lossy_local_pose_64[bone_index] = transform_cast(lossy_local_pose[bone_index]);
 
-		double error = -1.0;
-		for (uint16_t bone_index = 0; bone_index < num_bones; ++bone_index)
+				local_to_object_space(m_skeleton, raw_local_pose, raw_object_pose);
+				local_to_object_space(m_skeleton, m_lossy_local_pose_64, base_object_pose);
+
+				for (uint16_t bone_index = 0; bone_index < m_num_bones; ++bone_index)
+					base_bone_errors[bone_index] = calculate_bone_error(bone_index, raw_object_pose[bone_index], base_object_pose[bone_index]);
+			}
+		}
+
+		void release_base_poses()
+		{
+			if (m_num_cached_samples == 0)
+				return;
+
+			deallocate_type_array(m_allocator, m_cached_raw_object_poses, size_t(m_num_cached_samples) * m_num_bones);
+			deallocate_type_array(m_allocator, m_cached_base_object_poses, size_t(m_num_cached_samples) * m_num_bones);
+			deallocate_type_array(m_allocator, m_cached_base_bone_errors, size_t(m_num_cached_samples) * m_num_bones);
+
+			m_cached_raw_object_poses = nullptr;
+			m_cached_base_object_poses = nullptr;
+			m_cached_base_bone_errors = nullptr;
+			m_num_cached_samples = 0;
+		}
+
+		// Error of a lossy pose that differs from the cached base pose in the given
+		// bone only, cache_base_poses must have been called first. The modified bone
+		// and its descendants are re-evaluated with a single forward pass, the
+		// remaining bones reuse their cached object space transforms and errors.
+		// Returns exactly what calculate_error would for the same poses.
+		double calculate_error_for_subtree(uint32_t sample_index, uint16_t modified_bone_index, const Transform_32* lossy_local_pose)
+		{
+			ACL_ENSURE(sample_index < m_num_cached_samples, "Invalid sample index: %u >= %u", sample_index, m_num_cached_samples);
+			ACL_ENSURE(modified_bone_index < m_num_bones, "Invalid bone index: %u >= %u", modified_bone_index, m_num_bones);
+
+			const RigidBone* bones = m_skeleton.get_bones();
+			size_t pose_offset = size_t(sample_index) * m_num_bones;
+			const Transform_64* raw_object_pose = m_cached_raw_object_poses + pose_offset;
+			const Transform_64* base_object_pose = m_cached_base_object_poses + pose_offset;
+			const double* base_bone_errors = m_cached_base_bone_errors + pose_offset;
+
+			double error = -1.0;
+
+			// Bones are sorted parent first, everything before the modified bone is untouched
+			for (uint16_t bone_index = 0; bone_index < modified_bone_index; ++bone_index)
+			{
+				m_is_bone_dirty[bone_index] = 0;
+				error = max(error, base_bone_errors[bone_index]);
+			}
+
+			for (uint16_t bone_index = modified_bone_index; bone_index < m_num_bones; ++bone_index)
+			{
+				uint16_t parent_index = bones[bone_index].parent_index;
+				bool is_dirty = bone_index == modified_bone_index || (parent_index != INVALID_BONE_INDEX && m_is_bone_dirty[parent_index] != 0);
+				m_is_bone_dirty[bone_index] = is_dirty ? 1 : 0;
+
+				if (!is_dirty)
+				{
+					error = max(error, base_bone_errors[bone_index]);
+					continue;
+				}
+
+				Transform_64 local_transform = transform_cast(lossy_local_pose[bone_index]);
+
+				Transform_64 object_transform;
+				if (parent_index == INVALID_BONE_INDEX)
+					object_transform = local_transform;
+				else
+				{
+					const Transform_64& parent_object_transform = m_is_bone_dirty[parent_index] != 0 ? m_lossy_object_pose[parent_index] : base_object_pose[parent_index];
+					object_transform = transform_mul(local_transform, parent_object_transform);
+				}
+
+				m_lossy_object_pose[bone_index] = object_transform;
+				error = max(error, calculate_bone_error(bone_index, raw_object_pose[bone_index], object_transform));
+			}
+
+			ACL_ENSURE(error >= 0.0, "Invalid error: %f", error);
+
+			return error;
+		}
+
+		// Commits a lossy pose that differs from the cached base pose in the given
+		// bone into the cache: the bone and its descendants get new cached object
+		// space transforms and errors. Searches that keep the values they choose
+		// for a track call this once per sample so the bones evaluated afterwards
+		// measure against the accumulated error of every choice made before them.
+		void commit_base_pose_bone(uint32_t sample_index, uint16_t modified_bone_index, const Transform_32* lossy_local_pose)
+		{
+			ACL_ENSURE(sample_index < m_num_cached_samples, "Invalid sample index: %u >= %u", sample_index, m_num_cached_samples);
+			ACL_ENSURE(modified_bone_index < m_num_bones, "Invalid bone index: %u >= %u", modified_bone_index, m_num_bones);
+
+			const RigidBone* bones = m_skeleton.get_bones();
+			size_t pose_offset = size_t(sample_index) * m_num_bones;
+			const Transform_64* raw_object_pose = m_cached_raw_object_poses + pose_offset;
+			Transform_64* base_object_pose = m_cached_base_object_poses + pose_offset;
+			double* base_bone_errors = m_cached_base_bone_errors + pose_offset;
+
+			// Bones are sorted parent first, everything before the modified bone is untouched
+			for (uint16_t bone_index = 0; bone_index < modified_bone_index; ++bone_index)
+				m_is_bone_dirty[bone_index] = 0;
+
+			for (uint16_t bone_index = modified_bone_index; bone_index < m_num_bones; ++bone_index)
+			{
+				uint16_t parent_index = bones[bone_index].parent_index;
+				bool is_dirty = bone_index == modified_bone_index || (parent_index != INVALID_BONE_INDEX && m_is_bone_dirty[parent_index] != 0);
+				m_is_bone_dirty[bone_index] = is_dirty ? 1 : 0;
+
+				if (!is_dirty)
+					continue;
+
+				Transform_64 local_transform = transform_cast(lossy_local_pose[bone_index]);
+
+				// Dirty parents precede their children, their cached object space
+				// transforms are already up to date when we read them
+				Transform_64 object_transform;
+				if (parent_index == INVALID_BONE_INDEX)
+					object_transform = local_transform;
+				else
+					object_transform = transform_mul(local_transform, base_object_pose[parent_index]);
+
+				base_object_pose[bone_index] = object_transform;
+				base_bone_errors[bone_index] = calculate_bone_error(bone_index, raw_object_pose[bone_index], object_transform);
+			}
+		}
+
+		// Evaluates the error at every sample index in [first_sample_index, first_sample_index + num_samples)
+		// and returns the largest. The sample function fills the provided raw and lossy local
+		// pose buffers for the requested sample index.
+		template<typename SamplePosesFn>
+		double calculate_max_error(uint32_t first_sample_index, uint32_t num_samples, SamplePosesFn&& sample_poses_fn)
+		{
+			double max_error = -1.0;
+			for (uint32_t sample_index = first_sample_index; sample_index < first_sample_index + num_samples; ++sample_index)
+			{
+				sample_poses_fn(sample_index, m_raw_local_pose, m_lossy_local_pose);
+				max_error = max(max_error, calculate_error(m_raw_local_pose, m_lossy_local_pose));
+			}
+
+			return max_error;
+		}
+
+	private:
+		double calculate_bone_error(uint16_t bone_index, const Transform_64& raw_object_transform, const Transform_64& lossy_object_transform) const
 		{
 			// We use a virtual vertex to simulate skinning
 			// We use 2 virtual vertices, to ensure we have at least one that isn't co-linear with the rotation axis
-			double vtx_distance = bones[bone_index].vertex_distance;
-			Vector4_64 vtx0 = vector_mul(x_axis, vtx_distance);
-			Vector4_64 vtx1 = vector_mul(y_axis, vtx_distance);
+			double vtx_distance = m_skeleton.get_bones()[bone_index].vertex_distance;
+			Vector4_64 vtx0 = vector_mul(vector_set(1.0, 0.0, 0.0), vtx_distance);
+			Vector4_64 vtx1 = vector_mul(vector_set(0.0, 1.0, 0.0), vtx_distance);
 
-			Vector4_64 raw_vtx0 = transform_position(raw_object_pose[bone_index], vtx0);
-			Vector4_64 lossy_vtx0 = transform_position(lossy_object_pose[bone_index], vtx0);
+			Vector4_64 raw_vtx0 = transform_position(raw_object_transform, vtx0);
+			Vector4_64 lossy_vtx0 = transform_position(lossy_object_transform, vtx0);
 			double vtx0_error = vector_distance3(raw_vtx0, lossy_vtx0);
-			error = max(error, vtx0_error);
 
-			Vector4_64 raw_vtx1 = transform_position(raw_object_pose[bone_index], vtx1);
-			Vector4_64 lossy_vtx1 = transform_position(lossy_object_pose[bone_index], vtx1);
+			Vector4_64 raw_vtx1 = transform_position(raw_object_transform, vtx1);
+			Vector4_64 lossy_vtx1 = transform_position(lossy_object_transform, vtx1);
 			double vtx1_error = vector_distance3(raw_vtx1, lossy_vtx1);
-			error = max(error, vtx1_error);
+
+			return max(vtx0_error, vtx1_error);
 		}
 
-		ACL_ENSURE(error >= 0.0, "Invalid error: %f", error);
+		Allocator&				m_allocator;
+		const RigidSkeleton&	m_skeleton;
+
+		Transform_64*			m_raw_object_pose;
+		Transform_64*			m_lossy_object_pose;
+		Transform_64*			m_lossy_local_pose_64;
+
+		Transform_64*			m_raw_local_pose;
+		Transform_32*			m_lossy_local_pose;
+
+		uint8_t*				m_is_bone_dirty;
+
+		// Base pose cache, see cache_base_poses
+		Transform_64*			m_cached_raw_object_poses;
+		Transform_64*			m_cached_base_object_poses;
+		double*					m_cached_base_bone_errors;
+		uint32_t				m_num_cached_samples;
+
+		uint16_t				m_num_bones;
+	};
+
+	inline double calculate_skeleton_error(Allocator& allocator, const RigidSkeleton& skeleton, const Transform_64* raw_local_pose, const Transform_32* lossy_local_pose)
+	{
+		SkeletonErrorMetricContext context(allocator, skeleton);
+		return context.calculate_error(raw_local_pose, lossy_local_pose);
+	}
+
+	// Batched entry point: evaluates the error over the whole sample range in one call.
+	// With a task scheduler the range is split into blocks, each with its own scratch
+	// context, in which case the sample function must be safe to call from multiple threads.
+	template<typename SamplePosesFn>
+	inline double calculate_max_skeleton_error(Allocator& allocator, const RigidSkeleton& skeleton, uint32_t num_samples, SamplePosesFn&& sample_poses_fn, ITaskScheduler* task_scheduler = nullptr)
+	{
+		if (num_samples == 0)
+			return 0.0;
+
+		if (task_scheduler == nullptr)
+		{
+			SkeletonErrorMetricContext context(allocator, skeleton);
+			return context.calculate_max_error(0, num_samples, std::forward<SamplePosesFn>(sample_poses_fn));
+		}
+
+		constexpr uint32_t MAX_NUM_ERROR_TASKS = 16;
+		uint32_t num_tasks = num_samples < MAX_NUM_ERROR_TASKS ? num_samples : MAX_NUM_ERROR_TASKS;
+		uint32_t num_samples_per_task = (num_samples + num_tasks - 1) / num_tasks;
+
+		double* task_errors = allocate_type_array<double>(allocator, num_tasks);
+		parallel_tasks(task_scheduler, num_tasks, [&](uint32_t task_index)
+		{
+			uint32_t first_sample_index = task_index * num_samples_per_task;
+			if (first_sample_index >= num_samples)
+			{
+				task_errors[task_index] = -1.0;
+				return;
+			}
+
+			uint32_t num_task_samples = num_samples - first_sample_index < num_samples_per_task ? num_samples - first_sample_index : num_samples_per_task;
+
+			SkeletonErrorMetricContext context(allocator, skeleton);
+			task_errors[task_index] = context.calculate_max_error(first_sample_index, num_task_samples, sample_poses_fn);
+		});
+
+		double max_error = -1.0;
+		for (uint32_t task_index = 0; task_index < num_tasks; ++task_index)
+			max_error = max(max_error, task_errors[task_index]);
 
-		deallocate_type_array(allocator, raw_object_pose, num_bones);
-		deallocate_type_array(allocator, lossy_object_pose, num_bones);
-		deallocate_type_array(allocator, lossy_local_pose_64, num_bones);
+		deallocate_type_array(allocator, task_errors, num_tasks);
 
-		return error;
+		return max_error;
 	}
 }
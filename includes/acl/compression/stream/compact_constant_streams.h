@@ -26,7 +26,14 @@
 
 #include "acl/core/memory.h"
 #include "acl/core/error.h"
+#include "acl/math/quat_32.h"
+#include "acl/math/vector4_32.h"
 #include "acl/math/vector4_64.h"
+#include "acl/math/transform_32.h"
+#include "acl/math/transform_64.h"
+#include "acl/compression/animation_clip.h"
+#include "acl/compression/skeleton.h"
+#include "acl/compression/skeleton_error_metric.h"
 #include "acl/compression/stream/track_stream.h"
 
 #include <stdint.h>
@@ -71,6 +78,133 @@ namespace acl
 				bone_stream.is_translation_constant = true;
 				bone_stream.is_translation_default = vector_near_equal(vector_cast(translation), vector_zero_32());
 			}
+
+			if (bone_stream.has_scale && bone_stream.scale_range.is_constant(threshold))
+			{
+				TrackStream constant_stream(allocator, 1, bone_stream.scales.get_sample_size());
+				Vector4_64 scale = bone_stream.scales.get_sample<Vector4_64>(0);
+				constant_stream.set_sample(0, scale);
+
+				bone_stream.scales = std::move(constant_stream);
+				bone_stream.scale_range = TrackStreamRange(scale, scale);
+				bone_stream.is_scale_constant = true;
+				bone_stream.is_scale_default = vector_near_equal3(vector_cast(scale), vector_set(1.0f));
+			}
+		}
+	}
+
+	// Error metric driven variant. Tracks whose range sweeps past the bitwise
+	// threshold can still be invisible in object space: a track also collapses
+	// when holding its first sample for the whole clip keeps the skeleton error
+	// under the clip error threshold at every sample, so near constant finger
+	// and twist bones drop to a single sample too. Judged with the same object
+	// space metric and subtree evaluation the variable format selection uses;
+	// every track is evaluated in isolation against the raw values of the
+	// other bones. Scale tracks only collapse bitwise, the error metric poses
+	// carry no scale.
+	inline void compact_constant_streams(Allocator& allocator, BoneStreams* bone_streams, uint16_t num_bones, double threshold,
+		const AnimationClip& clip, const RigidSkeleton& skeleton)
+	{
+		ACL_ENSURE(num_bones == clip.get_num_bones(), "Unexpected number of bones. %u != %u", num_bones, clip.get_num_bones());
+
+		// Bitwise constant tracks collapse without paying for the error metric
+		compact_constant_streams(allocator, bone_streams, num_bones, threshold);
+
+		uint32_t num_samples = clip.get_num_samples();
+		if (num_bones == 0 || num_samples <= 1)
+			return;
+
+		double error_threshold = clip.get_error_threshold();
+
+		// The raw poses come from the clip, the lossy scratch poses start as their
+		// 32 bit cast and only the track being evaluated is overwritten
+		Transform_64* raw_poses = allocate_type_array<Transform_64>(allocator, size_t(num_samples) * num_bones);
+		Transform_32* lossy_poses = allocate_type_array<Transform_32>(allocator, size_t(num_samples) * num_bones);
+
+		const AnimatedBone* clip_bones = clip.get_bones();
+		for (uint32_t sample_index = 0; sample_index < num_samples; ++sample_index)
+		{
+			for (uint16_t bone_index = 0; bone_index < num_bones; ++bone_index)
+			{
+				Quat_64 rotation = clip_bones[bone_index].rotation_track.get_sample(sample_index);
+				Vector4_64 translation = clip_bones[bone_index].translation_track.get_sample(sample_index);
+
+				size_t pose_offset = (size_t(sample_index) * num_bones) + bone_index;
+				raw_poses[pose_offset] = transform_set(rotation, translation);
+				lossy_poses[pose_offset] = transform_cast(raw_poses[pose_offset]);
+			}
+		}
+
+		SkeletonErrorMetricContext error_metric_context(allocator, skeleton);
+		error_metric_context.cache_base_poses(num_samples, raw_poses, lossy_poses);
+
+		for (uint16_t bone_index = 0; bone_index < num_bones; ++bone_index)
+		{
+			BoneStreams& bone_stream = bone_streams[bone_index];
+
+			if (!bone_stream.is_rotation_constant)
+			{
+				Vector4_64 rotation = bone_stream.rotations.get_sample<Vector4_64>(0);
+				Quat_32 constant_rotation = quat_cast(vector_to_quat(rotation));
+
+				bool is_within_threshold = true;
+				for (uint32_t sample_index = 0; sample_index < num_samples && is_within_threshold; ++sample_index)
+				{
+					size_t pose_offset = (size_t(sample_index) * num_bones) + bone_index;
+					lossy_poses[pose_offset].rotation = constant_rotation;
+
+					const Transform_32* lossy_pose = &lossy_poses[size_t(sample_index) * num_bones];
+					is_within_threshold = error_metric_context.calculate_error_for_subtree(sample_index, bone_index, lossy_pose) <= error_threshold;
+				}
+
+				if (is_within_threshold)
+				{
+					TrackStream constant_stream(allocator, 1, bone_stream.rotations.get_sample_size());
+					constant_stream.set_sample(0, rotation);
+
+					bone_stream.rotations = std::move(constant_stream);
+					bone_stream.rotation_range = TrackStreamRange(rotation, rotation);
+					bone_stream.is_rotation_constant = true;
+					bone_stream.is_rotation_default = quat_near_identity(quat_cast(vector_to_quat(rotation)));
+				}
+			}
+
+			if (!bone_stream.is_translation_constant)
+			{
+				Vector4_64 translation = bone_stream.translations.get_sample<Vector4_64>(0);
+				Vector4_32 constant_translation = vector_cast(translation);
+
+				bool is_within_threshold = true;
+				for (uint32_t sample_index = 0; sample_index < num_samples && is_within_threshold; ++sample_index)
+				{
+					size_t pose_offset = (size_t(sample_index) * num_bones) + bone_index;
+					lossy_poses[pose_offset].translation = constant_translation;
+
+					const Transform_32* lossy_pose = &lossy_poses[size_t(sample_index) * num_bones];
+					is_within_threshold = error_metric_context.calculate_error_for_subtree(sample_index, bone_index, lossy_pose) <= error_threshold;
+				}
+
+				if (is_within_threshold)
+				{
+					TrackStream constant_stream(allocator, 1, bone_stream.translations.get_sample_size());
+					constant_stream.set_sample(0, translation);
+
+					bone_stream.translations = std::move(constant_stream);
+					bone_stream.translation_range = TrackStreamRange(translation, translation);
+					bone_stream.is_translation_constant = true;
+					bone_stream.is_translation_default = vector_near_equal(vector_cast(translation), vector_zero_32());
+				}
+			}
+
+			// Restore the raw values before we evaluate the next bone
+			for (uint32_t sample_index = 0; sample_index < num_samples; ++sample_index)
+			{
+				size_t pose_offset = (size_t(sample_index) * num_bones) + bone_index;
+				lossy_poses[pose_offset] = transform_cast(raw_poses[pose_offset]);
+			}
 		}
+
+		deallocate_type_array(allocator, raw_poses, size_t(num_samples) * num_bones);
+		deallocate_type_array(allocator, lossy_poses, size_t(num_samples) * num_bones);
 	}
 }
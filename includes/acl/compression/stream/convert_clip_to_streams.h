@@ -35,6 +35,56 @@
 
 namespace acl
 {
+	inline void convert_bone_to_streams(Allocator& allocator, const AnimatedBone& bone, uint32_t num_samples, BoneStreams& bone_stream)
+	{
+		bone_stream.rotations = TrackStream(allocator, num_samples, sizeof(Quat_64));
+		bone_stream.translations = TrackStream(allocator, num_samples, sizeof(Vector4_64));
+
+		TypedTrackStream<Quat_64> rotations(bone_stream.rotations);
+		TypedTrackStream<Vector4_64> translations(bone_stream.translations);
+
+		for (uint32_t sample_index = 0; sample_index < num_samples; ++sample_index)
+		{
+			Quat_64 rotation = bone.rotation_track.get_sample(sample_index);
+			rotations.set_sample(sample_index, rotation);
+
+			Vector4_64 translation = bone.translation_track.get_sample(sample_index);
+			translations.set_sample(sample_index, translation);
+		}
+
+		// The ranges come from a single linear pass over the freshly written buffers
+		bone_stream.rotation_range = extract_track_stream_range(bone_stream.rotations);
+		bone_stream.translation_range = extract_track_stream_range(bone_stream.translations);
+		bone_stream.is_rotation_constant = num_samples == 1;
+		bone_stream.is_rotation_default = bone_stream.is_rotation_constant && quat_near_identity(quat_cast(bone.rotation_track.get_sample(0)));
+		bone_stream.is_translation_constant = num_samples == 1;
+		bone_stream.is_translation_default = bone_stream.is_translation_constant && vector_near_equal(vector_cast(bone.translation_track.get_sample(0)), vector_zero_32());
+		bone_stream.are_rotations_normalized = false;
+		bone_stream.are_translations_normalized = false;
+
+		// Scale tracks are only present when the clip carries them, clips without
+		// scale read as a default scale track downstream
+		const bool has_scale = bone.scale_track.is_initialized();
+		if (has_scale)
+		{
+			bone_stream.scales = TrackStream(allocator, num_samples, sizeof(Vector4_64));
+
+			TypedTrackStream<Vector4_64> scales(bone_stream.scales);
+			for (uint32_t sample_index = 0; sample_index < num_samples; ++sample_index)
+				scales.set_sample(sample_index, bone.scale_track.get_sample(sample_index));
+
+			bone_stream.scale_range = extract_track_stream_range(bone_stream.scales);
+			bone_stream.is_scale_constant = num_samples == 1;
+			bone_stream.is_scale_default = bone_stream.is_scale_constant && vector_near_equal3(vector_cast(bone.scale_track.get_sample(0)), vector_set(1.0f));
+		}
+		else
+		{
+			bone_stream.is_scale_constant = true;
+			bone_stream.is_scale_default = true;
+		}
+		bone_stream.has_scale = has_scale;
+	}
+
 	inline BoneStreams* convert_clip_to_streams(Allocator& allocator, const AnimationClip& clip)
 	{
 		uint16_t num_bones = clip.get_num_bones();
@@ -47,41 +97,7 @@ namespace acl
 		BoneStreams* bone_streams = allocate_type_array<BoneStreams>(allocator, num_bones);
 
 		for (uint16_t bone_index = 0; bone_index < num_bones; ++bone_index)
-		{
-			const AnimatedBone& bone = bones[bone_index];
-			BoneStreams& bone_stream = bone_streams[bone_index];
-
-			bone_stream.rotations = TrackStream(allocator, num_samples, sizeof(Quat_64));
-			bone_stream.translations = TrackStream(allocator, num_samples, sizeof(Vector4_64));
-
-			Vector4_64 rotation_min = vector_set(1e10);
-			Vector4_64 rotation_max = vector_set(-1e10);
-			Vector4_64 translation_min = vector_set(1e10);
-			Vector4_64 translation_max = vector_set(-1e10);
-
-			for (uint32_t sample_index = 0; sample_index < num_samples; ++sample_index)
-			{
-				Quat_64 rotation = bone.rotation_track.get_sample(sample_index);
-				bone_stream.rotations.set_sample(sample_index, rotation);
-
-				Vector4_64 translation = bone.translation_track.get_sample(sample_index);
-				bone_stream.translations.set_sample(sample_index, translation);
-
-				rotation_min = vector_min(rotation_min, quat_to_vector(rotation));
-				rotation_max = vector_max(rotation_max, quat_to_vector(rotation));
-				translation_min = vector_min(translation_min, translation);
-				translation_max = vector_max(translation_max, translation);
-			}
-
-			bone_stream.rotation_range = TrackStreamRange(rotation_min, rotation_max);
-			bone_stream.translation_range = TrackStreamRange(translation_min, translation_max);
-			bone_stream.is_rotation_constant = num_samples == 1;
-			bone_stream.is_rotation_default = bone_stream.is_rotation_constant && quat_near_identity(quat_cast(bone.rotation_track.get_sample(0)));
-			bone_stream.is_translation_constant = num_samples == 1;
-			bone_stream.is_translation_default = bone_stream.is_translation_constant && vector_near_equal(vector_cast(bone.translation_track.get_sample(0)), vector_zero_32());
-			bone_stream.are_rotations_normalized = false;
-			bone_stream.are_translations_normalized = false;
-		}
+			convert_bone_to_streams(allocator, bones[bone_index], num_samples, bone_streams[bone_index]);
 
 		return bone_streams;
 	}
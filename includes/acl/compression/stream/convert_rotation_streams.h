@@ -34,6 +34,56 @@
 
 namespace acl
 {
+	//////////////////////////////////////////////////////////////////////////
+	// Each target representation below is one kernel over the whole contiguous
+	// stream buffer. convert_rotation_streams dispatches once per track on the
+	// clip wide format: adding a representation means adding one kernel and one
+	// dispatch case, the per track loops never branch per sample. With the
+	// per track format search this pass runs many times per clip.
+	//////////////////////////////////////////////////////////////////////////
+
+	// Drop W representations: every sample gets a positive w so the component
+	// can be dropped and reconstructed from the other three at decompression.
+	// The flip is branchless: the broadcast w compares against zero and the
+	// mask selects between the sample and its negation, four samples are
+	// processed per iteration to keep the loop busy while the selects retire.
+	inline void convert_rotations_drop_w(TrackStream& stream)
+	{
+		// We convert our rotation stream in place. We assume that the original format is Quat_128 stored at Quat_64
+		TypedTrackStream<Quat_64> rotations(stream);
+
+		Vector4_64 zero = vector_zero_64();
+
+		uint32_t num_samples = rotations.get_num_samples();
+		uint32_t num_batched_samples = num_samples & ~3;
+
+		for (uint32_t sample_index = 0; sample_index < num_batched_samples; sample_index += 4)
+		{
+			Quat_64 rotation0 = rotations.get_sample(sample_index + 0);
+			Quat_64 rotation1 = rotations.get_sample(sample_index + 1);
+			Quat_64 rotation2 = rotations.get_sample(sample_index + 2);
+			Quat_64 rotation3 = rotations.get_sample(sample_index + 3);
+
+			Vector4_64 mask0 = vector_less_than(vector_set(quat_get_w(rotation0)), zero);
+			Vector4_64 mask1 = vector_less_than(vector_set(quat_get_w(rotation1)), zero);
+			Vector4_64 mask2 = vector_less_than(vector_set(quat_get_w(rotation2)), zero);
+			Vector4_64 mask3 = vector_less_than(vector_set(quat_get_w(rotation3)), zero);
+
+			rotation0 = vector_to_quat(vector_blend(mask0, quat_to_vector(quat_neg(rotation0)), quat_to_vector(rotation0)));
+			rotation1 = vector_to_quat(vector_blend(mask1, quat_to_vector(quat_neg(rotation1)), quat_to_vector(rotation1)));
+			rotation2 = vector_to_quat(vector_blend(mask2, quat_to_vector(quat_neg(rotation2)), quat_to_vector(rotation2)));
+			rotation3 = vector_to_quat(vector_blend(mask3, quat_to_vector(quat_neg(rotation3)), quat_to_vector(rotation3)));
+
+			rotations.set_sample(sample_index + 0, rotation0);
+			rotations.set_sample(sample_index + 1, rotation1);
+			rotations.set_sample(sample_index + 2, rotation2);
+			rotations.set_sample(sample_index + 3, rotation3);
+		}
+
+		for (uint32_t sample_index = num_batched_samples; sample_index < num_samples; ++sample_index)
+			rotations.set_sample(sample_index, quat_ensure_positive_w(rotations.get_sample(sample_index)));
+	}
+
 	inline void convert_rotation_streams(Allocator& allocator, BoneStreams* bone_streams, uint16_t num_bones, RotationFormat8 rotation_format)
 	{
 		if (num_bones == 0)
@@ -46,40 +96,20 @@ namespace acl
 		{
 			BoneStreams& bone_stream = bone_streams[bone_index];
 
-			// We convert our rotation stream in place. We assume that the original format is Quat_128 stored at Quat_64
-			// For all other formats, we keep the same sample size and either keep Quat_64 or use Vector4_64
-			ACL_ENSURE(bone_stream.rotations.get_sample_size() == sizeof(Quat_64), "Unexpected rotation sample size. %u != %u", bone_stream.rotations.get_sample_size(), sizeof(Quat_64));
-
-			Vector4_64 rotation_min = vector_set(1e10);
-			Vector4_64 rotation_max = vector_set(-1e10);
-
-			uint32_t num_samples = bone_stream.rotations.get_num_samples();
-			for (uint32_t sample_index = 0; sample_index < num_samples; ++sample_index)
+			switch (rotation_format)
 			{
-				Quat_64 rotation = bone_stream.rotations.get_sample<Quat_64>(sample_index);
-
-				switch (rotation_format)
-				{
-				case RotationFormat8::Quat_128:
-					// Original format, nothing to do
-					break;
-				case RotationFormat8::Quat_96:
-				case RotationFormat8::Quat_48:
-				case RotationFormat8::Quat_32:
-					// Drop W, we just ensure it is positive and write it back, the W component can be ignored afterwards
-					rotation = quat_ensure_positive_w(rotation);
-					bone_stream.rotations.set_sample(sample_index, rotation);
-					break;
-				default:
-					ACL_ENSURE(false, "Invalid or unsupported rotation format: %s", get_rotation_format_name(rotation_format));
-					break;
-				}
-
-				rotation_min = vector_min(rotation_min, quat_to_vector(rotation));
-				rotation_max = vector_max(rotation_max, quat_to_vector(rotation));
+			case RotationFormat8::Quat_96:
+			case RotationFormat8::Quat_48:
+			case RotationFormat8::Quat_32:
+				convert_rotations_drop_w(bone_stream.rotations);
+				break;
+			default:
+				ACL_ENSURE(false, "Invalid or unsupported rotation format: %s", get_rotation_format_name(rotation_format));
+				break;
 			}
 
-			bone_stream.rotation_range = TrackStreamRange(rotation_min, rotation_max);
+			// The range comes from a single linear pass over the converted buffer
+			bone_stream.rotation_range = extract_track_stream_range(bone_stream.rotations);
 		}
 	}
 }
@@ -0,0 +1,100 @@
+#pragma once
+
+////////////////////////////////////////////////////////////////////////////////
+// The MIT License (MIT)
+//
+// Copyright (c) 2017 Nicholas Frechette & Animation Compression Library contributors
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+////////////////////////////////////////////////////////////////////////////////
+
+#include "acl/core/memory.h"
+#include "acl/core/error.h"
+#include "acl/core/algorithm_types.h"
+#include "acl/math/quat_64.h"
+#include "acl/math/vector4_64.h"
+#include "acl/math/transform_64.h"
+#include "acl/compression/skeleton.h"
+#include "acl/compression/stream/track_stream.h"
+
+#include <stdint.h>
+
+namespace acl
+{
+	// Rewrites every track as its delta from a reference pose, see
+	// CompressionSettings::additive_base_pose. Rotations store
+	// quat_mul(sample, quat_conjugate(base)) so quat_mul(delta, base)
+	// reconstructs the absolute, translations store sample - base.
+	// Additive clips deviate only slightly from their base so most deltas land
+	// near identity: near identity tracks collapse to default tracks downstream
+	// and the remaining ranges shrink to a sliver of the normalized domain,
+	// which is where range reduction and variable quantization earn their bits.
+	// Must run right after the clip is converted to streams, before the
+	// rotation format conversion alters the samples.
+	inline void convert_streams_to_relative(BoneStreams* bone_streams, uint16_t num_bones, const RigidSkeleton& skeleton, AdditiveBasePose8 base_pose, const Transform_64* base_transforms)
+	{
+		ACL_ENSURE(base_pose != AdditiveBasePose8::None, "Nothing to convert without a base pose!");
+		ACL_ENSURE(base_pose != AdditiveBasePose8::Custom || base_transforms != nullptr, "A custom base pose requires base transforms!");
+
+		for (uint16_t bone_index = 0; bone_index < num_bones; ++bone_index)
+		{
+			BoneStreams& bone_stream = bone_streams[bone_index];
+
+			Quat_64 base_rotation;
+			Vector4_64 base_translation;
+			if (base_pose == AdditiveBasePose8::Custom)
+			{
+				base_rotation = base_transforms[bone_index].rotation;
+				base_translation = base_transforms[bone_index].translation;
+			}
+			else
+			{
+				const RigidBone& bone = skeleton.get_bone(bone_index);
+				base_rotation = bone.bind_rotation;
+				base_translation = bone.bind_translation;
+			}
+
+			const Quat_64 inv_base_rotation = quat_conjugate(base_rotation);
+
+			TypedTrackStream<Quat_64> rotations(bone_stream.rotations);
+			TypedTrackStream<Vector4_64> translations(bone_stream.translations);
+
+			uint32_t num_samples = rotations.get_num_samples();
+			for (uint32_t sample_index = 0; sample_index < num_samples; ++sample_index)
+			{
+				// The positive w hemisphere keeps the deltas clustered around
+				// identity instead of straddling both representations of it
+				Quat_64 delta_rotation = quat_normalize(quat_mul(rotations.get_sample(sample_index), inv_base_rotation));
+				rotations.set_sample(sample_index, quat_ensure_positive_w(delta_rotation));
+
+				Vector4_64 delta_translation = vector_sub(translations.get_sample(sample_index), base_translation);
+				translations.set_sample(sample_index, delta_translation);
+			}
+
+			// The ranges and single sample default flags were extracted from the
+			// absolute samples, redo them over the deltas
+			bone_stream.rotation_range = extract_track_stream_range(bone_stream.rotations);
+			bone_stream.translation_range = extract_track_stream_range(bone_stream.translations);
+			if (bone_stream.is_rotation_constant)
+				bone_stream.is_rotation_default = quat_near_identity(rotations.get_sample(0));
+			if (bone_stream.is_translation_constant)
+				bone_stream.is_translation_default = vector_near_equal(translations.get_sample(0), vector_zero_64());
+		}
+	}
+}
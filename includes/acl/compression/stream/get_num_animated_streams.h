@@ -65,4 +65,28 @@ namespace acl
 		out_num_animated_rotation_streams = num_animated_rotation_streams;
 		out_num_animated_translation_streams = num_animated_translation_streams;
 	}
+
+	// Both counts are zero for clips without scale tracks
+	inline void get_num_animated_scale_streams(const BoneStreams* bone_streams, uint16_t num_bones,
+		uint32_t& out_num_constant_scale_streams, uint32_t& out_num_animated_scale_streams)
+	{
+		uint32_t num_constant_scale_streams = 0;
+		uint32_t num_animated_scale_streams = 0;
+
+		for (uint16_t bone_index = 0; bone_index < num_bones; ++bone_index)
+		{
+			const BoneStreams& bone_stream = bone_streams[bone_index];
+
+			if (bone_stream.has_scale && !bone_stream.is_scale_default)
+			{
+				if (bone_stream.is_scale_constant)
+					num_constant_scale_streams++;
+				else
+					num_animated_scale_streams++;
+			}
+		}
+
+		out_num_constant_scale_streams = num_constant_scale_streams;
+		out_num_animated_scale_streams = num_animated_scale_streams;
+	}
 }
@@ -28,6 +28,7 @@
 #include "acl/core/error.h"
 #include "acl/core/enum_utils.h"
 #include "acl/core/algorithm_types.h"
+#include "acl/core/task_scheduler.h"
 #include "acl/math/quat_64.h"
 #include "acl/math/vector4_64.h"
 #include "acl/compression/stream/track_stream.h"
@@ -36,93 +37,107 @@
 
 namespace acl
 {
-	inline void normalize_rotation_streams(BoneStreams* bone_streams, uint16_t num_bones, RangeReductionFlags8 range_reduction, RotationFormat8 rotation_format)
+	inline void normalize_rotation_stream(BoneStreams& bone_stream, RotationFormat8 rotation_format)
 	{
-		if (!is_enum_flag_set(range_reduction, RangeReductionFlags8::Rotations))
-			return;
-
-		for (uint16_t bone_index = 0; bone_index < num_bones; ++bone_index)
-		{
-			BoneStreams& bone_stream = bone_streams[bone_index];
+		// We expect all our samples to have the same width of sizeof(Vector4_64)
+		TypedTrackStream<Vector4_64> rotations(bone_stream.rotations);
 
-			// We expect all our samples to have the same width of sizeof(Vector4_64)
-			ACL_ENSURE(bone_stream.rotations.get_sample_size() == sizeof(Vector4_64), "Unexpected rotation sample size. %u != %u", bone_stream.rotations.get_sample_size(), sizeof(Vector4_64));
+		if (!bone_stream.is_rotation_animated())
+			return;
 
-			if (!bone_stream.is_rotation_animated())
-				continue;
+		uint32_t num_samples = rotations.get_num_samples();
 
-			uint32_t num_samples = bone_stream.rotations.get_num_samples();
+		Vector4_64 range_min = bone_stream.rotation_range.get_min();
+		Vector4_64 range_reciprocal_extent = bone_stream.rotation_range.get_reciprocal_extent();
+		Vector4_64 one = vector_set(1.0);
 
-			Vector4_64 range_min = bone_stream.rotation_range.get_min();
-			Vector4_64 range_extent = bone_stream.rotation_range.get_extent();
+		// The samples are contiguous, normalize them in a single linear pass over the
+		// raw buffer and multiply by the cached reciprocal extent instead of dividing
+		// per sample. Components with a degenerate extent have a zero reciprocal and
+		// normalize to 0.0; the multiply can overshoot 1.0 by a rounding ulp at the
+		// range maximum so we clamp it back.
+		Vector4_64* samples = rotations.get_raw_samples();
 
-			for (uint32_t sample_index = 0; sample_index < num_samples; ++sample_index)
-			{
-				// normalized value is between [0.0 .. 1.0]
-				// value = (normalized value * range extent) + range min
-				// normalized value = (value - range min) / range extent
-				Vector4_64 rotation = bone_stream.rotations.get_sample<Vector4_64>(sample_index);
-				Vector4_64 normalized_rotation = vector_div(vector_sub(rotation, range_min), range_extent);
-				Vector4_64 is_range_zero_mask = vector_less_than(range_extent, vector_set(0.000000001));
-				normalized_rotation = vector_blend(is_range_zero_mask, vector_zero_64(), normalized_rotation);
+		for (uint32_t sample_index = 0; sample_index < num_samples; ++sample_index)
+		{
+			// normalized value is between [0.0 .. 1.0]
+			// value = (normalized value * range extent) + range min
+			// normalized value = (value - range min) / range extent
+			Vector4_64 normalized_rotation = vector_mul(vector_sub(samples[sample_index], range_min), range_reciprocal_extent);
+			normalized_rotation = vector_min(normalized_rotation, one);
 
 #if defined(ACL_USE_ERROR_CHECKS)
-				switch (rotation_format)
-				{
-				case RotationFormat8::Quat_128:
-					ACL_ENSURE(vector_all_greater_equal(normalized_rotation, vector_zero_64()) && vector_all_less_equal(normalized_rotation, vector_set(1.0)), "Invalid normalized rotation. 0.0 <= [%f, %f, %f, %f] <= 1.0", vector_get_x(normalized_rotation), vector_get_y(normalized_rotation), vector_get_z(normalized_rotation), vector_get_w(normalized_rotation));
-					break;
-				case RotationFormat8::Quat_96:
-				case RotationFormat8::Quat_48:
-				case RotationFormat8::Quat_32:
-					ACL_ENSURE(vector_all_greater_equal3(normalized_rotation, vector_zero_64()) && vector_all_less_equal3(normalized_rotation, vector_set(1.0)), "Invalid normalized rotation. 0.0 <= [%f, %f, %f] <= 1.0", vector_get_x(normalized_rotation), vector_get_y(normalized_rotation), vector_get_z(normalized_rotation));
-					break;
-				}
-#endif
-
-				bone_stream.rotations.set_sample(sample_index, normalized_rotation);
+			switch (rotation_format)
+			{
+			case RotationFormat8::Quat_128:
+				ACL_ENSURE(vector_all_greater_equal(normalized_rotation, vector_zero_64()) && vector_all_less_equal(normalized_rotation, vector_set(1.0)), "Invalid normalized rotation. 0.0 <= [%f, %f, %f, %f] <= 1.0", vector_get_x(normalized_rotation), vector_get_y(normalized_rotation), vector_get_z(normalized_rotation), vector_get_w(normalized_rotation));
+				break;
+			case RotationFormat8::Quat_96:
+			case RotationFormat8::Quat_48:
+			case RotationFormat8::Quat_32:
+				ACL_ENSURE(vector_all_greater_equal3(normalized_rotation, vector_zero_64()) && vector_all_less_equal3(normalized_rotation, vector_set(1.0)), "Invalid normalized rotation. 0.0 <= [%f, %f, %f] <= 1.0", vector_get_x(normalized_rotation), vector_get_y(normalized_rotation), vector_get_z(normalized_rotation));
+				break;
 			}
+#endif
 
-			bone_stream.are_rotations_normalized = true;
+			samples[sample_index] = normalized_rotation;
 		}
+
+		bone_stream.are_rotations_normalized = true;
 	}
 
-	inline void normalize_translation_streams(BoneStreams* bone_streams, uint16_t num_bones, RangeReductionFlags8 range_reduction)
+	inline void normalize_translation_stream(BoneStreams& bone_stream)
 	{
-		if (!is_enum_flag_set(range_reduction, RangeReductionFlags8::Translations))
+		// We expect all our samples to have the same width of sizeof(Vector4_64)
+		TypedTrackStream<Vector4_64> translations(bone_stream.translations);
+
+		if (!bone_stream.is_translation_animated())
 			return;
 
-		for (uint16_t bone_index = 0; bone_index < num_bones; ++bone_index)
-		{
-			BoneStreams& bone_stream = bone_streams[bone_index];
+		uint32_t num_samples = translations.get_num_samples();
+
+		Vector4_64 range_min = bone_stream.translation_range.get_min();
+		Vector4_64 range_reciprocal_extent = bone_stream.translation_range.get_reciprocal_extent();
+		Vector4_64 one = vector_set(1.0);
 
-			// We expect all our samples to have the same width of sizeof(Vector4_64)
-			ACL_ENSURE(bone_stream.translations.get_sample_size() == sizeof(Vector4_64), "Unexpected translation sample size. %u != %u", bone_stream.translations.get_sample_size(), sizeof(Vector4_64));
+		// Single linear pass over the raw buffer, see normalize_rotation_stream
+		Vector4_64* samples = translations.get_raw_samples();
 
-			if (!bone_stream.is_translation_animated())
-				continue;
+		for (uint32_t sample_index = 0; sample_index < num_samples; ++sample_index)
+		{
+			// normalized value is between [0.0 .. 1.0]
+			// value = (normalized value * range extent) + range min
+			// normalized value = (value - range min) / range extent
+			Vector4_64 normalized_translation = vector_mul(vector_sub(samples[sample_index], range_min), range_reciprocal_extent);
+			normalized_translation = vector_min(normalized_translation, one);
 
-			uint32_t num_samples = bone_stream.translations.get_num_samples();
+			ACL_ENSURE(vector_all_greater_equal3(normalized_translation, vector_zero_64()) && vector_all_less_equal3(normalized_translation, vector_set(1.0)), "Invalid normalized translation. 0.0 <= [%f, %f, %f] <= 1.0", vector_get_x(normalized_translation), vector_get_y(normalized_translation), vector_get_z(normalized_translation));
 
-			Vector4_64 range_min = bone_stream.translation_range.get_min();
-			Vector4_64 range_extent = bone_stream.translation_range.get_extent();
+			samples[sample_index] = normalized_translation;
+		}
 
-			for (uint32_t sample_index = 0; sample_index < num_samples; ++sample_index)
-			{
-				// normalized value is between [0.0 .. 1.0]
-				// value = (normalized value * range extent) + range min
-				// normalized value = (value - range min) / range extent
-				Vector4_64 translation = bone_stream.translations.get_sample<Vector4_64>(sample_index);
-				Vector4_64 normalized_translation = vector_div(vector_sub(translation, range_min), range_extent);
-				Vector4_64 is_range_zero_mask = vector_less_than(range_extent, vector_set(0.000000001));
-				normalized_translation = vector_blend(is_range_zero_mask, vector_zero_64(), normalized_translation);
+		bone_stream.are_translations_normalized = true;
+	}
 
-				ACL_ENSURE(vector_all_greater_equal3(normalized_translation, vector_zero_64()) && vector_all_less_equal3(normalized_translation, vector_set(1.0)), "Invalid normalized translation. 0.0 <= [%f, %f, %f] <= 1.0", vector_get_x(normalized_translation), vector_get_y(normalized_translation), vector_get_z(normalized_translation));
+	inline void normalize_rotation_streams(BoneStreams* bone_streams, uint16_t num_bones, RangeReductionFlags8 range_reduction, RotationFormat8 rotation_format, ITaskScheduler* task_scheduler = nullptr)
+	{
+		if (!is_enum_flag_set(range_reduction, RangeReductionFlags8::Rotations))
+			return;
 
-				bone_stream.translations.set_sample(sample_index, normalized_translation);
-			}
+		parallel_tasks(task_scheduler, num_bones, [bone_streams, rotation_format](uint32_t bone_index)
+		{
+			normalize_rotation_stream(bone_streams[bone_index], rotation_format);
+		});
+	}
 
-			bone_stream.are_translations_normalized = true;
-		}
+	inline void normalize_translation_streams(BoneStreams* bone_streams, uint16_t num_bones, RangeReductionFlags8 range_reduction, ITaskScheduler* task_scheduler = nullptr)
+	{
+		if (!is_enum_flag_set(range_reduction, RangeReductionFlags8::Translations))
+			return;
+
+		parallel_tasks(task_scheduler, num_bones, [bone_streams](uint32_t bone_index)
+		{
+			normalize_translation_stream(bone_streams[bone_index]);
+		});
 	}
 }
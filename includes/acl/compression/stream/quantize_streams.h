@@ -26,6 +26,7 @@
 
 #include "acl/core/memory.h"
 #include "acl/core/error.h"
+#include "acl/core/task_scheduler.h"
 #include "acl/math/quat_64.h"
 #include "acl/math/quat_packing.h"
 #include "acl/math/vector4_64.h"
@@ -36,37 +37,90 @@
 
 namespace acl
 {
-	inline void quantize_rotation_streams(Allocator& allocator, BoneStreams* bone_streams, uint16_t num_bones, RotationFormat8 rotation_format)
+	inline void quantize_rotation_stream(Allocator& allocator, BoneStreams& bone_stream, RotationFormat8 rotation_format)
 	{
-		// By the time we get here, values have been converted to their final format, and normalized if selected
-		for (uint16_t bone_index = 0; bone_index < num_bones; ++bone_index)
+		// We expect all our samples to have the same width of sizeof(Quat_64)
+		ConstTypedTrackStream<Quat_64> raw_rotations(bone_stream.rotations);
+
+		uint32_t num_samples = raw_rotations.get_num_samples();
+		TrackStream quantized_stream(allocator, num_samples, get_packed_rotation_size(rotation_format));
+
+		Vector4_64 rotation_min = vector_set(1e10);
+		Vector4_64 rotation_max = vector_set(-1e10);
+
+		if (rotation_format == RotationFormat8::Quat_128 || rotation_format == RotationFormat8::Quat_96)
 		{
-			BoneStreams& bone_stream = bone_streams[bone_index];
+			// The full float formats pack with plain stores and their round trip
+			// value is known without unpacking: the samples already went through
+			// float. The loop processes four samples per iteration and measures
+			// the range in float, converting once at the end, instead of round
+			// tripping every sample through the unpack and quat helpers.
+			Vector4_32 sample_min = vector_set(1e10f);
+			Vector4_32 sample_max = vector_set(-1e10f);
 
-			// We expect all our samples to have the same width of sizeof(Vector4_64)
-			ACL_ENSURE(bone_stream.rotations.get_sample_size() == sizeof(Vector4_64), "Unexpected rotation sample size. %u != %u", bone_stream.rotations.get_sample_size(), sizeof(Vector4_64));
+			uint32_t num_batched_samples = num_samples & ~3;
+			for (uint32_t sample_index = 0; sample_index < num_batched_samples; sample_index += 4)
+			{
+				Vector4_32 rotation0 = quat_to_vector(quat_cast(raw_rotations.get_sample(sample_index + 0)));
+				Vector4_32 rotation1 = quat_to_vector(quat_cast(raw_rotations.get_sample(sample_index + 1)));
+				Vector4_32 rotation2 = quat_to_vector(quat_cast(raw_rotations.get_sample(sample_index + 2)));
+				Vector4_32 rotation3 = quat_to_vector(quat_cast(raw_rotations.get_sample(sample_index + 3)));
 
-			uint32_t num_samples = bone_stream.rotations.get_num_samples();
-			TrackStream quantized_stream(allocator, num_samples, get_packed_rotation_size(rotation_format));
+				if (rotation_format == RotationFormat8::Quat_128)
+				{
+					pack_vector4_128(rotation0, quantized_stream.get_sample_ptr(sample_index + 0));
+					pack_vector4_128(rotation1, quantized_stream.get_sample_ptr(sample_index + 1));
+					pack_vector4_128(rotation2, quantized_stream.get_sample_ptr(sample_index + 2));
+					pack_vector4_128(rotation3, quantized_stream.get_sample_ptr(sample_index + 3));
+				}
+				else
+				{
+					pack_vector3_96(rotation0, quantized_stream.get_sample_ptr(sample_index + 0));
+					pack_vector3_96(rotation1, quantized_stream.get_sample_ptr(sample_index + 1));
+					pack_vector3_96(rotation2, quantized_stream.get_sample_ptr(sample_index + 2));
+					pack_vector3_96(rotation3, quantized_stream.get_sample_ptr(sample_index + 3));
 
-			Vector4_64 rotation_min = vector_set(1e10);
-			Vector4_64 rotation_max = vector_set(-1e10);
+					// unpack_vector3_96 returns a zero w
+					Vector4_32 mask_w = vector_set(1.0f, 1.0f, 1.0f, 0.0f);
+					rotation0 = vector_mul(rotation0, mask_w);
+					rotation1 = vector_mul(rotation1, mask_w);
+					rotation2 = vector_mul(rotation2, mask_w);
+					rotation3 = vector_mul(rotation3, mask_w);
+				}
+
+				sample_min = vector_min(sample_min, vector_min(vector_min(rotation0, rotation1), vector_min(rotation2, rotation3)));
+				sample_max = vector_max(sample_max, vector_max(vector_max(rotation0, rotation1), vector_max(rotation2, rotation3)));
+			}
+
+			for (uint32_t sample_index = num_batched_samples; sample_index < num_samples; ++sample_index)
+			{
+				Vector4_32 rotation = quat_to_vector(quat_cast(raw_rotations.get_sample(sample_index)));
+				uint8_t* quantized_ptr = quantized_stream.get_sample_ptr(sample_index);
+
+				if (rotation_format == RotationFormat8::Quat_128)
+					pack_vector4_128(rotation, quantized_ptr);
+				else
+				{
+					pack_vector3_96(rotation, quantized_ptr);
+					rotation = vector_mul(rotation, vector_set(1.0f, 1.0f, 1.0f, 0.0f));
+				}
 
+				sample_min = vector_min(sample_min, rotation);
+				sample_max = vector_max(sample_max, rotation);
+			}
+
+			rotation_min = vector_cast(sample_min);
+			rotation_max = vector_cast(sample_max);
+		}
+		else
+		{
 			for (uint32_t sample_index = 0; sample_index < num_samples; ++sample_index)
 			{
-				Quat_64 rotation = bone_stream.rotations.get_sample<Quat_64>(sample_index);
+				Quat_64 rotation = raw_rotations.get_sample(sample_index);
 				uint8_t* quantized_ptr = quantized_stream.get_sample_ptr(sample_index);
 
 				switch (rotation_format)
 				{
-				case RotationFormat8::Quat_128:
-					pack_vector4_128(quat_to_vector(quat_cast(rotation)), quantized_ptr);
-					rotation = quat_cast(vector_to_quat(unpack_vector4_128(quantized_ptr)));
-					break;
-				case RotationFormat8::Quat_96:
-					pack_vector3_96(quat_to_vector(quat_cast(rotation)), quantized_ptr);
-					rotation = quat_cast(vector_to_quat(unpack_vector3_96(quantized_ptr)));
-					break;
 				case RotationFormat8::Quat_48:
 					pack_vector3_48(quat_to_vector(quat_cast(rotation)), quantized_ptr);
 					rotation = quat_cast(vector_to_quat(unpack_vector3_48(quantized_ptr)));
@@ -76,68 +130,128 @@ namespace acl
 					rotation = quat_cast(vector_to_quat(unpack_vector3_32<11, 11, 10>(quantized_ptr)));
 					break;
 				default:
-					ACL_ENSURE(false, "Invalid or unsupported rotation format: %s", get_rotation_format_name(format));
+					ACL_ENSURE(false, "Invalid or unsupported rotation format: %s", get_rotation_format_name(rotation_format));
 					break;
 				}
 
 				rotation_min = vector_min(rotation_min, quat_to_vector(rotation));
 				rotation_max = vector_max(rotation_max, quat_to_vector(rotation));
 			}
-
-			bone_stream.rotations = std::move(quantized_stream);
-			//bone_stream.rotation_range = TrackStreamRange(rotation_min, rotation_max);
 		}
+
+		bone_stream.rotations = std::move(quantized_stream);
+		//bone_stream.rotation_range = TrackStreamRange(rotation_min, rotation_max);
 	}
 
-	inline void quantize_translation_streams(Allocator& allocator, BoneStreams* bone_streams, uint16_t num_bones, VectorFormat8 translation_format)
+	inline void quantize_translation_stream(Allocator& allocator, BoneStreams& bone_stream, VectorFormat8 translation_format)
 	{
-		// By the time we get here, values have been converted to their final format, and normalized if selected
-		for (uint16_t bone_index = 0; bone_index < num_bones; ++bone_index)
-		{
-			BoneStreams& bone_stream = bone_streams[bone_index];
+		// We expect all our samples to have the same width of sizeof(Vector4_64)
+		ConstTypedTrackStream<Vector4_64> raw_translations(bone_stream.translations);
 
-			// We expect all our samples to have the same width of sizeof(Vector4_64)
-			ACL_ENSURE(bone_stream.translations.get_sample_size() == sizeof(Vector4_64), "Unexpected translation sample size. %u != %u", bone_stream.translations.get_sample_size(), sizeof(Vector4_64));
+		// Constant translation tracks store the remaining sample with full precision
+		VectorFormat8 format = bone_stream.is_translation_animated() ? translation_format : VectorFormat8::Vector3_96;
 
-			// Constant translation tracks store the remaining sample with full precision
-			VectorFormat8 format = bone_stream.is_translation_animated() ? translation_format : VectorFormat8::Vector3_96;
+		uint32_t num_samples = raw_translations.get_num_samples();
+		TrackStream quantized_stream(allocator, num_samples, get_packed_vector_size(format));
 
-			uint32_t num_samples = bone_stream.translations.get_num_samples();
-			TrackStream quantized_stream(allocator, num_samples, get_packed_vector_size(format));
+		Vector4_64 translation_min = vector_set(1e10);
+		Vector4_64 translation_max = vector_set(-1e10);
 
-			Vector4_64 translation_min = vector_set(1e10);
-			Vector4_64 translation_max = vector_set(-1e10);
+		for (uint32_t sample_index = 0; sample_index < num_samples; ++sample_index)
+		{
+			Vector4_64 translation = raw_translations.get_sample(sample_index);
+			uint8_t* quantized_ptr = quantized_stream.get_sample_ptr(sample_index);
 
-			for (uint32_t sample_index = 0; sample_index < num_samples; ++sample_index)
+			switch (format)
 			{
-				Vector4_64 translation = bone_stream.translations.get_sample<Vector4_64>(sample_index);
-				uint8_t* quantized_ptr = quantized_stream.get_sample_ptr(sample_index);
+			case VectorFormat8::Vector3_96:
+				pack_vector3_96(vector_cast(translation), quantized_ptr);
+				translation = vector_cast(unpack_vector3_96(quantized_ptr));
+				break;
+			case VectorFormat8::Vector3_48:
+				pack_vector3_48(vector_cast(translation), quantized_ptr);
+				translation = vector_cast(unpack_vector3_48(quantized_ptr));
+				break;
+			case VectorFormat8::Vector3_32:
+				pack_vector3_32<11, 11, 10>(vector_cast(translation), quantized_ptr);
+				translation = vector_cast(unpack_vector3_32<11, 11, 10>(quantized_ptr));
+				break;
+			default:
+				ACL_ENSURE(false, "Invalid or unsupported vector format: %s", get_vector_format_name(format));
+				break;
+			}
 
-				switch (format)
-				{
-				case VectorFormat8::Vector3_96:
-					pack_vector3_96(vector_cast(translation), quantized_ptr);
-					translation = vector_cast(unpack_vector3_96(quantized_ptr));
-					break;
-				case VectorFormat8::Vector3_48:
-					pack_vector3_48(vector_cast(translation), quantized_ptr);
-					translation = vector_cast(unpack_vector3_48(quantized_ptr));
-					break;
-				case VectorFormat8::Vector3_32:
-					pack_vector3_32<11, 11, 10>(vector_cast(translation), quantized_ptr);
-					translation = vector_cast(unpack_vector3_32<11, 11, 10>(quantized_ptr));
-					break;
-				default:
-					ACL_ENSURE(false, "Invalid or unsupported vector format: %s", get_vector_format_name(format));
-					break;
-				}
+			translation_min = vector_min(translation_min, translation);
+			translation_max = vector_max(translation_max, translation);
+		}
 
-				translation_min = vector_min(translation_min, translation);
-				translation_max = vector_max(translation_max, translation);
-			}
+		bone_stream.translations = std::move(quantized_stream);
+		//bone_stream.translation_range = TrackStreamRange(translation_min, translation_max);
+	}
 
-			bone_stream.translations = std::move(quantized_stream);
-			//bone_stream.translation_range = TrackStreamRange(translation_min, translation_max);
+	inline void quantize_scale_stream(Allocator& allocator, BoneStreams& bone_stream)
+	{
+		// We expect all our samples to have the same width of sizeof(Vector4_64)
+		ConstTypedTrackStream<Vector4_64> raw_scales(bone_stream.scales);
+
+		// Scale tracks always store their samples with full precision, they are
+		// few and small errors multiply through the hierarchy
+		uint32_t num_samples = raw_scales.get_num_samples();
+		TrackStream quantized_stream(allocator, num_samples, get_packed_vector_size(VectorFormat8::Vector3_96));
+
+		for (uint32_t sample_index = 0; sample_index < num_samples; ++sample_index)
+		{
+			Vector4_64 scale = raw_scales.get_sample(sample_index);
+			uint8_t* quantized_ptr = quantized_stream.get_sample_ptr(sample_index);
+
+			pack_vector3_96(vector_cast(scale), quantized_ptr);
 		}
+
+		bone_stream.scales = std::move(quantized_stream);
+	}
+
+	inline void quantize_rotation_streams(Allocator& allocator, BoneStreams* bone_streams, uint16_t num_bones, RotationFormat8 rotation_format, ITaskScheduler* task_scheduler = nullptr)
+	{
+		// By the time we get here, values have been converted to their final format, and normalized if selected.
+		// Every track is independent, the only shared state is the allocator which must be thread safe.
+		parallel_tasks(task_scheduler, num_bones, [&allocator, bone_streams, rotation_format](uint32_t bone_index)
+		{
+			quantize_rotation_stream(allocator, bone_streams[bone_index], rotation_format);
+		});
+	}
+
+	inline void quantize_translation_streams(Allocator& allocator, BoneStreams* bone_streams, uint16_t num_bones, VectorFormat8 translation_format, ITaskScheduler* task_scheduler = nullptr)
+	{
+		// By the time we get here, values have been converted to their final format, and normalized if selected.
+		// Every track is independent, the only shared state is the allocator which must be thread safe.
+		parallel_tasks(task_scheduler, num_bones, [&allocator, bone_streams, translation_format](uint32_t bone_index)
+		{
+			quantize_translation_stream(allocator, bone_streams[bone_index], translation_format);
+		});
+	}
+
+	inline void quantize_scale_streams(Allocator& allocator, BoneStreams* bone_streams, uint16_t num_bones, ITaskScheduler* task_scheduler = nullptr)
+	{
+		parallel_tasks(task_scheduler, num_bones, [&allocator, bone_streams](uint32_t bone_index)
+		{
+			if (bone_streams[bone_index].has_scale)
+				quantize_scale_stream(allocator, bone_streams[bone_index]);
+		});
+	}
+
+	// Delta encoded clips pack their animated samples at write time straight from the
+	// normalized streams, only the constant and default tracks are quantized in place here
+	inline void quantize_constant_streams(Allocator& allocator, BoneStreams* bone_streams, uint16_t num_bones, RotationFormat8 rotation_format, VectorFormat8 translation_format, ITaskScheduler* task_scheduler = nullptr)
+	{
+		parallel_tasks(task_scheduler, num_bones, [&allocator, bone_streams, rotation_format, translation_format](uint32_t bone_index)
+		{
+			BoneStreams& bone_stream = bone_streams[bone_index];
+
+			if (!bone_stream.is_rotation_animated())
+				quantize_rotation_stream(allocator, bone_stream, rotation_format);
+
+			if (!bone_stream.is_translation_animated())
+				quantize_translation_stream(allocator, bone_stream, translation_format);
+		});
 	}
 }
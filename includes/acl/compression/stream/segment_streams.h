@@ -0,0 +1,110 @@
+#pragma once
+
+////////////////////////////////////////////////////////////////////////////////
+// The MIT License (MIT)
+//
+// Copyright (c) 2017 Nicholas Frechette & Animation Compression Library contributors
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+////////////////////////////////////////////////////////////////////////////////
+
+#include "acl/core/memory.h"
+#include "acl/core/error.h"
+#include "acl/math/vector4_64.h"
+#include "acl/compression/stream/track_stream.h"
+
+#include <stdint.h>
+#include <algorithm>
+#include <cstring>
+
+namespace acl
+{
+	//////////////////////////////////////////////////////////////////////////
+	// A segment is a self contained slice of the clip: its own samples and its
+	// own track ranges. Consecutive segments overlap by one sample so that any
+	// interpolation key frame pair always lives within a single segment, which
+	// keeps a seek within one set of pages and lets every segment carry its
+	// own range data.
+	//////////////////////////////////////////////////////////////////////////
+	struct ClipSegment
+	{
+		BoneStreams* bone_streams;
+		uint32_t first_sample_index;
+		uint32_t num_samples;
+	};
+
+	constexpr uint32_t calculate_num_segments(uint32_t num_samples, uint32_t num_samples_per_segment)
+	{
+		return num_samples_per_segment == 0 || num_samples <= 1 ? 1 : (((num_samples - 1) + num_samples_per_segment - 1) / num_samples_per_segment);
+	}
+
+	inline TrackStream extract_track_stream_segment(Allocator& allocator, const TrackStream& stream, uint32_t first_sample_index, uint32_t num_samples, TrackStreamRange& out_range)
+	{
+		// We expect all our samples to have the same width of sizeof(Vector4_64)
+		ACL_ENSURE(stream.get_sample_size() == sizeof(Vector4_64), "Unexpected sample size. %u != %u", stream.get_sample_size(), sizeof(Vector4_64));
+
+		// Constant and default streams store a single sample which every segment shares
+		uint32_t num_stream_samples = stream.get_num_samples();
+		uint32_t first = num_stream_samples == 1 ? 0 : first_sample_index;
+		uint32_t count = num_stream_samples == 1 ? 1 : num_samples;
+		ACL_ENSURE(first + count <= num_stream_samples, "Invalid segment sample range. %u > %u", first + count, num_stream_samples);
+
+		TrackStream segment_stream(allocator, count, stream.get_sample_size());
+		std::memcpy(segment_stream.get_raw_data(), stream.get_sample_ptr(first), size_t(stream.get_sample_size()) * count);
+
+		// The range comes from a single linear pass over the copied samples
+		out_range = extract_track_stream_range(segment_stream);
+		return segment_stream;
+	}
+
+	inline ClipSegment* segment_streams(Allocator& allocator, const BoneStreams* bone_streams, uint16_t num_bones, uint32_t num_samples, uint32_t num_samples_per_segment, uint32_t num_segments)
+	{
+		ACL_ENSURE(num_samples_per_segment > 0, "Invalid segment size: %u", num_samples_per_segment);
+		ACL_ENSURE(num_segments == calculate_num_segments(num_samples, num_samples_per_segment), "Unexpected number of segments. %u != %u", num_segments, calculate_num_segments(num_samples, num_samples_per_segment));
+
+		ClipSegment* segments = allocate_type_array<ClipSegment>(allocator, num_segments);
+
+		for (uint32_t segment_index = 0; segment_index < num_segments; ++segment_index)
+		{
+			ClipSegment& segment = segments[segment_index];
+			segment.first_sample_index = segment_index * num_samples_per_segment;
+			// +1 overlap so both interpolation key frames always land in this segment
+			segment.num_samples = std::min(num_samples_per_segment + 1, num_samples - segment.first_sample_index);
+			segment.bone_streams = allocate_type_array<BoneStreams>(allocator, num_bones);
+
+			for (uint16_t bone_index = 0; bone_index < num_bones; ++bone_index)
+			{
+				const BoneStreams& bone_stream = bone_streams[bone_index];
+				BoneStreams& segment_bone_stream = segment.bone_streams[bone_index];
+
+				segment_bone_stream.rotations = extract_track_stream_segment(allocator, bone_stream.rotations, segment.first_sample_index, segment.num_samples, segment_bone_stream.rotation_range);
+				segment_bone_stream.translations = extract_track_stream_segment(allocator, bone_stream.translations, segment.first_sample_index, segment.num_samples, segment_bone_stream.translation_range);
+
+				segment_bone_stream.is_rotation_constant = bone_stream.is_rotation_constant;
+				segment_bone_stream.is_rotation_default = bone_stream.is_rotation_default;
+				segment_bone_stream.is_translation_constant = bone_stream.is_translation_constant;
+				segment_bone_stream.is_translation_default = bone_stream.is_translation_default;
+				segment_bone_stream.are_rotations_normalized = bone_stream.are_rotations_normalized;
+				segment_bone_stream.are_translations_normalized = bone_stream.are_translations_normalized;
+			}
+		}
+
+		return segments;
+	}
+}
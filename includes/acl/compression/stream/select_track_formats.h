@@ -0,0 +1,363 @@
+#pragma once
+
+////////////////////////////////////////////////////////////////////////////////
+// The MIT License (MIT)
+//
+// Copyright (c) 2017 Nicholas Frechette & Animation Compression Library contributors
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+////////////////////////////////////////////////////////////////////////////////
+
+#include "acl/core/memory.h"
+#include "acl/core/error.h"
+#include "acl/core/enum_utils.h"
+#include "acl/core/algorithm_types.h"
+#include "acl/math/quat_32.h"
+#include "acl/math/quat_packing.h"
+#include "acl/math/vector4_32.h"
+#include "acl/math/vector4_packing.h"
+#include "acl/math/transform_32.h"
+#include "acl/math/transform_64.h"
+#include "acl/compression/animation_clip.h"
+#include "acl/compression/skeleton.h"
+#include "acl/compression/skeleton_error_metric.h"
+#include "acl/compression/stream/track_stream.h"
+
+#include <stdint.h>
+
+namespace acl
+{
+	// Formats chosen for a single bone by the variable quantization search
+	struct BoneTrackFormats
+	{
+		RotationFormat8 rotation_format;
+		VectorFormat8 translation_format;
+	};
+
+	// Simulates quantizing then decoding a rotation sample with the given format,
+	// matching what the decoder will reconstruct bit for bit
+	inline Quat_32 simulate_quantized_rotation(const BoneStreams& bone_stream, uint32_t sample_index, RotationFormat8 format)
+	{
+		if (bone_stream.is_rotation_default)
+			return quat_identity_32();
+
+		ConstTypedTrackStream<Vector4_64> rotations(bone_stream.rotations);
+
+		uint32_t num_samples = rotations.get_num_samples();
+		sample_index = sample_index < num_samples ? sample_index : num_samples - 1;
+
+		Vector4_64 sample = rotations.get_sample(sample_index);
+
+		alignas(16) uint8_t buffer[16];
+		Vector4_32 decoded;
+		switch (format)
+		{
+		case RotationFormat8::Quat_128:
+			pack_vector4_128(vector_cast(sample), &buffer[0]);
+			decoded = unpack_vector4_128(&buffer[0]);
+			break;
+		case RotationFormat8::Quat_96:
+			pack_vector3_96(vector_cast(sample), &buffer[0]);
+			decoded = unpack_vector3_96(&buffer[0]);
+			break;
+		case RotationFormat8::Quat_48:
+			pack_vector3_48(vector_cast(sample), &buffer[0]);
+			decoded = unpack_vector3_48(&buffer[0]);
+			break;
+		case RotationFormat8::Quat_32:
+			pack_vector3_32<11, 11, 10>(vector_cast(sample), &buffer[0]);
+			decoded = unpack_vector3_32<11, 11, 10>(&buffer[0]);
+			break;
+		default:
+			ACL_ENSURE(false, "Invalid or unsupported rotation format: %s", get_rotation_format_name(format));
+			decoded = vector_cast(sample);
+			break;
+		}
+
+		if (bone_stream.are_rotations_normalized)
+		{
+			Vector4_32 range_min = vector_cast(bone_stream.rotation_range.get_min());
+			Vector4_32 range_extent = vector_cast(bone_stream.rotation_range.get_extent());
+			decoded = vector_mul_add(decoded, range_extent, range_min);
+		}
+
+		if (format == RotationFormat8::Quat_128)
+			return vector_to_quat(decoded);
+
+		return quat_from_positive_w(decoded);
+	}
+
+	// Simulates quantizing then decoding a translation sample with the given format,
+	// matching what the decoder will reconstruct bit for bit
+	inline Vector4_32 simulate_quantized_translation(const BoneStreams& bone_stream, uint32_t sample_index, VectorFormat8 format)
+	{
+		if (bone_stream.is_translation_default)
+			return vector_zero_32();
+
+		// Constant translation tracks store the remaining sample with full precision
+		if (!bone_stream.is_translation_animated())
+			format = VectorFormat8::Vector3_96;
+
+		ConstTypedTrackStream<Vector4_64> translations(bone_stream.translations);
+
+		uint32_t num_samples = translations.get_num_samples();
+		sample_index = sample_index < num_samples ? sample_index : num_samples - 1;
+
+		Vector4_64 sample = translations.get_sample(sample_index);
+
+		alignas(16) uint8_t buffer[16];
+		Vector4_32 decoded;
+		switch (format)
+		{
+		case VectorFormat8::Vector3_96:
+			pack_vector3_96(vector_cast(sample), &buffer[0]);
+			decoded = unpack_vector3_96(&buffer[0]);
+			break;
+		case VectorFormat8::Vector3_48:
+			pack_vector3_48(vector_cast(sample), &buffer[0]);
+			decoded = unpack_vector3_48(&buffer[0]);
+			break;
+		case VectorFormat8::Vector3_32:
+			pack_vector3_32<11, 11, 10>(vector_cast(sample), &buffer[0]);
+			decoded = unpack_vector3_32<11, 11, 10>(&buffer[0]);
+			break;
+		default:
+			ACL_ENSURE(false, "Invalid or unsupported vector format: %s", get_vector_format_name(format));
+			decoded = vector_cast(sample);
+			break;
+		}
+
+		if (bone_stream.are_translations_normalized)
+		{
+			Vector4_32 range_min = vector_cast(bone_stream.translation_range.get_min());
+			Vector4_32 range_extent = vector_cast(bone_stream.translation_range.get_extent());
+			decoded = vector_mul_add(decoded, range_extent, range_min);
+		}
+
+		return decoded;
+	}
+
+	// Reconstructs the full precision value of a rotation sample in the domain the
+	// quantization simulation decodes into, without the quantization round trip.
+	// The streams were converted with Quat_96 so w comes back from the positive
+	// w hemisphere like the decoder does.
+	inline Quat_32 get_full_precision_rotation(const BoneStreams& bone_stream, uint32_t sample_index)
+	{
+		if (bone_stream.is_rotation_default)
+			return quat_identity_32();
+
+		ConstTypedTrackStream<Vector4_64> rotations(bone_stream.rotations);
+
+		uint32_t num_samples = rotations.get_num_samples();
+		sample_index = sample_index < num_samples ? sample_index : num_samples - 1;
+
+		Vector4_32 sample = vector_cast(rotations.get_sample(sample_index));
+
+		if (bone_stream.are_rotations_normalized)
+		{
+			Vector4_32 range_min = vector_cast(bone_stream.rotation_range.get_min());
+			Vector4_32 range_extent = vector_cast(bone_stream.rotation_range.get_extent());
+			sample = vector_mul_add(sample, range_extent, range_min);
+		}
+
+		return quat_from_positive_w(sample);
+	}
+
+	// Reconstructs the full precision value of a translation sample in the domain
+	// the quantization simulation decodes into, without the quantization round trip
+	inline Vector4_32 get_full_precision_translation(const BoneStreams& bone_stream, uint32_t sample_index)
+	{
+		if (bone_stream.is_translation_default)
+			return vector_zero_32();
+
+		ConstTypedTrackStream<Vector4_64> translations(bone_stream.translations);
+
+		uint32_t num_samples = translations.get_num_samples();
+		sample_index = sample_index < num_samples ? sample_index : num_samples - 1;
+
+		Vector4_32 sample = vector_cast(translations.get_sample(sample_index));
+
+		if (bone_stream.are_translations_normalized)
+		{
+			Vector4_32 range_min = vector_cast(bone_stream.translation_range.get_min());
+			Vector4_32 range_extent = vector_cast(bone_stream.translation_range.get_extent());
+			sample = vector_mul_add(sample, range_extent, range_min);
+		}
+
+		return sample;
+	}
+
+	// Searches for the cheapest format per track that keeps the skeleton error within
+	// the clip error threshold. Candidates are ordered cheapest first. Bones are
+	// processed parent first and each bone's chosen values are committed into the
+	// error metric base poses, so every bone is measured with the accumulated error
+	// of all the choices made above it instead of against pristine parents; the
+	// compounded error of the final format set stays within the threshold. The most
+	// precise candidate is kept when none passes.
+	//
+	// The unsigned packed formats require normalized values, so when range reduction
+	// is disabled the candidate list shrinks accordingly. Quat_128 is excluded when
+	// rotation range reduction is enabled so every rotation track shares the same
+	// range data size in the compressed stream.
+	//
+	// When measure_against_streams is set, the reference poses come from the full
+	// precision stream samples instead of the raw clip. Additive clips use it since
+	// their streams hold base relative deltas the raw clip no longer matches; the
+	// deltas are evaluated as if they were a pose, which bounds how the error
+	// propagates when the runtime applies them on top of a base.
+	inline void select_variable_track_formats(Allocator& allocator, const BoneStreams* bone_streams, uint16_t num_bones,
+		const AnimationClip& clip, const RigidSkeleton& skeleton, RangeReductionFlags8 range_reduction,
+		bool measure_against_streams, BoneTrackFormats* out_bone_formats)
+	{
+		ACL_ENSURE(num_bones == clip.get_num_bones(), "Unexpected number of bones. %u != %u", num_bones, clip.get_num_bones());
+
+		const bool are_rotations_normalized = are_enum_flags_set(range_reduction, RangeReductionFlags8::PerClip | RangeReductionFlags8::Rotations);
+		const bool are_translations_normalized = are_enum_flags_set(range_reduction, RangeReductionFlags8::PerClip | RangeReductionFlags8::Translations);
+
+		const RotationFormat8 rotation_candidates_normalized[] = { RotationFormat8::Quat_32, RotationFormat8::Quat_48, RotationFormat8::Quat_96 };
+		const RotationFormat8 rotation_candidates_raw[] = { RotationFormat8::Quat_96, RotationFormat8::Quat_128 };
+		const VectorFormat8 translation_candidates_normalized[] = { VectorFormat8::Vector3_32, VectorFormat8::Vector3_48, VectorFormat8::Vector3_96 };
+		const VectorFormat8 translation_candidates_raw[] = { VectorFormat8::Vector3_96 };
+
+		const RotationFormat8* rotation_candidates = are_rotations_normalized ? &rotation_candidates_normalized[0] : &rotation_candidates_raw[0];
+		uint32_t num_rotation_candidates = are_rotations_normalized ? 3 : 2;
+		const VectorFormat8* translation_candidates = are_translations_normalized ? &translation_candidates_normalized[0] : &translation_candidates_raw[0];
+		uint32_t num_translation_candidates = are_translations_normalized ? 3 : 1;
+
+		uint32_t num_samples = clip.get_num_samples();
+		double error_threshold = clip.get_error_threshold();
+
+		// The raw poses come from the clip, the lossy scratch poses start as their
+		// 32 bit cast and accumulate the chosen quantized values bone by bone
+		Transform_64* raw_poses = allocate_type_array<Transform_64>(allocator, size_t(num_samples) * num_bones);
+		Transform_32* lossy_poses = allocate_type_array<Transform_32>(allocator, size_t(num_samples) * num_bones);
+
+		const AnimatedBone* clip_bones = clip.get_bones();
+		for (uint32_t sample_index = 0; sample_index < num_samples; ++sample_index)
+		{
+			for (uint16_t bone_index = 0; bone_index < num_bones; ++bone_index)
+			{
+				Quat_64 rotation;
+				Vector4_64 translation;
+				if (measure_against_streams)
+				{
+					rotation = quat_cast(get_full_precision_rotation(bone_streams[bone_index], sample_index));
+					translation = vector_cast(get_full_precision_translation(bone_streams[bone_index], sample_index));
+				}
+				else
+				{
+					rotation = clip_bones[bone_index].rotation_track.get_sample(sample_index);
+					translation = clip_bones[bone_index].translation_track.get_sample(sample_index);
+				}
+
+				size_t pose_offset = (size_t(sample_index) * num_bones) + bone_index;
+				raw_poses[pose_offset] = transform_set(rotation, translation);
+				lossy_poses[pose_offset] = transform_cast(raw_poses[pose_offset]);
+			}
+		}
+
+		// Object space transforms of the raw poses and of the unmodified lossy poses
+		// are computed once; every candidate evaluation below alters a single bone
+		// and only pays for its subtree
+		SkeletonErrorMetricContext error_metric_context(allocator, skeleton);
+		error_metric_context.cache_base_poses(num_samples, raw_poses, lossy_poses);
+
+		for (uint16_t bone_index = 0; bone_index < num_bones; ++bone_index)
+		{
+			const BoneStreams& bone_stream = bone_streams[bone_index];
+
+			// Constant tracks are not normalized and store few samples, keep them at
+			// the most precise candidate instead of searching. Every candidate is
+			// evaluated, including the most precise one, so a fallback that fails
+			// the threshold is a measured fact and not an assumption
+			uint32_t num_rotation_searched = bone_stream.is_rotation_animated() ? num_rotation_candidates : 0;
+			uint32_t num_translation_searched = bone_stream.is_translation_animated() ? num_translation_candidates : 0;
+
+			// Rotation format search
+			RotationFormat8 chosen_rotation_format = rotation_candidates[num_rotation_candidates - 1];
+			for (uint32_t candidate_index = 0; candidate_index < num_rotation_searched; ++candidate_index)
+			{
+				RotationFormat8 candidate = rotation_candidates[candidate_index];
+
+				bool is_within_threshold = true;
+				for (uint32_t sample_index = 0; sample_index < num_samples && is_within_threshold; ++sample_index)
+				{
+					size_t pose_offset = (size_t(sample_index) * num_bones) + bone_index;
+					lossy_poses[pose_offset].rotation = simulate_quantized_rotation(bone_stream, sample_index, candidate);
+
+					const Transform_32* lossy_pose = &lossy_poses[size_t(sample_index) * num_bones];
+					is_within_threshold = error_metric_context.calculate_error_for_subtree(sample_index, bone_index, lossy_pose) <= error_threshold;
+				}
+
+				if (is_within_threshold)
+				{
+					chosen_rotation_format = candidate;
+					break;
+				}
+			}
+
+			// The translation search must see the chosen rotation, not the last
+			// candidate evaluated
+			for (uint32_t sample_index = 0; sample_index < num_samples; ++sample_index)
+			{
+				size_t pose_offset = (size_t(sample_index) * num_bones) + bone_index;
+				lossy_poses[pose_offset].rotation = simulate_quantized_rotation(bone_stream, sample_index, chosen_rotation_format);
+			}
+
+			// Translation format search
+			VectorFormat8 chosen_translation_format = translation_candidates[num_translation_candidates - 1];
+			for (uint32_t candidate_index = 0; candidate_index < num_translation_searched; ++candidate_index)
+			{
+				VectorFormat8 candidate = translation_candidates[candidate_index];
+
+				bool is_within_threshold = true;
+				for (uint32_t sample_index = 0; sample_index < num_samples && is_within_threshold; ++sample_index)
+				{
+					size_t pose_offset = (size_t(sample_index) * num_bones) + bone_index;
+					lossy_poses[pose_offset].translation = simulate_quantized_translation(bone_stream, sample_index, candidate);
+
+					const Transform_32* lossy_pose = &lossy_poses[size_t(sample_index) * num_bones];
+					is_within_threshold = error_metric_context.calculate_error_for_subtree(sample_index, bone_index, lossy_pose) <= error_threshold;
+				}
+
+				if (is_within_threshold)
+				{
+					chosen_translation_format = candidate;
+					break;
+				}
+			}
+
+			// Keep the chosen values and commit the bone into the base poses: the
+			// bones evaluated after this one measure against the accumulated error
+			// of every choice made so far instead of against a pristine parent chain
+			for (uint32_t sample_index = 0; sample_index < num_samples; ++sample_index)
+			{
+				size_t pose_offset = (size_t(sample_index) * num_bones) + bone_index;
+				lossy_poses[pose_offset].translation = simulate_quantized_translation(bone_stream, sample_index, chosen_translation_format);
+				error_metric_context.commit_base_pose_bone(sample_index, bone_index, &lossy_poses[size_t(sample_index) * num_bones]);
+			}
+
+			out_bone_formats[bone_index].rotation_format = chosen_rotation_format;
+			out_bone_formats[bone_index].translation_format = chosen_translation_format;
+		}
+
+		deallocate_type_array(allocator, raw_poses, size_t(num_samples) * num_bones);
+		deallocate_type_array(allocator, lossy_poses, size_t(num_samples) * num_bones);
+	}
+}
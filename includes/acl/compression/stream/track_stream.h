@@ -28,8 +28,10 @@
 #include "acl/core/error.h"
 #include "acl/math/quat_64.h"
 #include "acl/math/vector4_64.h"
+#include "acl/math/vector4_packing.h"
 
 #include <stdint.h>
+#include <cstring>
 
 namespace acl
 {
@@ -39,10 +41,12 @@ namespace acl
 		TrackStream() : m_allocator(nullptr), m_samples(nullptr), m_num_samples(0), m_sample_size(0) {}
 		TrackStream(Allocator& allocator, uint32_t num_samples, uint32_t sample_size)
 			: m_allocator(&allocator)
-			, m_samples(reinterpret_cast<uint8_t*>(allocator.allocate(sample_size * num_samples, 16)))
+			, m_samples(reinterpret_cast<uint8_t*>(allocator.allocate((sample_size * num_samples) + PACKED_DATA_TAIL_PADDING, 16)))
 			, m_num_samples(num_samples)
 			, m_sample_size(sample_size)
-		{}
+		{
+			std::memset(m_samples + (sample_size * num_samples), 0, PACKED_DATA_TAIL_PADDING);
+		}
 		TrackStream(const TrackStream&) = delete;
 
 		TrackStream(TrackStream&& other)
@@ -55,7 +59,7 @@ namespace acl
 		~TrackStream()
 		{
 			if (m_allocator != nullptr && m_num_samples != 0)
-				m_allocator->deallocate(m_samples, m_sample_size * m_num_samples);
+				m_allocator->deallocate(m_samples, (m_sample_size * m_num_samples) + PACKED_DATA_TAIL_PADDING);
 		}
 
 		TrackStream& operator=(const TrackStream&) = delete;
@@ -89,6 +93,13 @@ namespace acl
 			return *safe_ptr_cast<SampleType>(ptr);
 		}
 
+		template<typename SampleType>
+		SampleType get_sample(uint32_t sample_index) const
+		{
+			const uint8_t* ptr = get_sample_ptr(sample_index);
+			return *safe_ptr_cast<const SampleType>(ptr);
+		}
+
 		template<typename SampleType>
 		void set_sample(uint32_t sample_index, const SampleType& sample)
 		{
@@ -100,6 +111,22 @@ namespace acl
 		uint32_t get_num_samples() const { return m_num_samples; }
 		uint32_t get_sample_size() const { return m_sample_size; }
 
+		// The samples are contiguous, bulk passes can walk the raw buffer linearly
+		// instead of going through the per sample accessors
+		uint8_t* get_raw_data() { return m_samples; }
+		const uint8_t* get_raw_data() const { return m_samples; }
+
+		// Copy of this stream with the samples allocated from the provided allocator
+		TrackStream duplicate(Allocator& allocator) const
+		{
+			if (m_allocator == nullptr)
+				return TrackStream();
+
+			TrackStream copy(allocator, m_num_samples, m_sample_size);
+			std::memcpy(copy.m_samples, m_samples, size_t(m_sample_size) * m_num_samples);
+			return copy;
+		}
+
 	protected:
 		Allocator*	m_allocator;
 		uint8_t*	m_samples;
@@ -107,6 +134,78 @@ namespace acl
 		uint32_t	m_sample_size;
 	};
 
+	//////////////////////////////////////////////////////////////////////////
+	// Typed views over a track stream whose samples are known to hold SampleType,
+	// e.g. the full precision Quat_64/Vector4_64 streams before quantization.
+	// The stride is known at compile time and every access is a direct typed
+	// load or store, the runtime byte offset math and the per call sample size
+	// checks of the type erased accessors stay out of the inner loops.
+	// A view does not own its samples and is invalidated when the stream it was
+	// created from is moved or destroyed.
+	// The type erased TrackStream remains the storage and API boundary type,
+	// once quantized the streams hold packed samples with no matching type.
+	//////////////////////////////////////////////////////////////////////////
+	template<typename SampleType>
+	class ConstTypedTrackStream
+	{
+	public:
+		explicit ConstTypedTrackStream(const TrackStream& stream)
+			: m_samples(safe_ptr_cast<const SampleType>(stream.get_raw_data()))
+			, m_num_samples(stream.get_num_samples())
+		{
+			ACL_ENSURE(stream.get_sample_size() == sizeof(SampleType), "Unexpected sample size. %u != %u", stream.get_sample_size(), sizeof(SampleType));
+		}
+
+		SampleType get_sample(uint32_t sample_index) const
+		{
+			ACL_ENSURE(sample_index < m_num_samples, "Invalid sample index. %u >= %u", sample_index, m_num_samples);
+			return m_samples[sample_index];
+		}
+
+		uint32_t get_num_samples() const { return m_num_samples; }
+
+		// The samples are contiguous, vectorized passes can walk them linearly
+		const SampleType* get_raw_samples() const { return m_samples; }
+
+	private:
+		const SampleType*	m_samples;
+		uint32_t			m_num_samples;
+	};
+
+	template<typename SampleType>
+	class TypedTrackStream
+	{
+	public:
+		explicit TypedTrackStream(TrackStream& stream)
+			: m_samples(safe_ptr_cast<SampleType>(stream.get_raw_data()))
+			, m_num_samples(stream.get_num_samples())
+		{
+			ACL_ENSURE(stream.get_sample_size() == sizeof(SampleType), "Unexpected sample size. %u != %u", stream.get_sample_size(), sizeof(SampleType));
+		}
+
+		SampleType get_sample(uint32_t sample_index) const
+		{
+			ACL_ENSURE(sample_index < m_num_samples, "Invalid sample index. %u >= %u", sample_index, m_num_samples);
+			return m_samples[sample_index];
+		}
+
+		void set_sample(uint32_t sample_index, const SampleType& sample)
+		{
+			ACL_ENSURE(sample_index < m_num_samples, "Invalid sample index. %u >= %u", sample_index, m_num_samples);
+			m_samples[sample_index] = sample;
+		}
+
+		uint32_t get_num_samples() const { return m_num_samples; }
+
+		// The samples are contiguous, vectorized passes can walk them linearly
+		SampleType* get_raw_samples() { return m_samples; }
+		const SampleType* get_raw_samples() const { return m_samples; }
+
+	private:
+		SampleType*	m_samples;
+		uint32_t	m_num_samples;
+	};
+
 	// For a rotation track, the extent only tells us if the track is constant or not
 	// since the min/max we maintain aren't valid rotations.
 	// Similarly, the center isn't a valid rotation and is meaningless.
@@ -116,43 +215,86 @@ namespace acl
 		TrackStreamRange()
 			: m_min(vector_set(0.0))
 			, m_max(vector_set(0.0))
+			, m_reciprocal_extent(vector_set(0.0))
 		{}
 
 		TrackStreamRange(const Vector4_64& min, const Vector4_64& max)
 			: m_min(min)
 			, m_max(max)
-		{}
+		{
+			// Cached once so normalization multiplies per sample instead of dividing.
+			// Components with a degenerate extent normalize to 0.0, their reciprocal is zeroed.
+			Vector4_64 extent = vector_sub(max, min);
+			Vector4_64 is_extent_zero_mask = vector_less_than(extent, vector_set(0.000000001));
+			m_reciprocal_extent = vector_blend(is_extent_zero_mask, vector_zero_64(), vector_div(vector_set(1.0), extent));
+		}
 
 		Vector4_64 get_min() const { return m_min; }
 		Vector4_64 get_max() const { return m_max; }
 
 		Vector4_64 get_center() const { return vector_mul(vector_add(m_max, m_min), 0.5); }
 		Vector4_64 get_extent() const { return vector_sub(m_max, m_min); }
+		Vector4_64 get_reciprocal_extent() const { return m_reciprocal_extent; }
 
 		bool is_constant(double threshold) const { return vector_all_less_than(vector_abs(vector_sub(m_max, m_min)), vector_set(threshold)); }
 
 	private:
 		Vector4_64	m_min;
 		Vector4_64	m_max;
+		Vector4_64	m_reciprocal_extent;
 	};
 
+	// Computes the min/max of every track component in a single linear pass over
+	// the raw sample buffer
+	inline TrackStreamRange extract_track_stream_range(const TrackStream& stream)
+	{
+		// We expect all our samples to have the same width of sizeof(Vector4_64)
+		ConstTypedTrackStream<Vector4_64> typed_stream(stream);
+
+		const Vector4_64* samples = typed_stream.get_raw_samples();
+		uint32_t num_samples = typed_stream.get_num_samples();
+
+		Vector4_64 range_min = vector_set(1e10);
+		Vector4_64 range_max = vector_set(-1e10);
+
+		for (uint32_t sample_index = 0; sample_index < num_samples; ++sample_index)
+		{
+			range_min = vector_min(range_min, samples[sample_index]);
+			range_max = vector_max(range_max, samples[sample_index]);
+		}
+
+		return TrackStreamRange(range_min, range_max);
+	}
+
 	struct BoneStreams
 	{
 		TrackStream rotations;
 		TrackStream translations;
 
+		// Empty when the clip has no scale tracks, see has_scale below
+		TrackStream scales;
+
 		TrackStreamRange rotation_range;
 		TrackStreamRange translation_range;
+		TrackStreamRange scale_range;
 
 		bool is_rotation_constant;
 		bool is_rotation_default;
 		bool is_translation_constant;
 		bool is_translation_default;
+		bool is_scale_constant;
+		bool is_scale_default;
 		bool are_rotations_normalized;
 		bool are_translations_normalized;
 
+		// Scale is a clip wide property, every bone of a clip holds the same value.
+		// Without scale the flags above read as a default scale track so clips
+		// without scale carry zero per bone overhead in the compressed stream.
+		bool has_scale;
+
 		bool is_rotation_animated() const { return !is_rotation_constant && !is_rotation_default; }
 		bool is_translation_animated() const { return !is_translation_constant && !is_translation_default; }
+		bool is_scale_animated() const { return has_scale && !is_scale_constant && !is_scale_default; }
 	};
 
 }
@@ -0,0 +1,163 @@
+#pragma once
+
+////////////////////////////////////////////////////////////////////////////////
+// The MIT License (MIT)
+//
+// Copyright (c) 2017 Nicholas Frechette & Animation Compression Library contributors
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+////////////////////////////////////////////////////////////////////////////////
+
+#include "acl/core/memory.h"
+#include "acl/core/error.h"
+#include "acl/core/algorithm_types.h"
+#include "acl/compression/stream/track_stream.h"
+
+#include <stdint.h>
+
+namespace acl
+{
+	inline void duplicate_bone_streams(Allocator& allocator, const BoneStreams& source, BoneStreams& out_bone_streams)
+	{
+		out_bone_streams.rotations = source.rotations.duplicate(allocator);
+		out_bone_streams.translations = source.translations.duplicate(allocator);
+		out_bone_streams.scales = source.scales.duplicate(allocator);
+		out_bone_streams.rotation_range = source.rotation_range;
+		out_bone_streams.translation_range = source.translation_range;
+		out_bone_streams.scale_range = source.scale_range;
+		out_bone_streams.is_rotation_constant = source.is_rotation_constant;
+		out_bone_streams.is_rotation_default = source.is_rotation_default;
+		out_bone_streams.is_translation_constant = source.is_translation_constant;
+		out_bone_streams.is_translation_default = source.is_translation_default;
+		out_bone_streams.is_scale_constant = source.is_scale_constant;
+		out_bone_streams.is_scale_default = source.is_scale_default;
+		out_bone_streams.are_rotations_normalized = source.are_rotations_normalized;
+		out_bone_streams.are_translations_normalized = source.are_translations_normalized;
+		out_bone_streams.has_scale = source.has_scale;
+	}
+
+	//////////////////////////////////////////////////////////////////////////
+	// Persistent cache of fully processed per bone streams from the last
+	// compression of a clip. When the same clip is compressed again with the
+	// same settings, bones whose raw track samples did not change reuse their
+	// cached streams and skip the compression pipeline entirely, which keeps
+	// editor iteration fast when only a few bones are tweaked between exports.
+	// The caller owns the cache and keeps it alive across compressions.
+	//////////////////////////////////////////////////////////////////////////
+	class TrackStreamCache
+	{
+	public:
+		TrackStreamCache(Allocator& allocator)
+			: m_allocator(allocator)
+			, m_bone_streams(nullptr)
+			, m_track_hashes(nullptr)
+			, m_num_bones(0)
+			, m_num_samples(0)
+			, m_rotation_format(RotationFormat8::Quat_128)
+			, m_translation_format(VectorFormat8::Vector3_96)
+			, m_range_reduction(RangeReductionFlags8::None)
+			, m_is_initialized(false)
+		{}
+
+		~TrackStreamCache()
+		{
+			reset();
+		}
+
+		TrackStreamCache(const TrackStreamCache&) = delete;
+		TrackStreamCache& operator=(const TrackStreamCache&) = delete;
+
+		void reset()
+		{
+			if (m_bone_streams != nullptr)
+			{
+				deallocate_type_array(m_allocator, m_bone_streams, m_num_bones);
+				deallocate_type_array(m_allocator, m_track_hashes, size_t(m_num_bones) * 2);
+				m_bone_streams = nullptr;
+				m_track_hashes = nullptr;
+			}
+
+			m_num_bones = 0;
+			m_num_samples = 0;
+			m_is_initialized = false;
+		}
+
+		// The cached streams were processed with particular settings baked in,
+		// any mismatch invalidates every cached track
+		bool is_compatible(RotationFormat8 rotation_format, VectorFormat8 translation_format, RangeReductionFlags8 range_reduction, uint16_t num_bones, uint32_t num_samples) const
+		{
+			return m_is_initialized
+				&& m_rotation_format == rotation_format
+				&& m_translation_format == translation_format
+				&& m_range_reduction == range_reduction
+				&& m_num_bones == num_bones
+				&& m_num_samples == num_samples;
+		}
+
+		bool is_bone_unchanged(uint16_t bone_index, uint32_t rotation_hash, uint32_t translation_hash) const
+		{
+			ACL_ENSURE(bone_index < m_num_bones, "Invalid bone index. %u >= %u", bone_index, m_num_bones);
+			return m_track_hashes[(bone_index * 2) + 0] == rotation_hash && m_track_hashes[(bone_index * 2) + 1] == translation_hash;
+		}
+
+		const BoneStreams& get_bone_streams(uint16_t bone_index) const
+		{
+			ACL_ENSURE(bone_index < m_num_bones, "Invalid bone index. %u >= %u", bone_index, m_num_bones);
+			return m_bone_streams[bone_index];
+		}
+
+		// Replaces the cached streams with copies of the provided processed streams
+		void update(const BoneStreams* bone_streams, const uint32_t* track_hashes, uint16_t num_bones, uint32_t num_samples, RotationFormat8 rotation_format, VectorFormat8 translation_format, RangeReductionFlags8 range_reduction)
+		{
+			reset();
+
+			m_bone_streams = allocate_type_array<BoneStreams>(m_allocator, num_bones);
+			m_track_hashes = allocate_type_array<uint32_t>(m_allocator, size_t(num_bones) * 2);
+
+			for (uint16_t bone_index = 0; bone_index < num_bones; ++bone_index)
+			{
+				duplicate_bone_streams(m_allocator, bone_streams[bone_index], m_bone_streams[bone_index]);
+				m_track_hashes[(bone_index * 2) + 0] = track_hashes[(bone_index * 2) + 0];
+				m_track_hashes[(bone_index * 2) + 1] = track_hashes[(bone_index * 2) + 1];
+			}
+
+			m_num_bones = num_bones;
+			m_num_samples = num_samples;
+			m_rotation_format = rotation_format;
+			m_translation_format = translation_format;
+			m_range_reduction = range_reduction;
+			m_is_initialized = true;
+		}
+
+	private:
+		Allocator&				m_allocator;
+
+		BoneStreams*			m_bone_streams;
+		uint32_t*				m_track_hashes;		// 2 per bone: rotation, translation
+
+		uint16_t				m_num_bones;
+		uint32_t				m_num_samples;
+
+		RotationFormat8			m_rotation_format;
+		VectorFormat8			m_translation_format;
+		RangeReductionFlags8	m_range_reduction;
+
+		bool					m_is_initialized;
+	};
+}
@@ -53,9 +53,12 @@ namespace acl
 		return (rotation_size * num_animated_rotation_tracks) + (translation_size * num_animated_translation_tracks);
 	}
 
+	// The optional bone order maps output entries to bone stream indices, it is
+	// used to sort the compressed tracks by LOD tier. Every section of the
+	// compressed clip must use the same order; identity when null.
 	inline void write_range_track_data(const BoneStreams* bone_streams, uint16_t num_bones,
 		RangeReductionFlags8 range_reduction, RotationFormat8 rotation_format, VectorFormat8 translation_format,
-		uint8_t* range_data, uint32_t range_data_size)
+		uint8_t* range_data, uint32_t range_data_size, const uint16_t* bone_order)
 	{
 		const uint8_t* range_data_end = add_offset_to_ptr<uint8_t>(range_data, range_data_size);
 
@@ -65,8 +68,9 @@ namespace acl
 		rotation_size /= 2;
 		translation_size /= 2;
 
-		for (uint16_t bone_index = 0; bone_index < num_bones; ++bone_index)
+		for (uint16_t entry_index = 0; entry_index < num_bones; ++entry_index)
 		{
+			const uint16_t bone_index = bone_order != nullptr ? bone_order[entry_index] : entry_index;
 			const BoneStreams& bone_stream = bone_streams[bone_index];
 
 			// normalized value is between [0.0 .. 1.0]
@@ -33,36 +33,56 @@
 
 namespace acl
 {
-	inline void write_default_track_bitset(const BoneStreams* bone_streams, uint16_t num_bones, uint32_t* default_tracks_bitset, uint32_t bitset_size)
+	// The optional bone order maps output entries to bone stream indices, it is
+	// used to sort the compressed tracks by LOD tier. Every section of the
+	// compressed clip must use the same order; identity when null.
+	inline void write_default_track_bitset(const BoneStreams* bone_streams, uint16_t num_bones, uint32_t* default_tracks_bitset, uint32_t bitset_size, const uint16_t* bone_order)
 	{
 		ACL_ENSURE(bone_streams != nullptr, "'bone_streams' cannot be null!");
 		ACL_ENSURE(default_tracks_bitset != nullptr, "'default_tracks_bitset' cannot be null!");
 
-		uint32_t default_track_offset = 0;
-
 		bitset_reset(default_tracks_bitset, bitset_size, false);
 
-		for (uint16_t bone_index = 0; bone_index < num_bones; ++bone_index)
+		BitSetWriteCursor cursor = bitset_make_write_cursor(default_tracks_bitset, bitset_size, 0);
+		for (uint16_t entry_index = 0; entry_index < num_bones; ++entry_index)
 		{
+			const uint16_t bone_index = bone_order != nullptr ? bone_order[entry_index] : entry_index;
 			const BoneStreams& bone_stream = bone_streams[bone_index];
 
-			bitset_set(default_tracks_bitset, bitset_size, default_track_offset++, bone_stream.is_rotation_default);
-			bitset_set(default_tracks_bitset, bitset_size, default_track_offset++, bone_stream.is_translation_default);
+			bitset_set(cursor, bone_stream.is_rotation_default);
+			bitset_advance(cursor);
+			bitset_set(cursor, bone_stream.is_translation_default);
+			bitset_advance(cursor);
+
+			// Clips without scale have two tracks per bone, their bitsets carry no scale bits
+			if (bone_stream.has_scale)
+			{
+				bitset_set(cursor, bone_stream.is_scale_default);
+				bitset_advance(cursor);
+			}
 		}
 	}
 
-	inline void write_constant_track_bitset(const BoneStreams* bone_streams, uint16_t num_bones, uint32_t* constant_tracks_bitset, uint32_t bitset_size)
+	inline void write_constant_track_bitset(const BoneStreams* bone_streams, uint16_t num_bones, uint32_t* constant_tracks_bitset, uint32_t bitset_size, const uint16_t* bone_order)
 	{
-		uint32_t constant_track_offset = 0;
-
 		bitset_reset(constant_tracks_bitset, bitset_size, false);
 
-		for (uint16_t bone_index = 0; bone_index < num_bones; ++bone_index)
+		BitSetWriteCursor cursor = bitset_make_write_cursor(constant_tracks_bitset, bitset_size, 0);
+		for (uint16_t entry_index = 0; entry_index < num_bones; ++entry_index)
 		{
+			const uint16_t bone_index = bone_order != nullptr ? bone_order[entry_index] : entry_index;
 			const BoneStreams& bone_stream = bone_streams[bone_index];
 
-			bitset_set(constant_tracks_bitset, bitset_size, constant_track_offset++, bone_stream.is_rotation_constant);
-			bitset_set(constant_tracks_bitset, bitset_size, constant_track_offset++, bone_stream.is_translation_constant);
+			bitset_set(cursor, bone_stream.is_rotation_constant);
+			bitset_advance(cursor);
+			bitset_set(cursor, bone_stream.is_translation_constant);
+			bitset_advance(cursor);
+
+			if (bone_stream.has_scale)
+			{
+				bitset_set(cursor, bone_stream.is_scale_constant);
+				bitset_advance(cursor);
+			}
 		}
 	}
 }
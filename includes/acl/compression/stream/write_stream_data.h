@@ -28,19 +28,25 @@
 #include "acl/core/error.h"
 #include "acl/math/quat_64.h"
 #include "acl/math/quat_packing.h"
+#include "acl/math/vector4_32.h"
 #include "acl/math/vector4_64.h"
+#include "acl/math/vector4_packing.h"
 #include "acl/compression/stream/track_stream.h"
 
 #include <stdint.h>
 
 namespace acl
 {
-	inline void write_constant_track_data(const BoneStreams* bone_streams, uint16_t num_bones, uint8_t* constant_data, uint32_t constant_data_size)
+	// The optional bone order maps output entries to bone stream indices, it is
+	// used to sort the compressed tracks by LOD tier. Every section of the
+	// compressed clip must use the same order; identity when null.
+	inline void write_constant_track_data(const BoneStreams* bone_streams, uint16_t num_bones, uint8_t* constant_data, uint32_t constant_data_size, const uint16_t* bone_order)
 	{
 		const uint8_t* constant_data_end = add_offset_to_ptr<uint8_t>(constant_data, constant_data_size);
 
-		for (uint16_t bone_index = 0; bone_index < num_bones; ++bone_index)
+		for (uint16_t entry_index = 0; entry_index < num_bones; ++entry_index)
 		{
+			const uint16_t bone_index = bone_order != nullptr ? bone_order[entry_index] : entry_index;
 			const BoneStreams& bone_stream = bone_streams[bone_index];
 
 			if (!bone_stream.is_rotation_default && bone_stream.is_rotation_constant)
@@ -59,13 +65,21 @@ namespace acl
 				constant_data += sample_size;
 			}
 
+			if (bone_stream.has_scale && !bone_stream.is_scale_default && bone_stream.is_scale_constant)
+			{
+				const uint8_t* scale_ptr = bone_stream.scales.get_sample_ptr(0);
+				uint32_t sample_size = bone_stream.scales.get_sample_size();
+				memcpy(constant_data, scale_ptr, sample_size);
+				constant_data += sample_size;
+			}
+
 			ACL_ENSURE(constant_data <= constant_data_end, "Invalid constant data offset. Wrote too much data.");
 		}
 
 		ACL_ENSURE(constant_data == constant_data_end, "Invalid constant data offset. Wrote too little data.");
 	}
 
-	inline void write_animated_track_data(const BoneStreams* bone_streams, uint16_t num_bones, uint8_t* animated_track_data, uint32_t animated_data_size)
+	inline void write_animated_track_data(const BoneStreams* bone_streams, uint16_t num_bones, AnimationDataLayout8 data_layout, bool are_key_frames_paired, uint8_t* animated_track_data, uint32_t animated_data_size, const uint16_t* bone_order)
 	{
 		const uint8_t* animated_track_data_end = add_offset_to_ptr<uint8_t>(animated_track_data, animated_data_size);
 
@@ -75,6 +89,8 @@ namespace acl
 			const BoneStreams& bone_stream = bone_streams[bone_index];
 			num_samples = std::max(num_samples, bone_stream.rotations.get_num_samples());
 			num_samples = std::max(num_samples, bone_stream.translations.get_num_samples());
+			if (bone_stream.has_scale)
+				num_samples = std::max(num_samples, bone_stream.scales.get_num_samples());
 
 			if (num_samples != 1)
 				break;
@@ -82,12 +98,77 @@ namespace acl
 
 		ACL_ENSURE(num_samples > 1, "No samples to write!");
 
+		if (are_key_frames_paired)
+		{
+			// Key frame pairs are interleaved per track: samples 2k and 2k+1 are
+			// written back to back for every track so interpolating between two
+			// consecutive key frames reads one contiguous region instead of two
+			// regions a whole pose apart. The last sample is duplicated when the
+			// sample count is odd to complete the final pair.
+			const uint32_t num_pairs = (num_samples + 1) / 2;
+			for (uint32_t pair_index = 0; pair_index < num_pairs; ++pair_index)
+			{
+				const uint32_t sample_index0 = pair_index * 2;
+				const uint32_t sample_index1 = std::min(sample_index0 + 1, num_samples - 1);
+
+				for (uint16_t entry_index = 0; entry_index < num_bones; ++entry_index)
+				{
+					const uint16_t bone_index = bone_order != nullptr ? bone_order[entry_index] : entry_index;
+					const BoneStreams& bone_stream = bone_streams[bone_index];
+
+					if (bone_stream.is_rotation_animated())
+					{
+						uint32_t sample_size = bone_stream.rotations.get_sample_size();
+						memcpy(animated_track_data, bone_stream.rotations.get_sample_ptr(sample_index0), sample_size);
+						memcpy(animated_track_data + sample_size, bone_stream.rotations.get_sample_ptr(sample_index1), sample_size);
+						animated_track_data += sample_size * 2;
+					}
+
+					if (data_layout == AnimationDataLayout8::Interleaved && bone_stream.is_translation_animated())
+					{
+						uint32_t sample_size = bone_stream.translations.get_sample_size();
+						memcpy(animated_track_data, bone_stream.translations.get_sample_ptr(sample_index0), sample_size);
+						memcpy(animated_track_data + sample_size, bone_stream.translations.get_sample_ptr(sample_index1), sample_size);
+						animated_track_data += sample_size * 2;
+					}
+
+					ACL_ENSURE(animated_track_data <= animated_track_data_end, "Invalid animated track data offset. Wrote too much data.");
+				}
+
+				if (data_layout == AnimationDataLayout8::GroupedPerTrackType)
+				{
+					for (uint16_t entry_index = 0; entry_index < num_bones; ++entry_index)
+					{
+						const uint16_t bone_index = bone_order != nullptr ? bone_order[entry_index] : entry_index;
+						const BoneStreams& bone_stream = bone_streams[bone_index];
+
+						if (bone_stream.is_translation_animated())
+						{
+							uint32_t sample_size = bone_stream.translations.get_sample_size();
+							memcpy(animated_track_data, bone_stream.translations.get_sample_ptr(sample_index0), sample_size);
+							memcpy(animated_track_data + sample_size, bone_stream.translations.get_sample_ptr(sample_index1), sample_size);
+							animated_track_data += sample_size * 2;
+						}
+
+						ACL_ENSURE(animated_track_data <= animated_track_data_end, "Invalid animated track data offset. Wrote too much data.");
+					}
+				}
+			}
+
+			ACL_ENSURE(animated_track_data == animated_track_data_end, "Invalid animated track data offset. Wrote too little data.");
+			return;
+		}
+
 		// Data is sorted first by time, second by bone.
 		// This ensures that all bones are contiguous in memory when we sample a particular time.
+		// The interleaved layout alternates rotation and translation per bone while the grouped
+		// layout stores every rotation of a key frame followed by every translation, which gives
+		// the decoder two linear streams per key frame instead of one interleaved one.
 		for (uint32_t sample_index = 0; sample_index < num_samples; ++sample_index)
 		{
-			for (uint16_t bone_index = 0; bone_index < num_bones; ++bone_index)
+			for (uint16_t entry_index = 0; entry_index < num_bones; ++entry_index)
 			{
+				const uint16_t bone_index = bone_order != nullptr ? bone_order[entry_index] : entry_index;
 				const BoneStreams& bone_stream = bone_streams[bone_index];
 
 				if (bone_stream.is_rotation_animated())
@@ -98,7 +179,7 @@ namespace acl
 					animated_track_data += sample_size;
 				}
 
-				if (bone_stream.is_translation_animated())
+				if (data_layout == AnimationDataLayout8::Interleaved && bone_stream.is_translation_animated())
 				{
 					const uint8_t* translation_ptr = bone_stream.translations.get_sample_ptr(sample_index);
 					uint32_t sample_size = bone_stream.translations.get_sample_size();
@@ -106,10 +187,134 @@ namespace acl
 					animated_track_data += sample_size;
 				}
 
+				// Scale tracks are only supported with the interleaved layout, see compress_clip_impl
+				if (bone_stream.is_scale_animated())
+				{
+					const uint8_t* scale_ptr = bone_stream.scales.get_sample_ptr(sample_index);
+					uint32_t sample_size = bone_stream.scales.get_sample_size();
+					memcpy(animated_track_data, scale_ptr, sample_size);
+					animated_track_data += sample_size;
+				}
+
 				ACL_ENSURE(animated_track_data <= animated_track_data_end, "Invalid animated track data offset. Wrote too much data.");
 			}
+
+			if (data_layout == AnimationDataLayout8::GroupedPerTrackType)
+			{
+				for (uint16_t entry_index = 0; entry_index < num_bones; ++entry_index)
+				{
+					const uint16_t bone_index = bone_order != nullptr ? bone_order[entry_index] : entry_index;
+					const BoneStreams& bone_stream = bone_streams[bone_index];
+
+					if (bone_stream.is_translation_animated())
+					{
+						const uint8_t* translation_ptr = bone_stream.translations.get_sample_ptr(sample_index);
+						uint32_t sample_size = bone_stream.translations.get_sample_size();
+						memcpy(animated_track_data, translation_ptr, sample_size);
+						animated_track_data += sample_size;
+					}
+
+					ACL_ENSURE(animated_track_data <= animated_track_data_end, "Invalid animated track data offset. Wrote too much data.");
+				}
+			}
 		}
 
 		ACL_ENSURE(animated_track_data == animated_track_data_end, "Invalid animated track data offset. Wrote too little data.");
 	}
+
+	// Delta packs one normalized track into its per sample slots, see
+	// CompressionSettings::enable_delta_encoding. The refresh frame is absolute and
+	// stores 48 bits so it matches the precision of the Quat_48/Vector3_48 clip
+	// formats the delta guards require; every following sample stores a 32 bit
+	// delta from the previous reconstructed sample. The running reconstruction
+	// mirrors the decoder's accumulation exactly, float op for float op, so the
+	// quantization error never drifts beyond a single delta step.
+	inline void write_delta_track_data(const TrackStream& stream, uint8_t* refresh_data, uint8_t* delta_data, uint32_t animated_pose_size, uint32_t num_samples)
+	{
+		// We expect all our samples to have the same width of sizeof(Vector4_64)
+		ACL_ENSURE(stream.get_sample_size() == sizeof(Vector4_64), "Unexpected sample size. %u != %u", stream.get_sample_size(), sizeof(Vector4_64));
+		ACL_ENSURE(stream.get_num_samples() == num_samples, "Unexpected number of samples. %u != %u", stream.get_num_samples(), num_samples);
+
+		// The refresh frame is absolute
+		Vector4_32 sample = vector_cast(*safe_ptr_cast<const Vector4_64>(stream.get_sample_ptr(0)));
+		pack_vector3_48(sample, refresh_data);
+
+		Vector4_32 reconstructed = unpack_vector3_48(refresh_data);
+
+		for (uint32_t sample_index = 1; sample_index < num_samples; ++sample_index)
+		{
+			sample = vector_cast(*safe_ptr_cast<const Vector4_64>(stream.get_sample_ptr(sample_index)));
+			pack_delta_vector3_32(vector_sub(sample, reconstructed), delta_data);
+
+			reconstructed = vector_add(reconstructed, unpack_delta_vector3_32(delta_data));
+			delta_data += animated_pose_size;
+		}
+	}
+
+	// Writes the animated track data of a delta encoded clip. The output layout is
+	// the same pose major order the regular writer produces: a leading refresh
+	// pose with 48 bits per track followed by delta poses with 32 bits per track;
+	// the tracks are walked one at a time since each carries its own running
+	// reconstruction.
+	inline void write_delta_animated_track_data(const BoneStreams* bone_streams, uint16_t num_bones, AnimationDataLayout8 data_layout, uint8_t* animated_track_data, uint32_t animated_data_size, const uint16_t* bone_order)
+	{
+		uint32_t num_samples = 1;
+		uint32_t num_animated_rotation_tracks = 0;
+		uint32_t num_animated_translation_tracks = 0;
+		for (uint16_t bone_index = 0; bone_index < num_bones; ++bone_index)
+		{
+			const BoneStreams& bone_stream = bone_streams[bone_index];
+
+			if (bone_stream.is_rotation_animated())
+			{
+				num_samples = std::max(num_samples, bone_stream.rotations.get_num_samples());
+				num_animated_rotation_tracks++;
+			}
+
+			if (bone_stream.is_translation_animated())
+			{
+				num_samples = std::max(num_samples, bone_stream.translations.get_num_samples());
+				num_animated_translation_tracks++;
+			}
+		}
+
+		ACL_ENSURE(num_samples > 1, "No samples to write!");
+
+		const uint32_t animated_pose_size = (num_animated_rotation_tracks + num_animated_translation_tracks) * sizeof(uint32_t);
+		const uint32_t refresh_pose_size = (num_animated_rotation_tracks + num_animated_translation_tracks) * get_packed_vector_size(VectorFormat8::Vector3_48);
+		ACL_ENSURE(refresh_pose_size + (animated_pose_size * (num_samples - 1)) == animated_data_size, "Invalid animated data size. %u != %u", refresh_pose_size + (animated_pose_size * (num_samples - 1)), animated_data_size);
+
+		// With the grouped layout every rotation of a key frame precedes every translation,
+		// the pose stride is identical either way
+		const uint32_t rotation_group_size = num_animated_rotation_tracks * sizeof(uint32_t);
+
+		uint32_t rotation_track_offset = 0;
+		uint32_t translation_track_offset = data_layout == AnimationDataLayout8::GroupedPerTrackType ? rotation_group_size : 0;
+
+		for (uint16_t entry_index = 0; entry_index < num_bones; ++entry_index)
+		{
+			const uint16_t bone_index = bone_order != nullptr ? bone_order[entry_index] : entry_index;
+			const BoneStreams& bone_stream = bone_streams[bone_index];
+
+			// The refresh slots are wider than the delta slots, the slot index maps
+			// a delta pose offset to the matching refresh pose offset
+			if (bone_stream.is_rotation_animated())
+			{
+				uint8_t* refresh_data = animated_track_data + ((rotation_track_offset / sizeof(uint32_t)) * get_packed_vector_size(VectorFormat8::Vector3_48));
+				write_delta_track_data(bone_stream.rotations, refresh_data, animated_track_data + refresh_pose_size + rotation_track_offset, animated_pose_size, num_samples);
+				rotation_track_offset += sizeof(uint32_t);
+				if (data_layout == AnimationDataLayout8::Interleaved)
+					translation_track_offset += sizeof(uint32_t);
+			}
+
+			if (bone_stream.is_translation_animated())
+			{
+				uint8_t* refresh_data = animated_track_data + ((translation_track_offset / sizeof(uint32_t)) * get_packed_vector_size(VectorFormat8::Vector3_48));
+				write_delta_track_data(bone_stream.translations, refresh_data, animated_track_data + refresh_pose_size + translation_track_offset, animated_pose_size, num_samples);
+				translation_track_offset += sizeof(uint32_t);
+				if (data_layout == AnimationDataLayout8::Interleaved)
+					rotation_track_offset += sizeof(uint32_t);
+			}
+		}
+	}
 }
@@ -66,8 +66,47 @@ namespace acl
 		Vector3_96				= 0,	// Full precision vector3, [x,y,z] stored with float32
 		Vector3_48				= 1,	// Quantized vector3, [x,y,z] stored with [16,16,16] bits
 		Vector3_32				= 2,	// Quantized vector3, [x,y,z] stored with [11,11,10] bits
-		// TODO: Implement these
-		//Vector3_Variable,		// Quantized vector3, [x,y,z] stored with [N,N,N] bits (same number of bits per component)
+		Vector3_Variable		= 3,	// Quantized vector3, [x,y,z] stored with [N,N,N] bits from the bit rate palette (same number of bits per component)
+	};
+
+	//////////////////////////////////////////////////////////////////////////
+	// Bit rate palette for VectorFormat8::Vector3_Variable.
+	// A bit rate maps to a number of bits per component: rate 0 stores nothing,
+	// the component is constant within its range and the range data alone
+	// reconstructs it, rates 1 to 17 store 3 to 19 bits per component.
+	// BE CAREFUL WHEN CHANGING THE PALETTE
+	// The bit rate is serialized in the compressed data, if you change the mapping
+	// the compressed clips will be invalid. If you do, bump the appropriate algorithm versions.
+	//////////////////////////////////////////////////////////////////////////
+
+	constexpr uint8_t NUM_BIT_RATES = 18;
+	constexpr uint8_t INVALID_BIT_RATE = 0xFF;
+
+	constexpr uint8_t get_num_bits_at_bit_rate(uint8_t bit_rate)
+	{
+		return bit_rate == 0 ? 0 : (bit_rate + 2);
+	}
+
+	// BE CAREFUL WHEN CHANGING VALUES IN THIS ENUM
+	// The animation data layout is serialized in the compressed data, if you change a value
+	// the compressed clips will be invalid. If you do, bump the appropriate algorithm versions.
+	enum class AnimationDataLayout8 : uint8_t
+	{
+		Interleaved				= 0,	// Per key frame, each bone stores its rotation then its translation
+		GroupedPerTrackType		= 1,	// Per key frame, every rotation is contiguous followed by every translation
+	};
+
+	//////////////////////////////////////////////////////////////////////////
+	// Reference pose additive clips are encoded against, see
+	// CompressionSettings::additive_base_pose. Only whether the clip is
+	// additive is serialized, the reference pose itself stays on the
+	// compression side: the decoder emits the deltas as compressed and the
+	// runtime applies them on top of whatever base it blends with.
+	enum class AdditiveBasePose8 : uint8_t
+	{
+		None					= 0,	// Absolute clip, tracks store the authored samples
+		BindPose				= 1,	// Tracks store deltas from the skeleton bind pose
+		Custom					= 2,	// Tracks store deltas from caller supplied base transforms
 	};
 
 	// BE CAREFUL WHEN CHANGING VALUES IN THIS ENUM
@@ -85,11 +124,18 @@ namespace acl
 
 		// Flags to determine how range reduction behaves
 		PerClip					= 0x10,
-		//PerSegment				= 0x20,		// TODO: Implement this
+		PerSegment				= 0x20,		// Requires a segmented clip, see CompressionSettings::num_samples_per_segment
 	};
 
 	ACL_IMPL_ENUM_FLAGS_OPERATORS(RangeReductionFlags8)
 
+	// Whether range data is present in the compressed stream, either one block
+	// for the whole clip or one block per segment
+	constexpr bool has_per_block_range_reduction(RangeReductionFlags8 flags)
+	{
+		return is_enum_flag_set(flags, RangeReductionFlags8::PerClip) || is_enum_flag_set(flags, RangeReductionFlags8::PerSegment);
+	}
+
 	//////////////////////////////////////////////////////////////////////////
 
 	// TODO: constexpr
@@ -139,6 +185,30 @@ namespace acl
 		case VectorFormat8::Vector3_96:		return "Vector3 96";
 		case VectorFormat8::Vector3_48:		return "Vector3 48";
 		case VectorFormat8::Vector3_32:		return "Vector3 32";
+		case VectorFormat8::Vector3_Variable:	return "Vector3 Variable";
+		default:							return "<Invalid>";
+		}
+	}
+
+	// TODO: constexpr
+	inline const char* get_animation_data_layout_name(AnimationDataLayout8 layout)
+	{
+		switch (layout)
+		{
+		case AnimationDataLayout8::Interleaved:			return "Interleaved";
+		case AnimationDataLayout8::GroupedPerTrackType:	return "Grouped Per Track Type";
+		default:										return "<Invalid>";
+		}
+	}
+
+	// TODO: constexpr
+	inline const char* get_additive_base_pose_name(AdditiveBasePose8 base_pose)
+	{
+		switch (base_pose)
+		{
+		case AdditiveBasePose8::None:		return "None";
+		case AdditiveBasePose8::BindPose:	return "Bind Pose";
+		case AdditiveBasePose8::Custom:		return "Custom";
 		default:							return "<Invalid>";
 		}
 	}
@@ -156,6 +226,12 @@ namespace acl
 			return "Per Clip Translations";
 		case RangeReductionFlags8::PerClip | RangeReductionFlags8::Rotations | RangeReductionFlags8::Translations:
 			return "Per Clip Rotations, Translations";
+		case RangeReductionFlags8::PerSegment | RangeReductionFlags8::Rotations:
+			return "Per Segment Rotations";
+		case RangeReductionFlags8::PerSegment | RangeReductionFlags8::Translations:
+			return "Per Segment Translations";
+		case RangeReductionFlags8::PerSegment | RangeReductionFlags8::Rotations | RangeReductionFlags8::Translations:
+			return "Per Segment Rotations, Translations";
 		default:
 			return "<Invalid>";
 		}
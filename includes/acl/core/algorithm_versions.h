@@ -31,7 +31,12 @@
 namespace acl
 {
 	// Algorithm version numbers
-	static constexpr uint16_t ALGORITHM_VERSION_UNIFORMLY_SAMPLED		= 0;
+	// Version 1: the animated track data can live in a separate payload buffer
+	// Version 2: the animated track data can be delta encoded
+	// Version 3: the constant track data can live in a shared database pool
+	// Version 4: the clip can carry scale tracks
+	// Version 5: tracks can store deltas from a reference pose (additive clips)
+	static constexpr uint16_t ALGORITHM_VERSION_UNIFORMLY_SAMPLED		= 5;
 	//static constexpr uint16_t ALGORITHM_VERSION_LINEAR_KEY_REDUCTION	= 0;
 	//static constexpr uint16_t ALGORITHM_VERSION_SPLINE_KEY_REDUCTION	= 0;
 
@@ -0,0 +1,147 @@
+#pragma once
+
+////////////////////////////////////////////////////////////////////////////////
+// The MIT License (MIT)
+//
+// Copyright (c) 2017 Nicholas Frechette & Animation Compression Library contributors
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+////////////////////////////////////////////////////////////////////////////////
+
+#include "acl/core/memory.h"
+#include "acl/core/error.h"
+
+#include <stdint.h>
+#include <algorithm>
+#include <mutex>
+
+namespace acl
+{
+	//////////////////////////////////////////////////////////////////////////
+	// A linear/arena allocator for the transient data of a compression job.
+	// Allocations bump a pointer within large blocks grabbed from a backing
+	// allocator, individual deallocations are no-ops, and reset() releases
+	// every block at once when the job completes. This keeps the many small
+	// short lived stream buffers out of the system heap.
+	//
+	// Allocations take a short lock which keeps the arena usable with the
+	// parallel compression passes. The backing allocator is only hit when
+	// a new block is needed.
+	//////////////////////////////////////////////////////////////////////////
+	class ArenaAllocator final : public Allocator
+	{
+	public:
+		static constexpr size_t DEFAULT_BLOCK_SIZE = 1 * 1024 * 1024;
+
+		ArenaAllocator(Allocator& backing_allocator, size_t block_size = DEFAULT_BLOCK_SIZE)
+			: m_backing_allocator(backing_allocator)
+			, m_first_block(nullptr)
+			, m_current_block(nullptr)
+			, m_block_size(block_size)
+		{
+			ACL_ENSURE(block_size > sizeof(BlockHeader), "Arena block size is too small: %u", block_size);
+		}
+
+		virtual ~ArenaAllocator()
+		{
+			reset();
+		}
+
+		virtual void* allocate(size_t size, size_t alignment = DEFAULT_ALIGNMENT) override
+		{
+			ACL_ENSURE(is_power_of_two(alignment), "Invalid alignment: %u. Expected a power of two", alignment);
+
+			std::lock_guard<std::mutex> lock(m_mutex);
+
+			if (m_current_block != nullptr)
+			{
+				void* ptr = allocate_from_block(*m_current_block, size, alignment);
+				if (ptr != nullptr)
+					return ptr;
+			}
+
+			// Oversized allocations get a dedicated block
+			size_t new_block_size = std::max<size_t>(m_block_size, sizeof(BlockHeader) + size + alignment);
+			BlockHeader* new_block = reinterpret_cast<BlockHeader*>(m_backing_allocator.allocate(new_block_size, DEFAULT_ALIGNMENT));
+			new_block->next = nullptr;
+			new_block->block_size = new_block_size;
+			new_block->allocated_size = sizeof(BlockHeader);
+
+			if (m_current_block != nullptr)
+				m_current_block->next = new_block;
+			else
+				m_first_block = new_block;
+			m_current_block = new_block;
+
+			void* ptr = allocate_from_block(*new_block, size, alignment);
+			ACL_ENSURE(ptr != nullptr, "Failed to allocate %u bytes from a fresh arena block", size);
+			return ptr;
+		}
+
+		virtual void deallocate(void* ptr, size_t size) override
+		{
+			// Individual deallocations are no-ops, everything is released by reset()
+			(void)ptr;
+			(void)size;
+		}
+
+		// Releases every block back to the backing allocator
+		void reset()
+		{
+			std::lock_guard<std::mutex> lock(m_mutex);
+
+			BlockHeader* block = m_first_block;
+			while (block != nullptr)
+			{
+				BlockHeader* next_block = block->next;
+				m_backing_allocator.deallocate(block, block->block_size);
+				block = next_block;
+			}
+
+			m_first_block = nullptr;
+			m_current_block = nullptr;
+		}
+
+	private:
+		struct BlockHeader
+		{
+			BlockHeader*	next;
+			size_t			block_size;
+			size_t			allocated_size;
+		};
+
+		static void* allocate_from_block(BlockHeader& block, size_t size, size_t alignment)
+		{
+			uintptr_t block_start = reinterpret_cast<uintptr_t>(&block);
+			uintptr_t ptr = align_to(block_start + block.allocated_size, alignment);
+			uintptr_t new_allocated_size = (ptr + size) - block_start;
+			if (new_allocated_size > block.block_size)
+				return nullptr;
+
+			block.allocated_size = new_allocated_size;
+			return reinterpret_cast<void*>(ptr);
+		}
+
+		Allocator&		m_backing_allocator;
+		BlockHeader*	m_first_block;
+		BlockHeader*	m_current_block;
+		size_t			m_block_size;
+		std::mutex		m_mutex;
+	};
+}
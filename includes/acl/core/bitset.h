@@ -2,6 +2,10 @@
 
 #include "acl/core/error.h"
 
+#if defined(_MSC_VER)
+#include <intrin.h>
+#endif
+
 namespace acl
 {
 	constexpr uint32_t get_bitset_size(uint32_t num_bits)
@@ -22,7 +26,7 @@ namespace acl
 		ACL_ENSURE(bit_offset < (size * 32), "Invalid bit offset: %u > %u", bit_offset, size * 32);
 
 		uint32_t offset = bit_offset / 32;
-		uint32_t mask = 1 << (31 - (bit_offset - offset));
+		uint32_t mask = 1 << (31 - (bit_offset % 32));
 
 		if (value)
 			bitset[offset] |= mask;
@@ -35,8 +39,111 @@ namespace acl
 		ACL_ENSURE(bit_offset < (size * 32), "Invalid bit offset: %u > %u", bit_offset, size * 32);
 
 		uint32_t offset = bit_offset / 32;
-		uint32_t mask = 1 << (31 - (bit_offset - offset));
+		uint32_t mask = 1 << (31 - (bit_offset % 32));
 
 		return (bitset[offset] & mask) != 0;
 	}
+
+	// Sequential cursor over a bitset. The current word pointer and bit mask are
+	// precomputed when the cursor is made, advancing shifts the mask instead of
+	// dividing on every access. Bit offsets map to word bits from the most
+	// significant bit down, matching bitset_set and bitset_test above.
+	struct BitSetCursor
+	{
+		const uint32_t* word;
+		uint32_t mask;
+	};
+
+	// Same as BitSetCursor over a mutable bitset
+	struct BitSetWriteCursor
+	{
+		uint32_t* word;
+		uint32_t mask;
+	};
+
+	inline BitSetCursor bitset_make_cursor(const uint32_t* bitset, uint32_t size, uint32_t bit_offset)
+	{
+		// One past the last bit is a valid cursor position as long as it is never read
+		ACL_ENSURE(bit_offset <= (size * 32), "Invalid bit offset: %u > %u", bit_offset, size * 32);
+
+		BitSetCursor cursor;
+		cursor.word = bitset + (bit_offset / 32);
+		cursor.mask = 0x80000000 >> (bit_offset % 32);
+		return cursor;
+	}
+
+	inline BitSetWriteCursor bitset_make_write_cursor(uint32_t* bitset, uint32_t size, uint32_t bit_offset)
+	{
+		ACL_ENSURE(bit_offset <= (size * 32), "Invalid bit offset: %u > %u", bit_offset, size * 32);
+
+		BitSetWriteCursor cursor;
+		cursor.word = bitset + (bit_offset / 32);
+		cursor.mask = 0x80000000 >> (bit_offset % 32);
+		return cursor;
+	}
+
+	inline bool bitset_test(const BitSetCursor& cursor)
+	{
+		return (*cursor.word & cursor.mask) != 0;
+	}
+
+	inline void bitset_set(const BitSetWriteCursor& cursor, bool value)
+	{
+		if (value)
+			*cursor.word |= cursor.mask;
+		else
+			*cursor.word &= ~cursor.mask;
+	}
+
+	inline void bitset_advance(BitSetCursor& cursor)
+	{
+		cursor.mask >>= 1;
+		if (cursor.mask == 0)
+		{
+			cursor.mask = 0x80000000;
+			cursor.word++;
+		}
+	}
+
+	inline void bitset_advance(BitSetWriteCursor& cursor)
+	{
+		cursor.mask >>= 1;
+		if (cursor.mask == 0)
+		{
+			cursor.mask = 0x80000000;
+			cursor.word++;
+		}
+	}
+
+	inline uint32_t count_set_bits(uint32_t value)
+	{
+#if defined(_MSC_VER)
+		return __popcnt(value);
+#elif defined(__GNUC__) || defined(__clang__)
+		return __builtin_popcount(value);
+#else
+		value = value - ((value >> 1) & 0x55555555);
+		value = (value & 0x33333333) + ((value >> 2) & 0x33333333);
+		return (((value + (value >> 4)) & 0x0F0F0F0F) * 0x01010101) >> 24;
+#endif
+	}
+
+	// Counts the number of set bits among the first num_bits bits of the bitset
+	inline uint32_t bitset_count_set_bits(const uint32_t* bitset, uint32_t size, uint32_t num_bits)
+	{
+		ACL_ENSURE(num_bits <= (size * 32), "Invalid bit count: %u > %u", num_bits, size * 32);
+
+		uint32_t num_set_bits = 0;
+
+		uint32_t num_words = num_bits / 32;
+		for (uint32_t offset = 0; offset < num_words; ++offset)
+			num_set_bits += count_set_bits(bitset[offset]);
+
+		// Bit offsets map to word bits from the most significant bit down
+		uint32_t remainder = num_bits % 32;
+		if (remainder != 0)
+			num_set_bits += count_set_bits(bitset[num_words] & ~(0xFFFFFFFF >> remainder));
+
+		return num_set_bits;
+	}
 }
@@ -0,0 +1,42 @@
+#pragma once
+
+////////////////////////////////////////////////////////////////////////////////
+// The MIT License (MIT)
+//
+// Copyright (c) 2017 Nicholas Frechette & Animation Compression Library contributors
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+////////////////////////////////////////////////////////////////////////////////
+
+// To override these macros, simply define them before including headers from the library.
+
+// Forces the function inline past the compiler's heuristics. Used on the hot
+// per bone decompression functions: they are called once per track from the
+// decode loops and inlining them keeps the track cursors in registers. Like
+// any forced inlining this trades I-cache footprint for call overhead, the
+// annotated functions are small enough that it is a clear win.
+#if !defined(ACL_FORCE_INLINE)
+	#if defined(_MSC_VER)
+		#define ACL_FORCE_INLINE __forceinline
+	#elif defined(__GNUC__) || defined(__clang__)
+		#define ACL_FORCE_INLINE inline __attribute__((always_inline))
+	#else
+		#define ACL_FORCE_INLINE inline
+	#endif
+#endif
@@ -26,6 +26,7 @@
 
 #include "acl/core/memory.h"
 #include "acl/core/algorithm_versions.h"
+#include "acl/core/hash.h"
 
 #include <stdint.h>
 
@@ -52,7 +53,7 @@ namespace acl
 				return false;
 
 			if (check_crc)
-				return true;	// TODO: Implement
+				return m_crc32 == calculate_crc32();
 			return true;
 		}
 
@@ -61,13 +62,20 @@ namespace acl
 
 		CompressedClip(uint32_t size, AlgorithmType8 type)
 			: m_size(size)
-			, m_crc32(0)		// TODO: Implement
+			, m_crc32(0)		// Calculated by finalize_compressed_clip once the buffer content is final
 			, m_tag(COMPRESSED_CLIP_TAG)
 			, m_version(get_algorithm_version(type))
 			, m_type(type)
 			, m_padding(0)
 		{}
 
+		uint32_t calculate_crc32() const
+		{
+			// Hash everything from the tag onwards, the size and hash themselves are excluded
+			const uint32_t hashed_offset = sizeof(m_size) + sizeof(m_crc32);
+			return crc32(add_offset_to_ptr<const uint8_t>(this, hashed_offset), m_size - hashed_offset);
+		}
+
 		// 16 byte header, the rest of the data follows in memory
 		uint32_t		m_size;
 		uint32_t		m_crc32;
@@ -84,4 +92,37 @@ namespace acl
 
 	static_assert(alignof(CompressedClip) == 16, "Invalid alignment for CompressedClip");
 	static_assert(sizeof(CompressedClip) == 16, "Invalid size for CompressedClip");
+
+	//////////////////////////////////////////////////////////////////////////
+	// Binds a compressed clip to an existing read-only buffer, e.g. a memory
+	// mapped file region, without copying or patching anything. The compressed
+	// format only uses offsets relative to the clip itself so decompression
+	// can read straight out of the mapped pages. Validates the header tag,
+	// the algorithm type and version, the recorded size against the provided
+	// buffer and the embedded content hash. Returns null if anything is off.
+	//
+	// The buffer must be 16 byte aligned, mapped pages always are.
+	//////////////////////////////////////////////////////////////////////////
+	inline const CompressedClip* bind_compressed_clip(const void* buffer, size_t buffer_size)
+	{
+		if (buffer == nullptr || buffer_size < sizeof(CompressedClip))
+			return nullptr;
+
+		const CompressedClip* clip = reinterpret_cast<const CompressedClip*>(buffer);
+		if (!is_aligned_to(clip, alignof(CompressedClip)))
+			return nullptr;
+
+		// The recorded size cannot be trusted until the header is validated,
+		// but reading it is safe since the buffer holds at least a full header
+		if (!clip->is_valid(false))
+			return nullptr;
+
+		if (clip->get_size() < sizeof(CompressedClip) || clip->get_size() > buffer_size)
+			return nullptr;
+
+		if (!clip->is_valid(true))
+			return nullptr;
+
+		return clip;
+	}
 }
@@ -0,0 +1,191 @@
+#pragma once
+
+////////////////////////////////////////////////////////////////////////////////
+// The MIT License (MIT)
+//
+// Copyright (c) 2017 Nicholas Frechette & Animation Compression Library contributors
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+////////////////////////////////////////////////////////////////////////////////
+
+#include "acl/core/memory.h"
+#include "acl/core/compressed_clip.h"
+#include "acl/core/hash.h"
+
+#include <stdint.h>
+
+namespace acl
+{
+	//////////////////////////////////////////////////////////////////////////
+	// Every clip of a character stores the same constant track values: the
+	// bind pose fingers and twist bones of a skeleton do not change between
+	// its clips. A clip database holds a batch of compressed clips sharing a
+	// skeleton with their constant track data split out into a single
+	// deduplicated pool; identical constant sections are stored once and
+	// every clip references its run by offset. See compress_clip_database.
+	//
+	// Memory layout:
+	//    CompressedClipDatabase
+	//    ClipDatabaseEntry entries[num_clips]
+	//    <deduplicated constant track data pool>
+	//    <compressed clips, 16 byte aligned>
+	//////////////////////////////////////////////////////////////////////////
+
+	struct ClipDatabaseEntry
+	{
+		uint32_t	clip_offset;			// From the start of the database, 16 byte aligned
+		uint32_t	constant_data_offset;	// From the start of the database, 0 when the clip has no constant track data
+	};
+
+	class alignas(16) CompressedClipDatabase
+	{
+	public:
+		uint32_t get_size() const { return m_size; }
+		uint32_t get_num_clips() const { return m_num_clips; }
+
+		bool is_valid(bool check_crc) const
+		{
+			if (!is_aligned_to(this, alignof(CompressedClipDatabase)))
+				return false;
+
+			if (m_tag != COMPRESSED_CLIP_DATABASE_TAG)
+				return false;
+
+			if (m_version != COMPRESSED_CLIP_DATABASE_VERSION)
+				return false;
+
+			if (check_crc)
+				return m_crc32 == calculate_crc32();
+			return true;
+		}
+
+		ClipDatabaseEntry* get_clip_entries() { return add_offset_to_ptr<ClipDatabaseEntry>(this, sizeof(CompressedClipDatabase)); }
+		const ClipDatabaseEntry* get_clip_entries() const { return add_offset_to_ptr<const ClipDatabaseEntry>(this, sizeof(CompressedClipDatabase)); }
+
+		const CompressedClip* get_clip(uint32_t clip_index) const
+		{
+			return add_offset_to_ptr<const CompressedClip>(this, get_clip_entries()[clip_index].clip_offset);
+		}
+
+		// Null when the clip has no constant track data
+		const uint8_t* get_clip_constant_data(uint32_t clip_index) const
+		{
+			const uint32_t constant_data_offset = get_clip_entries()[clip_index].constant_data_offset;
+			return constant_data_offset != 0 ? add_offset_to_ptr<const uint8_t>(this, constant_data_offset) : nullptr;
+		}
+
+	private:
+		// Distinct from COMPRESSED_CLIP_TAG and BINARY_CLIP_MAGIC so the formats
+		// can be told apart by sniffing the first four bytes
+		static constexpr uint32_t COMPRESSED_CLIP_DATABASE_TAG = 0xac12ac12;
+
+		// Database version numbers
+		// Version 1: initial format
+		static constexpr uint16_t COMPRESSED_CLIP_DATABASE_VERSION = 1;
+
+		CompressedClipDatabase(uint32_t size, uint32_t num_clips)
+			: m_size(size)
+			, m_crc32(0)		// Calculated by finalize_compressed_clip_database once the buffer content is final
+			, m_tag(COMPRESSED_CLIP_DATABASE_TAG)
+			, m_version(COMPRESSED_CLIP_DATABASE_VERSION)
+			, m_padding0(0)
+			, m_num_clips(num_clips)
+			, m_padding1(0)
+		{}
+
+		uint32_t calculate_crc32() const
+		{
+			// Hash everything from the tag onwards, the size and hash themselves are excluded
+			const uint32_t hashed_offset = sizeof(m_size) + sizeof(m_crc32);
+			return crc32(add_offset_to_ptr<const uint8_t>(this, hashed_offset), m_size - hashed_offset);
+		}
+
+		// 24 byte header padded to the alignment, the rest of the data follows in memory
+		uint32_t		m_size;
+		uint32_t		m_crc32;
+
+		// Everything starting here is included in the CRC32
+		uint32_t		m_tag;
+		uint16_t		m_version;
+		uint16_t		m_padding0;
+		uint32_t		m_num_clips;
+		uint32_t		m_padding1;
+
+		friend CompressedClipDatabase* make_compressed_clip_database(void* buffer, uint32_t size, uint32_t num_clips);
+		friend void finalize_compressed_clip_database(CompressedClipDatabase& database);
+	};
+
+	static_assert(alignof(CompressedClipDatabase) == 16, "Invalid alignment for CompressedClipDatabase");
+	static_assert(sizeof(CompressedClipDatabase) == 32, "Invalid size for CompressedClipDatabase");
+
+	//////////////////////////////////////////////////////////////////////////
+	// Binds a clip database to an existing read-only buffer, e.g. a memory
+	// mapped file region, without copying or patching anything, mirroring
+	// bind_compressed_clip. Validates the database header, the recorded size
+	// against the provided buffer, the embedded content hash, and that every
+	// clip entry lies within the buffer and holds a valid clip header.
+	// Returns null if anything is off.
+	//
+	// The buffer must be 16 byte aligned, mapped pages always are.
+	//////////////////////////////////////////////////////////////////////////
+	inline const CompressedClipDatabase* bind_compressed_clip_database(const void* buffer, size_t buffer_size)
+	{
+		if (buffer == nullptr || buffer_size < sizeof(CompressedClipDatabase))
+			return nullptr;
+
+		const CompressedClipDatabase* database = reinterpret_cast<const CompressedClipDatabase*>(buffer);
+		if (!is_aligned_to(database, alignof(CompressedClipDatabase)))
+			return nullptr;
+
+		// The recorded size cannot be trusted until the header is validated,
+		// but reading it is safe since the buffer holds at least a full header
+		if (!database->is_valid(false))
+			return nullptr;
+
+		if (database->get_size() < sizeof(CompressedClipDatabase) || database->get_size() > buffer_size)
+			return nullptr;
+
+		if (!database->is_valid(true))
+			return nullptr;
+
+		const uint32_t num_clips = database->get_num_clips();
+		if (sizeof(CompressedClipDatabase) + (size_t(num_clips) * sizeof(ClipDatabaseEntry)) > database->get_size())
+			return nullptr;
+
+		const ClipDatabaseEntry* entries = database->get_clip_entries();
+		for (uint32_t clip_index = 0; clip_index < num_clips; ++clip_index)
+		{
+			const uint32_t clip_offset = entries[clip_index].clip_offset;
+			if (clip_offset < sizeof(CompressedClipDatabase) || clip_offset + sizeof(CompressedClip) > database->get_size())
+				return nullptr;
+
+			const CompressedClip* clip = database->get_clip(clip_index);
+			if (!clip->is_valid(false))
+				return nullptr;
+
+			if (clip_offset + clip->get_size() > database->get_size())
+				return nullptr;
+
+			if (entries[clip_index].constant_data_offset >= database->get_size())
+				return nullptr;
+		}
+
+		return database;
+	}
+}
@@ -0,0 +1,98 @@
+#pragma once
+
+////////////////////////////////////////////////////////////////////////////////
+// The MIT License (MIT)
+//
+// Copyright (c) 2017 Nicholas Frechette & Animation Compression Library contributors
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+////////////////////////////////////////////////////////////////////////////////
+
+#include "acl/core/memory.h"
+#include "acl/core/error.h"
+
+#include <stdint.h>
+#include <atomic>
+
+namespace acl
+{
+	//////////////////////////////////////////////////////////////////////////
+	// An allocator that forwards every request to a backing allocator and
+	// tracks how much memory flows through it: the live allocated size, its
+	// high water mark, the total number of bytes ever allocated, and the
+	// number of allocations. It is used to measure the transient memory a
+	// compression job needs without changing its behavior.
+	//
+	// The counters are atomic which keeps the wrapper usable with the
+	// parallel compression passes; thread safety of the allocations
+	// themselves is up to the backing allocator.
+	//////////////////////////////////////////////////////////////////////////
+	class CountingAllocator final : public Allocator
+	{
+	public:
+		CountingAllocator(Allocator& backing_allocator)
+			: m_backing_allocator(backing_allocator)
+			, m_allocated_size(0)
+			, m_peak_allocated_size(0)
+			, m_total_allocated_size(0)
+			, m_num_allocations(0)
+		{}
+
+		virtual void* allocate(size_t size, size_t alignment = DEFAULT_ALIGNMENT) override
+		{
+			void* ptr = m_backing_allocator.allocate(size, alignment);
+
+			const size_t allocated_size = m_allocated_size.fetch_add(size) + size;
+			m_total_allocated_size.fetch_add(size);
+			m_num_allocations.fetch_add(1);
+
+			size_t peak_allocated_size = m_peak_allocated_size.load();
+			while (allocated_size > peak_allocated_size && !m_peak_allocated_size.compare_exchange_weak(peak_allocated_size, allocated_size));
+
+			return ptr;
+		}
+
+		virtual void deallocate(void* ptr, size_t size) override
+		{
+			if (ptr == nullptr)
+				return;
+
+			m_backing_allocator.deallocate(ptr, size);
+			m_allocated_size.fetch_sub(size);
+		}
+
+		// Size of the live allocations in bytes
+		size_t get_allocated_size() const { return m_allocated_size.load(); }
+
+		// Largest live allocated size seen so far in bytes
+		size_t get_peak_allocated_size() const { return m_peak_allocated_size.load(); }
+
+		// Sum of every allocation ever made in bytes, deallocations do not shrink it
+		size_t get_total_allocated_size() const { return m_total_allocated_size.load(); }
+
+		size_t get_num_allocations() const { return m_num_allocations.load(); }
+
+	private:
+		Allocator&			m_backing_allocator;
+		std::atomic<size_t>	m_allocated_size;
+		std::atomic<size_t>	m_peak_allocated_size;
+		std::atomic<size_t>	m_total_allocated_size;
+		std::atomic<size_t>	m_num_allocations;
+	};
+}
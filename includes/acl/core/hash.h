@@ -0,0 +1,62 @@
+#pragma once
+
+////////////////////////////////////////////////////////////////////////////////
+// The MIT License (MIT)
+//
+// Copyright (c) 2017 Nicholas Frechette & Animation Compression Library contributors
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+////////////////////////////////////////////////////////////////////////////////
+
+#include <stdint.h>
+#include <cstddef>
+
+namespace acl
+{
+	// CRC-32 (reflected polynomial 0xEDB88320) over an arbitrary buffer.
+	// Used as the compressed clip content hash, not meant to be cryptographic.
+	// The lazily built table makes concurrent first calls write identical
+	// values which keeps this safe without synchronization.
+	inline uint32_t crc32(const void* buffer, size_t buffer_size, uint32_t seed = 0)
+	{
+		// Byte wise table driven implementation, the table is built on first use
+		static uint32_t crc_table[256];
+		static bool is_table_initialized = false;
+		if (!is_table_initialized)
+		{
+			for (uint32_t entry_index = 0; entry_index < 256; ++entry_index)
+			{
+				uint32_t entry = entry_index;
+				for (uint32_t bit_index = 0; bit_index < 8; ++bit_index)
+					entry = (entry >> 1) ^ ((entry & 1) != 0 ? 0xEDB88320 : 0);
+				crc_table[entry_index] = entry;
+			}
+
+			is_table_initialized = true;
+		}
+
+		const uint8_t* bytes = reinterpret_cast<const uint8_t*>(buffer);
+
+		uint32_t crc = ~seed;
+		for (size_t byte_index = 0; byte_index < buffer_size; ++byte_index)
+			crc = (crc >> 8) ^ crc_table[(crc ^ bytes[byte_index]) & 0xFF];
+
+		return ~crc;
+	}
+}
@@ -29,6 +29,7 @@
 #include "acl/core/algorithm_types.h"
 #include "acl/compression/skeleton.h"
 #include "acl/compression/animation_clip.h"
+#include "acl/compression/compression_stats.h"
 #include "acl/decompression/output_writer.h"
 #include "acl/math/transform_32.h"
 
@@ -42,9 +43,17 @@ namespace acl
 	public:
 		virtual ~IAlgorithm() {}
 
-		virtual CompressedClip* compress_clip(Allocator& allocator, const AnimationClip& clip, const RigidSkeleton& skeleton) = 0;
+		// The optional stats gather per pass times, transient memory figures,
+		// and per track format decisions for diagnostics
+		virtual CompressedClip* compress_clip(Allocator& allocator, const AnimationClip& clip, const RigidSkeleton& skeleton, CompressionStats* out_stats = nullptr) = 0;
 
 		virtual void decompress_pose(const CompressedClip& clip, float sample_time, Transform_32* out_transforms, uint16_t num_transforms) = 0;
+
+		// Batch variant of decompress_pose: samples the same clip at several times
+		// at once, out_poses holds one transform array per requested sample time.
+		// Implementations are free to reorder the requests for cache locality.
+		virtual void decompress_poses(Allocator& allocator, const CompressedClip& clip, const float* sample_times, uint32_t num_poses, Transform_32* const* out_poses, uint16_t num_transforms) = 0;
+
 		virtual void decompress_bone(const CompressedClip& clip, float sample_time, uint16_t sample_bone_index, Quat_32* out_rotation, Vector4_32* out_translation) = 0;
 
 		virtual void print_stats(const CompressedClip& clip, std::FILE* file) {}
@@ -26,12 +26,22 @@
 
 #include "acl/core/error.h"
 
+// Shipping builds that provide their own Allocator implementation can strip
+// the default one, malloc.h is then never included and the decompression
+// include graph stays free of the CRT allocation machinery
+#if !defined(ACL_NO_DEFAULT_ALLOCATOR)
 #include <malloc.h>
+#endif
+
 #include <stdint.h>
 #include <type_traits>
 #include <limits>
 #include <memory>
 
+#if (defined(_M_IX86) || defined(_M_X64) || defined(__SSE2__)) && !defined(ACL_NO_INTRINSICS)
+#include <xmmintrin.h>		// For _mm_prefetch
+#endif
+
 namespace acl
 {
 	constexpr bool is_power_of_two(size_t input)
@@ -58,6 +68,10 @@ namespace acl
 		Allocator(const Allocator&) = delete;
 		Allocator& operator=(const Allocator&) = delete;
 
+#if defined(ACL_NO_DEFAULT_ALLOCATOR)
+		virtual void* allocate(size_t size, size_t alignment = DEFAULT_ALIGNMENT) = 0;
+		virtual void deallocate(void* ptr, size_t size) = 0;
+#else
 		virtual void* allocate(size_t size, size_t alignment = DEFAULT_ALIGNMENT)
 		{
 			return _aligned_malloc(size, alignment);
@@ -70,6 +84,7 @@ namespace acl
 
 			_aligned_free(ptr);
 		}
+#endif
 	};
 
 	template<typename AllocatedType, typename... Args>
@@ -259,6 +274,33 @@ namespace acl
 
 	//////////////////////////////////////////////////////////////////////////
 
+	// Hints the hardware to pull the cache line holding the given address into
+	// the cache hierarchy. Prefetches never fault, any address is safe.
+	// Compiles to nothing on platforms without a prefetch instruction.
+	inline void memory_prefetch(const void* ptr)
+	{
+#if (defined(_M_IX86) || defined(_M_X64) || defined(__SSE2__)) && !defined(ACL_NO_INTRINSICS)
+		_mm_prefetch(reinterpret_cast<const char*>(ptr), _MM_HINT_T0);
+#elif defined(__GNUC__)
+		__builtin_prefetch(ptr, 0, 3);
+#else
+		(void)ptr;
+#endif
+	}
+
+	// Prefetches every cache line the given byte range touches
+	inline void memory_prefetch_range(const void* ptr, size_t size)
+	{
+		constexpr size_t CACHE_LINE_SIZE = 64;
+
+		const uint8_t* first_line = reinterpret_cast<const uint8_t*>(reinterpret_cast<uintptr_t>(ptr) & ~(CACHE_LINE_SIZE - 1));
+		const uint8_t* end = reinterpret_cast<const uint8_t*>(ptr) + size;
+		for (const uint8_t* line = first_line; line < end; line += CACHE_LINE_SIZE)
+			memory_prefetch(line);
+	}
+
+	//////////////////////////////////////////////////////////////////////////
+
 	struct InvalidPtrOffset {};
 
 	template<typename DataType, typename OffsetType>
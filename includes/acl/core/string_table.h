@@ -0,0 +1,122 @@
+#pragma once
+
+////////////////////////////////////////////////////////////////////////////////
+// The MIT License (MIT)
+//
+// Copyright (c) 2017 Nicholas Frechette & Animation Compression Library contributors
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+////////////////////////////////////////////////////////////////////////////////
+
+#include "acl/core/memory.h"
+#include "acl/core/error.h"
+#include "acl/core/hash.h"
+#include "acl/core/arena_allocator.h"
+#include "acl/core/string_view.h"
+
+#include <cstring>
+
+namespace acl
+{
+	//////////////////////////////////////////////////////////////////////////
+	// Interning pool for strings. Identical strings always return the same
+	// characters, so views handed out by the table compare by pointer identity
+	// and the characters of the whole pool live in one arena instead of one
+	// heap allocation per string. Bone names are the main client: skeletons
+	// loaded from thousands of clips share a handful of name sets.
+	// Interned strings never go away before the table does.
+	//////////////////////////////////////////////////////////////////////////
+	class StringTable
+	{
+	public:
+		StringTable(Allocator& allocator, uint32_t num_buckets = 1024)
+			: m_allocator(allocator)
+			, m_arena(allocator, 64 * 1024)
+			, m_buckets(allocate_type_array<Entry*>(allocator, num_buckets))
+			, m_num_buckets(num_buckets)
+			, m_num_strings(0)
+		{
+			ACL_ENSURE(is_power_of_two(num_buckets), "Invalid number of buckets: %u. Expected a power of two", num_buckets);
+
+			for (uint32_t bucket_index = 0; bucket_index < num_buckets; ++bucket_index)
+				m_buckets[bucket_index] = nullptr;
+		}
+
+		~StringTable()
+		{
+			// The entries live in the arena which releases them all at once
+			deallocate_type_array(m_allocator, m_buckets, m_num_buckets);
+		}
+
+		StringTable(const StringTable&) = delete;
+		StringTable& operator=(const StringTable&) = delete;
+
+		// Returns a view of the interned copy, null terminated so the
+		// characters can be handed to C APIs
+		StringView intern(const char* str, size_t length)
+		{
+			uint32_t hash = crc32(str, length);
+			uint32_t bucket_index = hash & (m_num_buckets - 1);
+
+			for (Entry* entry = m_buckets[bucket_index]; entry != nullptr; entry = entry->next)
+			{
+				if (entry->hash == hash && entry->length == length && std::memcmp(entry->get_chars(), str, length) == 0)
+					return StringView(entry->get_chars(), length);
+			}
+
+			Entry* entry = reinterpret_cast<Entry*>(m_arena.allocate(sizeof(Entry) + length + 1, alignof(Entry)));
+			entry->next = m_buckets[bucket_index];
+			entry->hash = hash;
+			entry->length = safe_static_cast<uint32_t>(length);
+
+			char* chars = entry->get_chars();
+			std::memcpy(chars, str, length);
+			chars[length] = '\0';
+
+			m_buckets[bucket_index] = entry;
+			++m_num_strings;
+
+			return StringView(chars, length);
+		}
+
+		StringView intern(const StringView& view) { return intern(view.get_chars(), view.get_length()); }
+		StringView intern(const char* str) { return intern(str, str != nullptr ? std::strlen(str) : 0); }
+
+		uint32_t get_num_strings() const { return m_num_strings; }
+
+	private:
+		struct Entry
+		{
+			Entry*		next;
+			uint32_t	hash;
+			uint32_t	length;
+			// The characters follow the entry in the arena
+
+			char* get_chars() { return reinterpret_cast<char*>(this + 1); }
+			const char* get_chars() const { return reinterpret_cast<const char*>(this + 1); }
+		};
+
+		Allocator&		m_allocator;
+		ArenaAllocator	m_arena;
+
+		Entry**			m_buckets;
+		uint32_t		m_num_buckets;
+		uint32_t		m_num_strings;
+	};
+}
@@ -0,0 +1,195 @@
+#pragma once
+
+////////////////////////////////////////////////////////////////////////////////
+// The MIT License (MIT)
+//
+// Copyright (c) 2017 Nicholas Frechette & Animation Compression Library contributors
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+////////////////////////////////////////////////////////////////////////////////
+
+#include "acl/core/error.h"
+
+#include <stdint.h>
+#include <atomic>
+#include <condition_variable>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace acl
+{
+	//////////////////////////////////////////////////////////////////////////
+	// This interface allows the compression passes to dispatch their per-track
+	// work on a user provided scheduler (e.g. a game engine job system).
+	// Implementations must execute every task index exactly once and must not
+	// return from dispatch before every task completed.
+	// This is only used by the compression side, decompression never allocates
+	// nor spawns any work.
+	//////////////////////////////////////////////////////////////////////////
+	class ITaskScheduler
+	{
+	public:
+		virtual ~ITaskScheduler() {}
+
+		virtual void dispatch(uint32_t num_tasks, const std::function<void(uint32_t)>& task) = 0;
+	};
+
+	//////////////////////////////////////////////////////////////////////////
+	// A simple internal thread pool for callers without a job system of their
+	// own. The dispatching thread participates in the work and waits for every
+	// task to complete before returning.
+	//////////////////////////////////////////////////////////////////////////
+	class ThreadPoolTaskScheduler final : public ITaskScheduler
+	{
+	public:
+		explicit ThreadPoolTaskScheduler(uint32_t num_threads)
+			: m_task(nullptr)
+			, m_num_tasks(0)
+			, m_generation(0)
+			, m_next_task_index(0)
+			, m_num_completed_tasks(0)
+			, m_num_active_workers(0)
+			, m_is_running(true)
+		{
+			ACL_ENSURE(num_threads != 0, "A thread pool requires at least one thread");
+
+			m_threads.reserve(num_threads);
+			for (uint32_t thread_index = 0; thread_index < num_threads; ++thread_index)
+				m_threads.emplace_back([this]() { worker_loop(); });
+		}
+
+		~ThreadPoolTaskScheduler()
+		{
+			{
+				std::unique_lock<std::mutex> lock(m_mutex);
+				m_is_running = false;
+			}
+			m_wake_signal.notify_all();
+
+			for (std::thread& thread : m_threads)
+				thread.join();
+		}
+
+		ThreadPoolTaskScheduler(const ThreadPoolTaskScheduler&) = delete;
+		ThreadPoolTaskScheduler& operator=(const ThreadPoolTaskScheduler&) = delete;
+
+		virtual void dispatch(uint32_t num_tasks, const std::function<void(uint32_t)>& task) override
+		{
+			if (num_tasks == 0)
+				return;
+
+			{
+				std::unique_lock<std::mutex> lock(m_mutex);
+
+				// Make sure no worker is still draining a previous dispatch before we reset the counters
+				m_done_signal.wait(lock, [this]() { return m_num_active_workers.load() == 0; });
+
+				m_task = &task;
+				m_num_tasks = num_tasks;
+				m_next_task_index.store(0);
+				m_num_completed_tasks.store(0);
+				m_generation++;
+			}
+			m_wake_signal.notify_all();
+
+			// The dispatching thread participates in the work
+			execute_tasks(task, num_tasks);
+
+			std::unique_lock<std::mutex> lock(m_mutex);
+			m_done_signal.wait(lock, [this, num_tasks]() { return m_num_completed_tasks.load() >= num_tasks; });
+			m_task = nullptr;
+		}
+
+	private:
+		void worker_loop()
+		{
+			uint32_t last_generation = 0;
+			while (true)
+			{
+				const std::function<void(uint32_t)>* task;
+				uint32_t num_tasks;
+
+				{
+					std::unique_lock<std::mutex> lock(m_mutex);
+					m_wake_signal.wait(lock, [this, last_generation]() { return !m_is_running || (m_task != nullptr && m_generation != last_generation); });
+
+					if (!m_is_running)
+						return;
+
+					last_generation = m_generation;
+					task = m_task;
+					num_tasks = m_num_tasks;
+					m_num_active_workers.fetch_add(1);
+				}
+
+				execute_tasks(*task, num_tasks);
+
+				{
+					std::unique_lock<std::mutex> lock(m_mutex);
+					m_num_active_workers.fetch_sub(1);
+				}
+				m_done_signal.notify_all();
+			}
+		}
+
+		void execute_tasks(const std::function<void(uint32_t)>& task, uint32_t num_tasks)
+		{
+			while (true)
+			{
+				uint32_t task_index = m_next_task_index.fetch_add(1);
+				if (task_index >= num_tasks)
+					break;
+
+				task(task_index);
+
+				if (m_num_completed_tasks.fetch_add(1) + 1 >= num_tasks)
+					m_done_signal.notify_all();
+			}
+		}
+
+		std::vector<std::thread>				m_threads;
+		std::mutex								m_mutex;
+		std::condition_variable					m_wake_signal;
+		std::condition_variable					m_done_signal;
+
+		const std::function<void(uint32_t)>*	m_task;
+		uint32_t								m_num_tasks;
+		uint32_t								m_generation;
+		std::atomic<uint32_t>					m_next_task_index;
+		std::atomic<uint32_t>					m_num_completed_tasks;
+		std::atomic<uint32_t>					m_num_active_workers;
+		bool									m_is_running;
+	};
+
+	// Dispatches num_tasks on the provided scheduler, or runs them inline on the
+	// calling thread when no scheduler is provided or the work is trivial
+	template<typename FunctionType>
+	inline void parallel_tasks(ITaskScheduler* task_scheduler, uint32_t num_tasks, FunctionType&& task_fn)
+	{
+		if (task_scheduler == nullptr || num_tasks <= 1)
+		{
+			for (uint32_t task_index = 0; task_index < num_tasks; ++task_index)
+				task_fn(task_index);
+		}
+		else
+			task_scheduler->dispatch(num_tasks, std::function<void(uint32_t)>(std::forward<FunctionType>(task_fn)));
+	}
+}
@@ -0,0 +1,47 @@
+#pragma once
+
+////////////////////////////////////////////////////////////////////////////////
+// The MIT License (MIT)
+//
+// Copyright (c) 2017 Nicholas Frechette & Animation Compression Library contributors
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+////////////////////////////////////////////////////////////////////////////////
+
+//////////////////////////////////////////////////////////////////////////
+// Single include for runtime pose decompression. Pulls in only the decoder
+// and its dependencies: none of the compression, IO, SJSON, or stats
+// headers, and nothing that touches stdio.
+//
+// For shipping builds, define before including any library header:
+//    ACL_NO_ERROR_CHECKS         every ACL_ENSURE/ACL_ASSERT in the decode
+//                                path compiles to nothing and assert.h is
+//                                never included, no checks remain in the
+//                                per bone loops
+//    ACL_NO_DEFAULT_ALLOCATOR    malloc.h is never included, Allocator
+//                                becomes pure virtual and the runtime
+//                                provides its own implementation
+//
+// With both defined the decompression include graph is free of the CRT
+// stdio, assert, and allocation machinery. The hot per bone decode
+// functions are annotated with ACL_FORCE_INLINE, see acl/core/compiler.h.
+//////////////////////////////////////////////////////////////////////////
+
+#include "acl/algorithm/uniformly_sampled/decoder.h"
+#include "acl/decompression/output_writer.h"
@@ -36,7 +36,13 @@ namespace acl
 	// the callbacks can trivially be inlined.
 	struct OutputWriter
 	{
-		// TODO: use constexpr flags to control if we extract rotation only, translation only, etc.
+		// Channel mask. Override these in your writer to control which channels are
+		// extracted; the decoder skips the unpack, range expansion, and interpolation
+		// of unwanted channels entirely, not just the store. Keep the overrides
+		// constexpr and the skipped code is stripped at compile time.
+		constexpr bool are_rotations_wanted() const { return true; }
+		constexpr bool are_translations_wanted() const { return true; }
+		constexpr bool are_scales_wanted() const { return true; }
 
 		void write_bone_rotation(uint32_t bone_index, const Quat_32& rotation)
 		{
@@ -45,5 +51,60 @@ namespace acl
 		void write_bone_translation(uint32_t bone_index, const Vector4_32& translation)
 		{
 		}
+
+		// Only called for clips compressed with scale tracks
+		void write_bone_scale(uint32_t bone_index, const Vector4_32& scale)
+		{
+		}
+	};
+
+	//////////////////////////////////////////////////////////////////////////
+	// Writes the decompressed pose directly into caller owned SoA planes, one
+	// float array per component, the layout blending runtimes consume. No AoS
+	// pose is materialized and no conversion pass runs afterwards. The caller
+	// owns the arrays and each must hold one float per bone; planes of masked
+	// out channels are never touched and can be null.
+	// The channel mask is a template argument so a rotation only blend
+	// instantiates a decompressor that never unpacks translations at all.
+	//////////////////////////////////////////////////////////////////////////
+	template<bool rotations_wanted = true, bool translations_wanted = true>
+	struct SoAOutputWriter : public OutputWriter
+	{
+		float* rotations_x;
+		float* rotations_y;
+		float* rotations_z;
+		float* rotations_w;
+
+		float* translations_x;
+		float* translations_y;
+		float* translations_z;
+
+		SoAOutputWriter()
+			: rotations_x(nullptr)
+			, rotations_y(nullptr)
+			, rotations_z(nullptr)
+			, rotations_w(nullptr)
+			, translations_x(nullptr)
+			, translations_y(nullptr)
+			, translations_z(nullptr)
+		{}
+
+		constexpr bool are_rotations_wanted() const { return rotations_wanted; }
+		constexpr bool are_translations_wanted() const { return translations_wanted; }
+
+		void write_bone_rotation(uint32_t bone_index, const Quat_32& rotation)
+		{
+			rotations_x[bone_index] = quat_get_x(rotation);
+			rotations_y[bone_index] = quat_get_y(rotation);
+			rotations_z[bone_index] = quat_get_z(rotation);
+			rotations_w[bone_index] = quat_get_w(rotation);
+		}
+
+		void write_bone_translation(uint32_t bone_index, const Vector4_32& translation)
+		{
+			translations_x[bone_index] = vector_get_x(translation);
+			translations_y[bone_index] = vector_get_y(translation);
+			translations_z[bone_index] = vector_get_z(translation);
+		}
 	};
 }
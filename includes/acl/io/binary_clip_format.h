@@ -0,0 +1,85 @@
+#pragma once
+
+////////////////////////////////////////////////////////////////////////////////
+// The MIT License (MIT)
+//
+// Copyright (c) 2017 Nicholas Frechette & Animation Compression Library contributors
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+////////////////////////////////////////////////////////////////////////////////
+
+#include <stdint.h>
+#include <cstring>
+
+//////////////////////////////////////////////////////////////////////////
+// Versioned little-endian binary variant of the ACL intermediate format.
+// Same logical schema as the SJSON text format but with no text parsing:
+// a clip header, the skeleton bones, then the raw per bone rotation and
+// translation tracks as doubles, ready to be copied straight into the
+// AnimationTrack buffers.
+//
+// File layout:
+//    BinaryClipHeader
+//    clip name bytes (clip_name_length, not null terminated)
+//    For every bone:
+//       BinaryClipBone
+//       bone name bytes (name_length, not null terminated)
+//    For every bone:
+//       num_samples * 4 doubles of rotations (x, y, z, w)
+//       num_samples * 3 doubles of translations (x, y, z)
+//
+// Structures are read and written with memcpy, alignment in the file is
+// not required.
+//////////////////////////////////////////////////////////////////////////
+
+namespace acl
+{
+	constexpr uint32_t BINARY_CLIP_MAGIC = 0xac11ac11;
+	constexpr uint32_t BINARY_CLIP_VERSION = 1;
+
+	struct BinaryClipHeader
+	{
+		uint32_t magic;
+		uint32_t version;
+		uint32_t num_samples;
+		uint32_t sample_rate;
+		double error_threshold;
+		uint16_t num_bones;
+		uint16_t clip_name_length;
+	};
+
+	struct BinaryClipBone
+	{
+		uint16_t parent_index;
+		uint16_t name_length;
+		double vertex_distance;
+		double bind_rotation[4];
+		double bind_translation[3];
+	};
+
+	inline bool is_binary_clip(const void* input, size_t input_length)
+	{
+		if (input == nullptr || input_length < sizeof(uint32_t))
+			return false;
+
+		uint32_t magic;
+		std::memcpy(&magic, input, sizeof(uint32_t));
+		return magic == BINARY_CLIP_MAGIC;
+	}
+}
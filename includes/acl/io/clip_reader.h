@@ -24,12 +24,14 @@
 // SOFTWARE.
 ////////////////////////////////////////////////////////////////////////////////
 
+#include "acl/io/binary_clip_format.h"
 #include "acl/io/clip_reader_error.h"
 #include "acl/compression/animation_clip.h"
 #include "acl/compression/skeleton.h"
 #include "acl/core/memory.h"
 #include "acl/core/string.h"
 #include "acl/core/string_view.h"
+#include "acl/core/string_table.h"
 #include "acl/sjson/sjson_parser.h"
 
 #include <stdint.h>
@@ -39,9 +41,34 @@ namespace acl
 	class ClipReader
 	{
 	public:
-		ClipReader(Allocator& allocator, const char* sjson_input, size_t input_length)
+		// The optional string table interns the bone names; loaders cooking many
+		// clips share one table so identical skeletons share their name storage.
+		// When none is provided, each skeleton owns a private table.
+		ClipReader(Allocator& allocator, const char* sjson_input, size_t input_length, StringTable* string_table = nullptr)
 			: m_allocator(allocator)
 			, m_parser(sjson_input, input_length)
+			, m_binary_input(is_binary_clip(sjson_input, input_length) ? reinterpret_cast<const uint8_t*>(sjson_input) : nullptr)
+			, m_binary_input_length(input_length)
+			, m_string_table(string_table)
+			, m_error()
+			, m_version()
+			, m_num_samples()
+			, m_sample_rate()
+		{
+		}
+
+		// Streaming mode: the reader pulls the SJSON text through the provided read
+		// callback and never holds more than the window buffer worth of it, which
+		// keeps the peak memory footprint constant regardless of the file size.
+		// The callback can be called at any input offset, a plain file handle or a
+		// memory mapped view both work. The caller owns the window buffer and must
+		// keep it alive for the lifetime of the reader.
+		ClipReader(Allocator& allocator, char* window_buffer, size_t window_size, size_t input_length, SJSONReadCallback read_callback, void* callback_user_data, StringTable* string_table = nullptr)
+			: m_allocator(allocator)
+			, m_parser(window_buffer, window_size, input_length, read_callback, callback_user_data)
+			, m_binary_input(nullptr)
+			, m_binary_input_length(0)
+			, m_string_table(string_table)
 			, m_error()
 			, m_version()
 			, m_num_samples()
@@ -53,6 +80,9 @@ namespace acl
 		{
 			reset_state();
 
+			if (m_binary_input != nullptr)
+				return read_binary_header() && create_binary_skeleton(skeleton);
+
 			return read_version() && read_clip_header() && create_skeleton(skeleton);
 		}
 
@@ -60,6 +90,9 @@ namespace acl
 		{
 			reset_state();
 
+			if (m_binary_input != nullptr)
+				return read_binary_header() && skip_binary_bones() && create_clip(clip, skeleton) && read_binary_tracks(*clip, skeleton);
+
 			return read_version() && read_clip_header() && read_skeleton() && create_clip(clip, skeleton) && read_tracks(*clip, skeleton) && nothing_follows();
 		}
 
@@ -68,20 +101,187 @@ namespace acl
 	private:
 		Allocator& m_allocator;
 		SJSONParser m_parser;
+
+		// Set when the input begins with the binary clip magic, see binary_clip_format.h
+		const uint8_t* m_binary_input;
+		size_t m_binary_input_length;
+		size_t m_binary_offset;
+
+		// Optional shared interning pool for bone names, see constructor
+		StringTable* m_string_table;
+
 		ClipReaderError m_error;
 
 		double m_version;
 		uint32_t m_num_samples;
 		uint32_t m_sample_rate;
-		StringView m_clip_name;
+		String m_clip_name;
 		double m_error_threshold;
 
 		void reset_state()
 		{
 			m_parser.reset_state();
+			m_binary_offset = 0;
 			set_error(ClipReaderError::None);
 		}
 
+		//////////////////////////////////////////////////////////////////////////
+		// Binary format support
+
+		bool read_binary(void* output, size_t size)
+		{
+			if (m_binary_offset + size > m_binary_input_length)
+			{
+				set_error(ClipReaderError::InvalidBinaryClip);
+				return false;
+			}
+
+			std::memcpy(output, m_binary_input + m_binary_offset, size);
+			m_binary_offset += size;
+			return true;
+		}
+
+		bool read_binary_string(String& value, uint16_t length)
+		{
+			if (m_binary_offset + length > m_binary_input_length)
+			{
+				set_error(ClipReaderError::InvalidBinaryClip);
+				return false;
+			}
+
+			value = String(m_allocator, reinterpret_cast<const char*>(m_binary_input + m_binary_offset), length);
+			m_binary_offset += length;
+			return true;
+		}
+
+		bool read_binary_name(StringView& value, uint16_t length, StringTable& string_table)
+		{
+			if (m_binary_offset + length > m_binary_input_length)
+			{
+				set_error(ClipReaderError::InvalidBinaryClip);
+				return false;
+			}
+
+			value = string_table.intern(reinterpret_cast<const char*>(m_binary_input + m_binary_offset), length);
+			m_binary_offset += length;
+			return true;
+		}
+
+		bool read_binary_header()
+		{
+			BinaryClipHeader header;
+			if (!read_binary(&header, sizeof(header)))
+				return false;
+
+			if (header.version != BINARY_CLIP_VERSION)
+			{
+				set_error(ClipReaderError::UnsupportedVersion);
+				return false;
+			}
+
+			m_num_samples = header.num_samples;
+			m_sample_rate = header.sample_rate;
+			m_error_threshold = header.error_threshold;
+
+			return read_binary_string(m_clip_name, header.clip_name_length);
+		}
+
+		bool create_binary_skeleton(std::unique_ptr<RigidSkeleton, Deleter<RigidSkeleton>>& skeleton)
+		{
+			BinaryClipHeader header;
+			std::memcpy(&header, m_binary_input, sizeof(header));
+
+			// Without a shared table, the skeleton owns a private one for its bone names
+			StringTable* string_table = m_string_table;
+			StringTable* owned_string_table = nullptr;
+			if (string_table == nullptr)
+				string_table = owned_string_table = allocate_type<StringTable>(m_allocator, m_allocator);
+
+			std::unique_ptr<RigidBone, Deleter<RigidBone>> bones = make_unique_array<RigidBone>(m_allocator, header.num_bones);
+
+			for (uint16_t bone_index = 0; bone_index < header.num_bones; ++bone_index)
+			{
+				BinaryClipBone file_bone;
+				if (!read_binary(&file_bone, sizeof(file_bone)) || !read_binary_name(bones.get()[bone_index].name, file_bone.name_length, *string_table))
+				{
+					if (owned_string_table != nullptr)
+						deallocate_type(m_allocator, owned_string_table);
+					return false;
+				}
+
+				RigidBone& bone = bones.get()[bone_index];
+				bone.parent_index = file_bone.parent_index;
+				bone.vertex_distance = file_bone.vertex_distance;
+				bone.bind_rotation = quat_unaligned_load(&file_bone.bind_rotation[0]);
+				bone.bind_translation = vector_unaligned_load3(&file_bone.bind_translation[0]);
+			}
+
+			skeleton = make_unique<RigidSkeleton>(m_allocator, m_allocator, bones.get(), header.num_bones, owned_string_table);
+			return true;
+		}
+
+		bool skip_binary_bones()
+		{
+			BinaryClipHeader header;
+			std::memcpy(&header, m_binary_input, sizeof(header));
+
+			for (uint16_t bone_index = 0; bone_index < header.num_bones; ++bone_index)
+			{
+				BinaryClipBone file_bone;
+				if (!read_binary(&file_bone, sizeof(file_bone)))
+					return false;
+
+				if (m_binary_offset + file_bone.name_length > m_binary_input_length)
+				{
+					set_error(ClipReaderError::InvalidBinaryClip);
+					return false;
+				}
+
+				m_binary_offset += file_bone.name_length;
+			}
+
+			return true;
+		}
+
+		bool read_binary_tracks(AnimationClip& clip, const RigidSkeleton& skeleton)
+		{
+			// Tracks are stored in bone order, raw doubles straight into the track buffers
+			uint16_t num_bones = skeleton.get_num_bones();
+			for (uint16_t bone_index = 0; bone_index < num_bones; ++bone_index)
+			{
+				AnimatedBone& bone = clip.get_bones()[bone_index];
+
+				for (uint32_t sample_index = 0; sample_index < m_num_samples; ++sample_index)
+				{
+					double quaternion[4];
+					if (!read_binary(&quaternion[0], sizeof(quaternion)))
+						return false;
+
+					bone.rotation_track.set_sample(sample_index, quat_unaligned_load(&quaternion[0]));
+				}
+
+				for (uint32_t sample_index = 0; sample_index < m_num_samples; ++sample_index)
+				{
+					double translation[3];
+					if (!read_binary(&translation[0], sizeof(translation)))
+						return false;
+
+					bone.translation_track.set_sample(sample_index, vector_unaligned_load3(&translation[0]));
+				}
+			}
+
+			if (m_binary_offset != m_binary_input_length)
+			{
+				set_error(ClipReaderError::InvalidBinaryClip);
+				return false;
+			}
+
+			return true;
+		}
+
+		//////////////////////////////////////////////////////////////////////////
+		// SJSON format support
+
 		bool read_version()
 		{
 			if (!m_parser.read("version", m_version))
@@ -101,12 +301,17 @@ namespace acl
 
 		bool read_clip_header()
 		{
+			StringView clip_name;
+
 			if (!m_parser.object_begins("clip"))
 				goto error;
 			
-			if (!m_parser.read("name", m_clip_name))
+			if (!m_parser.read("name", clip_name))
 				goto error;
 
+			// Copy the name, the view points into the parser window which can slide before the clip is created
+			m_clip_name = String(m_allocator, clip_name);
+
 			double num_samples;
 			if (!m_parser.read("num_samples", num_samples))
 				goto error;
@@ -147,16 +352,26 @@ namespace acl
 			SJSONParser::State before_bones = m_parser.save_state();
 
 			uint16_t num_bones;
-			if (!process_each_bone(nullptr, num_bones))
+			if (!process_each_bone(nullptr, num_bones, nullptr))
 				return false;
 
 			m_parser.restore_state(before_bones);
 
+			// Without a shared table, the skeleton owns a private one for its bone names
+			StringTable* string_table = m_string_table;
+			StringTable* owned_string_table = nullptr;
+			if (string_table == nullptr)
+				string_table = owned_string_table = allocate_type<StringTable>(m_allocator, m_allocator);
+
 			std::unique_ptr<RigidBone, Deleter<RigidBone>> bones = make_unique_array<RigidBone>(m_allocator, num_bones);
-			if (!process_each_bone(bones.get(), num_bones))
+			if (!process_each_bone(bones.get(), num_bones, string_table))
+			{
+				if (owned_string_table != nullptr)
+					deallocate_type(m_allocator, owned_string_table);
 				return false;
+			}
 
-			skeleton = make_unique<RigidSkeleton>(m_allocator, m_allocator, bones.get(), num_bones);
+			skeleton = make_unique<RigidSkeleton>(m_allocator, m_allocator, bones.get(), num_bones, owned_string_table);
 
 			return true;
 		}
@@ -164,10 +379,10 @@ namespace acl
 		bool read_skeleton()
 		{
 			uint16_t num_bones;
-			return process_each_bone(nullptr, num_bones);
+			return process_each_bone(nullptr, num_bones, nullptr);
 		}
 
-		bool process_each_bone(RigidBone* bones, uint16_t& num_bones)
+		bool process_each_bone(RigidBone* bones, uint16_t& num_bones, StringTable* string_table)
 		{
 			bool counting = bones == nullptr;
 			num_bones = 0;
@@ -188,7 +403,7 @@ namespace acl
 					goto error;
 
 				if (!counting)
-					bone.name = String(m_allocator, name);
+					bone.name = string_table->intern(name);
 
 				StringView parent;
 				if (!m_parser.read("parent", parent))
@@ -36,6 +36,7 @@ namespace acl
 			NoParentBoneWithThatName,
 			NoBoneWithThatName,
 			UnsignedIntegerExpected,
+			InvalidBinaryClip,
 		};
 
 		ClipReaderError()
@@ -61,6 +62,8 @@ namespace acl
 				return "The skeleton does not define a bone with this name";
 			case UnsignedIntegerExpected:
 				return "An unsigned integer is expected here";
+			case InvalidBinaryClip:
+				return "The binary clip data is truncated or malformed";
 			default:
 				return SJSONParserError::get_description();
 			}
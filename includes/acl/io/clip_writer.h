@@ -28,6 +28,7 @@
 #include "acl/compression/skeleton.h"
 #include "acl/core/memory.h"
 #include "acl/core/error.h"
+#include "acl/io/binary_clip_format.h"
 
 #include <stdint.h>
 
@@ -63,8 +64,8 @@ namespace acl
 			const RigidBone& parent_bone = bone.is_root() ? bone : skeleton.get_bone(bone.parent_index);
 
 			fprintf(file, "\t{\n");
-			fprintf(file, "\t\tname = \"%s\"\n", bone.name.c_str());
-			fprintf(file, "\t\tparent = \"%s\"\n", bone.is_root() ? "" : parent_bone.name.c_str());
+			fprintf(file, "\t\tname = \"%.*s\"\n", int(bone.name.get_length()), bone.name.get_chars());
+			fprintf(file, "\t\tparent = \"%.*s\"\n", bone.is_root() ? 0 : int(parent_bone.name.get_length()), parent_bone.name.get_chars());
 			fprintf(file, "\t\tvertex_distance = %f\n", bone.vertex_distance);
 			if (!quat_near_identity(bone.bind_rotation))
 				fprintf(file, "\t\tbind_rotation = [ %.16f, %.16f, %.16f, %.16f ]\n", quat_get_x(bone.bind_rotation), quat_get_y(bone.bind_rotation), quat_get_z(bone.bind_rotation), quat_get_w(bone.bind_rotation));
@@ -83,7 +84,7 @@ namespace acl
 			const AnimatedBone& bone = clip.get_animated_bone(bone_index);
 
 			fprintf(file, "\t{\n");
-			fprintf(file, "\t\tname = \"%s\"\n", rigid_bone.name.c_str());
+			fprintf(file, "\t\tname = \"%.*s\"\n", int(rigid_bone.name.get_length()), rigid_bone.name.get_chars());
 			fprintf(file, "\t\trotations =\n");
 			fprintf(file, "\t\t[\n");
 			uint32_t num_rotation_samples = bone.rotation_track.get_num_samples();
@@ -108,4 +109,74 @@ namespace acl
 
 		std::fclose(file);
 	}
+
+	// Binary variant of the intermediate format, see binary_clip_format.h for the layout.
+	// Same logical content as write_acl_clip but with no text formatting, which makes
+	// round-tripping a large clip library considerably faster and smaller on disk.
+	inline void write_acl_binary_clip(const RigidSkeleton& skeleton, const AnimationClip& clip, const char* acl_filename)
+	{
+		if (ACL_TRY_ASSERT(acl_filename != nullptr, "'acl_filename' cannot be NULL!"))
+			return;
+
+		std::FILE* file = nullptr;
+		fopen_s(&file, acl_filename, "wb");
+
+		if (ACL_TRY_ASSERT(file != nullptr, "Failed to open ACL file for writing: %s", acl_filename))
+			return;
+
+		uint16_t num_bones = skeleton.get_num_bones();
+
+		BinaryClipHeader header;
+		header.magic = BINARY_CLIP_MAGIC;
+		header.version = BINARY_CLIP_VERSION;
+		header.num_samples = clip.get_num_samples();
+		header.sample_rate = clip.get_sample_rate();
+		header.error_threshold = clip.get_error_threshold();
+		header.num_bones = num_bones;
+		header.clip_name_length = safe_static_cast<uint16_t>(clip.get_name().size());
+		fwrite(&header, sizeof(header), 1, file);
+		fwrite(clip.get_name().c_str(), sizeof(char), header.clip_name_length, file);
+
+		for (uint16_t bone_index = 0; bone_index < num_bones; ++bone_index)
+		{
+			const RigidBone& bone = skeleton.get_bone(bone_index);
+
+			BinaryClipBone file_bone;
+			file_bone.parent_index = bone.parent_index;
+			file_bone.name_length = safe_static_cast<uint16_t>(bone.name.get_length());
+			file_bone.vertex_distance = bone.vertex_distance;
+			file_bone.bind_rotation[0] = quat_get_x(bone.bind_rotation);
+			file_bone.bind_rotation[1] = quat_get_y(bone.bind_rotation);
+			file_bone.bind_rotation[2] = quat_get_z(bone.bind_rotation);
+			file_bone.bind_rotation[3] = quat_get_w(bone.bind_rotation);
+			file_bone.bind_translation[0] = vector_get_x(bone.bind_translation);
+			file_bone.bind_translation[1] = vector_get_y(bone.bind_translation);
+			file_bone.bind_translation[2] = vector_get_z(bone.bind_translation);
+			fwrite(&file_bone, sizeof(file_bone), 1, file);
+			fwrite(bone.name.get_chars(), sizeof(char), file_bone.name_length, file);
+		}
+
+		for (uint16_t bone_index = 0; bone_index < num_bones; ++bone_index)
+		{
+			const AnimatedBone& bone = clip.get_animated_bone(bone_index);
+
+			uint32_t num_rotation_samples = bone.rotation_track.get_num_samples();
+			for (uint32_t sample_index = 0; sample_index < num_rotation_samples; ++sample_index)
+			{
+				Quat_64 rotation = bone.rotation_track.get_sample(sample_index);
+				double samples[4] = { quat_get_x(rotation), quat_get_y(rotation), quat_get_z(rotation), quat_get_w(rotation) };
+				fwrite(&samples[0], sizeof(double), 4, file);
+			}
+
+			uint32_t num_translation_samples = bone.translation_track.get_num_samples();
+			for (uint32_t sample_index = 0; sample_index < num_translation_samples; ++sample_index)
+			{
+				Vector4_64 translation = bone.translation_track.get_sample(sample_index);
+				double samples[3] = { vector_get_x(translation), vector_get_y(translation), vector_get_z(translation) };
+				fwrite(&samples[0], sizeof(double), 3, file);
+			}
+		}
+
+		std::fclose(file);
+	}
 }
@@ -26,8 +26,16 @@
 
 //#define ACL_NO_INTRINSICS
 
+#if defined(__AVX2__) && !defined(ACL_NO_INTRINSICS)
+	#define ACL_AVX2_INTRINSICS
+	#define ACL_AVX_INTRINSICS
+#endif
+
 #if defined(__AVX__) && !defined(ACL_NO_INTRINSICS)
 	#define ACL_AVX_INTRINSICS
+#endif
+
+#if defined(ACL_AVX_INTRINSICS)
 	#define ACL_SSE4_INTRINSICS
 	#define ACL_SSE3_INTRINSICS
 	#define ACL_SSE2_INTRINSICS
@@ -36,9 +44,10 @@
 #if !defined(ACL_SSE2_INTRINSICS) && !defined(ACL_NO_INTRINSICS)
 	#if defined(_M_IX86) || defined(_M_X64)
 		#define ACL_SSE2_INTRINSICS
-	//#elif defined(_M_ARM) || defined(_M_ARM64)
-		// TODO: Implement ARM NEON
-		//#define ACL_ARM_NEON_INTRINSICS
+	#elif defined(__aarch64__) || defined(_M_ARM64)
+		// NEON on ARM64 only: the 32 bit ISA lacks the vector divide, square root,
+		// and horizontal reductions the float math below relies on
+		#define ACL_NEON_INTRINSICS
 	#else
 		#define ACL_NO_INTRINSICS
 	#endif
@@ -61,4 +70,8 @@
 #include <immintrin.h>
 #endif
 
+#if defined(ACL_NEON_INTRINSICS)
+#include <arm_neon.h>
+#endif
+
 #include "acl/math/math_types.h"
@@ -66,6 +66,10 @@ namespace acl
 		}
 	}
 
+#if defined(ACL_NEON_INTRINSICS)
+	typedef float32x4_t Quat_32;
+	typedef float32x4_t Vector4_32;
+#else
 	struct Quat_32
 	{
 		float x;
@@ -81,7 +85,9 @@ namespace acl
 		float z;
 		float w;
 	};
+#endif
 
+	// NEON has no double vector support, the 64 bit types remain scalar on ARM
 	struct Quat_64
 	{
 		double x;
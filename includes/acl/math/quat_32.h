@@ -36,6 +36,9 @@ namespace acl
 	{
 #if defined(ACL_SSE2_INTRINSICS)
 		return Quat_32(_mm_set_ps(w, z, y, x));
+#elif defined(ACL_NEON_INTRINSICS)
+		float values[4] = { x, y, z, w };
+		return vld1q_f32(&values[0]);
 #else
 		return Quat_32{ x, y, z, w };
 #endif
@@ -61,7 +64,7 @@ namespace acl
 
 	inline Quat_32 vector_to_quat(const Vector4_32& input)
 	{
-#if defined(ACL_SSE2_INTRINSICS)
+#if defined(ACL_SSE2_INTRINSICS) || defined(ACL_NEON_INTRINSICS)
 		return input;
 #else
 		return Quat_32{ input.x, input.y, input.z, input.w };
@@ -72,6 +75,8 @@ namespace acl
 	{
 #if defined(ACL_SSE2_INTRINSICS)
 		return _mm_shuffle_ps(_mm_cvtpd_ps(input.xy), _mm_cvtpd_ps(input.zw), _MM_SHUFFLE(1, 0, 1, 0));
+#elif defined(ACL_NEON_INTRINSICS)
+		return quat_set(float(input.x), float(input.y), float(input.z), float(input.w));
 #else
 		return Quat_32{ float(input.x), float(input.y), float(input.z), float(input.w) };
 #endif
@@ -81,6 +86,8 @@ namespace acl
 	{
 #if defined(ACL_SSE2_INTRINSICS)
 		return _mm_cvtss_f32(input);
+#elif defined(ACL_NEON_INTRINSICS)
+		return vgetq_lane_f32(input, 0);
 #else
 		return input.x;
 #endif
@@ -90,6 +97,8 @@ namespace acl
 	{
 #if defined(ACL_SSE2_INTRINSICS)
 		return _mm_cvtss_f32(_mm_shuffle_ps(input, input, _MM_SHUFFLE(1, 1, 1, 1)));
+#elif defined(ACL_NEON_INTRINSICS)
+		return vgetq_lane_f32(input, 1);
 #else
 		return input.y;
 #endif
@@ -99,6 +108,8 @@ namespace acl
 	{
 #if defined(ACL_SSE2_INTRINSICS)
 		return _mm_cvtss_f32(_mm_shuffle_ps(input, input, _MM_SHUFFLE(2, 2, 2, 2)));
+#elif defined(ACL_NEON_INTRINSICS)
+		return vgetq_lane_f32(input, 2);
 #else
 		return input.z;
 #endif
@@ -108,6 +119,8 @@ namespace acl
 	{
 #if defined(ACL_SSE2_INTRINSICS)
 		return _mm_cvtss_f32(_mm_shuffle_ps(input, input, _MM_SHUFFLE(3, 3, 3, 3)));
+#elif defined(ACL_NEON_INTRINSICS)
+		return vgetq_lane_f32(input, 3);
 #else
 		return input.w;
 #endif
@@ -229,10 +242,14 @@ namespace acl
 		return quat_set(s * vector_get_x(axis), s * vector_get_y(axis), s * vector_get_z(axis), c);
 	}
 
+	inline float quat_dot(const Quat_32& lhs, const Quat_32& rhs)
+	{
+		return vector_dot(quat_to_vector(lhs), quat_to_vector(rhs));
+	}
+
 	inline float quat_length_squared(const Quat_32& input)
 	{
-		// TODO: Use dot instruction
-		return (quat_get_x(input) * quat_get_x(input)) + (quat_get_y(input) * quat_get_y(input)) + (quat_get_z(input) * quat_get_z(input)) + (quat_get_w(input) * quat_get_w(input));
+		return vector_length_squared(quat_to_vector(input));
 	}
 
 	inline float quat_length(const Quat_32& input)
@@ -249,9 +266,30 @@ namespace acl
 
 	inline Quat_32 quat_normalize(const Quat_32& input)
 	{
+#if defined(ACL_SSE2_INTRINSICS)
+		// The dot product, square root, and divide all happen in registers,
+		// the length never coerces to a scalar
+#if defined(ACL_SSE4_INTRINSICS)
+		__m128 length_squared = _mm_dp_ps(input, input, 0xFF);
+#else
+		__m128 x2_y2_z2_w2 = _mm_mul_ps(input, input);
+		__m128 z2_w2_x2_y2 = _mm_shuffle_ps(x2_y2_z2_w2, x2_y2_z2_w2, _MM_SHUFFLE(1, 0, 3, 2));
+		__m128 x2z2_y2w2 = _mm_add_ps(x2_y2_z2_w2, z2_w2_x2_y2);
+		__m128 y2w2_x2z2 = _mm_shuffle_ps(x2z2_y2w2, x2z2_y2w2, _MM_SHUFFLE(2, 3, 0, 1));
+		__m128 length_squared = _mm_add_ps(x2z2_y2w2, y2w2_x2z2);
+#endif
+		__m128 length = _mm_sqrt_ps(length_squared);
+		return _mm_div_ps(input, length);
+#elif defined(ACL_NEON_INTRINSICS)
+		// The reduction, square root, and divide all happen in registers
+		float32x4_t length_squared = vdupq_n_f32(vaddvq_f32(vmulq_f32(input, input)));
+		float32x4_t length = vsqrtq_f32(length_squared);
+		return vdivq_f32(input, length);
+#else
 		float length_recip = quat_length_reciprocal(input);
 		Vector4_32 input_vector = quat_to_vector(input);
 		return vector_to_quat(vector_mul(input_vector, length_recip));
+#endif
 	}
 
 	inline Quat_32 quat_lerp(const Quat_32& start, const Quat_32& end, float alpha)
@@ -279,6 +317,40 @@ namespace acl
 		return quat_set(vector_get_x(input), vector_get_y(input), vector_get_z(input), w);
 	}
 
+	// Reconstructs the positive w component of both rotations, lerps, and
+	// normalizes. This is the decompression hot loop for the drop w formats,
+	// fusing the steps keeps every intermediate value in registers.
+	inline Quat_32 quat_lerp_from_positive_w(const Vector4_32& start_xyz, const Vector4_32& end_xyz, float alpha)
+	{
+#if defined(ACL_SSE2_INTRINSICS)
+		const __m128 zero = _mm_setzero_ps();
+		const __m128 one = _mm_set_ps1(1.0f);
+
+		__m128 start_sq = _mm_mul_ps(start_xyz, start_xyz);
+		__m128 start_y2 = _mm_shuffle_ps(start_sq, start_sq, _MM_SHUFFLE(1, 1, 1, 1));
+		__m128 start_z2 = _mm_shuffle_ps(start_sq, start_sq, _MM_SHUFFLE(2, 2, 2, 2));
+		__m128 start_w_squared = _mm_sub_ss(one, _mm_add_ss(_mm_add_ss(start_sq, start_y2), start_z2));
+		__m128 start_w = _mm_sqrt_ss(_mm_max_ss(start_w_squared, zero));
+
+		__m128 end_sq = _mm_mul_ps(end_xyz, end_xyz);
+		__m128 end_y2 = _mm_shuffle_ps(end_sq, end_sq, _MM_SHUFFLE(1, 1, 1, 1));
+		__m128 end_z2 = _mm_shuffle_ps(end_sq, end_sq, _MM_SHUFFLE(2, 2, 2, 2));
+		__m128 end_w_squared = _mm_sub_ss(one, _mm_add_ss(_mm_add_ss(end_sq, end_y2), end_z2));
+		__m128 end_w = _mm_sqrt_ss(_mm_max_ss(end_w_squared, zero));
+
+		// Insert the w components in the w lanes: [z, z, w, w] then [x, y, z, w]
+		__m128 start_zw = _mm_shuffle_ps(start_xyz, start_w, _MM_SHUFFLE(0, 0, 2, 2));
+		__m128 start = _mm_shuffle_ps(start_xyz, start_zw, _MM_SHUFFLE(2, 0, 1, 0));
+		__m128 end_zw = _mm_shuffle_ps(end_xyz, end_w, _MM_SHUFFLE(0, 0, 2, 2));
+		__m128 end = _mm_shuffle_ps(end_xyz, end_zw, _MM_SHUFFLE(2, 0, 1, 0));
+
+		__m128 value = _mm_add_ps(start, _mm_mul_ps(_mm_sub_ps(end, start), _mm_set_ps1(alpha)));
+		return quat_normalize(vector_to_quat(value));
+#else
+		return quat_lerp(quat_from_positive_w(start_xyz), quat_from_positive_w(end_xyz), alpha);
+#endif
+	}
+
 	inline bool quat_is_valid(const Quat_32& input)
 	{
 		return is_finite(quat_get_x(input)) && is_finite(quat_get_y(input)) && is_finite(quat_get_z(input)) && is_finite(quat_get_w(input));
@@ -300,4 +372,66 @@ namespace acl
 		float angle = quat_get_angle(input);
 		return abs(angle) < threshold;
 	}
+
+	//////////////////////////////////////////////////////////////////////////
+	// Batch kernels for the compression inner loops. Quaternions are processed
+	// four at a time: each group transposes into SoA form so the horizontal
+	// reductions become plain component wise math, see vector_transpose4.
+	// The tail falls back to the scalar helpers above.
+	//////////////////////////////////////////////////////////////////////////
+
+	inline void quat_normalize_batch(Quat_32* quats, size_t num_quats)
+	{
+		size_t num_batched_quats = num_quats & ~size_t(3);
+		for (size_t quat_index = 0; quat_index < num_batched_quats; quat_index += 4)
+		{
+			Vector4_32 xxxx = quat_to_vector(quats[quat_index + 0]);
+			Vector4_32 yyyy = quat_to_vector(quats[quat_index + 1]);
+			Vector4_32 zzzz = quat_to_vector(quats[quat_index + 2]);
+			Vector4_32 wwww = quat_to_vector(quats[quat_index + 3]);
+			vector_transpose4(xxxx, yyyy, zzzz, wwww);
+
+			Vector4_32 length_squared = vector_mul_add(xxxx, xxxx, vector_mul_add(yyyy, yyyy, vector_mul_add(zzzz, zzzz, vector_mul(wwww, wwww))));
+			Vector4_32 length = vector_sqrt(length_squared);
+
+			xxxx = vector_div(xxxx, length);
+			yyyy = vector_div(yyyy, length);
+			zzzz = vector_div(zzzz, length);
+			wwww = vector_div(wwww, length);
+
+			vector_transpose4(xxxx, yyyy, zzzz, wwww);
+			quats[quat_index + 0] = vector_to_quat(xxxx);
+			quats[quat_index + 1] = vector_to_quat(yyyy);
+			quats[quat_index + 2] = vector_to_quat(zzzz);
+			quats[quat_index + 3] = vector_to_quat(wwww);
+		}
+
+		for (size_t quat_index = num_batched_quats; quat_index < num_quats; ++quat_index)
+			quats[quat_index] = quat_normalize(quats[quat_index]);
+	}
+
+	inline void quat_dot_batch(const Quat_32* lhs, const Quat_32* rhs, size_t num_quats, float* out_dots)
+	{
+		size_t num_batched_quats = num_quats & ~size_t(3);
+		for (size_t quat_index = 0; quat_index < num_batched_quats; quat_index += 4)
+		{
+			Vector4_32 lhs_xxxx = quat_to_vector(lhs[quat_index + 0]);
+			Vector4_32 lhs_yyyy = quat_to_vector(lhs[quat_index + 1]);
+			Vector4_32 lhs_zzzz = quat_to_vector(lhs[quat_index + 2]);
+			Vector4_32 lhs_wwww = quat_to_vector(lhs[quat_index + 3]);
+			vector_transpose4(lhs_xxxx, lhs_yyyy, lhs_zzzz, lhs_wwww);
+
+			Vector4_32 rhs_xxxx = quat_to_vector(rhs[quat_index + 0]);
+			Vector4_32 rhs_yyyy = quat_to_vector(rhs[quat_index + 1]);
+			Vector4_32 rhs_zzzz = quat_to_vector(rhs[quat_index + 2]);
+			Vector4_32 rhs_wwww = quat_to_vector(rhs[quat_index + 3]);
+			vector_transpose4(rhs_xxxx, rhs_yyyy, rhs_zzzz, rhs_wwww);
+
+			Vector4_32 dots = vector_mul_add(lhs_xxxx, rhs_xxxx, vector_mul_add(lhs_yyyy, rhs_yyyy, vector_mul_add(lhs_zzzz, rhs_zzzz, vector_mul(lhs_wwww, rhs_wwww))));
+			vector_unaligned_write(dots, reinterpret_cast<uint8_t*>(out_dots + quat_index));
+		}
+
+		for (size_t quat_index = num_batched_quats; quat_index < num_quats; ++quat_index)
+			out_dots[quat_index] = quat_dot(lhs[quat_index], rhs[quat_index]);
+	}
 }
@@ -82,6 +82,58 @@ namespace acl
 		return quat_from_positive_w(rotation_xyz);
 	}
 
+	//////////////////////////////////////////////////////////////////////////
+	// Fused unpack and interpolate kernels. Decompression always unpacks both
+	// interpolation key frames then lerps between them, fusing the steps keeps
+	// the intermediate values in registers instead of round tripping each one
+	// through the unpack and quat helpers.
+	//////////////////////////////////////////////////////////////////////////
+
+	inline Quat_32 unpack2_lerp_quat_128(const uint8_t* data_ptr0, const uint8_t* data_ptr1, float alpha)
+	{
+		Vector4_32 rotation0 = unpack_vector4_128(data_ptr0);
+		Vector4_32 rotation1 = unpack_vector4_128(data_ptr1);
+		return quat_lerp(vector_to_quat(rotation0), vector_to_quat(rotation1), alpha);
+	}
+
+	inline Quat_32 unpack2_lerp_quat_96(const uint8_t* data_ptr0, const uint8_t* data_ptr1, float alpha)
+	{
+		Vector4_32 rotation0_xyz = unpack_vector3_96(data_ptr0);
+		Vector4_32 rotation1_xyz = unpack_vector3_96(data_ptr1);
+		return quat_lerp_from_positive_w(rotation0_xyz, rotation1_xyz, alpha);
+	}
+
+	inline Quat_32 unpack2_lerp_quat_48(const uint8_t* data_ptr0, const uint8_t* data_ptr1, float alpha)
+	{
+		Vector4_32 rotation0_xyz = unpack_vector3_48(data_ptr0);
+		Vector4_32 rotation1_xyz = unpack_vector3_48(data_ptr1);
+		return quat_lerp_from_positive_w(rotation0_xyz, rotation1_xyz, alpha);
+	}
+
+	inline Quat_32 unpack2_lerp_quat_32(const uint8_t* data_ptr0, const uint8_t* data_ptr1, float alpha)
+	{
+		Vector4_32 rotation0_xyz = unpack_vector3_32<11, 11, 10>(data_ptr0);
+		Vector4_32 rotation1_xyz = unpack_vector3_32<11, 11, 10>(data_ptr1);
+		return quat_lerp_from_positive_w(rotation0_xyz, rotation1_xyz, alpha);
+	}
+
+	// Fixed point variants for the quantized formats, see unpack2_lerp_vector3_48_fixed.
+	// W is reconstructed from the interpolated components instead of per key frame
+	// which stays within quantization noise of the float kernels since both key
+	// frames share the positive w hemisphere.
+
+	inline Quat_32 unpack2_lerp_quat_48_fixed(const uint8_t* data_ptr0, const uint8_t* data_ptr1, uint32_t alpha)
+	{
+		Vector4_32 rotation_xyz = unpack2_lerp_vector3_48_fixed(data_ptr0, data_ptr1, alpha);
+		return quat_from_positive_w(rotation_xyz);
+	}
+
+	inline Quat_32 unpack2_lerp_quat_32_fixed(const uint8_t* data_ptr0, const uint8_t* data_ptr1, uint32_t alpha)
+	{
+		Vector4_32 rotation_xyz = unpack2_lerp_vector3_32_fixed<11, 11, 10>(data_ptr0, data_ptr1, alpha);
+		return quat_from_positive_w(rotation_xyz);
+	}
+
 	//////////////////////////////////////////////////////////////////////////
 
 	// TODO: constexpr
@@ -34,6 +34,9 @@ namespace acl
 	{
 #if defined(ACL_SSE2_INTRINSICS)
 		return Vector4_32(_mm_set_ps(w, z, y, x));
+#elif defined(ACL_NEON_INTRINSICS)
+		float values[4] = { x, y, z, w };
+		return vld1q_f32(&values[0]);
 #else
 		return Vector4_32{ x, y, z, w };
 #endif
@@ -43,6 +46,9 @@ namespace acl
 	{
 #if defined(ACL_SSE2_INTRINSICS)
 		return Vector4_32(_mm_set_ps(0.0f, z, y, x));
+#elif defined(ACL_NEON_INTRINSICS)
+		float values[4] = { x, y, z, 0.0f };
+		return vld1q_f32(&values[0]);
 #else
 		return Vector4_32{ x, y, z, 0.0f };
 #endif
@@ -52,6 +58,8 @@ namespace acl
 	{
 #if defined(ACL_SSE2_INTRINSICS)
 		return Vector4_32(_mm_set_ps1(xyzw));
+#elif defined(ACL_NEON_INTRINSICS)
+		return vdupq_n_f32(xyzw);
 #else
 		return Vector4_32{ xyzw, xyzw, xyzw, xyzw };
 #endif
@@ -90,7 +98,7 @@ namespace acl
 
 	inline Vector4_32 quat_to_vector(const Quat_32& input)
 	{
-#if defined(ACL_SSE2_INTRINSICS)
+#if defined(ACL_SSE2_INTRINSICS) || defined(ACL_NEON_INTRINSICS)
 		return input;
 #else
 		return Vector4_32{ input.x, input.y, input.z, input.w };
@@ -101,6 +109,8 @@ namespace acl
 	{
 #if defined(ACL_SSE2_INTRINSICS)
 		return _mm_shuffle_ps(_mm_cvtpd_ps(input.xy), _mm_cvtpd_ps(input.zw), _MM_SHUFFLE(1, 0, 1, 0));
+#elif defined(ACL_NEON_INTRINSICS)
+		return vector_set(float(input.x), float(input.y), float(input.z), float(input.w));
 #else
 		return Vector4_32{ float(input.x), float(input.y), float(input.z), float(input.w) };
 #endif
@@ -110,6 +120,8 @@ namespace acl
 	{
 #if defined(ACL_SSE2_INTRINSICS)
 		return _mm_cvtss_f32(input);
+#elif defined(ACL_NEON_INTRINSICS)
+		return vgetq_lane_f32(input, 0);
 #else
 		return input.x;
 #endif
@@ -119,6 +131,8 @@ namespace acl
 	{
 #if defined(ACL_SSE2_INTRINSICS)
 		return _mm_cvtss_f32(_mm_shuffle_ps(input, input, _MM_SHUFFLE(1, 1, 1, 1)));
+#elif defined(ACL_NEON_INTRINSICS)
+		return vgetq_lane_f32(input, 1);
 #else
 		return input.y;
 #endif
@@ -128,6 +142,8 @@ namespace acl
 	{
 #if defined(ACL_SSE2_INTRINSICS)
 		return _mm_cvtss_f32(_mm_shuffle_ps(input, input, _MM_SHUFFLE(2, 2, 2, 2)));
+#elif defined(ACL_NEON_INTRINSICS)
+		return vgetq_lane_f32(input, 2);
 #else
 		return input.z;
 #endif
@@ -137,6 +153,8 @@ namespace acl
 	{
 #if defined(ACL_SSE2_INTRINSICS)
 		return _mm_cvtss_f32(_mm_shuffle_ps(input, input, _MM_SHUFFLE(3, 3, 3, 3)));
+#elif defined(ACL_NEON_INTRINSICS)
+		return vgetq_lane_f32(input, 3);
 #else
 		return input.w;
 #endif
@@ -192,6 +210,8 @@ namespace acl
 	{
 #if defined(ACL_SSE2_INTRINSICS)
 		return _mm_add_ps(lhs, rhs);
+#elif defined(ACL_NEON_INTRINSICS)
+		return vaddq_f32(lhs, rhs);
 #else
 		return vector_set(lhs.x + rhs.x, lhs.y + rhs.y, lhs.z + rhs.z, lhs.w + rhs.w);
 #endif
@@ -201,6 +221,8 @@ namespace acl
 	{
 #if defined(ACL_SSE2_INTRINSICS)
 		return _mm_sub_ps(lhs, rhs);
+#elif defined(ACL_NEON_INTRINSICS)
+		return vsubq_f32(lhs, rhs);
 #else
 		return vector_set(lhs.x - rhs.x, lhs.y - rhs.y, lhs.z - rhs.z, lhs.w - rhs.w);
 #endif
@@ -210,6 +232,8 @@ namespace acl
 	{
 #if defined(ACL_SSE2_INTRINSICS)
 		return _mm_mul_ps(lhs, rhs);
+#elif defined(ACL_NEON_INTRINSICS)
+		return vmulq_f32(lhs, rhs);
 #else
 		return vector_set(lhs.x * rhs.x, lhs.y * rhs.y, lhs.z * rhs.z, lhs.w * rhs.w);
 #endif
@@ -220,10 +244,34 @@ namespace acl
 		return vector_mul(lhs, vector_set(rhs));
 	}
 
+	inline Vector4_32 vector_div(const Vector4_32& lhs, const Vector4_32& rhs)
+	{
+#if defined(ACL_SSE2_INTRINSICS)
+		return _mm_div_ps(lhs, rhs);
+#elif defined(ACL_NEON_INTRINSICS)
+		return vdivq_f32(lhs, rhs);
+#else
+		return vector_set(lhs.x / rhs.x, lhs.y / rhs.y, lhs.z / rhs.z, lhs.w / rhs.w);
+#endif
+	}
+
+	inline Vector4_32 vector_sqrt(const Vector4_32& input)
+	{
+#if defined(ACL_SSE2_INTRINSICS)
+		return _mm_sqrt_ps(input);
+#elif defined(ACL_NEON_INTRINSICS)
+		return vsqrtq_f32(input);
+#else
+		return vector_set(sqrt(input.x), sqrt(input.y), sqrt(input.z), sqrt(input.w));
+#endif
+	}
+
 	inline Vector4_32 vector_max(const Vector4_32& lhs, const Vector4_32& rhs)
 	{
 #if defined(ACL_SSE2_INTRINSICS)
 		return _mm_max_ps(lhs, rhs);
+#elif defined(ACL_NEON_INTRINSICS)
+		return vmaxq_f32(lhs, rhs);
 #else
 		return vector_set(max(lhs.x, rhs.x), max(lhs.y, rhs.y), max(lhs.z, rhs.z), max(lhs.w, rhs.w));
 #endif
@@ -233,6 +281,8 @@ namespace acl
 	{
 #if defined(ACL_SSE2_INTRINSICS)
 		return _mm_min_ps(lhs, rhs);
+#elif defined(ACL_NEON_INTRINSICS)
+		return vminq_f32(lhs, rhs);
 #else
 		return vector_set(min(lhs.x, rhs.x), min(lhs.y, rhs.y), min(lhs.z, rhs.z), min(lhs.w, rhs.w));
 #endif
@@ -242,6 +292,8 @@ namespace acl
 	{
 #if defined(ACL_SSE2_INTRINSICS)
 		return vector_max(vector_sub(_mm_setzero_ps(), input), input);
+#elif defined(ACL_NEON_INTRINSICS)
+		return vabsq_f32(input);
 #else
 		return vector_set(abs(input.x), abs(input.y), abs(input.z), abs(input.w));
 #endif
@@ -254,14 +306,36 @@ namespace acl
 
 	inline float vector_dot(const Vector4_32& lhs, const Vector4_32& rhs)
 	{
-		// TODO: Use dot instruction
+#if defined(ACL_SSE4_INTRINSICS)
+		return _mm_cvtss_f32(_mm_dp_ps(lhs, rhs, 0xFF));
+#elif defined(ACL_SSE2_INTRINSICS)
+		__m128 x2_y2_z2_w2 = _mm_mul_ps(lhs, rhs);
+		__m128 z2_w2_x2_y2 = _mm_shuffle_ps(x2_y2_z2_w2, x2_y2_z2_w2, _MM_SHUFFLE(1, 0, 3, 2));
+		__m128 x2z2_y2w2 = _mm_add_ps(x2_y2_z2_w2, z2_w2_x2_y2);
+		__m128 y2w2_x2z2 = _mm_shuffle_ps(x2z2_y2w2, x2z2_y2w2, _MM_SHUFFLE(2, 3, 0, 1));
+		return _mm_cvtss_f32(_mm_add_ps(x2z2_y2w2, y2w2_x2z2));
+#elif defined(ACL_NEON_INTRINSICS)
+		return vaddvq_f32(vmulq_f32(lhs, rhs));
+#else
 		return (vector_get_x(lhs) * vector_get_x(rhs)) + (vector_get_y(lhs) * vector_get_y(rhs)) + (vector_get_z(lhs) * vector_get_z(rhs)) + (vector_get_w(lhs) * vector_get_w(rhs));
+#endif
 	}
 
 	inline float vector_dot3(const Vector4_32& lhs, const Vector4_32& rhs)
 	{
-		// TODO: Use dot instruction
+#if defined(ACL_SSE4_INTRINSICS)
+		return _mm_cvtss_f32(_mm_dp_ps(lhs, rhs, 0x7F));
+#elif defined(ACL_SSE2_INTRINSICS)
+		__m128 x2_y2_z2_w2 = _mm_mul_ps(lhs, rhs);
+		__m128 y2_y2_y2_y2 = _mm_shuffle_ps(x2_y2_z2_w2, x2_y2_z2_w2, _MM_SHUFFLE(1, 1, 1, 1));
+		__m128 z2_z2_z2_z2 = _mm_shuffle_ps(x2_y2_z2_w2, x2_y2_z2_w2, _MM_SHUFFLE(2, 2, 2, 2));
+		return _mm_cvtss_f32(_mm_add_ss(_mm_add_ss(x2_y2_z2_w2, y2_y2_y2_y2), z2_z2_z2_z2));
+#elif defined(ACL_NEON_INTRINSICS)
+		float32x4_t x2_y2_z2_w2 = vmulq_f32(lhs, rhs);
+		return vaddvq_f32(vsetq_lane_f32(0.0f, x2_y2_z2_w2, 3));
+#else
 		return (vector_get_x(lhs) * vector_get_x(rhs)) + (vector_get_y(lhs) * vector_get_y(rhs)) + (vector_get_z(lhs) * vector_get_z(rhs));
+#endif
 	}
 
 	inline float vector_length_squared(const Vector4_32& input)
@@ -312,6 +386,8 @@ namespace acl
 	{
 #if defined(ACL_SSE2_INTRINSICS)
 		return _mm_movemask_ps(_mm_cmplt_ps(lhs, rhs)) == 0xF;
+#elif defined(ACL_NEON_INTRINSICS)
+		return vminvq_u32(vcltq_f32(lhs, rhs)) != 0;
 #else
 		return lhs.x < rhs.x && lhs.y < rhs.y && lhs.z < rhs.z && lhs.w < rhs.w;
 #endif
@@ -321,6 +397,9 @@ namespace acl
 	{
 #if defined(ACL_SSE2_INTRINSICS)
 		return (_mm_movemask_ps(_mm_cmplt_ps(lhs, rhs)) & 0x7) == 0x7;
+#elif defined(ACL_NEON_INTRINSICS)
+		// Force the w lane to true, it must not participate in the result
+		return vminvq_u32(vsetq_lane_u32(0xFFFFFFFF, vcltq_f32(lhs, rhs), 3)) != 0;
 #else
 		return lhs.x < rhs.x && lhs.y < rhs.y && lhs.z < rhs.z;
 #endif
@@ -330,6 +409,8 @@ namespace acl
 	{
 #if defined(ACL_SSE2_INTRINSICS)
 		return _mm_movemask_ps(_mm_cmplt_ps(lhs, rhs)) != 0;
+#elif defined(ACL_NEON_INTRINSICS)
+		return vmaxvq_u32(vcltq_f32(lhs, rhs)) != 0;
 #else
 		return lhs.x < rhs.x || lhs.y < rhs.y || lhs.z < rhs.z || lhs.w < rhs.w;
 #endif
@@ -339,6 +420,9 @@ namespace acl
 	{
 #if defined(ACL_SSE2_INTRINSICS)
 		return (_mm_movemask_ps(_mm_cmplt_ps(lhs, rhs)) & 0x7) != 0;
+#elif defined(ACL_NEON_INTRINSICS)
+		// Force the w lane to false, it must not participate in the result
+		return vmaxvq_u32(vsetq_lane_u32(0, vcltq_f32(lhs, rhs), 3)) != 0;
 #else
 		return lhs.x < rhs.x || lhs.y < rhs.y || lhs.z < rhs.z;
 #endif
@@ -367,6 +451,39 @@ namespace acl
 	// output = (input * scale) + offset
 	inline Vector4_32 vector_mul_add(const Vector4_32& input, const Vector4_32& scale, const Vector4_32& offset)
 	{
+#if defined(ACL_AVX2_INTRINSICS)
+		return _mm_fmadd_ps(input, scale, offset);
+#elif defined(ACL_NEON_INTRINSICS)
+		return vfmaq_f32(offset, input, scale);
+#else
 		return vector_add(vector_mul(input, scale), offset);
+#endif
+	}
+
+	// Transposes four vectors in place between AoS and SoA form:
+	// [x0, y0, z0, w0][x1, y1, z1, w1][x2, y2, z2, w2][x3, y3, z3, w3]
+	// becomes
+	// [x0, x1, x2, x3][y0, y1, y2, y3][z0, z1, z2, z3][w0, w1, w2, w3]
+	inline void vector_transpose4(Vector4_32& vec0, Vector4_32& vec1, Vector4_32& vec2, Vector4_32& vec3)
+	{
+#if defined(ACL_SSE2_INTRINSICS)
+		_MM_TRANSPOSE4_PS(vec0, vec1, vec2, vec3);
+#elif defined(ACL_NEON_INTRINSICS)
+		float32x4x2_t x0y0_x1y1 = vtrnq_f32(vec0, vec1);
+		float32x4x2_t x2y2_x3y3 = vtrnq_f32(vec2, vec3);
+		vec0 = vcombine_f32(vget_low_f32(x0y0_x1y1.val[0]), vget_low_f32(x2y2_x3y3.val[0]));
+		vec1 = vcombine_f32(vget_low_f32(x0y0_x1y1.val[1]), vget_low_f32(x2y2_x3y3.val[1]));
+		vec2 = vcombine_f32(vget_high_f32(x0y0_x1y1.val[0]), vget_high_f32(x2y2_x3y3.val[0]));
+		vec3 = vcombine_f32(vget_high_f32(x0y0_x1y1.val[1]), vget_high_f32(x2y2_x3y3.val[1]));
+#else
+		Vector4_32 xxxx = vector_set(vec0.x, vec1.x, vec2.x, vec3.x);
+		Vector4_32 yyyy = vector_set(vec0.y, vec1.y, vec2.y, vec3.y);
+		Vector4_32 zzzz = vector_set(vec0.z, vec1.z, vec2.z, vec3.z);
+		Vector4_32 wwww = vector_set(vec0.w, vec1.w, vec2.w, vec3.w);
+		vec0 = xxxx;
+		vec1 = yyyy;
+		vec2 = zzzz;
+		vec3 = wwww;
+#endif
 	}
 }
@@ -26,13 +26,23 @@
 
 #include "acl/core/error.h"
 #include "acl/core/memory.h"
+#include "acl/core/algorithm_types.h"
 #include "acl/math/vector4_32.h"
 #include "acl/math/scalar_packing.h"
 
 #include <stdint.h>
+#include <cstring>
 
 namespace acl
 {
+	// Buffers holding packed samples keep this many bytes of trailing padding:
+	// the unpackers below read whole 16 byte vectors instead of gathering the
+	// components one at a time and the padding keeps the load of the last
+	// sample inside the allocation. Every allocation the encoder writes packed
+	// data into accounts for it, the padded bytes are zeroed and never read
+	// back as data.
+	constexpr uint32_t PACKED_DATA_TAIL_PADDING = 15;
+
 	inline void pack_vector4_128(const Vector4_32& vector, uint8_t* out_vector_data)
 	{
 		vector_unaligned_write(vector, out_vector_data);
@@ -67,11 +77,23 @@ namespace acl
 
 	inline Vector4_32 unpack_vector3_48(const uint8_t* vector_data)
 	{
+#if defined(ACL_SSE2_INTRINSICS)
+		// A single unaligned vector load grabs all three components at once and
+		// reads up to 10 bytes past the sample, which every buffer holding packed
+		// samples guarantees with PACKED_DATA_TAIL_PADDING trailing bytes
+		__m128i zero = _mm_setzero_si128();
+		__m128i packed = _mm_loadu_si128(reinterpret_cast<const __m128i*>(vector_data));
+		__m128 value = _mm_cvtepi32_ps(_mm_unpacklo_epi16(packed, zero));
+		value = _mm_div_ps(value, _mm_set_ps1(65535.0f));
+		value = _mm_sub_ps(_mm_add_ps(value, value), _mm_set_ps1(1.0f));
+		return _mm_and_ps(value, _mm_castsi128_ps(_mm_set_epi32(0, ~0, ~0, ~0)));
+#else
 		const uint16_t* data_ptr_u16 = safe_ptr_cast<const uint16_t>(vector_data);
 		size_t x = data_ptr_u16[0];
 		size_t y = data_ptr_u16[1];
 		size_t z = data_ptr_u16[2];
 		return vector_set(unpack_scalar_signed(x, 16), unpack_scalar_signed(y, 16), unpack_scalar_signed(z, 16));
+#endif
 	}
 
 	template<size_t XBits, size_t YBits, size_t ZBits>
@@ -96,6 +118,24 @@ namespace acl
 	{
 		static_assert(XBits + YBits + ZBits == 32, "Sum of XYZ bits does not equal 32!");
 
+#if defined(ACL_SSE2_INTRINSICS)
+		// A single unaligned 4 byte load replaces the two uint16 reads.
+		// The packer wrote the high half first so the halves swap back with a rotate.
+		// The memcpy keeps the unaligned read well defined and compiles down to
+		// the same single load.
+		uint32_t raw_u32;
+		std::memcpy(&raw_u32, vector_data, sizeof(raw_u32));
+		uint32_t vector_u32 = (raw_u32 << 16) | (raw_u32 >> 16);
+		uint32_t x = vector_u32 >> (YBits + ZBits);
+		uint32_t y = (vector_u32 >> ZBits) & ((1 << YBits) - 1);
+		uint32_t z = vector_u32 & ((1 << ZBits) - 1);
+
+		__m128 value = _mm_cvtepi32_ps(_mm_set_epi32(0, int(z), int(y), int(x)));
+		__m128 max_values = _mm_set_ps(1.0f, float((1 << ZBits) - 1), float((1 << YBits) - 1), float((1 << XBits) - 1));
+		value = _mm_div_ps(value, max_values);
+		value = _mm_sub_ps(_mm_add_ps(value, value), _mm_set_ps1(1.0f));
+		return _mm_and_ps(value, _mm_castsi128_ps(_mm_set_epi32(0, ~0, ~0, ~0)));
+#else
 		// Read 2 bytes at a time to ensure safe alignment
 		const uint16_t* data_ptr_u16 = safe_ptr_cast<const uint16_t>(vector_data);
 		uint32_t vector_u32 = (safe_static_cast<uint32_t>(data_ptr_u16[0]) << 16) | safe_static_cast<uint32_t>(data_ptr_u16[1]);
@@ -103,9 +143,160 @@ namespace acl
 		size_t y = (vector_u32 >> ZBits) & ((1 << YBits) - 1);
 		size_t z = vector_u32 & ((1 << ZBits) - 1);
 		return vector_set(unpack_scalar_signed(x, XBits), unpack_scalar_signed(y, YBits), unpack_scalar_signed(z, ZBits));
+#endif
+	}
+
+	//////////////////////////////////////////////////////////////////////////
+	// Fixed point variants of the fused unpack and interpolate kernels.
+	// The quantized components of both key frames are interpolated directly
+	// with integer math: a widening multiply with a 16.16 fixed point alpha
+	// replaces the float lerp and every component converts to float once at
+	// the end instead of once per key frame. The integer to float conversion
+	// is affine so the result matches lerping the unpacked floats up to
+	// fixed point rounding.
+	//////////////////////////////////////////////////////////////////////////
+
+	// Interpolation alpha in 16.16 fixed point, alpha must be in [0.0, 1.0]
+	inline uint32_t pack_fixed_point_alpha(float alpha)
+	{
+		return uint32_t(alpha * 65536.0f);
+	}
+
+	inline size_t lerp_fixed_point(size_t value0, size_t value1, uint32_t alpha)
+	{
+		const int64_t delta = int64_t(value1) - int64_t(value0);
+		return size_t(int64_t(value0) + ((delta * int64_t(alpha)) >> 16));
+	}
+
+	inline Vector4_32 unpack2_lerp_vector3_48_fixed(const uint8_t* vector_data0, const uint8_t* vector_data1, uint32_t alpha)
+	{
+		const uint16_t* data0_u16 = safe_ptr_cast<const uint16_t>(vector_data0);
+		const uint16_t* data1_u16 = safe_ptr_cast<const uint16_t>(vector_data1);
+		size_t x = lerp_fixed_point(data0_u16[0], data1_u16[0], alpha);
+		size_t y = lerp_fixed_point(data0_u16[1], data1_u16[1], alpha);
+		size_t z = lerp_fixed_point(data0_u16[2], data1_u16[2], alpha);
+		return vector_set(unpack_scalar_signed(x, 16), unpack_scalar_signed(y, 16), unpack_scalar_signed(z, 16));
+	}
+
+	template<size_t XBits, size_t YBits, size_t ZBits>
+	inline Vector4_32 unpack2_lerp_vector3_32_fixed(const uint8_t* vector_data0, const uint8_t* vector_data1, uint32_t alpha)
+	{
+		static_assert(XBits + YBits + ZBits == 32, "Sum of XYZ bits does not equal 32!");
+
+		// Read 2 bytes at a time to ensure safe alignment
+		const uint16_t* data0_u16 = safe_ptr_cast<const uint16_t>(vector_data0);
+		const uint16_t* data1_u16 = safe_ptr_cast<const uint16_t>(vector_data1);
+		uint32_t vector0_u32 = (safe_static_cast<uint32_t>(data0_u16[0]) << 16) | safe_static_cast<uint32_t>(data0_u16[1]);
+		uint32_t vector1_u32 = (safe_static_cast<uint32_t>(data1_u16[0]) << 16) | safe_static_cast<uint32_t>(data1_u16[1]);
+		size_t x = lerp_fixed_point(vector0_u32 >> (YBits + ZBits), vector1_u32 >> (YBits + ZBits), alpha);
+		size_t y = lerp_fixed_point((vector0_u32 >> ZBits) & ((1 << YBits) - 1), (vector1_u32 >> ZBits) & ((1 << YBits) - 1), alpha);
+		size_t z = lerp_fixed_point(vector0_u32 & ((1 << ZBits) - 1), vector1_u32 & ((1 << ZBits) - 1), alpha);
+		return vector_set(unpack_scalar_signed(x, XBits), unpack_scalar_signed(y, YBits), unpack_scalar_signed(z, ZBits));
+	}
+
+	//////////////////////////////////////////////////////////////////////////
+	// Delta packing for delta encoded clips, see
+	// CompressionSettings::enable_delta_encoding.
+	// Every delta stores the change from the previous reconstructed sample in
+	// the normalized domain, clamped to a +-DELTA_ENCODING_WINDOW window and
+	// packed in 32 bits. The window trades precision for reach: a small window
+	// gives temporally coherent tracks an effective precision well above what
+	// 32 bit absolute samples could offer while large jumps are smeared over
+	// several samples until the running reconstruction catches up.
+	// The window is sized for the clip wide normalized domain; per segment
+	// normalization shrinks the extent under the per step deltas and saturates
+	// the clamp, the encoder guards reject that combination.
+	//////////////////////////////////////////////////////////////////////////
+
+	constexpr float DELTA_ENCODING_WINDOW = 0.125f;
+
+	inline void pack_delta_vector3_32(const Vector4_32& delta, uint8_t* out_vector_data)
+	{
+		const Vector4_32 window = vector_set(DELTA_ENCODING_WINDOW);
+		Vector4_32 clamped_delta = vector_max(vector_min(delta, window), vector_neg(window));
+		pack_vector3_32<11, 11, 10>(vector_mul(clamped_delta, 1.0f / DELTA_ENCODING_WINDOW), out_vector_data);
+	}
+
+	inline Vector4_32 unpack_delta_vector3_32(const uint8_t* vector_data)
+	{
+		return vector_mul(unpack_vector3_32<11, 11, 10>(vector_data), DELTA_ENCODING_WINDOW);
 	}
 
 	//////////////////////////////////////////////////////////////////////////
+	// Variable bit rate packing for VectorFormat8::Vector3_Variable.
+	// Every component stores num_bits bits from the bit rate palette, packed
+	// most significant bit first and left aligned within 64 bits so the unpack
+	// shifts depend only on the bit count. The unpack kernel is table driven:
+	// no branching on the rate, only shifts, masks, and a multiply.
+	//////////////////////////////////////////////////////////////////////////
+
+	// (1 << num_bits) - 1 for every bit count in the palette
+	constexpr uint64_t VECTOR3_N_COMPONENT_MASKS[20] =
+	{
+		0x00000, 0x00001, 0x00003, 0x00007, 0x0000F, 0x0001F, 0x0003F, 0x0007F, 0x000FF, 0x001FF,
+		0x003FF, 0x007FF, 0x00FFF, 0x01FFF, 0x03FFF, 0x07FFF, 0x0FFFF, 0x1FFFF, 0x3FFFF, 0x7FFFF,
+	};
+
+	// 1.0 / ((1 << num_bits) - 1) for every bit count in the palette,
+	// the unpack kernel multiplies instead of dividing
+	constexpr float VECTOR3_N_INV_MAX_VALUES[20] =
+	{
+		1.0f, 1.0f / 1.0f, 1.0f / 3.0f, 1.0f / 7.0f, 1.0f / 15.0f, 1.0f / 31.0f, 1.0f / 63.0f, 1.0f / 127.0f, 1.0f / 255.0f, 1.0f / 511.0f,
+		1.0f / 1023.0f, 1.0f / 2047.0f, 1.0f / 4095.0f, 1.0f / 8191.0f, 1.0f / 16383.0f, 1.0f / 32767.0f, 1.0f / 65535.0f, 1.0f / 131071.0f, 1.0f / 262143.0f, 1.0f / 524287.0f,
+	};
+
+	inline void pack_vector3_n(const Vector4_32& vector, uint8_t num_bits, uint8_t* out_vector_data)
+	{
+		ACL_ENSURE(num_bits > 0 && num_bits <= 19, "Invalid number of bits per component: %u", num_bits);
+
+		uint64_t vector_x = pack_scalar_signed(vector_get_x(vector), num_bits);
+		uint64_t vector_y = pack_scalar_signed(vector_get_y(vector), num_bits);
+		uint64_t vector_z = pack_scalar_signed(vector_get_z(vector), num_bits);
+
+		uint64_t vector_u64 = (vector_x << (num_bits * 2)) | (vector_y << num_bits) | vector_z;
+
+		// Left align so the unpack shifts depend only on the bit count
+		vector_u64 <<= 64 - (num_bits * 3);
+
+		// Written a byte at a time to ensure safe alignment
+		uint32_t num_bytes = ((uint32_t(num_bits) * 3) + 7) / 8;
+		for (uint32_t byte_index = 0; byte_index < num_bytes; ++byte_index)
+			out_vector_data[byte_index] = uint8_t(vector_u64 >> (56 - (byte_index * 8)));
+	}
+
+	// Always reads 8 bytes, streams holding variable rate samples pad their
+	// allocation so the last sample reads safely.
+	// A 0 bit rate never reaches the kernel, the decoder reconstructs those
+	// components from the range data alone.
+	inline Vector4_32 unpack_vector3_n(const uint8_t* vector_data, uint8_t num_bits)
+	{
+		ACL_ENSURE(num_bits > 0 && num_bits <= 19, "Invalid number of bits per component: %u", num_bits);
+
+		// Read a byte at a time to ensure safe alignment
+		uint64_t vector_u64 = 0;
+		for (uint32_t byte_index = 0; byte_index < 8; ++byte_index)
+			vector_u64 = (vector_u64 << 8) | vector_data[byte_index];
+
+		const uint64_t mask = VECTOR3_N_COMPONENT_MASKS[num_bits];
+		const float inv_max_value = VECTOR3_N_INV_MAX_VALUES[num_bits];
+
+		size_t x = size_t(vector_u64 >> (64 - num_bits));
+		size_t y = size_t(vector_u64 >> (64 - (num_bits * 2))) & size_t(mask);
+		size_t z = size_t(vector_u64 >> (64 - (num_bits * 3))) & size_t(mask);
+
+		float vector_x = (safe_to_float(x) * inv_max_value * 2.0f) - 1.0f;
+		float vector_y = (safe_to_float(y) * inv_max_value * 2.0f) - 1.0f;
+		float vector_z = (safe_to_float(z) * inv_max_value * 2.0f) - 1.0f;
+		return vector_set(vector_x, vector_y, vector_z);
+	}
+
+	//////////////////////////////////////////////////////////////////////////
+
+	// Packed size in bytes at each bit rate, excluding the tail padding needed by unpack_vector3_n
+	constexpr uint32_t get_packed_vector_size_at_bit_rate(uint8_t bit_rate)
+	{
+		return ((uint32_t(get_num_bits_at_bit_rate(bit_rate)) * 3) + 7) / 8;
+	}
 
 	// TODO: constexpr
 	inline uint32_t get_packed_vector_size(VectorFormat8 format)
@@ -115,6 +306,9 @@ namespace acl
 		case VectorFormat8::Vector3_96:		return sizeof(float) * 3;
 		case VectorFormat8::Vector3_48:		return sizeof(uint16_t) * 3;
 		case VectorFormat8::Vector3_32:		return sizeof(uint32_t);
+		case VectorFormat8::Vector3_Variable:
+			ACL_ENSURE(false, "Vector3 Variable size depends on the bit rate, use get_packed_vector_size_at_bit_rate");
+			return 0;
 		default:
 			ACL_ENSURE(false, "Invalid or unsupported vector format: %s", get_vector_format_name(format));
 			return 0;
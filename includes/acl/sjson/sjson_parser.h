@@ -24,11 +24,14 @@
 // SOFTWARE.
 ////////////////////////////////////////////////////////////////////////////////
 
+#include "acl/core/error.h"
 #include "acl/core/string_view.h"
+#include "acl/math/math.h"
 #include "acl/sjson/sjson_parser_error.h"
 
 #include <cctype>
 #include <cmath>
+#include <cstring>
 #include <stdint.h>
 
 namespace acl
@@ -45,16 +48,49 @@ namespace acl
 	     - unescaping characters within strings; the returned string view will be
 		   exactly as the string appears in the JSON.
     */
+	// Reads up to buffer_size bytes at the provided input offset into the provided
+	// buffer and returns the number of bytes actually read. Used by the streaming
+	// parser mode to pull input on demand, reads can happen at any offset.
+	using SJSONReadCallback = size_t(*)(void* user_data, size_t offset, char* buffer, size_t buffer_size);
+
 	class SJSONParser
 	{
 	public:
 		SJSONParser(const char* input, size_t input_length)
 			: m_input(input)
 			, m_input_length(input_length)
+			, m_window_buffer(nullptr)
+			, m_window_size(input_length)
+			, m_window_start(0)
+			, m_window_end(input_length)
+			, m_read_callback(nullptr)
+			, m_callback_user_data(nullptr)
 			, m_state(input, input_length)
 		{
 		}
 
+		// Streaming mode: the parser never holds more than the provided window of
+		// text and pulls input through the read callback as it advances. The caller
+		// owns the window buffer and must keep it alive while parsing. Individual
+		// tokens and the string views returned must fit within the window.
+		SJSONParser(char* window_buffer, size_t window_size, size_t input_length, SJSONReadCallback read_callback, void* callback_user_data)
+			: m_input(window_buffer)
+			, m_input_length(input_length)
+			, m_window_buffer(window_buffer)
+			, m_window_size(window_size)
+			, m_window_start(0)
+			, m_window_end(0)
+			, m_read_callback(read_callback)
+			, m_callback_user_data(callback_user_data)
+			, m_state(nullptr, 0)
+		{
+			ACL_ENSURE(window_buffer != nullptr, "A window buffer is required to stream");
+			ACL_ENSURE(window_size > WINDOW_BACK_SLACK, "Streaming window is too small: %u", window_size);
+			ACL_ENSURE(read_callback != nullptr, "A read callback is required to stream");
+
+			m_state.symbol = symbol_at(0);
+		}
+
 		bool object_begins() { return read_opening_brace(); }
 		bool object_begins(const char* having_name) { return read_key(having_name) && read_equal_sign() && object_begins(); }
 		bool object_ends() { return read_closing_brace(); }
@@ -103,9 +139,48 @@ namespace acl
 			if (num_elements == 0)
 				return true;
 
+			return read_double_array(values, num_elements);
+		}
+
+		// Bulk fast path for comma separated runs of numbers, the bulk of a clip
+		// file. The cursor lives in locals instead of going through advance() for
+		// every character, digits convert eight at a time, and whitespace is
+		// scanned a chunk at a time with SSE when available. Track parsing in
+		// ClipReader is entirely made of these.
+		bool read_double_array(double* values, uint32_t num_elements)
+		{
+			// The streaming window cannot be scanned in place, parse one value at a time
+			if (m_read_callback != nullptr)
+			{
+				for (uint32_t i = 0; i < num_elements; ++i)
+				{
+					if (!read_double(values[i]) || i < num_elements - 1 && !read_comma())
+						return false;
+				}
+
+				return true;
+			}
+
 			for (uint32_t i = 0; i < num_elements; ++i)
 			{
-				if (!read_double(values[i]) || i < num_elements - 1 && !read_comma())
+				if (i != 0)
+				{
+					if (!skip_whitespace_fast())
+						return false;
+
+					if (m_state.symbol != ',')
+					{
+						set_error(SJSONParserError::CommaExpected);
+						return false;
+					}
+
+					sync_state_at(m_state.offset + 1);
+				}
+
+				if (!skip_whitespace_fast())
+					return false;
+
+				if (!read_double_fast(values[i]))
 					return false;
 			}
 
@@ -213,15 +288,61 @@ namespace acl
 
 		State save_state() const { return m_state; }
 		void restore_state(const State& s) { m_state = s; }
-		void reset_state() { m_state = State(m_input, m_input_length); }
+		void reset_state()
+		{
+			m_state = State(nullptr, 0);
+			m_state.symbol = symbol_at(0);
+		}
 
 	private:
 		static size_t constexpr MAX_NUMBER_LENGTH = 64;
 
-		const char* m_input;
+		// When refilling the window, this many bytes before the requested offset are
+		// kept so tokens being read across a refill remain addressable
+		static size_t constexpr WINDOW_BACK_SLACK = 4 * MAX_NUMBER_LENGTH;
+
+		const char* m_input;				// The whole input, or the streaming window buffer
 		const size_t m_input_length;
+
+		// Streaming mode support, the window covers input offsets [m_window_start, m_window_end)
+		char* m_window_buffer;
+		size_t m_window_size;
+		size_t m_window_start;
+		size_t m_window_end;
+		SJSONReadCallback m_read_callback;
+		void* m_callback_user_data;
+
 		State m_state;
 
+		bool fill_window(size_t offset)
+		{
+			size_t new_window_start = offset >= WINDOW_BACK_SLACK ? offset - WINDOW_BACK_SLACK : 0;
+			size_t num_bytes_read = m_read_callback(m_callback_user_data, new_window_start, m_window_buffer, m_window_size);
+			m_window_start = new_window_start;
+			m_window_end = new_window_start + num_bytes_read;
+			return offset < m_window_end;
+		}
+
+		char symbol_at(size_t offset)
+		{
+			if (offset >= m_input_length)
+				return '\0';
+
+			if (offset < m_window_start || offset >= m_window_end)
+			{
+				if (m_read_callback == nullptr || !fill_window(offset))
+					return '\0';
+			}
+
+			return m_input[offset - m_window_start];
+		}
+
+		const char* ptr_at(size_t offset)
+		{
+			ACL_ENSURE(offset >= m_window_start && offset < m_window_end, "Token does not fit within the streaming window");
+			return m_input + (offset - m_window_start);
+		}
+
 		bool read_equal_sign()      { return read_symbol('=', SJSONParserError::EqualSignExpected); }
 		bool read_opening_brace()   { return read_symbol('{', SJSONParserError::OpeningBraceExpected); }
 		bool read_closing_brace()   { return read_symbol('}', SJSONParserError::ClosingBraceExpected); }
@@ -366,7 +487,7 @@ namespace acl
 				advance();
 			}
 
-			value = StringView(m_input + start_offset, end_offset - start_offset + 1);
+			value = StringView(ptr_at(start_offset), end_offset - start_offset + 1);
 			return true;
 		}
 
@@ -417,7 +538,7 @@ namespace acl
 				advance();
 			}
 
-			value = StringView(m_input + start_offset, end_offset - start_offset + 1);
+			value = StringView(ptr_at(start_offset), end_offset - start_offset + 1);
 			return true;
 		}
 
@@ -521,7 +642,7 @@ namespace acl
 				return false;
 			}
 
-			std::memcpy(slice, m_input + start_offset, length);
+			std::memcpy(slice, ptr_at(start_offset), length);
 			slice[length] = '\0';
 
 			char* last_used_symbol = nullptr;
@@ -536,6 +657,263 @@ namespace acl
 			return true;
 		}
 
+		//////////////////////////////////////////////////////////////////////////
+		// Fast path internals for read_double_array, whole buffer mode only
+
+		// The significand digits we can accumulate in 64 bits
+		static uint32_t constexpr MAX_SIGNIFICAND_DIGITS = 19;
+
+		// Moves the cursor to new_offset, updating the line and column the same
+		// way advance() would have one character at a time
+		void sync_state_at(size_t new_offset)
+		{
+			for (size_t offset = m_state.offset + 1; offset <= new_offset && offset < m_input_length; ++offset)
+			{
+				if (m_input[offset] == '\n')
+				{
+					++m_state.line;
+					m_state.column = 1;
+				}
+				else
+					++m_state.column;
+			}
+
+			m_state.offset = new_offset;
+			m_state.symbol = new_offset < m_input_length ? m_input[new_offset] : '\0';
+		}
+
+		// Skips whitespace without touching the parser state until the extent is
+		// known, falling back to the slow path when a comment begins
+		bool skip_whitespace_fast()
+		{
+			const char* input = m_input;
+			const size_t input_length = m_input_length;
+
+			while (true)
+			{
+				size_t offset = m_state.offset;
+
+#if defined(ACL_SSE2_INTRINSICS)
+				const __m128i space = _mm_set1_epi8(' ');
+				const __m128i tab = _mm_set1_epi8('\t');
+				const __m128i newline = _mm_set1_epi8('\n');
+				const __m128i carriage_return = _mm_set1_epi8('\r');
+
+				while (offset + 16 <= input_length)
+				{
+					__m128i chunk = _mm_loadu_si128(reinterpret_cast<const __m128i*>(input + offset));
+					__m128i is_whitespace = _mm_or_si128(
+						_mm_or_si128(_mm_cmpeq_epi8(chunk, space), _mm_cmpeq_epi8(chunk, tab)),
+						_mm_or_si128(_mm_cmpeq_epi8(chunk, newline), _mm_cmpeq_epi8(chunk, carriage_return)));
+
+					if (_mm_movemask_epi8(is_whitespace) != 0xFFFF)
+						break;		// The scalar loop below finds the exact extent
+
+					offset += 16;
+				}
+#endif
+
+				while (offset < input_length && std::isspace(input[offset]))
+					++offset;
+
+				sync_state_at(offset);
+
+				// Comments between numbers are rare, let the slow path consume one
+				// and come back, it leaves the cursor right after the comment
+				if (m_state.symbol == '/')
+				{
+					if (!skip_comments_and_whitespace_fail_if_eof())
+						return false;
+
+					continue;
+				}
+
+				if (eof())
+				{
+					set_error(SJSONParserError::InputTruncated);
+					return false;
+				}
+
+				return true;
+			}
+		}
+
+		// All eight characters are decimal digits. Little endian, the first
+		// character sits in the lowest byte
+		static bool are_eight_digits(uint64_t chunk)
+		{
+			return (((chunk + 0x4646464646464646ull) | (chunk - 0x3030303030303030ull)) & 0x8080808080808080ull) == 0;
+		}
+
+		// Converts eight ASCII digits with three multiplies instead of eight
+		static uint32_t convert_eight_digits(uint64_t chunk)
+		{
+			chunk -= 0x3030303030303030ull;
+			uint64_t pairs = ((chunk * (1 + (10ull << 8))) >> 8) & 0x00FF00FF00FF00FFull;
+			uint64_t quads = ((pairs * (1 + (100ull << 16))) >> 16) & 0x0000FFFF0000FFFFull;
+			return uint32_t((quads * (1 + (10000ull << 32))) >> 32);
+		}
+
+		// Scans a run of decimal digits, converting eight at a time when possible.
+		// Digits past what fits in the significand are consumed but dropped
+		static void scan_digits(const char* input, size_t input_length, size_t& offset, uint64_t& significand, uint32_t& num_digits, uint32_t& num_dropped_digits)
+		{
+			while (offset + 8 <= input_length)
+			{
+				uint64_t chunk;
+				std::memcpy(&chunk, input + offset, sizeof(chunk));
+				if (!are_eight_digits(chunk))
+					break;
+
+				if (num_digits + 8 <= MAX_SIGNIFICAND_DIGITS)
+				{
+					significand = (significand * 100000000ull) + convert_eight_digits(chunk);
+					num_digits += 8;
+				}
+				else
+					num_dropped_digits += 8;
+
+				offset += 8;
+			}
+
+			while (offset < input_length && input[offset] >= '0' && input[offset] <= '9')
+			{
+				if (num_digits < MAX_SIGNIFICAND_DIGITS)
+				{
+					significand = (significand * 10) + uint64_t(input[offset] - '0');
+					++num_digits;
+				}
+				else
+					++num_dropped_digits;
+
+				++offset;
+			}
+		}
+
+		// Parses a number straight out of the input buffer. When the significand
+		// fits in 53 bits and the exponent within the table, scaling by an exact
+		// power of ten yields the correctly rounded result and strtod is never
+		// called. Everything else, a couple numbers per clip, goes through the
+		// strtod fallback so no value ever parses differently than read_double
+		bool read_double_fast(double& value)
+		{
+			const char* input = m_input;
+			const size_t input_length = m_input_length;
+			size_t offset = m_state.offset;
+			size_t start_offset = offset;
+
+			bool is_negative = false;
+			if (offset < input_length && input[offset] == '-')
+			{
+				is_negative = true;
+				++offset;
+			}
+
+			uint64_t significand = 0;
+			uint32_t num_digits = 0;
+			uint32_t num_dropped_digits = 0;
+
+			size_t integer_start = offset;
+			scan_digits(input, input_length, offset, significand, num_digits, num_dropped_digits);
+
+			if (offset == integer_start)
+			{
+				set_error(SJSONParserError::NumberExpected);
+				return false;
+			}
+
+			uint32_t num_dropped_integer_digits = num_dropped_digits;
+
+			int32_t exponent = 0;
+			if (offset < input_length && input[offset] == '.')
+			{
+				++offset;
+
+				uint32_t num_digits_before_fraction = num_digits;
+				scan_digits(input, input_length, offset, significand, num_digits, num_dropped_digits);
+
+				exponent -= int32_t(num_digits - num_digits_before_fraction);
+			}
+
+			if (offset < input_length && (input[offset] == 'e' || input[offset] == 'E'))
+			{
+				++offset;
+
+				bool is_exponent_negative = false;
+				if (offset < input_length && (input[offset] == '+' || input[offset] == '-'))
+				{
+					is_exponent_negative = input[offset] == '-';
+					++offset;
+				}
+
+				if (offset >= input_length || input[offset] < '0' || input[offset] > '9')
+				{
+					sync_state_at(offset);
+					set_error(SJSONParserError::InvalidNumber);
+					return false;
+				}
+
+				int32_t explicit_exponent = 0;
+				while (offset < input_length && input[offset] >= '0' && input[offset] <= '9')
+				{
+					if (explicit_exponent < 100000)
+						explicit_exponent = (explicit_exponent * 10) + (input[offset] - '0');
+
+					++offset;
+				}
+
+				exponent += is_exponent_negative ? -explicit_exponent : explicit_exponent;
+			}
+
+			exponent += int32_t(num_dropped_integer_digits);
+
+			// Powers of ten up to 1e22 are exactly representable as doubles
+			static constexpr double EXACT_POWERS_OF_TEN[23] =
+			{
+				1e0, 1e1, 1e2, 1e3, 1e4, 1e5, 1e6, 1e7, 1e8, 1e9, 1e10, 1e11,
+				1e12, 1e13, 1e14, 1e15, 1e16, 1e17, 1e18, 1e19, 1e20, 1e21, 1e22,
+			};
+
+			if (num_dropped_digits == 0 && significand <= (1ull << 53) && exponent >= -22 && exponent <= 22)
+			{
+				double result = double(significand);
+				if (exponent < 0)
+					result /= EXACT_POWERS_OF_TEN[-exponent];
+				else
+					result *= EXACT_POWERS_OF_TEN[exponent];
+
+				value = is_negative ? -result : result;
+			}
+			else
+			{
+				size_t length = offset - start_offset;
+
+				char slice[MAX_NUMBER_LENGTH + 1];
+				if (length >= MAX_NUMBER_LENGTH)
+				{
+					sync_state_at(offset);
+					set_error(SJSONParserError::NumberIsTooLong);
+					return false;
+				}
+
+				std::memcpy(slice, input + start_offset, length);
+				slice[length] = '\0';
+
+				char* last_used_symbol = nullptr;
+				value = std::strtod(slice, &last_used_symbol);
+
+				if (last_used_symbol != slice + length)
+				{
+					sync_state_at(offset);
+					set_error(SJSONParserError::NumberCouldNotBeConverted);
+					return false;
+				}
+			}
+
+			sync_state_at(offset);
+			return true;
+		}
+
 		bool skip_comments_and_whitespace_fail_if_eof()
 		{
 			if (!skip_comments_and_whitespace())
@@ -563,7 +941,7 @@ namespace acl
 			}
 			else
 			{
-				m_state.symbol = m_input[m_state.offset];
+				m_state.symbol = symbol_at(m_state.offset);
 
 				if (m_state.symbol == '\n')
 				{
@@ -33,6 +33,8 @@
 #include <Windows.h>
 #include <conio.h>
 
+#include <algorithm>
+#include <atomic>
 #include <cstring>
 #include <cstdio>
 #include <fstream>
@@ -40,6 +42,9 @@
 #include <sstream>
 #include <string>
 #include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
 
 //#define ACL_RUN_UNIT_TESTS
 
@@ -106,6 +111,10 @@ struct RawOutputWriterImpl : public acl::OutputWriter
 struct Options
 {
 	const char*		input_filename;
+	const char*		input_directory;
+	const char*		input_list_filename;
+	const char*		cache_directory;
+	uint32_t		num_threads;
 	bool			output_stats;
 	const char*		output_stats_filename;
 
@@ -114,14 +123,23 @@ struct Options
 	std::FILE*		output_stats_file;
 
 	Options()
-		: input_filename(nullptr),
-		  output_stats(false)
+		: input_filename(nullptr)
+		, input_directory(nullptr)
+		, input_list_filename(nullptr)
+		, cache_directory(nullptr)
+		, num_threads(0)
+		, output_stats(false)
 		, output_stats_filename(nullptr)
 		, output_stats_file(nullptr)
 	{}
 
 	Options(Options&& other)
-		: output_stats(other.output_stats)
+		: input_filename(other.input_filename)
+		, input_directory(other.input_directory)
+		, input_list_filename(other.input_list_filename)
+		, cache_directory(other.cache_directory)
+		, num_threads(other.num_threads)
+		, output_stats(other.output_stats)
 		, output_stats_filename(other.output_stats_filename)
 		, output_stats_file(other.output_stats_file)
 	{
@@ -136,9 +154,15 @@ struct Options
 
 	Options& operator=(Options&& rhs)
 	{
+		std::swap(input_filename, rhs.input_filename);
+		std::swap(input_directory, rhs.input_directory);
+		std::swap(input_list_filename, rhs.input_list_filename);
+		std::swap(cache_directory, rhs.cache_directory);
+		std::swap(num_threads, rhs.num_threads);
 		std::swap(output_stats, rhs.output_stats);
 		std::swap(output_stats_filename, rhs.output_stats_filename);
 		std::swap(output_stats_file, rhs.output_stats_file);
+		return *this;
 	}
 
 	Options(const Options&) = delete;
@@ -154,6 +178,10 @@ struct Options
 };
 
 constexpr char* ACL_INPUT_FILE_OPTION = "-acl=";
+constexpr char* ACL_INPUT_DIR_OPTION = "-acl_dir=";
+constexpr char* ACL_INPUT_LIST_OPTION = "-acl_list=";
+constexpr char* CACHE_DIR_OPTION = "-cache=";
+constexpr char* NUM_THREADS_OPTION = "-threads=";
 constexpr char* STATS_OUTPUT_OPTION = "-stats";
 
 static bool parse_options(int argc, char** argv, Options& options)
@@ -169,6 +197,34 @@ static bool parse_options(int argc, char** argv, Options& options)
 			continue;
 		}
 
+		option_length = std::strlen(ACL_INPUT_DIR_OPTION);
+		if (std::strncmp(argument, ACL_INPUT_DIR_OPTION, option_length) == 0)
+		{
+			options.input_directory = argument + option_length;
+			continue;
+		}
+
+		option_length = std::strlen(ACL_INPUT_LIST_OPTION);
+		if (std::strncmp(argument, ACL_INPUT_LIST_OPTION, option_length) == 0)
+		{
+			options.input_list_filename = argument + option_length;
+			continue;
+		}
+
+		option_length = std::strlen(CACHE_DIR_OPTION);
+		if (std::strncmp(argument, CACHE_DIR_OPTION, option_length) == 0)
+		{
+			options.cache_directory = argument + option_length;
+			continue;
+		}
+
+		option_length = std::strlen(NUM_THREADS_OPTION);
+		if (std::strncmp(argument, NUM_THREADS_OPTION, option_length) == 0)
+		{
+			options.num_threads = uint32_t(atoi(argument + option_length));
+			continue;
+		}
+
 		option_length = std::strlen(STATS_OUTPUT_OPTION);
 		if (std::strncmp(argument, STATS_OUTPUT_OPTION, option_length) == 0)
 		{
@@ -182,9 +238,17 @@ static bool parse_options(int argc, char** argv, Options& options)
 		return false;
 	}
 
-	if (options.input_filename == nullptr || std::strlen(options.input_filename) == 0)
+	int num_input_options = 0;
+	if (options.input_filename != nullptr && std::strlen(options.input_filename) != 0)
+		num_input_options++;
+	if (options.input_directory != nullptr && std::strlen(options.input_directory) != 0)
+		num_input_options++;
+	if (options.input_list_filename != nullptr && std::strlen(options.input_list_filename) != 0)
+		num_input_options++;
+
+	if (num_input_options != 1)
 	{
-		printf("An input file is required.\n");
+		printf("Exactly one input is required: -acl=<file>, -acl_dir=<directory>, or -acl_list=<response file>.\n");
 		return false;
 	}
 
@@ -286,9 +350,9 @@ static void run_unit_tests()
 }
 #endif
 
-static void print_stats(const Options& options, const acl::AnimationClip& clip, const acl::CompressedClip& compressed_clip, uint64_t elapsed_cycles, double max_error, acl::IAlgorithm& algorithm)
+static void print_stats(std::FILE* file, const char* clip_filename, const acl::AnimationClip& clip, const acl::CompressedClip& compressed_clip, uint64_t elapsed_cycles, double max_error, acl::IAlgorithm& algorithm, const acl::CompressionStats& compression_stats)
 {
-	if (!options.output_stats)
+	if (file == nullptr)
 		return;
 
 	uint32_t raw_size = clip.get_total_size();
@@ -299,8 +363,7 @@ static void print_stats(const Options& options, const acl::AnimationClip& clip,
 	QueryPerformanceFrequency(&frequency_cycles_per_sec);
 	double elapsed_time_sec = double(elapsed_cycles) / double(frequency_cycles_per_sec.QuadPart);
 
-	std::FILE* file = options.output_stats_file;
-
+	fprintf(file, "Clip source file: %s\n", clip_filename);
 	fprintf(file, "Clip algorithm: %s\n", get_algorithm_name(compressed_clip.get_algorithm_type()));
 	fprintf(file, "Clip raw size (bytes): %u\n", raw_size);
 	fprintf(file, "Clip compressed size (bytes): %u\n", compressed_size);
@@ -309,6 +372,7 @@ static void print_stats(const Options& options, const acl::AnimationClip& clip,
 	fprintf(file, "Clip compression time (s): %.6f\n", elapsed_time_sec);
 	fprintf(file, "Clip duration (s): %.3f\n", clip.get_duration());
 	//fprintf(file, "Clip num segments: %u\n", 0);		// TODO
+	acl::print_stats(compression_stats, file);
 	algorithm.print_stats(compressed_clip, file);
 	fprintf(file, "\n");
 }
@@ -320,6 +384,8 @@ static double find_max_error(acl::Allocator& allocator, const acl::AnimationClip
 	uint16_t num_bones = clip.get_num_bones();
 	RawOutputWriterImpl raw_output_writer(allocator, num_bones);
 	Transform_32* lossy_pose_transforms = allocate_type_array<Transform_32>(allocator, num_bones);
+	SkeletonErrorMetricContext error_metric_context(allocator, skeleton);
+	AnimationClipSamplingContext sampling_context(clip);
 
 	double max_error = -1.0;
 	double sample_time = 0.0;
@@ -327,10 +393,11 @@ static double find_max_error(acl::Allocator& allocator, const acl::AnimationClip
 	double sample_increment = 1.0 / clip.get_sample_rate();
 	while (sample_time < clip_duration)
 	{
-		clip.sample_pose(sample_time, raw_output_writer);
+		sampling_context.seek(sample_time);
+		sampling_context.sample_pose(raw_output_writer);
 		algorithm.decompress_pose(compressed_clip, (float)sample_time, lossy_pose_transforms, num_bones);
 
-		double error = calculate_skeleton_error(allocator, skeleton, raw_output_writer.m_transforms, lossy_pose_transforms);
+		double error = error_metric_context.calculate_error(raw_output_writer.m_transforms, lossy_pose_transforms);
 		max_error = max(max_error, error);
 
 		sample_time += sample_increment;
@@ -338,10 +405,11 @@ static double find_max_error(acl::Allocator& allocator, const acl::AnimationClip
 
 	// Make sure we test the last sample time possible as well
 	{
-		clip.sample_pose(clip_duration, raw_output_writer);
+		sampling_context.seek(clip_duration);
+		sampling_context.sample_pose(raw_output_writer);
 		algorithm.decompress_pose(compressed_clip, (float)clip_duration, lossy_pose_transforms, num_bones);
 
-		double error = calculate_skeleton_error(allocator, skeleton, raw_output_writer.m_transforms, lossy_pose_transforms);
+		double error = error_metric_context.calculate_error(raw_output_writer.m_transforms, lossy_pose_transforms);
 		max_error = max(max_error, error);
 	}
 
@@ -362,32 +430,231 @@ static double find_max_error(acl::Allocator& allocator, const acl::AnimationClip
 	return max_error;
 }
 
-static void try_algorithm(const Options& options, acl::Allocator& allocator, const acl::AnimationClip& clip, const acl::RigidSkeleton& skeleton, acl::IAlgorithm &algorithm)
+//////////////////////////////////////////////////////////////////////////
+// Cook cache. Compressing a clip is orders of magnitude slower than reading
+// the result back so when -cache=<directory> is given, every compressed clip
+// is stored in a content addressed record: the key hashes the raw clip
+// samples, the skeleton, and the compression settings with the same crc32
+// the compressed clip uses for integrity. An unchanged input finds its
+// record and skips both compression and error measurement, the stats come
+// from the figures stored alongside the clip.
+//////////////////////////////////////////////////////////////////////////
+
+// Bumping the version invalidates every record, do so whenever the encoder
+// output or the hashed inputs change meaning
+constexpr uint32_t COOK_CACHE_TAG = 0xac10cace;
+constexpr uint32_t COOK_CACHE_VERSION = 1;
+
+struct CookCacheRecord
+{
+	uint32_t	tag;
+	uint32_t	version;
+	uint32_t	compressed_size;
+	uint32_t	padding;
+	uint64_t	elapsed_cycles;
+	double		max_error;
+};
+
+static uint32_t hash_animation_clip(const acl::AnimationClip& clip, uint32_t hash)
+{
+	using namespace acl;
+
+	uint16_t num_bones = clip.get_num_bones();
+	uint32_t num_samples = clip.get_num_samples();
+	uint32_t sample_rate = clip.get_sample_rate();
+	double error_threshold = clip.get_error_threshold();
+	bool has_scale = clip.has_scale_tracks();
+
+	hash = crc32(&num_bones, sizeof(num_bones), hash);
+	hash = crc32(&num_samples, sizeof(num_samples), hash);
+	hash = crc32(&sample_rate, sizeof(sample_rate), hash);
+	hash = crc32(&error_threshold, sizeof(error_threshold), hash);
+	hash = crc32(&has_scale, sizeof(has_scale), hash);
+
+	const AnimatedBone* bones = clip.get_bones();
+	for (uint16_t bone_index = 0; bone_index < num_bones; ++bone_index)
+	{
+		uint32_t track_hash = bones[bone_index].rotation_track.get_hash();
+		hash = crc32(&track_hash, sizeof(track_hash), hash);
+
+		track_hash = bones[bone_index].translation_track.get_hash();
+		hash = crc32(&track_hash, sizeof(track_hash), hash);
+
+		if (has_scale)
+		{
+			track_hash = bones[bone_index].scale_track.get_hash();
+			hash = crc32(&track_hash, sizeof(track_hash), hash);
+		}
+	}
+
+	return hash;
+}
+
+static uint32_t hash_rigid_skeleton(const acl::RigidSkeleton& skeleton, uint32_t hash)
+{
+	using namespace acl;
+
+	uint16_t num_bones = skeleton.get_num_bones();
+	hash = crc32(&num_bones, sizeof(num_bones), hash);
+
+	const RigidBone* bones = skeleton.get_bones();
+	for (uint16_t bone_index = 0; bone_index < num_bones; ++bone_index)
+	{
+		const RigidBone& bone = bones[bone_index];
+
+		hash = crc32(&bone.parent_index, sizeof(bone.parent_index), hash);
+		hash = crc32(&bone.vertex_distance, sizeof(bone.vertex_distance), hash);
+
+		// Extracted component wise so the hash does not depend on the SIMD representation
+		double bind_pose[7] =
+		{
+			quat_get_x(bone.bind_rotation), quat_get_y(bone.bind_rotation), quat_get_z(bone.bind_rotation), quat_get_w(bone.bind_rotation),
+			vector_get_x(bone.bind_translation), vector_get_y(bone.bind_translation), vector_get_z(bone.bind_translation),
+		};
+		hash = crc32(&bind_pose[0], sizeof(bind_pose), hash);
+	}
+
+	return hash;
+}
+
+static uint32_t hash_compression_settings(const acl::uniformly_sampled::CompressionSettings& settings, uint16_t num_bones, uint32_t hash)
+{
+	using namespace acl;
+
+	// Hashed field by field: the struct carries padding and the task scheduler
+	// pointer, neither of which affects the compressed output
+	hash = crc32(&settings.rotation_format, sizeof(settings.rotation_format), hash);
+	hash = crc32(&settings.translation_format, sizeof(settings.translation_format), hash);
+	hash = crc32(&settings.range_reduction, sizeof(settings.range_reduction), hash);
+	hash = crc32(&settings.enable_error_driven_constant_tracks, sizeof(settings.enable_error_driven_constant_tracks), hash);
+	hash = crc32(&settings.enable_variable_quantization, sizeof(settings.enable_variable_quantization), hash);
+	hash = crc32(&settings.data_layout, sizeof(settings.data_layout), hash);
+	hash = crc32(&settings.interleave_key_frame_pairs, sizeof(settings.interleave_key_frame_pairs), hash);
+	hash = crc32(&settings.enable_delta_encoding, sizeof(settings.enable_delta_encoding), hash);
+	hash = crc32(&settings.generate_telemetry, sizeof(settings.generate_telemetry), hash);
+	hash = crc32(&settings.num_lod_levels, sizeof(settings.num_lod_levels), hash);
+	if (settings.bone_lod_levels != nullptr)
+		hash = crc32(settings.bone_lod_levels, num_bones, hash);
+	hash = crc32(&settings.num_samples_per_segment, sizeof(settings.num_samples_per_segment), hash);
+	hash = crc32(&settings.target_sample_rate, sizeof(settings.target_sample_rate), hash);
+	hash = crc32(&settings.enable_error_driven_downsampling, sizeof(settings.enable_error_driven_downsampling), hash);
+
+	return hash;
+}
+
+static std::string make_cache_record_path(const char* cache_directory, uint32_t cook_hash)
+{
+	std::string directory = cache_directory;
+	while (!directory.empty() && (directory.back() == '\\' || directory.back() == '/'))
+		directory.pop_back();
+
+	char record_filename[32];
+	sprintf_s(record_filename, "%08x.acl.cache", cook_hash);
+	return directory + "\\" + record_filename;
+}
+
+static acl::CompressedClip* read_cache_record(acl::Allocator& allocator, const char* record_path, CookCacheRecord& out_record)
+{
+	using namespace acl;
+
+	std::FILE* file = nullptr;
+	fopen_s(&file, record_path, "rb");
+	if (file == nullptr)
+		return nullptr;
+
+	CookCacheRecord record;
+	if (fread(&record, sizeof(record), 1, file) != 1 || record.tag != COOK_CACHE_TAG || record.version != COOK_CACHE_VERSION || record.compressed_size == 0)
+	{
+		std::fclose(file);
+		return nullptr;
+	}
+
+	void* buffer = allocator.allocate(record.compressed_size, alignof(CompressedClip));
+	size_t num_bytes_read = fread(buffer, 1, record.compressed_size, file);
+	std::fclose(file);
+
+	// The clip carries its own crc so a truncated or stale record reads as invalid
+	// and falls back to compression like a plain miss
+	CompressedClip* compressed_clip = reinterpret_cast<CompressedClip*>(buffer);
+	if (num_bytes_read != record.compressed_size || !compressed_clip->is_valid(true) || compressed_clip->get_size() != record.compressed_size)
+	{
+		allocator.deallocate(buffer, record.compressed_size);
+		return nullptr;
+	}
+
+	out_record = record;
+	return compressed_clip;
+}
+
+static void write_cache_record(const char* record_path, const acl::CompressedClip& compressed_clip, uint64_t elapsed_cycles, double max_error)
+{
+	std::FILE* file = nullptr;
+	fopen_s(&file, record_path, "wb");
+	if (file == nullptr)
+		return;		// The cache directory might not exist, a failed write only costs a future miss
+
+	CookCacheRecord record;
+	record.tag = COOK_CACHE_TAG;
+	record.version = COOK_CACHE_VERSION;
+	record.compressed_size = compressed_clip.get_size();
+	record.padding = 0;
+	record.elapsed_cycles = elapsed_cycles;
+	record.max_error = max_error;
+
+	fwrite(&record, sizeof(record), 1, file);
+	fwrite(&compressed_clip, 1, record.compressed_size, file);
+	std::fclose(file);
+}
+
+static void try_algorithm(std::FILE* stats_file, const char* clip_filename, const char* cache_record_path, acl::Allocator& allocator, const acl::AnimationClip& clip, const acl::RigidSkeleton& skeleton, acl::IAlgorithm &algorithm)
 {
 	using namespace acl;
 
+	if (cache_record_path != nullptr)
+	{
+		CookCacheRecord record;
+		CompressedClip* cached_clip = read_cache_record(allocator, cache_record_path, record);
+		if (cached_clip != nullptr)
+		{
+			// Only the total time and max error survive in the record, the per pass
+			// breakdown belongs to the compression run that produced it
+			CompressionStats compression_stats;
+			print_stats(stats_file, clip_filename, clip, *cached_clip, record.elapsed_cycles, record.max_error, algorithm, compression_stats);
+
+			allocator.deallocate(cached_clip, record.compressed_size);
+			return;
+		}
+	}
+
 	LARGE_INTEGER start_time_cycles;
 	QueryPerformanceCounter(&start_time_cycles);
 
-	CompressedClip* compressed_clip = algorithm.compress_clip(allocator, clip, skeleton);
+	CompressionStats compression_stats;
+	CompressedClip* compressed_clip = algorithm.compress_clip(allocator, clip, skeleton, &compression_stats);
 
 	LARGE_INTEGER end_time_cycles;
 	QueryPerformanceCounter(&end_time_cycles);
 
 	ACL_ENSURE(compressed_clip->is_valid(true), "Compressed clip is invalid");
 
+	uint64_t elapsed_cycles = end_time_cycles.QuadPart - start_time_cycles.QuadPart;
 	double max_error = find_max_error(allocator, clip, skeleton, *compressed_clip, algorithm);
 
-	print_stats(options, clip, *compressed_clip, end_time_cycles.QuadPart - start_time_cycles.QuadPart, max_error, algorithm);
+	if (cache_record_path != nullptr)
+		write_cache_record(cache_record_path, *compressed_clip, elapsed_cycles, max_error);
+
+	print_stats(stats_file, clip_filename, clip, *compressed_clip, elapsed_cycles, max_error, algorithm, compression_stats);
 
 	allocator.deallocate(compressed_clip, compressed_clip->get_size());
 }
 
 static bool read_clip(acl::Allocator& allocator, const char* filename,
 					  std::unique_ptr<acl::AnimationClip, acl::Deleter<acl::AnimationClip>>& clip,
-					  std::unique_ptr<acl::RigidSkeleton, acl::Deleter<acl::RigidSkeleton>>& skeleton)
+					  std::unique_ptr<acl::RigidSkeleton, acl::Deleter<acl::RigidSkeleton>>& skeleton,
+					  bool verbose)
 {
-	printf("Reading ACL input clip...");
+	if (verbose)
+		printf("Reading ACL input clip...");
 
 	LARGE_INTEGER read_start_time_cycles;
 	QueryPerformanceCounter(&read_start_time_cycles);
@@ -406,15 +673,18 @@ static bool read_clip(acl::Allocator& allocator, const char* filename,
 	double elapsed_time_sec = double(elapsed_cycles) / double(frequency_cycles_per_sec.QuadPart);
 	double elapsed_time_ms = elapsed_time_sec * 1000.0;
 
-	printf(" Done in %.1f ms!\n", elapsed_time_ms);
-	printf("Parsing ACL input clip...");
+	if (verbose)
+	{
+		printf(" Done in %.1f ms!\n", elapsed_time_ms);
+		printf("Parsing ACL input clip...");
+	}
 
 	acl::ClipReader reader(allocator, str.c_str(), str.length());
 
 	if (!reader.read(skeleton) || !reader.read(clip, *skeleton))
 	{
 		acl::ClipReaderError err = reader.get_error();
-		printf("\nError on line %d column %d: %s\n", err.line, err.column, err.get_description());
+		printf("%sError in %s on line %d column %d: %s\n", verbose ? "\n" : "", filename, err.line, err.column, err.get_description());
 		return false;
 	}
 
@@ -425,10 +695,233 @@ static bool read_clip(acl::Allocator& allocator, const char* filename,
 	elapsed_time_sec = double(elapsed_cycles) / double(frequency_cycles_per_sec.QuadPart);
 	elapsed_time_ms = elapsed_time_sec * 1000.0;
 
-	printf(" Done in %.1f ms!\n", elapsed_time_ms);
+	if (verbose)
+		printf(" Done in %.1f ms!\n", elapsed_time_ms);
+
+	return true;
+}
+
+static bool is_acl_input_file(const char* filename)
+{
+	size_t filename_length = std::strlen(filename);
+	const char* extension = ".acl.js";
+	size_t extension_length = std::strlen(extension);
+	return filename_length >= extension_length && std::strcmp(filename + filename_length - extension_length, extension) == 0;
+}
+
+static bool list_input_clips(const Options& options, std::vector<std::string>& out_clip_filenames)
+{
+	if (options.input_filename != nullptr)
+	{
+		out_clip_filenames.push_back(options.input_filename);
+		return true;
+	}
+
+	if (options.input_directory != nullptr)
+	{
+		std::string directory = options.input_directory;
+		while (!directory.empty() && (directory.back() == '\\' || directory.back() == '/'))
+			directory.pop_back();
+
+		std::string search_pattern = directory + "\\*";
+
+		WIN32_FIND_DATAA find_data;
+		HANDLE find_handle = FindFirstFileA(search_pattern.c_str(), &find_data);
+		if (find_handle == INVALID_HANDLE_VALUE)
+		{
+			printf("Failed to enumerate input directory: %s\n", options.input_directory);
+			return false;
+		}
+
+		do
+		{
+			if ((find_data.dwFileAttributes & FILE_ATTRIBUTE_DIRECTORY) != 0)
+				continue;
+
+			if (!is_acl_input_file(find_data.cFileName))
+				continue;
+
+			out_clip_filenames.push_back(directory + "\\" + find_data.cFileName);
+		} while (FindNextFileA(find_handle, &find_data) != 0);
+
+		FindClose(find_handle);
+		return true;
+	}
+
+	// Response file: one clip filename per line, blank lines are skipped
+	std::ifstream list_file(options.input_list_filename);
+	if (!list_file.good())
+	{
+		printf("Failed to open input list file: %s\n", options.input_list_filename);
+		return false;
+	}
+
+	std::string line;
+	while (std::getline(list_file, line))
+	{
+		while (!line.empty() && (line.back() == '\r' || line.back() == '\n' || line.back() == ' ' || line.back() == '\t'))
+			line.pop_back();
+
+		if (!line.empty())
+			out_clip_filenames.push_back(line);
+	}
+
 	return true;
 }
 
+static void compress_clip(std::FILE* stats_file, const char* clip_filename, const char* cache_directory, acl::Allocator& allocator, const acl::AnimationClip& clip, const acl::RigidSkeleton& skeleton)
+{
+	using namespace acl;
+
+	UniformlySampledAlgorithm uniform_tests[] =
+	{
+		UniformlySampledAlgorithm(RotationFormat8::Quat_128, VectorFormat8::Vector3_96, RangeReductionFlags8::None),
+		UniformlySampledAlgorithm(RotationFormat8::Quat_128, VectorFormat8::Vector3_96, RangeReductionFlags8::PerClip | acl::RangeReductionFlags8::Rotations),
+		UniformlySampledAlgorithm(RotationFormat8::Quat_128, VectorFormat8::Vector3_96, RangeReductionFlags8::PerClip | acl::RangeReductionFlags8::Translations),
+		UniformlySampledAlgorithm(RotationFormat8::Quat_128, VectorFormat8::Vector3_96, RangeReductionFlags8::PerClip | acl::RangeReductionFlags8::Rotations | acl::RangeReductionFlags8::Translations),
+		UniformlySampledAlgorithm(RotationFormat8::Quat_128, VectorFormat8::Vector3_48, RangeReductionFlags8::PerClip | acl::RangeReductionFlags8::Translations),
+		UniformlySampledAlgorithm(RotationFormat8::Quat_128, VectorFormat8::Vector3_48, RangeReductionFlags8::PerClip | acl::RangeReductionFlags8::Rotations | acl::RangeReductionFlags8::Translations),
+		UniformlySampledAlgorithm(RotationFormat8::Quat_128, VectorFormat8::Vector3_32, RangeReductionFlags8::PerClip | acl::RangeReductionFlags8::Translations),
+		UniformlySampledAlgorithm(RotationFormat8::Quat_128, VectorFormat8::Vector3_32, RangeReductionFlags8::PerClip | acl::RangeReductionFlags8::Rotations | acl::RangeReductionFlags8::Translations),
+		UniformlySampledAlgorithm(RotationFormat8::Quat_96, VectorFormat8::Vector3_96, RangeReductionFlags8::None),
+		UniformlySampledAlgorithm(RotationFormat8::Quat_96, VectorFormat8::Vector3_96, RangeReductionFlags8::PerClip | acl::RangeReductionFlags8::Rotations),
+		UniformlySampledAlgorithm(RotationFormat8::Quat_96, VectorFormat8::Vector3_96, RangeReductionFlags8::PerClip | acl::RangeReductionFlags8::Translations),
+		UniformlySampledAlgorithm(RotationFormat8::Quat_96, VectorFormat8::Vector3_96, RangeReductionFlags8::PerClip | acl::RangeReductionFlags8::Rotations | acl::RangeReductionFlags8::Translations),
+		UniformlySampledAlgorithm(RotationFormat8::Quat_96, VectorFormat8::Vector3_48, RangeReductionFlags8::PerClip | acl::RangeReductionFlags8::Translations),
+		UniformlySampledAlgorithm(RotationFormat8::Quat_96, VectorFormat8::Vector3_48, RangeReductionFlags8::PerClip | acl::RangeReductionFlags8::Rotations | acl::RangeReductionFlags8::Translations),
+		UniformlySampledAlgorithm(RotationFormat8::Quat_96, VectorFormat8::Vector3_32, RangeReductionFlags8::PerClip | acl::RangeReductionFlags8::Translations),
+		UniformlySampledAlgorithm(RotationFormat8::Quat_96, VectorFormat8::Vector3_32, RangeReductionFlags8::PerClip | acl::RangeReductionFlags8::Rotations | acl::RangeReductionFlags8::Translations),
+		UniformlySampledAlgorithm(RotationFormat8::Quat_48, VectorFormat8::Vector3_96, RangeReductionFlags8::None),
+		UniformlySampledAlgorithm(RotationFormat8::Quat_48, VectorFormat8::Vector3_96, RangeReductionFlags8::PerClip | acl::RangeReductionFlags8::Rotations),
+		UniformlySampledAlgorithm(RotationFormat8::Quat_48, VectorFormat8::Vector3_96, RangeReductionFlags8::PerClip | acl::RangeReductionFlags8::Translations),
+		UniformlySampledAlgorithm(RotationFormat8::Quat_48, VectorFormat8::Vector3_96, RangeReductionFlags8::PerClip | acl::RangeReductionFlags8::Rotations | acl::RangeReductionFlags8::Translations),
+		UniformlySampledAlgorithm(RotationFormat8::Quat_48, VectorFormat8::Vector3_48, RangeReductionFlags8::PerClip | acl::RangeReductionFlags8::Translations),
+		UniformlySampledAlgorithm(RotationFormat8::Quat_48, VectorFormat8::Vector3_48, RangeReductionFlags8::PerClip | acl::RangeReductionFlags8::Rotations | acl::RangeReductionFlags8::Translations),
+		UniformlySampledAlgorithm(RotationFormat8::Quat_48, VectorFormat8::Vector3_32, RangeReductionFlags8::PerClip | acl::RangeReductionFlags8::Translations),
+		UniformlySampledAlgorithm(RotationFormat8::Quat_48, VectorFormat8::Vector3_32, RangeReductionFlags8::PerClip | acl::RangeReductionFlags8::Rotations | acl::RangeReductionFlags8::Translations),
+		UniformlySampledAlgorithm(RotationFormat8::Quat_32, VectorFormat8::Vector3_96, RangeReductionFlags8::None),
+		UniformlySampledAlgorithm(RotationFormat8::Quat_32, VectorFormat8::Vector3_96, RangeReductionFlags8::PerClip | acl::RangeReductionFlags8::Rotations),
+		UniformlySampledAlgorithm(RotationFormat8::Quat_32, VectorFormat8::Vector3_96, RangeReductionFlags8::PerClip | acl::RangeReductionFlags8::Translations),
+		UniformlySampledAlgorithm(RotationFormat8::Quat_32, VectorFormat8::Vector3_96, RangeReductionFlags8::PerClip | acl::RangeReductionFlags8::Rotations | acl::RangeReductionFlags8::Translations),
+		UniformlySampledAlgorithm(RotationFormat8::Quat_32, VectorFormat8::Vector3_48, RangeReductionFlags8::PerClip | acl::RangeReductionFlags8::Translations),
+		UniformlySampledAlgorithm(RotationFormat8::Quat_32, VectorFormat8::Vector3_48, RangeReductionFlags8::PerClip | acl::RangeReductionFlags8::Rotations | acl::RangeReductionFlags8::Translations),
+		UniformlySampledAlgorithm(RotationFormat8::Quat_32, VectorFormat8::Vector3_32, RangeReductionFlags8::PerClip | acl::RangeReductionFlags8::Translations),
+		UniformlySampledAlgorithm(RotationFormat8::Quat_32, VectorFormat8::Vector3_32, RangeReductionFlags8::PerClip | acl::RangeReductionFlags8::Rotations | acl::RangeReductionFlags8::Translations),
+	};
+
+	bool use_cache = cache_directory != nullptr && std::strlen(cache_directory) != 0;
+
+	// The clip and skeleton are shared by every settings combination, hash them once
+	uint32_t input_hash = 0;
+	if (use_cache)
+	{
+		input_hash = crc32(&COOK_CACHE_VERSION, sizeof(COOK_CACHE_VERSION));
+		input_hash = hash_animation_clip(clip, input_hash);
+		input_hash = hash_rigid_skeleton(skeleton, input_hash);
+	}
+
+	for (UniformlySampledAlgorithm& algorithm : uniform_tests)
+	{
+		std::string cache_record_path;
+		if (use_cache)
+		{
+			uint32_t cook_hash = hash_compression_settings(algorithm.get_compression_settings(), clip.get_num_bones(), input_hash);
+			cache_record_path = make_cache_record_path(cache_directory, cook_hash);
+		}
+
+		try_algorithm(stats_file, clip_filename, use_cache ? cache_record_path.c_str() : nullptr, allocator, clip, skeleton, algorithm);
+	}
+}
+
+static bool compress_clips(const Options& options, const std::vector<std::string>& clip_filenames)
+{
+	using namespace acl;
+
+	uint32_t num_threads = options.num_threads != 0 ? options.num_threads : std::thread::hardware_concurrency();
+	num_threads = std::max<uint32_t>(num_threads, 1);
+	num_threads = std::min<uint32_t>(num_threads, uint32_t(clip_filenames.size()));
+
+	const bool verbose = clip_filenames.size() == 1;
+
+	std::atomic<size_t> clip_dispatch_index(0);
+	std::atomic<size_t> num_failed_clips(0);
+	std::atomic<size_t> num_processed_clips(0);
+	std::mutex output_mutex;
+
+	auto compress_worker = [&]()
+	{
+		// Clips are independent, every worker uses its own allocator to avoid contention
+		Allocator allocator;
+
+		while (true)
+		{
+			size_t clip_index = clip_dispatch_index.fetch_add(1);
+			if (clip_index >= clip_filenames.size())
+				break;
+
+			const std::string& clip_filename = clip_filenames[clip_index];
+
+			std::unique_ptr<AnimationClip, Deleter<AnimationClip>> clip;
+			std::unique_ptr<RigidSkeleton, Deleter<RigidSkeleton>> skeleton;
+
+			if (!read_clip(allocator, clip_filename.c_str(), clip, skeleton, verbose))
+			{
+				++num_failed_clips;
+				continue;
+			}
+
+			// Stats are buffered per clip and flushed under the lock so blocks from
+			// different workers never interleave in the aggregated output
+			std::FILE* clip_stats_file = nullptr;
+			if (options.output_stats)
+			{
+				tmpfile_s(&clip_stats_file);
+				ACL_ENSURE(clip_stats_file != nullptr, "Failed to create a temporary stats file");
+			}
+
+			compress_clip(clip_stats_file, clip_filename.c_str(), options.cache_directory, allocator, *clip.get(), *skeleton.get());
+
+			size_t num_processed = ++num_processed_clips;
+
+			{
+				std::lock_guard<std::mutex> lock(output_mutex);
+
+				if (clip_stats_file != nullptr)
+				{
+					std::rewind(clip_stats_file);
+
+					char copy_buffer[4 * 1024];
+					size_t num_bytes_read;
+					while ((num_bytes_read = fread(copy_buffer, 1, sizeof(copy_buffer), clip_stats_file)) != 0)
+						fwrite(copy_buffer, 1, num_bytes_read, options.output_stats_file);
+
+					std::fclose(clip_stats_file);
+				}
+
+				if (!verbose)
+					printf("Compressed clip %zu / %zu: %s\n", num_processed, clip_filenames.size(), clip_filename.c_str());
+			}
+		}
+	};
+
+	if (num_threads <= 1)
+	{
+		compress_worker();
+	}
+	else
+	{
+		std::vector<std::thread> threads;
+		threads.reserve(num_threads);
+		for (uint32_t thread_index = 0; thread_index < num_threads; ++thread_index)
+			threads.emplace_back(compress_worker);
+
+		for (std::thread& thread : threads)
+			thread.join();
+	}
+
+	return num_failed_clips == 0;
+}
+
 int main(int argc, char** argv)
 {
 	using namespace acl;
@@ -444,62 +937,25 @@ int main(int argc, char** argv)
 		return -1;
 	}
 
-	Allocator allocator;
-	std::unique_ptr<AnimationClip, Deleter<AnimationClip>> clip;
-	std::unique_ptr<RigidSkeleton, Deleter<RigidSkeleton>> skeleton;
-
-	if (!read_clip(allocator, options.input_filename, clip, skeleton))
+	std::vector<std::string> clip_filenames;
+	if (!list_input_clips(options, clip_filenames))
 	{
 		return -1;
 	}
 
-	// Compress & Decompress
+	if (clip_filenames.empty())
 	{
-		UniformlySampledAlgorithm uniform_tests[] =
-		{
-			UniformlySampledAlgorithm(RotationFormat8::Quat_128, VectorFormat8::Vector3_96, RangeReductionFlags8::None),
-			UniformlySampledAlgorithm(RotationFormat8::Quat_128, VectorFormat8::Vector3_96, RangeReductionFlags8::PerClip | acl::RangeReductionFlags8::Rotations),
-			UniformlySampledAlgorithm(RotationFormat8::Quat_128, VectorFormat8::Vector3_96, RangeReductionFlags8::PerClip | acl::RangeReductionFlags8::Translations),
-			UniformlySampledAlgorithm(RotationFormat8::Quat_128, VectorFormat8::Vector3_96, RangeReductionFlags8::PerClip | acl::RangeReductionFlags8::Rotations | acl::RangeReductionFlags8::Translations),
-			UniformlySampledAlgorithm(RotationFormat8::Quat_128, VectorFormat8::Vector3_48, RangeReductionFlags8::PerClip | acl::RangeReductionFlags8::Translations),
-			UniformlySampledAlgorithm(RotationFormat8::Quat_128, VectorFormat8::Vector3_48, RangeReductionFlags8::PerClip | acl::RangeReductionFlags8::Rotations | acl::RangeReductionFlags8::Translations),
-			UniformlySampledAlgorithm(RotationFormat8::Quat_128, VectorFormat8::Vector3_32, RangeReductionFlags8::PerClip | acl::RangeReductionFlags8::Translations),
-			UniformlySampledAlgorithm(RotationFormat8::Quat_128, VectorFormat8::Vector3_32, RangeReductionFlags8::PerClip | acl::RangeReductionFlags8::Rotations | acl::RangeReductionFlags8::Translations),
-			UniformlySampledAlgorithm(RotationFormat8::Quat_96, VectorFormat8::Vector3_96, RangeReductionFlags8::None),
-			UniformlySampledAlgorithm(RotationFormat8::Quat_96, VectorFormat8::Vector3_96, RangeReductionFlags8::PerClip | acl::RangeReductionFlags8::Rotations),
-			UniformlySampledAlgorithm(RotationFormat8::Quat_96, VectorFormat8::Vector3_96, RangeReductionFlags8::PerClip | acl::RangeReductionFlags8::Translations),
-			UniformlySampledAlgorithm(RotationFormat8::Quat_96, VectorFormat8::Vector3_96, RangeReductionFlags8::PerClip | acl::RangeReductionFlags8::Rotations | acl::RangeReductionFlags8::Translations),
-			UniformlySampledAlgorithm(RotationFormat8::Quat_96, VectorFormat8::Vector3_48, RangeReductionFlags8::PerClip | acl::RangeReductionFlags8::Translations),
-			UniformlySampledAlgorithm(RotationFormat8::Quat_96, VectorFormat8::Vector3_48, RangeReductionFlags8::PerClip | acl::RangeReductionFlags8::Rotations | acl::RangeReductionFlags8::Translations),
-			UniformlySampledAlgorithm(RotationFormat8::Quat_96, VectorFormat8::Vector3_32, RangeReductionFlags8::PerClip | acl::RangeReductionFlags8::Translations),
-			UniformlySampledAlgorithm(RotationFormat8::Quat_96, VectorFormat8::Vector3_32, RangeReductionFlags8::PerClip | acl::RangeReductionFlags8::Rotations | acl::RangeReductionFlags8::Translations),
-			UniformlySampledAlgorithm(RotationFormat8::Quat_48, VectorFormat8::Vector3_96, RangeReductionFlags8::None),
-			UniformlySampledAlgorithm(RotationFormat8::Quat_48, VectorFormat8::Vector3_96, RangeReductionFlags8::PerClip | acl::RangeReductionFlags8::Rotations),
-			UniformlySampledAlgorithm(RotationFormat8::Quat_48, VectorFormat8::Vector3_96, RangeReductionFlags8::PerClip | acl::RangeReductionFlags8::Translations),
-			UniformlySampledAlgorithm(RotationFormat8::Quat_48, VectorFormat8::Vector3_96, RangeReductionFlags8::PerClip | acl::RangeReductionFlags8::Rotations | acl::RangeReductionFlags8::Translations),
-			UniformlySampledAlgorithm(RotationFormat8::Quat_48, VectorFormat8::Vector3_48, RangeReductionFlags8::PerClip | acl::RangeReductionFlags8::Translations),
-			UniformlySampledAlgorithm(RotationFormat8::Quat_48, VectorFormat8::Vector3_48, RangeReductionFlags8::PerClip | acl::RangeReductionFlags8::Rotations | acl::RangeReductionFlags8::Translations),
-			UniformlySampledAlgorithm(RotationFormat8::Quat_48, VectorFormat8::Vector3_32, RangeReductionFlags8::PerClip | acl::RangeReductionFlags8::Translations),
-			UniformlySampledAlgorithm(RotationFormat8::Quat_48, VectorFormat8::Vector3_32, RangeReductionFlags8::PerClip | acl::RangeReductionFlags8::Rotations | acl::RangeReductionFlags8::Translations),
-			UniformlySampledAlgorithm(RotationFormat8::Quat_32, VectorFormat8::Vector3_96, RangeReductionFlags8::None),
-			UniformlySampledAlgorithm(RotationFormat8::Quat_32, VectorFormat8::Vector3_96, RangeReductionFlags8::PerClip | acl::RangeReductionFlags8::Rotations),
-			UniformlySampledAlgorithm(RotationFormat8::Quat_32, VectorFormat8::Vector3_96, RangeReductionFlags8::PerClip | acl::RangeReductionFlags8::Translations),
-			UniformlySampledAlgorithm(RotationFormat8::Quat_32, VectorFormat8::Vector3_96, RangeReductionFlags8::PerClip | acl::RangeReductionFlags8::Rotations | acl::RangeReductionFlags8::Translations),
-			UniformlySampledAlgorithm(RotationFormat8::Quat_32, VectorFormat8::Vector3_48, RangeReductionFlags8::PerClip | acl::RangeReductionFlags8::Translations),
-			UniformlySampledAlgorithm(RotationFormat8::Quat_32, VectorFormat8::Vector3_48, RangeReductionFlags8::PerClip | acl::RangeReductionFlags8::Rotations | acl::RangeReductionFlags8::Translations),
-			UniformlySampledAlgorithm(RotationFormat8::Quat_32, VectorFormat8::Vector3_32, RangeReductionFlags8::PerClip | acl::RangeReductionFlags8::Translations),
-			UniformlySampledAlgorithm(RotationFormat8::Quat_32, VectorFormat8::Vector3_32, RangeReductionFlags8::PerClip | acl::RangeReductionFlags8::Rotations | acl::RangeReductionFlags8::Translations),
-		};
-
-		for (UniformlySampledAlgorithm& algorithm : uniform_tests)
-			try_algorithm(options, allocator, *clip.get(), *skeleton.get(), algorithm);
+		printf("No input clips found.\n");
+		return -1;
 	}
 
+	bool success = compress_clips(options, clip_filenames);
+
 	if (IsDebuggerPresent())
 	{
 		printf("Press any key to continue...\n");
 		while (_kbhit() == 0);
 	}
 
-	return 0;
+	return success ? 0 : -1;
 }
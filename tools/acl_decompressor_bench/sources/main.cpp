@@ -0,0 +1,457 @@
+////////////////////////////////////////////////////////////////////////////////
+// The MIT License (MIT)
+//
+// Copyright (c) 2017 Nicholas Frechette & Animation Compression Library contributors
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+////////////////////////////////////////////////////////////////////////////////
+
+#include "acl/core/memory.h"
+#include "acl/compression/skeleton.h"
+#include "acl/compression/animation_clip.h"
+#include "acl/io/clip_reader.h"
+
+#include "acl/algorithm/uniformly_sampled/algorithm.h"
+
+#include <Windows.h>
+#include <conio.h>
+
+#include <cstring>
+#include <cstdio>
+#include <fstream>
+#include <streambuf>
+#include <sstream>
+#include <string>
+#include <memory>
+
+// Decompression micro-benchmark. Compresses the input clip with every format
+// combination acl_compressor measures and times the decompression hot loops:
+// warm and cold cache full pose decompression, single bone decompression, and
+// a per phase breakdown (context initialization, seeking, track decoding).
+// Stats use the same 'key: value' line format as acl_compressor so
+// acl_compressor.py can aggregate both tools.
+
+struct PoseOutputWriterImpl : public acl::OutputWriter
+{
+	PoseOutputWriterImpl(acl::Allocator& allocator, uint16_t num_bones)
+		: m_allocator(allocator)
+		, m_transforms(acl::allocate_type_array<acl::Transform_32>(allocator, num_bones))
+		, m_num_bones(num_bones)
+	{}
+
+	~PoseOutputWriterImpl()
+	{
+		deallocate_type_array(m_allocator, m_transforms, m_num_bones);
+	}
+
+	void write_bone_rotation(uint32_t bone_index, const acl::Quat_32& rotation)
+	{
+		ACL_ENSURE(bone_index < m_num_bones, "Invalid bone index. %u >= %u", bone_index, m_num_bones);
+		m_transforms[bone_index].rotation = rotation;
+	}
+
+	void write_bone_translation(uint32_t bone_index, const acl::Vector4_32& translation)
+	{
+		ACL_ENSURE(bone_index < m_num_bones, "Invalid bone index. %u >= %u", bone_index, m_num_bones);
+		m_transforms[bone_index].translation = translation;
+	}
+
+	acl::Allocator& m_allocator;
+	acl::Transform_32* m_transforms;
+	uint16_t m_num_bones;
+};
+
+struct Options
+{
+	const char*		input_filename;
+	bool			output_stats;
+	const char*		output_stats_filename;
+
+	//////////////////////////////////////////////////////////////////////////
+
+	std::FILE*		output_stats_file;
+
+	Options()
+		: input_filename(nullptr),
+		  output_stats(false)
+		, output_stats_filename(nullptr)
+		, output_stats_file(nullptr)
+	{}
+
+	Options(Options&& other)
+		: output_stats(other.output_stats)
+		, output_stats_filename(other.output_stats_filename)
+		, output_stats_file(other.output_stats_file)
+	{
+		new (&other) Options();
+	}
+
+	~Options()
+	{
+		if (output_stats_file != nullptr && output_stats_file != stdout)
+			std::fclose(output_stats_file);
+	}
+
+	Options& operator=(Options&& rhs)
+	{
+		std::swap(output_stats, rhs.output_stats);
+		std::swap(output_stats_filename, rhs.output_stats_filename);
+		std::swap(output_stats_file, rhs.output_stats_file);
+		return *this;
+	}
+
+	Options(const Options&) = delete;
+	Options& operator=(const Options&) = delete;
+
+	void open_output_stats_file()
+	{
+		std::FILE* file = nullptr;
+		if (output_stats_filename != nullptr)
+			fopen_s(&file, output_stats_filename, "w");
+		output_stats_file = file != nullptr ? file : stdout;
+	}
+};
+
+constexpr char* ACL_INPUT_FILE_OPTION = "-acl=";
+constexpr char* STATS_OUTPUT_OPTION = "-stats";
+
+static bool parse_options(int argc, char** argv, Options& options)
+{
+	for (int arg_index = 1; arg_index < argc; ++arg_index)
+	{
+		const char* argument = argv[arg_index];
+
+		size_t option_length = std::strlen(ACL_INPUT_FILE_OPTION);
+		if (std::strncmp(argument, ACL_INPUT_FILE_OPTION, option_length) == 0)
+		{
+			options.input_filename = argument + option_length;
+			continue;
+		}
+
+		option_length = std::strlen(STATS_OUTPUT_OPTION);
+		if (std::strncmp(argument, STATS_OUTPUT_OPTION, option_length) == 0)
+		{
+			options.output_stats = true;
+			options.output_stats_filename = argument[option_length] == '=' ? argument + option_length + 1 : nullptr;
+			options.open_output_stats_file();
+			continue;
+		}
+
+		printf("Unrecognized option %s\n", argument);
+		return false;
+	}
+
+	if (options.input_filename == nullptr || std::strlen(options.input_filename) == 0)
+	{
+		printf("An input file is required.\n");
+		return false;
+	}
+
+	return true;
+}
+
+// How many full playback passes we time per benchmark loop
+constexpr uint32_t NUM_DECOMPRESSION_PASSES = 100;
+
+// How many context initializations we time
+constexpr uint32_t NUM_CONTEXT_INIT_PASSES = 1000;
+
+// Large enough to flush every cache level found in the wild
+constexpr size_t CACHE_EVICTION_BUFFER_SIZE = 16 * 1024 * 1024;
+
+struct BenchResults
+{
+	uint64_t warm_pose_cycles;				// seek + full pose decompression, warm cache
+	uint64_t cold_pose_cycles;				// seek + full pose decompression, caches evicted between poses
+	uint64_t warm_bone_cycles;				// seek + single bone decompression, warm cache
+	uint64_t context_init_cycles;			// context initialization only
+	uint64_t seek_cycles;					// seeking only
+
+	uint32_t num_pose_samples;				// poses decompressed per warm/cold/seek loop
+	uint32_t num_cold_pose_samples;			// poses decompressed per cold loop
+	uint32_t num_bone_samples;				// bones decompressed per bone loop
+	uint32_t num_context_inits;
+};
+
+static void evict_caches(uint8_t* buffer)
+{
+	// Touching every cache line of a buffer larger than the last level cache
+	// evicts the compressed clip. Hardware miss counters would be more precise
+	// but they aren't accessible from user space on every target we run on.
+	for (size_t offset = 0; offset < CACHE_EVICTION_BUFFER_SIZE; offset += 64)
+		buffer[offset] += 1;
+}
+
+static BenchResults run_decompression_bench(acl::Allocator& allocator, const acl::AnimationClip& clip, const acl::CompressedClip& compressed_clip)
+{
+	using namespace acl;
+	using namespace acl::uniformly_sampled;
+
+	uint16_t num_bones = clip.get_num_bones();
+	uint32_t num_samples = clip.get_num_samples();
+	float clip_duration = float(clip.get_duration());
+	float sample_increment = 1.0f / float(clip.get_sample_rate());
+
+	PoseOutputWriterImpl pose_writer(allocator, num_bones);
+	uint8_t* eviction_buffer = allocate_type_array<uint8_t>(allocator, CACHE_EVICTION_BUFFER_SIZE);
+
+	BenchResults results = {};
+
+	DecompressionSettings settings;
+	DecompressionContext<DecompressionSettings> context;
+	context.initialize(allocator, compressed_clip);
+
+	LARGE_INTEGER start_time_cycles;
+	LARGE_INTEGER end_time_cycles;
+
+	// Context initialization phase
+	{
+		QueryPerformanceCounter(&start_time_cycles);
+
+		for (uint32_t pass_index = 0; pass_index < NUM_CONTEXT_INIT_PASSES; ++pass_index)
+			context.initialize(allocator, compressed_clip);
+
+		QueryPerformanceCounter(&end_time_cycles);
+
+		results.context_init_cycles = end_time_cycles.QuadPart - start_time_cycles.QuadPart;
+		results.num_context_inits = NUM_CONTEXT_INIT_PASSES;
+	}
+
+	// Seek phase, the decoding cost of a pose is the warm pose cost minus this
+	{
+		QueryPerformanceCounter(&start_time_cycles);
+
+		for (uint32_t pass_index = 0; pass_index < NUM_DECOMPRESSION_PASSES; ++pass_index)
+		{
+			float sample_time = 0.0f;
+			for (uint32_t sample_index = 0; sample_index < num_samples; ++sample_index)
+			{
+				context.seek(sample_time);
+				sample_time = min(sample_time + sample_increment, clip_duration);
+			}
+		}
+
+		QueryPerformanceCounter(&end_time_cycles);
+
+		results.seek_cycles = end_time_cycles.QuadPart - start_time_cycles.QuadPart;
+		results.num_pose_samples = NUM_DECOMPRESSION_PASSES * num_samples;
+	}
+
+	// Warm cache pose decompression, every pass after the first hits the caches
+	{
+		QueryPerformanceCounter(&start_time_cycles);
+
+		for (uint32_t pass_index = 0; pass_index < NUM_DECOMPRESSION_PASSES; ++pass_index)
+		{
+			float sample_time = 0.0f;
+			for (uint32_t sample_index = 0; sample_index < num_samples; ++sample_index)
+			{
+				context.seek(sample_time);
+				decompress_pose(context, pose_writer);
+				sample_time = min(sample_time + sample_increment, clip_duration);
+			}
+		}
+
+		QueryPerformanceCounter(&end_time_cycles);
+
+		results.warm_pose_cycles = end_time_cycles.QuadPart - start_time_cycles.QuadPart;
+	}
+
+	// Cold cache pose decompression, the clip is evicted between every pose
+	{
+		uint64_t total_cycles = 0;
+
+		float sample_time = 0.0f;
+		for (uint32_t sample_index = 0; sample_index < num_samples; ++sample_index)
+		{
+			evict_caches(eviction_buffer);
+
+			QueryPerformanceCounter(&start_time_cycles);
+
+			context.seek(sample_time);
+			decompress_pose(context, pose_writer);
+
+			QueryPerformanceCounter(&end_time_cycles);
+
+			total_cycles += end_time_cycles.QuadPart - start_time_cycles.QuadPart;
+			sample_time = min(sample_time + sample_increment, clip_duration);
+		}
+
+		results.cold_pose_cycles = total_cycles;
+		results.num_cold_pose_samples = num_samples;
+	}
+
+	// Warm cache single bone decompression
+	{
+		Quat_32 rotation;
+		Vector4_32 translation;
+
+		QueryPerformanceCounter(&start_time_cycles);
+
+		for (uint32_t pass_index = 0; pass_index < NUM_DECOMPRESSION_PASSES; ++pass_index)
+		{
+			context.seek(clip_duration * 0.5f);
+			for (uint16_t bone_index = 0; bone_index < num_bones; ++bone_index)
+				decompress_bone(context, bone_index, &rotation, &translation);
+		}
+
+		QueryPerformanceCounter(&end_time_cycles);
+
+		results.warm_bone_cycles = end_time_cycles.QuadPart - start_time_cycles.QuadPart;
+		results.num_bone_samples = NUM_DECOMPRESSION_PASSES * num_bones;
+	}
+
+	deallocate_type_array(allocator, eviction_buffer, CACHE_EVICTION_BUFFER_SIZE);
+
+	return results;
+}
+
+static void print_stats(const Options& options, const acl::AnimationClip& clip, const acl::CompressedClip& compressed_clip, const BenchResults& results)
+{
+	if (!options.output_stats)
+		return;
+
+	using namespace acl;
+
+	uint16_t num_bones = clip.get_num_bones();
+
+	LARGE_INTEGER frequency_cycles_per_sec;
+	QueryPerformanceFrequency(&frequency_cycles_per_sec);
+	double cycles_to_us = 1000000.0 / double(frequency_cycles_per_sec.QuadPart);
+
+	double warm_pose_us = double(results.warm_pose_cycles) * cycles_to_us / double(results.num_pose_samples);
+	double cold_pose_us = double(results.cold_pose_cycles) * cycles_to_us / double(results.num_cold_pose_samples);
+	double warm_bone_us = double(results.warm_bone_cycles) * cycles_to_us / double(results.num_bone_samples);
+	double context_init_us = double(results.context_init_cycles) * cycles_to_us / double(results.num_context_inits);
+	double seek_us = double(results.seek_cycles) * cycles_to_us / double(results.num_pose_samples);
+	double decode_us = max(warm_pose_us - seek_us, 0.0);
+
+	std::FILE* file = options.output_stats_file;
+
+	fprintf(file, "Clip algorithm: %s\n", get_algorithm_name(compressed_clip.get_algorithm_type()));
+	fprintf(file, "Clip compressed size (bytes): %u\n", compressed_clip.get_size());
+	fprintf(file, "Clip num bones: %u\n", num_bones);
+	fprintf(file, "Clip duration (s): %.3f\n", clip.get_duration());
+	fprintf(file, "Clip decompression warm pose time (us): %.4f\n", warm_pose_us);
+	fprintf(file, "Clip decompression cold pose time (us): %.4f\n", cold_pose_us);
+	fprintf(file, "Clip decompression warm pose cycles per bone: %.2f\n", double(results.warm_pose_cycles) / double(results.num_pose_samples) / double(num_bones));
+	fprintf(file, "Clip decompression cold pose cycles per bone: %.2f\n", double(results.cold_pose_cycles) / double(results.num_cold_pose_samples) / double(num_bones));
+	fprintf(file, "Clip decompression warm bone time (us): %.4f\n", warm_bone_us);
+	fprintf(file, "Clip decompression context init time (us): %.4f\n", context_init_us);
+	fprintf(file, "Clip decompression seek time (us): %.4f\n", seek_us);
+	fprintf(file, "Clip decompression decode time (us): %.4f\n", decode_us);
+	fprintf(file, "\n");
+}
+
+static void bench_algorithm(const Options& options, acl::Allocator& allocator, const acl::AnimationClip& clip, const acl::RigidSkeleton& skeleton, acl::IAlgorithm& algorithm)
+{
+	using namespace acl;
+
+	CompressedClip* compressed_clip = algorithm.compress_clip(allocator, clip, skeleton);
+
+	ACL_ENSURE(compressed_clip->is_valid(true), "Compressed clip is invalid");
+
+	BenchResults results = run_decompression_bench(allocator, clip, *compressed_clip);
+
+	print_stats(options, clip, *compressed_clip, results);
+
+	allocator.deallocate(compressed_clip, compressed_clip->get_size());
+}
+
+static bool read_clip(acl::Allocator& allocator, const char* filename,
+					  std::unique_ptr<acl::AnimationClip, acl::Deleter<acl::AnimationClip>>& clip,
+					  std::unique_ptr<acl::RigidSkeleton, acl::Deleter<acl::RigidSkeleton>>& skeleton)
+{
+	printf("Reading ACL input clip...");
+
+	std::ifstream t(filename);
+	std::stringstream buffer;
+	buffer << t.rdbuf();
+	std::string str = buffer.str();
+
+	printf(" Done!\n");
+	printf("Parsing ACL input clip...");
+
+	acl::ClipReader reader(allocator, str.c_str(), str.length());
+
+	if (!reader.read(skeleton) || !reader.read(clip, *skeleton))
+	{
+		acl::ClipReaderError err = reader.get_error();
+		printf("\nError on line %d column %d: %s\n", err.line, err.column, err.get_description());
+		return false;
+	}
+
+	printf(" Done!\n");
+	return true;
+}
+
+int main(int argc, char** argv)
+{
+	using namespace acl;
+
+	Options options;
+
+	if (!parse_options(argc, argv, options))
+	{
+		return -1;
+	}
+
+	Allocator allocator;
+	std::unique_ptr<AnimationClip, Deleter<AnimationClip>> clip;
+	std::unique_ptr<RigidSkeleton, Deleter<RigidSkeleton>> skeleton;
+
+	if (!read_clip(allocator, options.input_filename, clip, skeleton))
+	{
+		return -1;
+	}
+
+	// Compress & benchmark decompression
+	{
+		UniformlySampledAlgorithm uniform_tests[] =
+		{
+			UniformlySampledAlgorithm(RotationFormat8::Quat_128, VectorFormat8::Vector3_96, RangeReductionFlags8::None),
+			UniformlySampledAlgorithm(RotationFormat8::Quat_128, VectorFormat8::Vector3_96, RangeReductionFlags8::PerClip | acl::RangeReductionFlags8::Rotations | acl::RangeReductionFlags8::Translations),
+			UniformlySampledAlgorithm(RotationFormat8::Quat_128, VectorFormat8::Vector3_48, RangeReductionFlags8::PerClip | acl::RangeReductionFlags8::Rotations | acl::RangeReductionFlags8::Translations),
+			UniformlySampledAlgorithm(RotationFormat8::Quat_128, VectorFormat8::Vector3_32, RangeReductionFlags8::PerClip | acl::RangeReductionFlags8::Rotations | acl::RangeReductionFlags8::Translations),
+			UniformlySampledAlgorithm(RotationFormat8::Quat_96, VectorFormat8::Vector3_96, RangeReductionFlags8::None),
+			UniformlySampledAlgorithm(RotationFormat8::Quat_96, VectorFormat8::Vector3_96, RangeReductionFlags8::PerClip | acl::RangeReductionFlags8::Rotations | acl::RangeReductionFlags8::Translations),
+			UniformlySampledAlgorithm(RotationFormat8::Quat_96, VectorFormat8::Vector3_48, RangeReductionFlags8::PerClip | acl::RangeReductionFlags8::Rotations | acl::RangeReductionFlags8::Translations),
+			UniformlySampledAlgorithm(RotationFormat8::Quat_96, VectorFormat8::Vector3_32, RangeReductionFlags8::PerClip | acl::RangeReductionFlags8::Rotations | acl::RangeReductionFlags8::Translations),
+			UniformlySampledAlgorithm(RotationFormat8::Quat_48, VectorFormat8::Vector3_96, RangeReductionFlags8::None),
+			UniformlySampledAlgorithm(RotationFormat8::Quat_48, VectorFormat8::Vector3_96, RangeReductionFlags8::PerClip | acl::RangeReductionFlags8::Rotations | acl::RangeReductionFlags8::Translations),
+			UniformlySampledAlgorithm(RotationFormat8::Quat_48, VectorFormat8::Vector3_48, RangeReductionFlags8::PerClip | acl::RangeReductionFlags8::Rotations | acl::RangeReductionFlags8::Translations),
+			UniformlySampledAlgorithm(RotationFormat8::Quat_48, VectorFormat8::Vector3_32, RangeReductionFlags8::PerClip | acl::RangeReductionFlags8::Rotations | acl::RangeReductionFlags8::Translations),
+			UniformlySampledAlgorithm(RotationFormat8::Quat_32, VectorFormat8::Vector3_96, RangeReductionFlags8::None),
+			UniformlySampledAlgorithm(RotationFormat8::Quat_32, VectorFormat8::Vector3_96, RangeReductionFlags8::PerClip | acl::RangeReductionFlags8::Rotations | acl::RangeReductionFlags8::Translations),
+			UniformlySampledAlgorithm(RotationFormat8::Quat_32, VectorFormat8::Vector3_48, RangeReductionFlags8::PerClip | acl::RangeReductionFlags8::Rotations | acl::RangeReductionFlags8::Translations),
+			UniformlySampledAlgorithm(RotationFormat8::Quat_32, VectorFormat8::Vector3_32, RangeReductionFlags8::PerClip | acl::RangeReductionFlags8::Rotations | acl::RangeReductionFlags8::Translations),
+		};
+
+		for (UniformlySampledAlgorithm& algorithm : uniform_tests)
+			bench_algorithm(options, allocator, *clip.get(), *skeleton.get(), algorithm);
+	}
+
+	if (IsDebuggerPresent())
+	{
+		printf("Press any key to continue...\n");
+		while (_kbhit() == 0);
+	}
+
+	return 0;
+}
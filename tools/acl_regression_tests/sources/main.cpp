@@ -0,0 +1,583 @@
+////////////////////////////////////////////////////////////////////////////////
+// The MIT License (MIT)
+//
+// Copyright (c) 2017 Nicholas Frechette & Animation Compression Library contributors
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+////////////////////////////////////////////////////////////////////////////////
+
+#include "acl/core/memory.h"
+#include "acl/compression/skeleton.h"
+#include "acl/compression/animation_clip.h"
+#include "acl/compression/skeleton_error_metric.h"
+
+#include "acl/algorithm/uniformly_sampled/algorithm.h"
+
+#include <Windows.h>
+
+#include <cstring>
+#include <cstdio>
+#include <cstdlib>
+#include <cmath>
+
+// Decompression conformance and performance regression suite.
+//
+// The golden input is a deterministic procedurally generated clip so the suite
+// has no data file dependencies and the reference values never drift: the raw
+// tracks are recomputed identically on every run and every platform.
+//
+// For every rotation/translation format combination the compressor supports we
+// verify that:
+//   - the compressed clip round trips its header and hash
+//   - the pose error against the raw clip stays below the format threshold
+//   - both full pose decompression paths (through a context and through the
+//     algorithm interface) reconstruct bit identical values
+//   - bone by bone decoding matches the pose within the compressor tolerance,
+//     the scalar and SoA kernels are allowed to round differently
+//
+// Decompression is also timed and compared against a baseline stats file when
+// one is provided: a regression larger than 5% on any tracked timing fails the
+// run. The process exit code is the number of failures so the suite can gate a
+// build as a post build step. Regenerate the baseline on the reference machine
+// with -write_baseline after an intentional decoder change.
+
+struct LossyPoseWriterImpl : public acl::OutputWriter
+{
+	LossyPoseWriterImpl(acl::Allocator& allocator, uint16_t num_bones)
+		: m_allocator(allocator)
+		, m_transforms(acl::allocate_type_array<acl::Transform_32>(allocator, num_bones))
+		, m_num_bones(num_bones)
+	{}
+
+	~LossyPoseWriterImpl()
+	{
+		deallocate_type_array(m_allocator, m_transforms, m_num_bones);
+	}
+
+	void write_bone_rotation(uint32_t bone_index, const acl::Quat_32& rotation)
+	{
+		ACL_ENSURE(bone_index < m_num_bones, "Invalid bone index. %u >= %u", bone_index, m_num_bones);
+		m_transforms[bone_index].rotation = rotation;
+	}
+
+	void write_bone_translation(uint32_t bone_index, const acl::Vector4_32& translation)
+	{
+		ACL_ENSURE(bone_index < m_num_bones, "Invalid bone index. %u >= %u", bone_index, m_num_bones);
+		m_transforms[bone_index].translation = translation;
+	}
+
+	acl::Allocator& m_allocator;
+	acl::Transform_32* m_transforms;
+	uint16_t m_num_bones;
+};
+
+struct RawPoseWriterImpl : public acl::OutputWriter
+{
+	RawPoseWriterImpl(acl::Allocator& allocator, uint16_t num_bones)
+		: m_allocator(allocator)
+		, m_transforms(acl::allocate_type_array<acl::Transform_64>(allocator, num_bones))
+		, m_num_bones(num_bones)
+	{}
+
+	~RawPoseWriterImpl()
+	{
+		deallocate_type_array(m_allocator, m_transforms, m_num_bones);
+	}
+
+	void write_bone_rotation(uint32_t bone_index, const acl::Quat_64& rotation)
+	{
+		ACL_ENSURE(bone_index < m_num_bones, "Invalid bone index. %u >= %u", bone_index, m_num_bones);
+		m_transforms[bone_index].rotation = rotation;
+	}
+
+	void write_bone_translation(uint32_t bone_index, const acl::Vector4_64& translation)
+	{
+		ACL_ENSURE(bone_index < m_num_bones, "Invalid bone index. %u >= %u", bone_index, m_num_bones);
+		m_transforms[bone_index].translation = translation;
+	}
+
+	acl::Allocator& m_allocator;
+	acl::Transform_64* m_transforms;
+	uint16_t m_num_bones;
+};
+
+struct Options
+{
+	const char*		baseline_filename;
+	const char*		write_baseline_filename;
+
+	Options()
+		: baseline_filename(nullptr)
+		, write_baseline_filename(nullptr)
+	{}
+};
+
+constexpr char* BASELINE_OPTION = "-baseline=";
+constexpr char* WRITE_BASELINE_OPTION = "-write_baseline=";
+
+static bool parse_options(int argc, char** argv, Options& options)
+{
+	for (int arg_index = 1; arg_index < argc; ++arg_index)
+	{
+		const char* argument = argv[arg_index];
+
+		size_t option_length = std::strlen(BASELINE_OPTION);
+		if (std::strncmp(argument, BASELINE_OPTION, option_length) == 0)
+		{
+			options.baseline_filename = argument + option_length;
+			continue;
+		}
+
+		option_length = std::strlen(WRITE_BASELINE_OPTION);
+		if (std::strncmp(argument, WRITE_BASELINE_OPTION, option_length) == 0)
+		{
+			options.write_baseline_filename = argument + option_length;
+			continue;
+		}
+
+		printf("Unrecognized option %s\n", argument);
+		return false;
+	}
+
+	return true;
+}
+
+//////////////////////////////////////////////////////////////////////////
+// Golden clip
+
+constexpr uint16_t NUM_TEST_BONES = 16;
+constexpr uint32_t NUM_TEST_SAMPLES = 120;
+constexpr uint32_t TEST_SAMPLE_RATE = 30;
+
+// Bones with special tracks so the constant and default paths are covered
+constexpr uint16_t CONSTANT_TEST_BONE = 5;
+constexpr uint16_t DEFAULT_TEST_BONE = 9;
+
+static acl::RigidSkeleton* build_regression_skeleton(acl::Allocator& allocator)
+{
+	using namespace acl;
+
+	RigidBone bones[NUM_TEST_BONES];
+	for (uint16_t bone_index = 1; bone_index < NUM_TEST_BONES; ++bone_index)
+	{
+		bones[bone_index].parent_index = bone_index - 1;
+		bones[bone_index].vertex_distance = 3.0;
+	}
+
+	return allocate_type<RigidSkeleton>(allocator, allocator, bones, NUM_TEST_BONES);
+}
+
+static acl::AnimationClip* build_regression_clip(acl::Allocator& allocator, const acl::RigidSkeleton& skeleton)
+{
+	using namespace acl;
+
+	AnimationClip* clip = allocate_type<AnimationClip>(allocator, allocator, skeleton, NUM_TEST_SAMPLES, TEST_SAMPLE_RATE, String(allocator, "regression"), 0.01);
+	AnimatedBone* bones = clip->get_bones();
+
+	for (uint32_t sample_index = 0; sample_index < NUM_TEST_SAMPLES; ++sample_index)
+	{
+		double sample_phase = double(sample_index) / double(NUM_TEST_SAMPLES);
+
+		for (uint16_t bone_index = 0; bone_index < NUM_TEST_BONES; ++bone_index)
+		{
+			AnimatedBone& bone = bones[bone_index];
+
+			if (bone_index == DEFAULT_TEST_BONE)
+			{
+				bone.rotation_track.set_sample(sample_index, quat_identity_64());
+				bone.translation_track.set_sample(sample_index, vector_zero_64());
+				continue;
+			}
+
+			if (bone_index == CONSTANT_TEST_BONE)
+			{
+				bone.rotation_track.set_sample(sample_index, quat_from_axis_angle(vector_set(0.0, 0.0, 1.0), 0.3));
+				bone.translation_track.set_sample(sample_index, vector_set(0.25, -0.5, 0.125));
+				continue;
+			}
+
+			// Deterministic animated tracks, amplitude well within a quaternion
+			// and a sub meter translation range
+			double angle = 0.7 * acl::sin(sample_phase * 6.283185307179586 + double(bone_index) * 0.35);
+			Vector4_64 axis = vector_set(0.267261241912424, 0.534522483824849, 0.801783725737273);
+			bone.rotation_track.set_sample(sample_index, quat_from_axis_angle(axis, angle));
+
+			Vector4_64 translation = vector_set(
+				0.4 * acl::sin(sample_phase * 6.283185307179586) + double(bone_index) * 0.05,
+				0.3 * acl::cos(sample_phase * 6.283185307179586 * 2.0),
+				0.2 * sample_phase);
+			bone.translation_track.set_sample(sample_index, translation);
+		}
+	}
+
+	return clip;
+}
+
+//////////////////////////////////////////////////////////////////////////
+// Conformance
+
+static bool bit_exact(const acl::Transform_32& lhs, const acl::Transform_32& rhs)
+{
+	using namespace acl;
+
+	return quat_get_x(lhs.rotation) == quat_get_x(rhs.rotation)
+		&& quat_get_y(lhs.rotation) == quat_get_y(rhs.rotation)
+		&& quat_get_z(lhs.rotation) == quat_get_z(rhs.rotation)
+		&& quat_get_w(lhs.rotation) == quat_get_w(rhs.rotation)
+		&& vector_get_x(lhs.translation) == vector_get_x(rhs.translation)
+		&& vector_get_y(lhs.translation) == vector_get_y(rhs.translation)
+		&& vector_get_z(lhs.translation) == vector_get_z(rhs.translation);
+}
+
+// Both full pose decompression paths must reconstruct bit identical values: a
+// context primed once and the stateless algorithm interface run the same code.
+// Bone by bone decoding goes through the scalar kernels while some pose paths
+// use the SoA kernels which round differently, it is checked within the same
+// tolerance acl_compressor uses instead of bit for bit
+static uint32_t run_conformance(acl::Allocator& allocator, const acl::AnimationClip& clip, const acl::RigidSkeleton& skeleton,
+								const acl::CompressedClip& compressed_clip, acl::IAlgorithm& algorithm, double error_threshold, const char* combo_name)
+{
+	using namespace acl;
+	using namespace acl::uniformly_sampled;
+
+	uint32_t num_failures = 0;
+
+	uint16_t num_bones = clip.get_num_bones();
+	uint32_t num_samples = clip.get_num_samples();
+	float clip_duration = float(clip.get_duration());
+	float sample_increment = 1.0f / float(clip.get_sample_rate());
+
+	RawPoseWriterImpl raw_pose(allocator, num_bones);
+	LossyPoseWriterImpl context_pose(allocator, num_bones);
+	Transform_32* algorithm_pose = allocate_type_array<Transform_32>(allocator, num_bones);
+
+	SkeletonErrorMetricContext error_metric_context(allocator, skeleton);
+	AnimationClipSamplingContext sampling_context(clip);
+
+	DecompressionSettings settings;
+	DecompressionContext<DecompressionSettings> context;
+	context.initialize(allocator, compressed_clip);
+
+	double max_error = -1.0;
+	bool poses_bit_exact = true;
+	bool bones_match = true;
+
+	float sample_time = 0.0f;
+	for (uint32_t sample_index = 0; sample_index < num_samples; ++sample_index)
+	{
+		context.seek(sample_time);
+		decompress_pose(context, context_pose);
+
+		algorithm.decompress_pose(compressed_clip, sample_time, algorithm_pose, num_bones);
+
+		sampling_context.seek(sample_time);
+		sampling_context.sample_pose(raw_pose);
+
+		double error = error_metric_context.calculate_error(raw_pose.m_transforms, context_pose.m_transforms);
+		max_error = max(max_error, error);
+
+		for (uint16_t bone_index = 0; bone_index < num_bones; ++bone_index)
+		{
+			poses_bit_exact &= bit_exact(context_pose.m_transforms[bone_index], algorithm_pose[bone_index]);
+
+			Transform_32 bone_transform;
+			decompress_bone(context, bone_index, &bone_transform.rotation, &bone_transform.translation);
+			bones_match &= quat_near_equal(context_pose.m_transforms[bone_index].rotation, bone_transform.rotation);
+			bones_match &= vector_near_equal3(context_pose.m_transforms[bone_index].translation, bone_transform.translation);
+		}
+
+		sample_time = min(sample_time + sample_increment, clip_duration);
+	}
+
+	if (max_error > error_threshold)
+	{
+		printf("FAILED: %s max error %.5f exceeds threshold %.5f\n", combo_name, max_error, error_threshold);
+		num_failures++;
+	}
+
+	if (!poses_bit_exact)
+	{
+		printf("FAILED: %s context and algorithm pose decompression differ\n", combo_name);
+		num_failures++;
+	}
+
+	if (!bones_match)
+	{
+		printf("FAILED: %s pose and bone decompression differ\n", combo_name);
+		num_failures++;
+	}
+
+	deallocate_type_array(allocator, algorithm_pose, num_bones);
+
+	return num_failures;
+}
+
+//////////////////////////////////////////////////////////////////////////
+// Performance
+
+// How many full playback passes we time per measurement
+constexpr uint32_t NUM_DECOMPRESSION_PASSES = 100;
+
+// Best of N measurements, scheduling noise only ever makes a run slower
+constexpr uint32_t NUM_TIMING_RUNS = 5;
+
+// A timing more than 5% over its baseline fails the run
+constexpr double REGRESSION_TOLERANCE = 1.05;
+
+static double measure_decompression_us_per_pose(acl::Allocator& allocator, const acl::AnimationClip& clip, const acl::CompressedClip& compressed_clip)
+{
+	using namespace acl;
+	using namespace acl::uniformly_sampled;
+
+	uint16_t num_bones = clip.get_num_bones();
+	uint32_t num_samples = clip.get_num_samples();
+	float clip_duration = float(clip.get_duration());
+	float sample_increment = 1.0f / float(clip.get_sample_rate());
+
+	LossyPoseWriterImpl pose_writer(allocator, num_bones);
+
+	DecompressionSettings settings;
+	DecompressionContext<DecompressionSettings> context;
+	context.initialize(allocator, compressed_clip);
+
+	LARGE_INTEGER frequency_cycles_per_sec;
+	QueryPerformanceFrequency(&frequency_cycles_per_sec);
+
+	uint64_t best_cycles = ~0ull;
+
+	for (uint32_t run_index = 0; run_index < NUM_TIMING_RUNS; ++run_index)
+	{
+		LARGE_INTEGER start_time_cycles;
+		QueryPerformanceCounter(&start_time_cycles);
+
+		for (uint32_t pass_index = 0; pass_index < NUM_DECOMPRESSION_PASSES; ++pass_index)
+		{
+			float sample_time = 0.0f;
+			for (uint32_t sample_index = 0; sample_index < num_samples; ++sample_index)
+			{
+				context.seek(sample_time);
+				decompress_pose(context, pose_writer);
+				sample_time = min(sample_time + sample_increment, clip_duration);
+			}
+		}
+
+		LARGE_INTEGER end_time_cycles;
+		QueryPerformanceCounter(&end_time_cycles);
+
+		uint64_t elapsed_cycles = end_time_cycles.QuadPart - start_time_cycles.QuadPart;
+		best_cycles = elapsed_cycles < best_cycles ? elapsed_cycles : best_cycles;
+	}
+
+	double cycles_to_us = 1000000.0 / double(frequency_cycles_per_sec.QuadPart);
+	return double(best_cycles) * cycles_to_us / double(NUM_DECOMPRESSION_PASSES * num_samples);
+}
+
+//////////////////////////////////////////////////////////////////////////
+// Baseline stats file, same 'key: value' line format as the other tools
+
+constexpr uint32_t MAX_TRACKED_TIMINGS = 32;
+
+struct TimingEntry
+{
+	char key[128];
+	double value_us;
+};
+
+static uint32_t read_baseline(const char* filename, TimingEntry* entries, uint32_t max_entries)
+{
+	std::FILE* file = nullptr;
+	fopen_s(&file, filename, "r");
+	if (file == nullptr)
+	{
+		printf("Could not open baseline file %s\n", filename);
+		return 0;
+	}
+
+	uint32_t num_entries = 0;
+	char line[256];
+	while (num_entries < max_entries && std::fgets(line, sizeof(line), file) != nullptr)
+	{
+		const char* separator = std::strrchr(line, ':');
+		if (separator == nullptr)
+			continue;
+
+		size_t key_length = separator - line;
+		if (key_length == 0 || key_length >= sizeof(entries[num_entries].key))
+			continue;
+
+		std::memcpy(entries[num_entries].key, line, key_length);
+		entries[num_entries].key[key_length] = '\0';
+		entries[num_entries].value_us = atof(separator + 1);
+		num_entries++;
+	}
+
+	std::fclose(file);
+	return num_entries;
+}
+
+static void write_baseline(const char* filename, const TimingEntry* entries, uint32_t num_entries)
+{
+	std::FILE* file = nullptr;
+	fopen_s(&file, filename, "w");
+	if (file == nullptr)
+	{
+		printf("Could not open baseline file %s for writing\n", filename);
+		return;
+	}
+
+	for (uint32_t entry_index = 0; entry_index < num_entries; ++entry_index)
+		fprintf(file, "%s: %.4f\n", entries[entry_index].key, entries[entry_index].value_us);
+
+	std::fclose(file);
+}
+
+static uint32_t check_against_baseline(const TimingEntry* baseline, uint32_t num_baseline_entries, const TimingEntry* measured, uint32_t num_measured_entries)
+{
+	uint32_t num_failures = 0;
+
+	for (uint32_t baseline_index = 0; baseline_index < num_baseline_entries; ++baseline_index)
+	{
+		const TimingEntry& baseline_entry = baseline[baseline_index];
+
+		for (uint32_t measured_index = 0; measured_index < num_measured_entries; ++measured_index)
+		{
+			const TimingEntry& measured_entry = measured[measured_index];
+			if (std::strcmp(baseline_entry.key, measured_entry.key) != 0)
+				continue;
+
+			if (measured_entry.value_us > baseline_entry.value_us * REGRESSION_TOLERANCE)
+			{
+				printf("FAILED: %s regressed: %.4f us > %.4f us (baseline %.4f us + 5%%)\n",
+					measured_entry.key, measured_entry.value_us, baseline_entry.value_us * REGRESSION_TOLERANCE, baseline_entry.value_us);
+				num_failures++;
+			}
+			break;
+		}
+	}
+
+	return num_failures;
+}
+
+//////////////////////////////////////////////////////////////////////////
+
+struct FormatCombo
+{
+	acl::RotationFormat8 rotation_format;
+	acl::VectorFormat8 translation_format;
+	acl::RangeReductionFlags8 range_reduction;
+	double error_threshold;
+};
+
+int main(int argc, char** argv)
+{
+	using namespace acl;
+
+	Options options;
+
+	if (!parse_options(argc, argv, options))
+	{
+		return -1;
+	}
+
+	Allocator allocator;
+
+	RigidSkeleton* skeleton = build_regression_skeleton(allocator);
+	AnimationClip* clip = build_regression_clip(allocator, *skeleton);
+
+	// Every format combination acl_compressor measures, with an error threshold
+	// per format: the raw formats must be nearly exact, the packed formats trade
+	// precision for size and their error budget reflects it
+	constexpr RangeReductionFlags8 per_clip_range_reduction = RangeReductionFlags8::PerClip | RangeReductionFlags8::Rotations | RangeReductionFlags8::Translations;
+	const FormatCombo format_combos[] =
+	{
+		{ RotationFormat8::Quat_128, VectorFormat8::Vector3_96, RangeReductionFlags8::None, 0.001 },
+		{ RotationFormat8::Quat_128, VectorFormat8::Vector3_96, per_clip_range_reduction, 0.001 },
+		{ RotationFormat8::Quat_128, VectorFormat8::Vector3_48, per_clip_range_reduction, 0.01 },
+		{ RotationFormat8::Quat_128, VectorFormat8::Vector3_32, per_clip_range_reduction, 0.1 },
+		{ RotationFormat8::Quat_96, VectorFormat8::Vector3_96, RangeReductionFlags8::None, 0.001 },
+		{ RotationFormat8::Quat_96, VectorFormat8::Vector3_96, per_clip_range_reduction, 0.001 },
+		{ RotationFormat8::Quat_96, VectorFormat8::Vector3_48, per_clip_range_reduction, 0.01 },
+		{ RotationFormat8::Quat_96, VectorFormat8::Vector3_32, per_clip_range_reduction, 0.1 },
+		{ RotationFormat8::Quat_48, VectorFormat8::Vector3_96, RangeReductionFlags8::None, 0.01 },
+		{ RotationFormat8::Quat_48, VectorFormat8::Vector3_96, per_clip_range_reduction, 0.01 },
+		{ RotationFormat8::Quat_48, VectorFormat8::Vector3_48, per_clip_range_reduction, 0.01 },
+		{ RotationFormat8::Quat_48, VectorFormat8::Vector3_32, per_clip_range_reduction, 0.1 },
+		{ RotationFormat8::Quat_32, VectorFormat8::Vector3_96, RangeReductionFlags8::None, 0.5 },
+		{ RotationFormat8::Quat_32, VectorFormat8::Vector3_96, per_clip_range_reduction, 0.5 },
+		{ RotationFormat8::Quat_32, VectorFormat8::Vector3_48, per_clip_range_reduction, 0.5 },
+		{ RotationFormat8::Quat_32, VectorFormat8::Vector3_32, per_clip_range_reduction, 0.5 },
+	};
+	constexpr uint32_t num_format_combos = sizeof(format_combos) / sizeof(FormatCombo);
+	static_assert(num_format_combos <= MAX_TRACKED_TIMINGS, "Too many format combinations to track");
+
+	TimingEntry measured_timings[MAX_TRACKED_TIMINGS];
+	uint32_t num_measured_timings = 0;
+
+	uint32_t num_failures = 0;
+
+	for (uint32_t combo_index = 0; combo_index < num_format_combos; ++combo_index)
+	{
+		const FormatCombo& combo = format_combos[combo_index];
+
+		char combo_name[128];
+		sprintf_s(combo_name, "%s %s %s", get_rotation_format_name(combo.rotation_format), get_vector_format_name(combo.translation_format),
+			combo.range_reduction == RangeReductionFlags8::None ? "raw" : "ranged");
+
+		UniformlySampledAlgorithm algorithm(combo.rotation_format, combo.translation_format, combo.range_reduction);
+		CompressedClip* compressed_clip = algorithm.compress_clip(allocator, *clip, *skeleton);
+
+		if (compressed_clip == nullptr || !compressed_clip->is_valid(true))
+		{
+			printf("FAILED: %s did not produce a valid compressed clip\n", combo_name);
+			num_failures++;
+			continue;
+		}
+
+		num_failures += run_conformance(allocator, *clip, *skeleton, *compressed_clip, algorithm, combo.error_threshold, combo_name);
+
+		TimingEntry& timing = measured_timings[num_measured_timings++];
+		sprintf_s(timing.key, "Regression %s warm pose time (us)", combo_name);
+		timing.value_us = measure_decompression_us_per_pose(allocator, *clip, *compressed_clip);
+
+		allocator.deallocate(compressed_clip, compressed_clip->get_size());
+	}
+
+	if (options.baseline_filename != nullptr)
+	{
+		TimingEntry baseline_timings[MAX_TRACKED_TIMINGS];
+		uint32_t num_baseline_timings = read_baseline(options.baseline_filename, baseline_timings, MAX_TRACKED_TIMINGS);
+		if (num_baseline_timings == 0)
+			num_failures++;
+		else
+			num_failures += check_against_baseline(baseline_timings, num_baseline_timings, measured_timings, num_measured_timings);
+	}
+
+	if (options.write_baseline_filename != nullptr)
+		write_baseline(options.write_baseline_filename, measured_timings, num_measured_timings);
+
+	deallocate_type(allocator, clip);
+	deallocate_type(allocator, skeleton);
+
+	if (num_failures == 0)
+		printf("Regression suite passed: %u format combinations\n", num_format_combos);
+	else
+		printf("Regression suite FAILED: %u failures\n", num_failures);
+
+	return int(num_failures);
+}